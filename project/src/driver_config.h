@@ -107,6 +107,8 @@
 #define CONFIG_UART1_RX_ENABLE_INTERRUPT                FALSE       /*!< Enable/Disable(Polling) UART1 RX Interrupt */
 
 #define CONFIG_ENABLE_DRIVER_SERIAL_FLASH               TRUE        /*!< Enable/Disable Serial Flash Driver */
+#define SERIAL_FLASH_DMA_EN                             FALSE       /*!< Enable/Disable Serial Flash DMA bulk read */
+#define SERIAL_FLASH_READ_AHEAD_EN                      FALSE       /*!< Enable/Disable Serial Flash read-ahead cache, need DMA bulk read */
 
 #define CONFIG_ENABLE_DRIVER_I2C                        TRUE        /*!< Enable/Disable I2C Driver */
 #define CONFIG_I2C_DEFAULT_IRQHANDLER                   FALSE       /*!< Enable/Disable I2C Default IRQ Handler */
@@ -176,6 +178,7 @@
 
 /// target configuration
 #define GPIO_CALLBACK_EN                                TRUE        /*!< Enable/Disable GPIO Driver Callback */
+#define GPIO_EDGE_CAPTURE_EN                            FALSE       /*!< Enable/Disable timestamped GPIO edge capture */
 
 #define UART_DMA_EN                                     FALSE       /*!< Enable/Disable UART DMA function */
 #define UART_CALLBACK_EN                                TRUE        /*!< Enable/Disable UART Driver Callback */
@@ -196,6 +199,7 @@
 #define TIMER1_CALLBACK_EN                              TRUE        /*!< Enable/Disable Timer1 Driver Callback */
 #define TIMER2_CALLBACK_EN                              TRUE        /*!< Enable/Disable Timer2 Driver Callback */
 #define TIMER3_CALLBACK_EN                              TRUE        /*!< Enable/Disable Timer3 Driver Callback */
+#define TIMER_WHEEL_EN                                  FALSE       /*!< Enable/Disable software timers multiplexed on Timer1, not with the 32k RCO */
 
 #define RTC_CALLBACK_EN                                 TRUE        /*!< Enable/Disable RTC Driver Callback */
 #define RTC_CAP_CALLBACK_EN                             TRUE        /*!< Enable/Disable RTC Capture Driver Callback */
@@ -206,6 +210,7 @@
 #define ADC_DMA_EN                                      FALSE       /*!< Enable/Disable ADC DMA function */
 #define ADC_CALLBACK_EN                                 TRUE        /*!< Enable/Disable ADC Driver Callback */
 #define ADC_WCMP_CALLBACK_EN                            TRUE        /*!< Enable/Disable ADC WCMP Callback */
+#define ADC_STREAM_EN                                   FALSE       /*!< Enable/Disable ADC double-buffered streaming */
 
 #define ACMP_CALLBACK_EN                                TRUE        /*!< Enable/Disable Analog Comparator Driver Callback */
 
@@ -213,6 +218,7 @@
 
 #define SLEEP_CALLBACK_EN                               TRUE        /*!< Enable/Disable Sleep Wakeup Callback */
 #define SLEEP_CONFIG_EN                                 TRUE        /*!< Enable/Disable User Config Before Enter Sleep */
+#define SLEEP_STAT_EN                                   FALSE       /*!< Enable/Disable Sleep residency and wakeup statistics */
 #define ACMP_WAKEUP_EN                                  FALSE       /*!< Enable/Disable Analog comparator wakeup MCU */
 #define GPIO_WAKEUP_EN                                  TRUE        /*!< Enable/Disable GPIO wakeup MCU */
 #define SLEEP_TIMER_WAKEUP_EN                           TRUE        /*!< Enable/Disable Sleep timer wakeup MCU */
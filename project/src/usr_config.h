@@ -72,6 +72,61 @@
 /// NVDS WRTIE SUPPORT
 // #define CFG_NVDS_WRITE
 
+/// Record store
+// Log-structured record store in the internal flash. CFG_REC_STORE_SECTOR_NUM sectors (4KB each)
+// from CFG_REC_STORE_BASE_ADDR are used as a circular log, at least 3 sectors are needed.
+// The region shall not overlap the application code, the OTA firmware 2 area or the OTA data,
+// which take the flash from 0x12000: the default region can not be used with CFG_PRF_OTAS.
+// #define CFG_REC_STORE
+// #define CFG_REC_STORE_BASE_ADDR     0x1A000
+// #define CFG_REC_STORE_SECTOR_NUM    4
+// #define CFG_REC_STORE_MAX_RECORDS   32
+
+/// GATT discovery cache
+// Keep the handles discovered by the profile clients per bonded device in the record store,
+// and enable the clients with PRF_CON_NORMAL on the next connections. The cached handles are
+// dropped by a Service Changed indication of the peer. Needs CFG_REC_STORE and CFG_SVC_DISC.
+// #define CFG_DISC_CACHE
+
+/// Glucose record store
+// Keep the glucose measurements of GLPS in a circular log of CFG_GLPS_REC_SECTOR_NUM sectors
+// (127 records each) from CFG_GLPS_REC_BASE_ADDR, and execute the RACP requests on it. The
+// oldest sector is dropped when the log is full. Costs about 200 bytes RAM per sector.
+// The default region ends at the record store. It shall not overlap the record store, the
+// application code or the OTA firmware 2 and data areas, which take the flash from 0x12000.
+// The log shall end in the 128KB flash, at most 31 sectors from 0x1000 (3937 records).
+// #define CFG_GLPS_REC
+// #define CFG_GLPS_REC_BASE_ADDR      0x16000
+// #define CFG_GLPS_REC_SECTOR_NUM     4
+
+/// Beacon scanner
+// Keep the advertisers found by the scan in a hash table of CFG_BEACON_SCAN_SIZE slots (power
+// of 2, 64 bytes each) with their averaged RSSI and decoded iBeacon/Eddystone fields. A summary
+// is printed every CFG_BEACON_SCAN_REPORT seconds, the devices not seen for CFG_BEACON_SCAN_AGE
+// seconds are removed. The observer scan does not filter the duplicated reports.
+// #define CFG_BEACON_SCAN
+// #define CFG_BEACON_SCAN_SIZE        64
+// #define CFG_BEACON_SCAN_REPORT      10
+// #define CFG_BEACON_SCAN_AGE         30
+
+/// Measurement notification scheduler
+// Queue the HRPS, HTPT and BLPS measurements sent with app_ntf_*_send() in one queue of
+// CFG_NTF_SCHED_SIZE entries (about 28 bytes each) in deadline order. With
+// CFG_MULTI_NOTIFICATION_IN_ONE_EVENT, up to CFG_NTF_SCHED_CREDITS PDUs are in flight.
+// #define CFG_NTF_SCHED
+// #define CFG_NTF_SCHED_SIZE          8
+// #define CFG_NTF_SCHED_CREDITS       4
+
+/// Kernel message profiler
+// Count the kernel messages handled by the application and the profiles, and measure the
+// handler execution time and the queue residency with SysTick. Costs about 2KB RAM.
+// #define CFG_MSG_PROF
+
+/// BLE heap monitor
+// Paint the BLE heap to find the peak usage, count the ke_malloc()/ke_msg_alloc() calls of
+// the application and the profiles by size, and probe the free blocks on demand.
+// #define CFG_HEAP_MON
+
 /// Test mode controll pin
 //#define CFG_TEST_CTRL_PIN GPIO_P31
 
@@ -85,6 +140,12 @@
 // consumption.
 #define CFG_MEM_RETENTION   (MEM_BLOCK1 | MEM_BLOCK2 | MEM_BLOCK3 | MEM_BLOCK4 | MEM_BLOCK5 | MEM_BLOCK6 | MEM_BLOCK7)
 
+/// Memory map
+// Find the banks used by the application image and the BLE stack from the linker symbols,
+// and retain only them in sleep instead of CFG_MEM_RETENTION. Data declared with
+// APP_MEM_NORETENTION is placed in a bank of its own which is powered down in sleep.
+// #define CFG_MEM_MAP
+
 /// Deep sleep support
 #define CFG_DEEP_SLEEP
 
@@ -113,6 +174,11 @@
 /// Debug trace option
 // #define CFG_DBG_TRACE_MORE
 
+/// Tokenized debug print, QPRINTF sends the format string address and raw arguments
+// #define CFG_DBG_TOKEN
+/// Tokenized debug print buffer size
+// #define CFG_DBG_TOKEN_BUF_SIZE 512
+
 /// Debug information
 #define CFG_DBG_INFO
 
@@ -146,6 +212,12 @@
 /// Security
 #define CFG_SECURITY_ON
 
+/// Maximum number of bonded devices
+// Each bonded device takes one NVDS tag from APP_NVDS_DB_START_TAG, up to 49 devices.
+// 49 devices take 3176 bytes of the 4KB NVDS sector with the system tags, 3960 bytes with
+// CSRK support (test/host/test_bond.c).
+// #define CFG_BONDED_DEV_NUM  8
+
 /// ATT parts
 //#define CFG_ATTC
 #define CFG_ATTS
@@ -34,6 +34,9 @@
 #include "gpio.h"
 #include "button.h"
 #include "sleep.h"
+#if GPIO_EDGE_CAPTURE_EN==TRUE || BLE_HID_DEVICE
+#include "bletime.h"
+#endif
 
 
 /*
@@ -72,6 +75,12 @@
  */
 
 struct usr_env_tag usr_env = {LED_ON_DUR_IDLE, LED_OFF_DUR_IDLE};
+
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/// Button 1 gesture recognition
+static struct button_gesture_tag usr_button1;
+#endif
+
 uint8_t adv1_data[] = {0x02,GAP_AD_TYPE_FLAGS,GAP_BR_EDR_NOT_SUPPORTED,0x04,GAP_AD_TYPE_SHORTENED_NAME,
                         'N', 'X' , 'P'}; // "NXP"
 
@@ -106,6 +115,11 @@ uint8_t scan_data[] = {0x05,0x12,0x06,0x00,0x80,0x0c}; //Slave Connection Interv
 /**
  ****************************************************************************************
  * @brief   Led1 for BLE status
+ * @description
+ *  Each blink takes two kernel timers, the chip wakes up from sleep to switch the LED on and
+ *  off. It can not blink in hardware: the PWM and the timers run from the AHB clock which is
+ *  stopped in sleep, they hold the chip in idle mode while enabled, and LED1 (P0.5 on the
+ *  miniDK) has no PWM or timer output.
  ****************************************************************************************
  */
 static void usr_led1_set(uint16_t timer_on, uint16_t timer_off)
@@ -359,30 +373,16 @@ void usr_sleep_restore(void)
 
 /**
  ****************************************************************************************
- * @brief Handles button press after cancel the jitter.
- *
- * @param[in] msgid     Id of the message received
- * @param[in] param     None
- * @param[in] dest_id   TASK_APP
- * @param[in] src_id    TASK_APP
- *
- * @return If the message was consumed or not.
+ * @brief   Button 1 click, start or stop adv
  ****************************************************************************************
  */
-int app_button_timer_handler(ke_msg_id_t const msgid, void const *param,
-                               ke_task_id_t const dest_id, ke_task_id_t const src_id)
+static void usr_button1_click(void)
 {
-    switch(msgid)
+    if(APP_IDLE == ke_state_get(TASK_APP))
     {
-        case APP_SYS_BUTTON_1_TIMER:
-            // make sure the button is pressed
-            if(gpio_read_pin(BUTTON1_PIN) == GPIO_LOW)
-            {
-                if(APP_IDLE == ke_state_get(TASK_APP))
-                {
-                    if(!app_qpps_env->enabled)
-                    {
-                        // start adv
+        if(!app_qpps_env->enabled)
+        {
+            // start adv
 //                        app_gap_adv_start_req(GAP_GEN_DISCOVERABLE|GAP_UND_CONNECTABLE,
 //                                app_env.adv_data, app_set_adv_data(GAP_GEN_DISCOVERABLE),
 //                                app_env.scanrsp_data, app_set_scan_rsp_data(app_get_local_service_flag()),
@@ -394,22 +394,94 @@ int app_button_timer_handler(ke_msg_id_t const msgid, void const *param,
 										ke_timer_set(APP_BEACON_CHG_CTX_TIMER, TASK_APP, 10);
 
 #if (QN_DEEP_SLEEP_EN)
-                        // prevent entering into deep sleep mode
-                        sleep_set_pm(PM_SLEEP);
+            // prevent entering into deep sleep mode
+            sleep_set_pm(PM_SLEEP);
 #endif
-                    }
-                }
-                else if(APP_ADV == ke_state_get(TASK_APP))
-                {
-                    // stop adv
-                    app_gap_adv_stop_req();
+        }
+    }
+    else if(APP_ADV == ke_state_get(TASK_APP))
+    {
+        // stop adv
+        app_gap_adv_stop_req();
 
 #if (QN_DEEP_SLEEP_EN)
-                    // allow entering into deep sleep mode
-                    sleep_set_pm(PM_DEEP_SLEEP);
+        // allow entering into deep sleep mode
+        sleep_set_pm(PM_DEEP_SLEEP);
 #endif
-                }
+    }
+}
+
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/**
+ ****************************************************************************************
+ * @brief   Get the button 1 gestures
+ * @description
+ *  The edges are given to the recognizer in the GPIO interrupt (usr_button1_cb), it is read
+ *  here with the interrupts disabled. The kernel timer is only set while a gesture waits for
+ *  a timeout (debounce, or long press and double click gap if they are enabled).
+ ****************************************************************************************
+ */
+static void usr_button1_process(void)
+{
+    enum button_gesture gesture;
+    uint32_t delay;
+
+    while (1)
+    {
+        GLOBAL_INT_DISABLE();
+        gesture = button_gesture_get(&usr_button1, (uint32_t)qn_clock_us(), &delay);
+        GLOBAL_INT_RESTORE();
+        if (gesture == BUTTON_GESTURE_NONE)
+            break;
+
+        switch (gesture)
+        {
+            case BUTTON_GESTURE_CLICK:
+                usr_button1_click();
+                break;
+
+            case BUTTON_GESTURE_DOUBLE_CLICK:
+            case BUTTON_GESTURE_LONG_PRESS:
+            default:
+                break;
+        }
+    }
+
+    // the kernel timer counts 10ms
+    if (delay)
+        ke_timer_set(APP_SYS_BUTTON_1_TIMER, TASK_APP, (delay + 9999) / 10000);
+    else
+        ke_timer_clear(APP_SYS_BUTTON_1_TIMER, TASK_APP);
+}
+#endif
+
+/**
+ ****************************************************************************************
+ * @brief Handles button press after cancel the jitter.
+ *
+ * @param[in] msgid     Id of the message received
+ * @param[in] param     None
+ * @param[in] dest_id   TASK_APP
+ * @param[in] src_id    TASK_APP
+ *
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+int app_button_timer_handler(ke_msg_id_t const msgid, void const *param,
+                               ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    switch(msgid)
+    {
+        case APP_SYS_BUTTON_1_TIMER:
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+            usr_button1_process();
+#else
+            // make sure the button is pressed
+            if(gpio_read_pin(BUTTON1_PIN) == GPIO_LOW)
+            {
+                usr_button1_click();
             }
+#endif
             break;
 
         default:
@@ -437,9 +509,14 @@ void app_event_button1_press_handler(void)
     }
 #endif
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+    ke_evt_clear(1UL << EVENT_BUTTON1_PRESS_ID);
+    usr_button1_process();
+#else
     // delay 20ms to debounce
     ke_timer_set(APP_SYS_BUTTON_1_TIMER, TASK_APP, 2);
     ke_evt_clear(1UL << EVENT_BUTTON1_PRESS_ID);
+#endif
 }
 
 /**
@@ -451,6 +528,21 @@ void app_event_button1_press_handler(void)
  */
 void usr_button1_cb(void)
 {
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+    struct gpio_edge edge;
+    bool start = false;
+
+    // only the first edge of a press or a release needs the kernel, the bounces are timed
+    // by the debounce timer it sets
+    while (gpio_edge_get(&edge))
+    {
+        if (edge.pin == BUTTON1_PIN)
+            start |= button_gesture_edge(&usr_button1, edge.level, edge.time);
+    }
+    if (!start)
+        return;
+#endif
+
     // If BLE is in the sleep mode, wakeup it.
     if(ble_ext_wakeup_allow())
     {
@@ -507,6 +599,17 @@ void gpio_interrupt_callback(enum gpio_pin pin)
  */
 void usr_init(void)
 {
+#if GPIO_EDGE_CAPTURE_EN==TRUE || BLE_HID_DEVICE
+    // the edges and the report latencies are timed by the RTC, it pauses in deep sleep
+    // while no gesture is in progress, there is no deep sleep in a connection
+    qn_time_init();
+    qn_clock_keep(false);
+#endif
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+    // the click is the only gesture used, it is reported at the release
+    button_gesture_init(&usr_button1, 0);
+#endif
+
     if(KE_EVENT_OK != ke_evt_callback_set(EVENT_BUTTON1_PRESS_ID, 
                                             app_event_button1_press_handler))
     {
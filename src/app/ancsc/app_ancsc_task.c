@@ -39,6 +39,383 @@ struct app_ancsc_env_tag *app_ancsc_env = &app_env.ancsc_ev[0];
 
 /// @endcond
 
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Requested attributes: AppIdentifier, Title and Message of at most APP_ANCSC_ATTR_MAX_LEN bytes
+static const uint8_t app_ancsc_attr_list[] =
+{
+    APP_ANCSC_ATTR_APP_ID,
+    APP_ANCSC_ATTR_TITLE, APP_ANCSC_ATTR_MAX_LEN, 0x00,
+    APP_ANCSC_ATTR_MESSAGE, APP_ANCSC_ATTR_MAX_LEN, 0x00
+};
+
+/// Cache slot of the requested attributes, in the order of app_ancsc_attr_list
+static const uint8_t app_ancsc_attr_id[APP_ANCSC_ATTR_NB] =
+{
+    APP_ANCSC_ATTR_APP_ID,
+    APP_ANCSC_ATTR_TITLE,
+    APP_ANCSC_ATTR_MESSAGE
+};
+
+/// Fetch priority of the categories, the highest first
+static const uint8_t app_ancsc_category_prio[CATEGORYID_ENTERTAINMENT + 1] =
+{
+    [CATEGORYID_OTHER]              = 0,
+    [CATEGORYID_INCOMINGCALL]       = 7,
+    [CATEGORYID_MISSEDCALL]         = 6,
+    [CATEGORYID_VOICEMAIL]          = 5,
+    [CATEGORYID_SOCIAL]             = 3,
+    [CATEGORYID_SCHEDULE]           = 5,
+    [CATEGORYID_EMAIL]              = 3,
+    [CATEGORYID_NEWS]               = 1,
+    [CATEGORYID_HEALTH_FITNESS]     = 2,
+    [CATEGORYID_BUSINESS_FINANCE]   = 2,
+    [CATEGORYID_LOCATION]           = 2,
+    [CATEGORYID_ENTERTAINMENT]      = 1,
+};
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Return true if the pending notification a shall be fetched before b
+static bool app_ancsc_ntf_before(struct ancsc_pending_ntf const *a, struct ancsc_pending_ntf const *b)
+{
+    if (a->prio != b->prio)
+    {
+        return (a->prio > b->prio);
+    }
+
+    return ((int16_t)(a->seq - b->seq) < 0);
+}
+
+/// Move the pending notification at pos up or down the heap to its place
+static void app_ancsc_queue_sift(struct app_ancsc_env_tag *env, uint8_t pos)
+{
+    struct ancsc_pending_ntf ntf = env->queue[pos];
+    uint8_t child;
+
+    // Up
+    while ((pos > 0) && app_ancsc_ntf_before(&ntf, &env->queue[(pos - 1) / 2]))
+    {
+        env->queue[pos] = env->queue[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+
+    // Down
+    while ((child = 2 * pos + 1) < env->queue_nb)
+    {
+        if ((child + 1 < env->queue_nb) && app_ancsc_ntf_before(&env->queue[child + 1], &env->queue[child]))
+        {
+            child++;
+        }
+        if (!app_ancsc_ntf_before(&env->queue[child], &ntf))
+        {
+            break;
+        }
+        env->queue[pos] = env->queue[child];
+        pos = child;
+    }
+
+    env->queue[pos] = ntf;
+}
+
+/// Find a pending notification, return APP_ANCSC_QUEUE_SIZE if not found
+static uint8_t app_ancsc_queue_find(struct app_ancsc_env_tag const *env, uint32_t ntf_uid)
+{
+    uint8_t pos;
+
+    for (pos = 0; pos < env->queue_nb; pos++)
+    {
+        if (env->queue[pos].ntf_uid == ntf_uid)
+        {
+            return pos;
+        }
+    }
+
+    return APP_ANCSC_QUEUE_SIZE;
+}
+
+/// Remove the pending notification at pos
+static void app_ancsc_queue_remove(struct app_ancsc_env_tag *env, uint8_t pos)
+{
+    env->queue_nb--;
+    if (pos != env->queue_nb)
+    {
+        env->queue[pos] = env->queue[env->queue_nb];
+        app_ancsc_queue_sift(env, pos);
+    }
+}
+
+/// Queue a notification, the least urgent one is dropped if the queue is full
+static void app_ancsc_queue_push(struct app_ancsc_env_tag *env, struct ancsc_ntf_source const *src)
+{
+    struct ancsc_pending_ntf ntf;
+    uint8_t pos;
+    uint8_t last;
+
+    if (app_ancsc_queue_find(env, src->ntf_uid) != APP_ANCSC_QUEUE_SIZE)
+    {
+        return;
+    }
+
+    ntf.ntf_uid = src->ntf_uid;
+    ntf.seq = env->seq++;
+    ntf.category_id = src->category_id;
+    ntf.prio = (src->category_id <= CATEGORYID_ENTERTAINMENT) ? (app_ancsc_category_prio[src->category_id] << 1) : 0;
+    if (src->event_flags & IMPORTANT_FLAG)
+    {
+        ntf.prio |= 1;
+    }
+
+    if (env->queue_nb < APP_ANCSC_QUEUE_SIZE)
+    {
+        pos = env->queue_nb++;
+    }
+    else
+    {
+        // The least urgent notification is one of the leaves
+        last = APP_ANCSC_QUEUE_SIZE / 2;
+        for (pos = last + 1; pos < APP_ANCSC_QUEUE_SIZE; pos++)
+        {
+            if (app_ancsc_ntf_before(&env->queue[last], &env->queue[pos]))
+            {
+                last = pos;
+            }
+        }
+
+        env->stat.drop_nb++;
+        if (!app_ancsc_ntf_before(&ntf, &env->queue[last]))
+        {
+            QPRINTF("Queue full, notification %d dropped\r\n", ntf.ntf_uid);
+            return;
+        }
+        QPRINTF("Queue full, notification %d dropped\r\n", env->queue[last].ntf_uid);
+        pos = last;
+    }
+
+    env->queue[pos] = ntf;
+    app_ancsc_queue_sift(env, pos);
+}
+
+/// Find the cache entry of a notification, return APP_ANCSC_CACHE_SIZE if not found
+static uint8_t app_ancsc_cache_find(struct app_ancsc_env_tag const *env, uint32_t ntf_uid)
+{
+    uint8_t i;
+
+    for (i = 0; i < APP_ANCSC_CACHE_SIZE; i++)
+    {
+        if (env->cache[env->lru[i]].valid && (env->cache[env->lru[i]].ntf_uid == ntf_uid))
+        {
+            return i;
+        }
+    }
+
+    return APP_ANCSC_CACHE_SIZE;
+}
+
+/// Move the cache entry at position pos of the LRU list to the front (used) or the back (dropped)
+static void app_ancsc_cache_move(struct app_ancsc_env_tag *env, uint8_t pos, bool front)
+{
+    uint8_t entry = env->lru[pos];
+
+    if (front)
+    {
+        for (; pos > 0; pos--)
+        {
+            env->lru[pos] = env->lru[pos - 1];
+        }
+    }
+    else
+    {
+        for (; pos < APP_ANCSC_CACHE_SIZE - 1; pos++)
+        {
+            env->lru[pos] = env->lru[pos + 1];
+        }
+    }
+
+    env->lru[pos] = entry;
+}
+
+/// Clear the attribute cache
+static void app_ancsc_cache_reset(struct app_ancsc_env_tag *env)
+{
+    uint8_t i;
+
+    env->cache_slot = GAP_INVALID_CONIDX;
+    memset(env->cache, 0, sizeof(env->cache));
+    for (i = 0; i < APP_ANCSC_CACHE_SIZE; i++)
+    {
+        env->lru[i] = i;
+    }
+}
+
+/// Print the attributes of a notification
+static void app_ancsc_cache_show(struct ancsc_attr_cache const *entry, bool cached)
+{
+    uint8_t i, j;
+
+    QPRINTF("NotificationUID %d, CategoryID %d%s\r\n", entry->ntf_uid, entry->category_id,
+            cached ? " (cached)" : "");
+    for (i = 0; i < APP_ANCSC_ATTR_NB; i++)
+    {
+        QPRINTF("  Attribute %d: ", app_ancsc_attr_id[i]);
+        for (j = 0; j < entry->len[i]; j++)
+        {
+            QPRINTF("%c", entry->value[i][j]);
+        }
+        QPRINTF("\r\n");
+    }
+}
+
+/// Fetch the attributes of the most urgent pending notification
+static void app_ancsc_fetch_next(uint8_t idx)
+{
+    struct app_ancsc_env_tag *env = &app_ancsc_env[idx];
+    struct ancsc_attr_cache *entry;
+
+    if (env->fetching)
+    {
+        return;
+    }
+
+    if (env->queue_nb == 0)
+    {
+        QPRINTF("\r\nAll NOTIFY info successfully recieved! fetch %d, cache hit %d, dropped %d, timeout %d\r\n",
+                env->stat.fetch_nb, env->stat.hit_nb, env->stat.drop_nb, env->stat.timeout_nb);
+        return;
+    }
+
+    // The least recently used entry receives the attributes
+    env->fetch_entry = env->lru[APP_ANCSC_CACHE_SIZE - 1];
+    entry = &env->cache[env->fetch_entry];
+    entry->ntf_uid = env->queue[0].ntf_uid;
+    entry->category_id = env->queue[0].category_id;
+    entry->valid = false;
+    memset(entry->len, 0, sizeof(entry->len));
+    app_ancsc_queue_remove(env, 0);
+
+    env->fetching = true;
+    env->ntf_uid = entry->ntf_uid;
+    env->parser.state = ANCSC_PARSE_CMD_ID;
+    env->stat.fetch_nb++;
+    app_ancsc_get_ntf_attribute_req(env->ntf_uid, sizeof(app_ancsc_attr_list),
+                                    (uint8_t *)app_ancsc_attr_list, env->conhdl);
+    ke_timer_set(ANCS_FETCH_TIMER0 + idx, TASK_APP, APP_ANCSC_FETCH_TIMEOUT);
+}
+
+/// End the on-going fetch and start the next one
+static void app_ancsc_fetch_end(uint8_t idx, bool complete)
+{
+    struct app_ancsc_env_tag *env = &app_ancsc_env[idx];
+    struct ancsc_attr_cache *entry = &env->cache[env->fetch_entry];
+    uint8_t pos;
+
+    ke_timer_clear(ANCS_FETCH_TIMER0 + idx, TASK_APP);
+    env->fetching = false;
+    if (complete)
+    {
+        entry->valid = true;
+        for (pos = 0; env->lru[pos] != env->fetch_entry; pos++)
+        {
+        }
+        app_ancsc_cache_move(env, pos, true);
+        app_ancsc_cache_show(entry, false);
+    }
+
+    app_ancsc_fetch_next(idx);
+}
+
+/// Parse a Data Source fragment, the state is kept for the next fragment
+static void app_ancsc_parse_data_source(uint8_t idx, uint8_t const *data, uint16_t len)
+{
+    struct app_ancsc_env_tag *env = &app_ancsc_env[idx];
+    struct ancsc_data_source_parser *p = &env->parser;
+    struct ancsc_attr_cache *entry = &env->cache[env->fetch_entry];
+    uint16_t nb;
+    uint8_t i;
+
+    while (len != 0)
+    {
+        switch (p->state)
+        {
+            case ANCSC_PARSE_CMD_ID:
+                p->state = ANCSC_PARSE_UID;
+                p->cnt = 0;
+                p->field = 0;
+                p->attr_nb = 0;
+                data++;
+                len--;
+                break;
+
+            case ANCSC_PARSE_UID:
+            case ANCSC_PARSE_ATTR_LEN:
+                p->field |= (uint32_t)(*data++) << (8 * p->cnt++);
+                len--;
+                if ((p->state == ANCSC_PARSE_UID) && (p->cnt == 4))
+                {
+                    // A late response of a dropped fetch is parsed but not kept
+                    p->store = env->fetching && (p->field == env->ntf_uid);
+                    p->state = ANCSC_PARSE_ATTR_ID;
+                }
+                else if ((p->state == ANCSC_PARSE_ATTR_LEN) && (p->cnt == 2))
+                {
+                    p->remain = (uint16_t)p->field;
+                    p->state = ANCSC_PARSE_ATTR_VAL;
+                }
+                break;
+
+            case ANCSC_PARSE_ATTR_ID:
+                for (i = 0; (i < APP_ANCSC_ATTR_NB) && (app_ancsc_attr_id[i] != *data); i++)
+                {
+                }
+                p->attr_slot = p->store ? i : APP_ANCSC_ATTR_NB;
+                p->state = ANCSC_PARSE_ATTR_LEN;
+                p->cnt = 0;
+                p->field = 0;
+                data++;
+                len--;
+                break;
+
+            default: // ANCSC_PARSE_ATTR_VAL
+                nb = (len < p->remain) ? len : p->remain;
+                if (p->attr_slot < APP_ANCSC_ATTR_NB)
+                {
+                    i = APP_ANCSC_ATTR_MAX_LEN - entry->len[p->attr_slot];
+                    if (i > nb)
+                    {
+                        i = nb;
+                    }
+                    memcpy(&entry->value[p->attr_slot][entry->len[p->attr_slot]], data, i);
+                    entry->len[p->attr_slot] += i;
+                }
+                data += nb;
+                len -= nb;
+                p->remain -= nb;
+                break;
+        }
+
+        // Attribute complete
+        if ((p->state == ANCSC_PARSE_ATTR_VAL) && (p->remain == 0))
+        {
+            p->state = ANCSC_PARSE_ATTR_ID;
+            if (++p->attr_nb == APP_ANCSC_ATTR_NB)
+            {
+                p->state = ANCSC_PARSE_CMD_ID;
+                if (p->store)
+                {
+                    app_ancsc_fetch_end(idx, true);
+                }
+                break;
+            }
+        }
+    }
+}
+
 /*
  * FUNCTION DEFINITIONS
  ****************************************************************************************
@@ -124,73 +501,112 @@ int app_ancsc_ancs_content_ind_handler(ke_msg_id_t const msgid,
 
 /*
  ****************************************************************************************
- * @brief check and handle the cached notify requests  *//**
+ * @brief clear the buffer when connection borken. *//**
  *
- * @param[in] idx       index of current connection
- * @param[in] conhle    current connected handle
+ * @param[in] idx       the index of the current connection
  * @description
  *
- * This handler is called when one notification had handled completely
+ * This function is called when the role is enabled and disabled, the pending notifications,
+ * the on-going fetch and the Data Source parser are reset. The attribute cache is kept.
  *
  ****************************************************************************************
  */
-void app_ancsc_send_ancs_attribute_req_next(uint8_t idx,uint16_t conhdl)
+void app_ancsc_clear_buffer(uint8_t idx)
 {
-   uint8_t ntf_cnt = app_ancsc_env[idx].ntf_cnt;
-   uint8_t rd_cnt = app_ancsc_env[idx].rd_ntf_cnt;
-   uint8_t index;
-    
-   if(rd_cnt < ntf_cnt)
-   {     
-       // find the ntf index to be handled
-       for(index = rd_cnt;index < ntf_cnt;)
-       {
-            if(app_ancsc_env[idx].ancs_source_record[index].handle_flag == 1) 
-                break;
-            else
-                index++;
-       }
-        app_ancsc_env[idx].ancs_source_record[index].handle_flag = 0;
-        app_ancsc_env[idx].rd_ntf_cnt = (index); 
-        app_ancsc_get_ntf_attribute_req(app_ancsc_env[idx].ancs_source_record[index].data_record.ntf_source.ntf_uid, app_ancsc_env[idx].req_cmd_len, app_ancsc_env[idx].req_cmd, conhdl);
-        app_ancsc_env[idx].ntf_uid = app_ancsc_env[idx].ancs_source_record[index].data_record.ntf_source.ntf_uid;
-       
-   }
-   else
-   {
-       memset(app_ancsc_env[idx].ancs_source_record,0,sizeof(struct ancsc_record_data_st)*APP_ANCSC_SOURCE_MAX_RECORD);
-       app_ancsc_env[idx].ntf_cnt = 0;
-       app_ancsc_env[idx].rd_ntf_cnt = 0;
-       app_ancsc_env[idx].rd_ntf_flag = ANCSC_RD_NTF_FINISHED;
-       app_ancsc_env[idx].rd_attr_flag = ANCSC_RD_ATTR_FINISHED;
-       QPRINTF("\r\nAll NOTIFY info successfully recieved!\r\n");
-   }
+    struct app_ancsc_env_tag *env = &app_ancsc_env[idx];
+
+    ke_timer_clear(ANCS_FETCH_TIMER0 + idx, TASK_APP);
+    env->fetching = false;
+    env->queue_nb = 0;
+    env->parser.state = ANCSC_PARSE_CMD_ID;
+    memset(&env->stat, 0, sizeof(env->stat));
 }
+
 /*
  ****************************************************************************************
- * @brief clear the buffer when connection borken. *//**
+ * @brief Take the attribute cache of the connected peer. *//**
  *
- * 
+ * @param[in] idx       the index of the current connection
  * @description
  *
- * This handler is called when disconnection happened
+ * This function is called when the role is enabled. The cache of a bonded peer is kept from
+ * its previous connection, it is moved from the index of that connection if the peer
+ * reconnected on another one. The cache is tagged with the bonded slot of the peer, not
+ * with its address which changes when the NP uses a resolvable private address. The cache
+ * is cleared for a new peer or a peer not bonded when the role is enabled.
  *
  ****************************************************************************************
  */
-void app_ancsc_clear_buffer(void)
+void app_ancsc_cache_attach(uint8_t idx)
 {
-   
-    uint8_t idx = KE_IDX_GET(TASK_ANCSC);
-    app_ancsc_env[idx].ntf_cnt = 0;
-    app_ancsc_env[idx].rd_ntf_cnt = 0;
-    app_ancsc_env[idx].rd_ntf_flag = ANCSC_RD_NTF_FINISHED;
-    app_ancsc_env[idx].rd_attr_flag = ANCSC_RD_ATTR_FINISHED;
-    app_ancsc_env[idx].recv_data_source.length = 0;
-    memset(app_ancsc_env[idx].ancs_source_record,0,sizeof(struct ancsc_record_data_st)*APP_ANCSC_SOURCE_MAX_RECORD);
-    memset(app_ancsc_env[idx].recv_data_source.data_souce_buffer,0,APP_ANCSC_DATA_SOURCE_BUFFER_LEN);
+    struct app_ancsc_env_tag *env = &app_ancsc_env[idx];
+    struct app_ancsc_env_tag *prev;
+    struct bd_addr addr;
+    uint8_t slot = GAP_INVALID_CONIDX;
+    uint8_t i;
 
-    
+    if (app_get_bd_addr_by_idx(idx, &addr))
+    {
+        slot = app_find_bonded_dev(&addr);
+    }
+
+    if ((slot != GAP_INVALID_CONIDX) && (env->cache_slot == slot))
+    {
+        return;
+    }
+
+    app_ancsc_cache_reset(env);
+    if (slot == GAP_INVALID_CONIDX)
+    {
+        return;
+    }
+    env->cache_slot = slot;
+
+    for (i = 0; i < BLE_CONNECTION_MAX; i++)
+    {
+        prev = &app_ancsc_env[i];
+        if ((i != idx) && !prev->enabled && (prev->cache_slot == slot))
+        {
+            memcpy(env->lru, prev->lru, sizeof(env->lru));
+            memcpy(env->cache, prev->cache, sizeof(env->cache));
+            app_ancsc_cache_reset(prev);
+            break;
+        }
+    }
 }
+
+/*
+ ****************************************************************************************
+ * @brief Drop the attribute cache of a bonded slot. *//**
+ *
+ * @param[in] slot      the bonded slot given to another peer
+ * @description
+ *
+ * This function is called when a new peer is bonded in the slot. A cache in use on a
+ * connection is kept until the role is disabled.
+ *
+ ****************************************************************************************
+ */
+void app_ancsc_cache_drop(uint8_t slot)
+{
+    uint8_t i;
+
+    for (i = 0; i < BLE_CONNECTION_MAX; i++)
+    {
+        if (app_ancsc_env[i].cache_slot == slot)
+        {
+            if (app_ancsc_env[i].enabled)
+            {
+                app_ancsc_env[i].cache_slot = GAP_INVALID_CONIDX;
+            }
+            else
+            {
+                app_ancsc_cache_reset(&app_ancsc_env[i]);
+            }
+        }
+    }
+}
+
 /*
  ****************************************************************************************
  * @brief Handler of the error occuration from peer device ANCS. *//**
@@ -199,23 +615,20 @@ void app_ancsc_clear_buffer(void)
  * @param[in] status    current status of the operation e
  * @description
  *
- * This handler is called when the error retured from Apple device
+ * This handler is called when the error retured from Apple device, the on-going fetch is
+ * dropped and the next pending notification is fetched.
  *
  ****************************************************************************************
  */
 void app_ancsc_get_ntf_error_handler(uint8_t idx, uint8_t status)
 {
-   
- 
-   app_ancsc_env[idx].ancs_source_record[app_ancsc_env[idx].rd_ntf_cnt].handle_flag = 0;
-   app_ancsc_env[idx].rd_ntf_cnt++;
-   app_ancsc_env[idx].rd_attr_flag = ANCSC_RD_ATTR_FINISHED;
-   app_ancsc_env[idx].recv_ntf_att_cnt = 0;
-   app_ancsc_env[idx].recv_data_source.length = 0;
-   memset(app_ancsc_env[idx].recv_data_source.data_souce_buffer,0,APP_ANCSC_DATA_SOURCE_BUFFER_LEN);
-   app_ancsc_send_ancs_attribute_req_next(idx,0);
-    
+    app_ancsc_env[idx].parser.state = ANCSC_PARSE_CMD_ID;
+    if (app_ancsc_env[idx].fetching)
+    {
+        app_ancsc_fetch_end(idx, false);
+    }
 }
+
 /*
  ****************************************************************************************
  * @brief Accept and process of the Notification Source notification. *//**
@@ -228,257 +641,139 @@ void app_ancsc_get_ntf_error_handler(uint8_t idx, uint8_t status)
  * @description
  *
  * This handler is called once a Notification Source value has been received from the peer device 
- * upon a notification operation.
+ * upon a notification operation. An added notification is shown from the cache or queued for
+ * its attributes to be fetched, a modified one is fetched again and a removed one is dropped
+ * from the queue and the cache.
  *
  ****************************************************************************************
  */
-
 int app_ancsc_ntf_source_ind_handler(ke_msg_id_t const msgid,
                                      struct ancsc_ntf_source_ind *param,
                                      ke_task_id_t const dest_id,
                                      ke_task_id_t const src_id)
 {
     uint8_t idx = KE_IDX_GET(src_id);
-    uint8_t notify_idx = app_ancsc_env[idx].ntf_cnt;
-    uint8_t tag;
+    struct app_ancsc_env_tag *env = &app_ancsc_env[idx];
+    uint8_t pos;
+
     QPRINTF("EventID: %d, EventFlags: %d, CategoryID: %d, count: %d, NotificationUID: %d\r\n", 
                     param->ntf_source.event_id, 
                     param->ntf_source.event_flags,
                     param->ntf_source.category_id, 
                     param->ntf_source.category_count,
                     param->ntf_source.ntf_uid);
-   
-    uint8_t cmd[] = {0x00, 0x01, 0x20, 0x00,0x03,0x20,0x00};
-    app_ancsc_env[idx].req_cmd_len = sizeof(cmd);
-     // reference the ancs spec, here request 2 notify attributes
-    // 0x00: APPIDentifier
-    // 0x01: Title
-    // 0x03: Messeage
-    memcpy(app_ancsc_env[idx].req_cmd,cmd,app_ancsc_env[idx].req_cmd_len);
-    app_ancsc_env[idx].req_ntf_att_cnt = 0x03;
-    if (param->ntf_source.event_id == NOTIFICATION_ADDED)
-    {
-        if(app_ancsc_env[idx].rd_ntf_flag== ANCSC_RD_NTF_FINISHED)
-        { 
-            app_ancsc_env[idx].rd_ntf_flag = ANCSC_RD_NTF_ONGOING;
-            memset(app_ancsc_env[idx].ancs_source_record,0,sizeof(struct ancsc_record_data_st)*APP_ANCSC_SOURCE_MAX_RECORD);
-            memcpy(&app_ancsc_env[idx].ancs_source_record[notify_idx].data_record,param,sizeof(struct ancsc_ntf_source_ind));          
-            app_ancsc_env[idx].ntf_cnt = 1;
-            app_ancsc_env[idx].rd_ntf_cnt = 0;
-            app_ancsc_env[idx].rd_attr_flag = ANCSC_RD_ATTR_FINISHED;
-            app_ancsc_get_ntf_attribute_req(param->ntf_source.ntf_uid, sizeof(cmd), cmd, param->conhdl);
-            app_ancsc_env[idx].ntf_uid = param->ntf_source.ntf_uid;  
-            
+
+    pos = app_ancsc_cache_find(env, param->ntf_source.ntf_uid);
+
+    if (param->ntf_source.event_id == NOTIFICATION_REMOVED)
+    {
+        if (pos != APP_ANCSC_CACHE_SIZE)
+        {
+            env->cache[env->lru[pos]].valid = false;
+            app_ancsc_cache_move(env, pos, false);
         }
-        else
+
+        pos = app_ancsc_queue_find(env, param->ntf_source.ntf_uid);
+        if (pos != APP_ANCSC_QUEUE_SIZE)
         {
-            if(app_ancsc_env[idx].ntf_cnt >= APP_ANCSC_SOURCE_MAX_RECORD)
-            {
-                QPRINTF("\r\nWarning: Notification Buffer overfloat!!\r\n");
-            }  
-            else
-            {
-                 QPRINTF("Saved New notification in buffer!\r\n");
-                 memcpy(&app_ancsc_env[idx].ancs_source_record[notify_idx].data_record,param,sizeof(struct ancsc_ntf_source_ind)); 
-                 app_ancsc_env[idx].ntf_cnt++;
-                 app_ancsc_env[idx].ancs_source_record[notify_idx].handle_flag = 1;
-            }
-           
-            
+            app_ancsc_queue_remove(env, pos);
         }
-     
     }
-    else // if the notification is removed, travers the notify list delete the unhanlded notify
+    else if ((param->ntf_source.event_id == NOTIFICATION_ADDED) && (pos != APP_ANCSC_CACHE_SIZE))
     {
-       
-        for(tag = 0; tag < app_ancsc_env[idx].ntf_cnt;tag++)
+        env->stat.hit_nb++;
+        app_ancsc_cache_move(env, pos, true);
+        app_ancsc_cache_show(&env->cache[env->lru[0]], true);
+    }
+    else
+    {
+        // A modified notification is fetched again
+        if (pos != APP_ANCSC_CACHE_SIZE)
         {
-            if(param->ntf_source.ntf_uid == app_ancsc_env[idx].ancs_source_record[tag].data_record.ntf_source.ntf_uid)
-            {
-                app_ancsc_env[idx].ancs_source_record[tag].handle_flag = 0; 
-            }    
+            env->cache[env->lru[pos]].valid = false;
+            app_ancsc_cache_move(env, pos, false);
+        }
+
+        if (!env->fetching || (env->ntf_uid != param->ntf_source.ntf_uid))
+        {
+            app_ancsc_queue_push(env, &param->ntf_source);
+            app_ancsc_fetch_next(idx);
         }
-    
     }
+
     return (KE_MSG_CONSUMED);
 }
+
 /*
  ****************************************************************************************
- * @brief handle the bufferd data of the uncomplete attribute which are transfered in multi fragment *//**
+ * @brief Accept and process of the Data Source notification. *//**
  *
- * @param[in]  recv_data_st   Pointer of the cached data 
- * @param[out] attr_nbr       Number of complete attribute frame in the buffer 
- * @param[out] tail_id_pos    the last attr id postion in the current package 
- * @param[out] offset         offset of length, from which index the traverse begin  
- * @description 
+ * @param[in] msgid     ANCSC_DATA_SOURCE_IND
+ * @param[in] param     Pointer to struct ancsc_data_source_ind
+ * @param[in] dest_id   TASK_APP
+ * @param[in] src_id    TASK_ANCSC
+ * @return If the message was consumed or not.
+ * @description
  *
- * this API used for handling the package data of APP, by traversing the package , attr_nbr value is updated accordingly,
- * based on the tail_id_pos, the ramaind data will stored in the buffer, processing of the nest coming package will be 
- * different.
+ * This handler is called once a Data Source value has been received from the peer device 
+ * upon a notification operation. If the value is larger than the 20 bytes, it is split into 
+ * multiple fragments by the NP. Each fragment is parsed as it is received, the attribute values
+ * are written in the cache entry of the on-going fetch. The value is complete when the tuples
+ * of all the requested attributes have been received, the next notification is then fetched.
+ * The fetch timeout restarts at each fragment.
  *
  ****************************************************************************************
  */
-void app_ancsc_data_source_buffer(uint8_t *attr_nbr,uint8_t *tail_id_pos,uint8_t offset,struct ancsc_data_source_ind *param)
+int app_ancsc_data_source_ind_handler(ke_msg_id_t const msgid,
+                                      struct ancsc_data_source_ind *param,
+                                      ke_task_id_t const dest_id,
+                                      ke_task_id_t const src_id)
 {
-    uint16_t att_length = 0;
-    uint8_t index = 0;
-    uint8_t pos = offset;
-    for(pos = offset; pos < param->data_size;)
-    {
-        att_length = co_read16p(&param->data_source[pos+1]);    
-        
-        pos +=(att_length + APP_ANCSC_DATA_SOURCE_HEAD_LEN);
-        index ++;
+    uint8_t idx = KE_IDX_GET(src_id);
 
-     }
-    
-    if(pos > param->data_size)
+    if (app_ancsc_env[idx].fetching)
     {
-         pos -= (att_length + APP_ANCSC_DATA_SOURCE_HEAD_LEN);
-         index--;   
+        ke_timer_set(ANCS_FETCH_TIMER0 + idx, TASK_APP, APP_ANCSC_FETCH_TIMEOUT);
     }
 
-    *tail_id_pos = pos;
-    *attr_nbr = index;        
-         
+    app_ancsc_parse_data_source(idx, param->data_source, param->data_size);
 
-    
-  
+    return (KE_MSG_CONSUMED);
 }
+
 /*
  ****************************************************************************************
- * @brief Accept and process of the Data Source notification. *//**
+ * @brief Handles the fetch timer. *//**
  *
- * @param[in] msgid     ANCSC_DATA_SOURCE_IND
- * @param[in] param     Pointer to struct ancsc_data_source_ind
+ * @param[in] msgid     ANCS_FETCH_TIMER0 + idx
+ * @param[in] param     None
  * @param[in] dest_id   TASK_APP
- * @param[in] src_id    TASK_ANCSC
+ * @param[in] src_id    TASK_APP
  * @return If the message was consumed or not.
  * @description
  *
- * This handler is called once a Data Source value has been received from the peer device 
- * upon a notification operation. If the value is larger than the 20 bytes, it is split into 
- * multiple fragments by the NP. The NC must recompose the value by splicing each fragment.
- * The value is complete when the complete tuples for each requested attribute has been received.
+ * This handler is called when the NP has not sent the Data Source of the on-going fetch in
+ * time. The fetch is dropped and the next pending notification is fetched, a late response
+ * of the dropped fetch is parsed but not kept.
  *
  ****************************************************************************************
  */
-int app_ancsc_data_source_ind_handler(ke_msg_id_t const msgid,
-                                      struct ancsc_data_source_ind *param,
-                                      ke_task_id_t const dest_id,
-                                      ke_task_id_t const src_id)
+int app_ancsc_fetch_timer_handler(ke_msg_id_t const msgid,
+                                  void const *param,
+                                  ke_task_id_t const dest_id,
+                                  ke_task_id_t const src_id)
 {
-    uint8_t idx = KE_IDX_GET(src_id); 
-    uint8_t complete_attr_nbr = 0;
-    uint8_t tail_id_pos = 0;
-    uint32_t NotificationUid;
-    // current length of the received buffer 
-    uint8_t cur_len = app_ancsc_env[idx].recv_data_source.length;
-    //one attribute data had not been completely recieved ,so the coming data package is pure data ,we recieved and recompose it 
-    if(app_ancsc_env[idx].rd_attr_flag == ANCSC_RD_ATTR_ONGOING)
-    {
-        
-//            QPRINTF("ONGOING ---the param data buffer: cur_len = %d\r\n",cur_len);
-//            for (uint8_t i = 0; i < param->data_size; i++)
-//                 QPRINTF("%02x ", param->data_source[i]);
-//                QPRINTF("\r\n");
-        if(cur_len < APP_ANCSC_DATA_SOURCE_HEAD_LEN)
-        {
-        
-            memcpy(&app_ancsc_env[idx].recv_data_source.data_souce_buffer[cur_len],&param->data_source,3-cur_len);
-            app_ancsc_env[idx].cur_lack_data_len = co_read16p(&app_ancsc_env[idx].recv_data_source.data_souce_buffer[1]);
-            if(param->data_size - (APP_ANCSC_DATA_SOURCE_HEAD_LEN - cur_len) < app_ancsc_env[idx].cur_lack_data_len)
-            {
-                app_ancsc_env[idx].cur_lack_data_len -= (param->data_size - (APP_ANCSC_DATA_SOURCE_HEAD_LEN - cur_len));
-                app_ancsc_env[idx].recv_data_source.length = APP_ANCSC_DATA_SOURCE_HEAD_LEN;
-            }
-            else
-            {
-              
-                app_ancsc_env[idx].recv_ntf_att_cnt++;
-                app_ancsc_data_source_buffer(&complete_attr_nbr,&tail_id_pos,\
-                app_ancsc_env[idx].cur_lack_data_len + (APP_ANCSC_DATA_SOURCE_HEAD_LEN-cur_len),param);
-                memcpy(app_ancsc_env[idx].recv_data_source.data_souce_buffer,&param->data_source[tail_id_pos],(param->data_size - tail_id_pos));
-                app_ancsc_env[idx].cur_lack_data_len = 0;
-
-                app_ancsc_env[idx].recv_data_source.length = param->data_size - tail_id_pos;
-            }
-        }
-        else if(cur_len == APP_ANCSC_DATA_SOURCE_HEAD_LEN)
-        {
-           
-            if( app_ancsc_env[idx].cur_lack_data_len == 0)
-            {
-                app_ancsc_env[idx].cur_lack_data_len = co_read16p(&app_ancsc_env[idx].recv_data_source.data_souce_buffer[1]);
-            }
-            if(param->data_size < app_ancsc_env[idx].cur_lack_data_len)
-            {
-                app_ancsc_env[idx].cur_lack_data_len -= param->data_size;
-            }
-            else
-            {
-                app_ancsc_env[idx].recv_ntf_att_cnt++;
-                app_ancsc_data_source_buffer(&complete_attr_nbr,&tail_id_pos,app_ancsc_env[idx].cur_lack_data_len,param);
-                memcpy(app_ancsc_env[idx].recv_data_source.data_souce_buffer,&param->data_source[tail_id_pos],(param->data_size - tail_id_pos));
-                app_ancsc_env[idx].cur_lack_data_len = 0;
-                app_ancsc_env[idx].recv_data_source.length = param->data_size - tail_id_pos;
-            }
-        }
-        else // cur_len > APP_ANCSC_DATA_SOURCE_HEAD_LEN
-        {
-         
-            app_ancsc_env[idx].cur_lack_data_len = co_read16p(&app_ancsc_env[idx].recv_data_source.data_souce_buffer[1]);
-           
-            if( param->data_size + ( app_ancsc_env[idx].recv_data_source.length - APP_ANCSC_DATA_SOURCE_HEAD_LEN) < app_ancsc_env[idx].cur_lack_data_len)
-            {         
-                app_ancsc_env[idx].cur_lack_data_len -= (param->data_size + ( app_ancsc_env[idx].recv_data_source.length - APP_ANCSC_DATA_SOURCE_HEAD_LEN));
-                memset(&app_ancsc_env[idx].recv_data_source.data_souce_buffer[APP_ANCSC_DATA_SOURCE_HEAD_LEN],0,APP_ANCSC_DATA_SOURCE_BUFFER_LEN-APP_ANCSC_DATA_SOURCE_HEAD_LEN);
-                app_ancsc_env[idx].recv_data_source.length = APP_ANCSC_DATA_SOURCE_HEAD_LEN;
-            }
-            else
-            {         
-               
-                app_ancsc_env[idx].recv_ntf_att_cnt++;
-                app_ancsc_data_source_buffer(&complete_attr_nbr,&tail_id_pos,\
-                app_ancsc_env[idx].cur_lack_data_len - (app_ancsc_env[idx].recv_data_source.length - APP_ANCSC_DATA_SOURCE_HEAD_LEN),param);
-                memcpy(app_ancsc_env[idx].recv_data_source.data_souce_buffer,&param->data_source[tail_id_pos],(param->data_size - tail_id_pos));
-                app_ancsc_env[idx].cur_lack_data_len = 0;
-                app_ancsc_env[idx].recv_data_source.length = param->data_size - tail_id_pos;
-            }
-        }
+    uint8_t idx = msgid - ANCS_FETCH_TIMER0;
+
+    if (app_ancsc_env[idx].fetching)
+    {
+        QPRINTF("Notification %d fetch timeout\r\n", app_ancsc_env[idx].ntf_uid);
+        app_ancsc_env[idx].stat.timeout_nb++;
+        app_ancsc_env[idx].parser.state = ANCSC_PARSE_CMD_ID;
+        app_ancsc_fetch_end(idx, false);
     }
-    else //start one new attribute list reading
-    {
-        NotificationUid = co_read32p(&param->data_source[1]);
-        QPRINTF("\r\nNotificationUid = %d request attribute numbers = %d \r\n",NotificationUid,app_ancsc_env[idx].req_ntf_att_cnt);
-        memset(app_ancsc_env[idx].recv_data_source.data_souce_buffer,0,APP_ANCSC_DATA_SOURCE_BUFFER_LEN);
-        if(param->data_source[0] == 0 && NotificationUid == app_ancsc_env[idx].ntf_uid)
-        {  
-            app_ancsc_data_source_buffer(&complete_attr_nbr,&tail_id_pos,RAW_ANCSC_DATA_SOURCE_HEAD_LEN,param); 
-            memcpy(app_ancsc_env[idx].recv_data_source.data_souce_buffer,&param->data_source[tail_id_pos],param->data_size - tail_id_pos);
-            app_ancsc_env[idx].recv_data_source.length = param->data_size - tail_id_pos;
-           
-        }               
-    }
-    		
-    app_ancsc_env[idx].recv_ntf_att_cnt += complete_attr_nbr;
-    app_ancsc_env[idx].rd_attr_flag = (app_ancsc_env[idx].recv_ntf_att_cnt == app_ancsc_env[idx].req_ntf_att_cnt)?ANCSC_RD_ATTR_FINISHED:ANCSC_RD_ATTR_ONGOING;
-    if( app_ancsc_env[idx].rd_attr_flag == ANCSC_RD_ATTR_FINISHED)
-    {
-         
-            //all the attribute recieved ;
-            memset(app_ancsc_env[idx].recv_data_source.data_souce_buffer,0,APP_ANCSC_DATA_SOURCE_BUFFER_LEN);
-            app_ancsc_env[idx].recv_data_source.length = 0;
-            app_ancsc_env[idx].recv_ntf_att_cnt = 0;
-            app_ancsc_env[idx].ancs_source_record[app_ancsc_env[idx].rd_ntf_cnt].handle_flag = 0;
-            app_ancsc_env[idx].rd_ntf_cnt++;
-            QPRINTF("Total Notification Number [%d]  Current Notification [%d] handle OK\r\n",app_ancsc_env[idx].ntf_cnt,app_ancsc_env[idx].rd_ntf_cnt);
-            //check the notify record buffer,if any exist, continue to send control point cmd;
-            app_ancsc_send_ancs_attribute_req_next(idx,param->conhdl);
-    }  
-    
-    return (KE_MSG_CONSUMED);
 
+    return (KE_MSG_CONSUMED);
 }
 
 /*
@@ -512,6 +807,8 @@ int app_ancsc_cmp_evt_handler(ke_msg_id_t const msgid,
                 app_ancsc_env[idx].conhdl = param->conhdl;
                 app_ancsc_env[idx].enabled = true;
                 app_ancsc_env[idx].operation = ANCSC_OP_IDLE;
+                app_ancsc_clear_buffer(idx);
+                app_ancsc_cache_attach(idx);
                 app_ancsc_sm_entry(idx, param->status);   
             }
             else
@@ -579,6 +876,12 @@ int app_ancsc_disable_ind_handler(ke_msg_id_t const msgid,
     app_ancsc_env[idx].conhdl = 0xFF;
     app_ancsc_env[idx].enabled = false;
     app_ancsc_env[idx].operation = ANCSC_OP_IDLE;
+    app_ancsc_clear_buffer(idx);
+    // The NotificationUIDs of a peer which is not bonded are not kept
+    if (app_ancsc_env[idx].cache_slot == GAP_INVALID_CONIDX)
+    {
+        app_ancsc_cache_reset(&app_ancsc_env[idx]);
+    }
     
     QPRINTF("ANCSC disable indication\r\n");
 
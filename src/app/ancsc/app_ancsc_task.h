@@ -23,6 +23,17 @@
  * @brief Apple Notification Center Service NC Role Task API
  *
  * Apple Notification Center Service NC Task APIs are used to handle the message from ANCSC to APP.
+ *
+ * The notifications announced by the Notification Source wait in a queue ordered by priority
+ * (CategoryID, raised by the Important flag) then by arrival, and their attributes are fetched
+ * one at a time. The Data Source fragments are parsed as they arrive, the attribute values are
+ * written in a LRU cache keyed by NotificationUID. A notification found in the cache is not
+ * fetched again, a modified one is. When the queue is full, the least urgent notification is
+ * dropped. A fetch without Data Source for APP_ANCSC_FETCH_TIMEOUT is dropped.
+ *
+ * The NotificationUIDs are the ones of the NP, so the cache is kept for a bonded NP across
+ * its connections, also when it reconnects on another connection index. The cache of a peer
+ * which is not bonded is cleared when the role is disabled.
  * @{
  ****************************************************************************************
  */
@@ -37,33 +48,32 @@
 
 //NVDS tag for nvds serice handle
 #define APP_ANCSC_NVDS_TAG  (150)
-#define APP_ANCSC_SOURCE_MAX_RECORD (20)  // buffered notify max number, the first notification are included.
-#define APP_ANCSC_RD_ATTR_CMD_NUM_MAX   (3)
-#define APP_ANCSC_MAX_REQ_CMD_LEN (50)
-#define APP_ANCSC_DATA_SOURCE_BUFFER_LEN (64)
-/*  
- *   1  byte   :   attributeID   
- *   2  bytes :   length
- *   so the total length of data source header is 3
-*/
-#define APP_ANCSC_DATA_SOURCE_HEAD_LEN    3
-#define RAW_ANCSC_DATA_SOURCE_HEAD_LEN    5
-
-struct ntf_attr_frame
-{
-    uint16_t data_len;
-    uint8_t atrr_rd_cmp_count;
-    uint8_t attr_hdr_state;
-    uint16_t attr_remainer;
-};
+/// Notifications waiting for their attributes to be fetched
+#ifndef APP_ANCSC_QUEUE_SIZE
+#define APP_ANCSC_QUEUE_SIZE        (16)
+#endif
+/// Notifications whose attributes are kept in the cache
+#ifndef APP_ANCSC_CACHE_SIZE
+#define APP_ANCSC_CACHE_SIZE        (4)
+#endif
+/// Time without Data Source before a fetch is dropped, in 10ms
+#ifndef APP_ANCSC_FETCH_TIMEOUT
+#define APP_ANCSC_FETCH_TIMEOUT     (300)
+#endif
+/// Kept bytes of an attribute value, the longer values are truncated
+#define APP_ANCSC_ATTR_MAX_LEN      (32)
+/// Number of requested notification attributes
+#define APP_ANCSC_ATTR_NB           (3)
+
+/// Notification attribute IDs
 enum
 {
-    ATTR_HRD_NONE,
-    ATTR_ID_CMP,
-    ATTR_LEN_LOW_CMP,
-    ATTR_HRD_CMP,
-
+    APP_ANCSC_ATTR_APP_ID,
+    APP_ANCSC_ATTR_TITLE,
+    APP_ANCSC_ATTR_SUBTITLE,
+    APP_ANCSC_ATTR_MESSAGE
 };
+
 enum
 {
     ANCSC_OP_IDLE,
@@ -72,19 +82,15 @@ enum
     ANCSC_OP_CFG_DATA_SOURCE,
     ANCSC_OP_CONTROL_POINT
 };
-// current read notify status, 
 
+/// Data Source parser states, one per field of the Get Notification Attributes response
 enum
 {
-    ANCSC_RD_NTF_FINISHED,
-    ANCSC_RD_NTF_ONGOING
-};
-
-// reading attribute state flags
-enum
-{
-    ANCSC_RD_ATTR_FINISHED, // state--- reading an attribute is complete,so read the next attribute if exist
-    ANCSC_RD_ATTR_ONGOING   // state--- reading an attribute is not complete,next package is pure data without package head
+    ANCSC_PARSE_CMD_ID,
+    ANCSC_PARSE_UID,
+    ANCSC_PARSE_ATTR_ID,
+    ANCSC_PARSE_ATTR_LEN,
+    ANCSC_PARSE_ATTR_VAL
 };
 
 struct ancsc_service_info
@@ -93,18 +99,66 @@ struct ancsc_service_info
     struct ancsc_content ancs;
 };
 
-struct ancsc_recv_data_source_st
+/// Notification waiting for its attributes
+struct ancsc_pending_ntf
 {
-    //the length of the buffer
-    uint8_t length;
-    //buffer of the uncoplete attibute
-    uint8_t data_souce_buffer[APP_ANCSC_DATA_SOURCE_BUFFER_LEN];
+    /// Notification UID
+    uint32_t ntf_uid;
+    /// Arrival order, the notifications of the same priority are fetched in order
+    uint16_t seq;
+    /// Fetch priority, from the category and the event flags
+    uint8_t prio;
+    /// Category ID
+    uint8_t category_id;
 };
-struct ancsc_record_data_st
+
+/// Fetched attributes of a notification
+struct ancsc_attr_cache
+{
+    /// Notification UID
+    uint32_t ntf_uid;
+    /// Category ID
+    uint8_t category_id;
+    /// All the attributes have been received
+    bool valid;
+    /// Length of the kept attribute values
+    uint8_t len[APP_ANCSC_ATTR_NB];
+    /// Attribute values
+    uint8_t value[APP_ANCSC_ATTR_NB][APP_ANCSC_ATTR_MAX_LEN];
+};
+
+/// Data Source stream parser, the fragments are parsed as they are received
+struct ancsc_data_source_parser
 {
-    struct ancsc_ntf_source_ind  data_record;
-    uint8_t handle_flag; // hanlded: 0 ; other: 1
+    /// Field being parsed
+    uint8_t state;
+    /// Received bytes of the UID or length field
+    uint8_t cnt;
+    /// Received attributes
+    uint8_t attr_nb;
+    /// Cache slot of the current attribute, APP_ANCSC_ATTR_NB to skip its value
+    uint8_t attr_slot;
+    /// The response is the one of the on-going fetch
+    bool store;
+    /// Value bytes left of the current attribute
+    uint16_t remain;
+    /// UID or length field being received
+    uint32_t field;
 };
+
+/// Notification handling statistics
+struct ancsc_stat
+{
+    /// Attribute fetches
+    uint16_t fetch_nb;
+    /// Notifications found in the cache
+    uint16_t hit_nb;
+    /// Notifications dropped because the queue was full
+    uint16_t drop_nb;
+    /// Fetches dropped by the timeout
+    uint16_t timeout_nb;
+};
+
 /// Apple Notification Center Service NC environment variable
 struct app_ancsc_env_tag
 {
@@ -114,31 +168,31 @@ struct app_ancsc_env_tag
     uint8_t operation;
     /// Connection handle
     uint16_t conhdl;
-    /// Notification UID
+    /// Notification UID of the on-going fetch
     uint32_t ntf_uid;
     struct ancsc_content ancs;
-
-    struct ancsc_record_data_st  ancs_source_record[APP_ANCSC_SOURCE_MAX_RECORD];
-   
-    uint8_t ntf_cnt;
-    uint8_t rd_ntf_cnt;
-    bool  rd_ntf_flag;
     uint16_t enable_count;
-    //uint8_t stop_timer;
-    
-    
-     bool rd_attr_flag; // current state of read attrbute, if one attriute is not complete, the next data package is pure data without head 
-    //number of the requested notify attributes , used for recomposing the data source fragments
-    uint16_t cur_lack_data_len;
-    uint8_t req_ntf_att_cnt;
-    //request cmd content buffer, store the cmd
-    uint8_t req_cmd[APP_ANCSC_MAX_REQ_CMD_LEN];
-    //cmd length
-    uint8_t req_cmd_len;
-    //attribute number that had been successfully recieved
-    uint8_t recv_ntf_att_cnt;
-    // store the broken data,eg. some data source may divided into serveral parts then splice the frament.
-    struct ancsc_recv_data_source_st recv_data_source;
+
+    /// A Get Notification Attributes command is on-going
+    bool fetching;
+    /// Cache entry filled by the on-going fetch
+    uint8_t fetch_entry;
+    /// Number of pending notifications
+    uint8_t queue_nb;
+    /// Arrival counter of the notifications
+    uint16_t seq;
+    /// Pending notifications, binary heap with the most urgent one first
+    struct ancsc_pending_ntf queue[APP_ANCSC_QUEUE_SIZE];
+    /// Bonded slot of the peer whose notifications are in the cache, GAP_INVALID_CONIDX if none
+    uint8_t cache_slot;
+    /// Cache entry indexes, the most recently used first
+    uint8_t lru[APP_ANCSC_CACHE_SIZE];
+    /// Attribute cache
+    struct ancsc_attr_cache cache[APP_ANCSC_CACHE_SIZE];
+    /// Data Source parser
+    struct ancsc_data_source_parser parser;
+    /// Statistics
+    struct ancsc_stat stat;
 };
 
 /*
@@ -192,6 +246,17 @@ int app_ancsc_cmp_evt_handler(ke_msg_id_t const msgid,
                               ke_task_id_t const dest_id,
                               ke_task_id_t const src_id);
 
+/*
+ ****************************************************************************************
+ * @brief Drop the on-going fetch when no Data Source has been received in time.
+ *
+ ****************************************************************************************
+ */
+int app_ancsc_fetch_timer_handler(ke_msg_id_t const msgid,
+                                  void const *param,
+                                  ke_task_id_t const dest_id,
+                                  ke_task_id_t const src_id);
+
 /*
  ****************************************************************************************
  * @brief Handles the disable indication to APP.
@@ -206,17 +271,31 @@ int app_ancsc_disable_ind_handler(ke_msg_id_t const msgid,
 void app_ancsc_sm_entry(uint8_t idx, uint8_t status);
 
 
-void app_ancsc_get_ntf_error_handler(uint8_t idx, uint8_t status);                                  
+void app_ancsc_get_ntf_error_handler(uint8_t idx, uint8_t status);
+
 /*
-**************************************************************************************
-* @brief Handle the data resouce package .
-*
-****************************************************************************************  
-*/     
-void app_ancsc_data_source_buffer(uint8_t *attr_nbr,uint8_t *last_attr_id_pos,uint8_t offset,struct ancsc_data_source_ind *param);                                  
+ ****************************************************************************************
+ * @brief Clear the pending notifications, the on-going fetch and the Data Source parser
+ *
+ ****************************************************************************************
+ */
+void app_ancsc_clear_buffer(uint8_t idx);
 
+/*
+ ****************************************************************************************
+ * @brief Take the attribute cache of the connected peer, kept if it is bonded
+ *
+ ****************************************************************************************
+ */
+void app_ancsc_cache_attach(uint8_t idx);
 
-void app_ancsc_clear_buffer(void);
+/*
+ ****************************************************************************************
+ * @brief Drop the attribute cache of a bonded slot, given to another peer
+ *
+ ****************************************************************************************
+ */
+void app_ancsc_cache_drop(uint8_t slot);
 #endif // BLE_ANCS_NC
 
 /// @} APP_ANCSC_TASK
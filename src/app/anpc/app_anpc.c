@@ -96,6 +96,31 @@ void app_anpc_enable_req(struct anp_cat_id_bit_mask *new_alert_enable,
     ke_msg_send(msg);
 }
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Alert Notification Client role without disconnection. *//**
+ * @param[in] conhdl        Connection handle for which the profile Alert Notification Client role is enabled.
+ * @response  ANPC_DISABLE_IND
+ * @description
+ *
+ *  This API is used for disabling the role on a connection which is kept, for example to discover
+ *  again the peer service after a change of the peer database. The role is enabled again with
+ *  app_anpc_enable_req().
+ *
+ ****************************************************************************************
+ */
+void app_anpc_disable_req(uint16_t conhdl)
+{
+    struct anpc_disable_req *msg = KE_MSG_ALLOC(ANPC_DISABLE_REQ, KE_BUILD_ID(TASK_ANPC, conhdl), TASK_APP,
+                                                 anpc_disable_req);
+
+    ///Connection handle
+    msg->conhdl = conhdl;
+
+    // Send the message
+    ke_msg_send(msg);
+}
+
  /*
  ****************************************************************************************
  * @brief Generic message to read a New Alert CFG or Unread Alert Status CFG characteristic
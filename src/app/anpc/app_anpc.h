@@ -42,6 +42,14 @@ void app_anpc_enable_req(struct anp_cat_id_bit_mask *new_alert_enable,
                          struct anp_cat_id_bit_mask *unread_alert_enable,
                          struct anpc_ans_content *ans,
                          uint16_t conhdl);
+
+/*
+ ****************************************************************************************
+ * @brief Disable the Alert Notification Client role without disconnection
+ *
+ ****************************************************************************************
+ */
+void app_anpc_disable_req(uint16_t conhdl);
 /*
  ****************************************************************************************
  * @brief Generic message to read a New Alert CFG or Unread Alert Status CFG characteristic
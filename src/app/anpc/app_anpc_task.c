@@ -144,7 +144,10 @@ int app_anpc_content_ind_handler(ke_msg_id_t const msgid,
     uint8_t idx = KE_IDX_GET(src_id);
     
     app_anpc_env[idx].conhdl = param->conhdl;
-    app_anpc_env[idx].enabled = true;
+    app_set_client_service_status(idx, BLE_AN_CLIENT_BIT, true);
+#if QN_DISC_CACHE
+    app_cache_store(param->conhdl, APP_CACHE_ANPC, &param->ans, sizeof(struct anpc_ans_content), 1);
+#endif
     return (KE_MSG_CONSUMED);
 }
 
@@ -180,8 +183,11 @@ int app_anpc_cmp_evt_handler(ke_msg_id_t const msgid,
                 uint8_t idx = KE_IDX_GET(src_id);
 
                 app_anpc_env[idx].conhdl = param->conhdl;
-                app_anpc_env[idx].enabled = true;
+                app_set_client_service_status(idx, BLE_AN_CLIENT_BIT, true);
                 QPRINTF("ANPC enable confirmation status: 0x%X.\r\n", param->status);
+#if QN_DISC_CACHE
+                app_cache_ready(param->conhdl, APP_CACHE_ANPC);
+#endif
             }
                 break;
             default:
@@ -214,6 +220,10 @@ int app_anpc_disable_ind_handler(ke_msg_id_t const msgid,
                                  ke_task_id_t const dest_id,
                                  ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    app_cache_disabled(param->conhdl, APP_CACHE_ANPC);
+#endif
+
     return (KE_MSG_CONSUMED);
 }
 
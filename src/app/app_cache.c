@@ -0,0 +1,845 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_cache.c
+ *
+ * @brief Application GATT Discovery Cache API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_CACHE
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include "app_env.h"
+#if QN_DISC_CACHE
+#include "lib.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Kernel time mask
+#define APP_CACHE_TIME_MASK             0x7FFFFF
+/// Size of the bonded device identity in the record header
+#define APP_CACHE_ID_LEN                BD_ADDR_LEN
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Cache record
+struct app_cache_rec
+{
+    /// Identity of the bonded device
+    uint8_t id[APP_CACHE_ID_LEN];
+    /// Handle range covered by the content
+    uint16_t shdl;
+    uint16_t ehdl;
+    /// Number of items of the content
+    uint8_t nb;
+    uint8_t rsv;
+    /// Content, word aligned
+    uint32_t data[APP_CACHE_DATA_MAX / 4];
+};
+
+/// Step of the Service Changed setup
+enum app_cache_sc_step
+{
+    APP_CACHE_SC_IDLE,
+    /// Find the GATT service range
+    APP_CACHE_SC_SVC,
+    /// Find the Service Changed characteristic in the range
+    APP_CACHE_SC_CHAR,
+    /// Find its Client Characteristic Configuration descriptor
+    APP_CACHE_SC_DESC,
+    /// Enable the indication
+    APP_CACHE_SC_WRITE
+};
+
+/// Connection state
+struct app_cache_link
+{
+    /// Kernel time of the connection
+    uint32_t conn_time;
+    /// Profiles enabled with the cached content
+    uint16_t hit;
+    /// Profiles disabled to be discovered again
+    uint16_t redisc;
+};
+
+/// Discovery cache environment
+struct app_cache_env_tag
+{
+    struct app_cache_link link[BLE_CONNECTION_MAX];
+    /// Record buffer
+    struct app_cache_rec rec;
+    /// Connection of the Service Changed setup, 0xFFFF if none
+    uint16_t sc_conhdl;
+    /// Step of the Service Changed setup
+    uint8_t sc_step;
+    /// A declaration ends the descriptors of the Service Changed characteristic
+    bool sc_desc_end;
+    /// GATT service range
+    uint16_t sc_shdl;
+    uint16_t sc_ehdl;
+    /// Service Changed value handle found
+    uint16_t sc_hdl;
+    /// Client Characteristic Configuration handle found
+    uint16_t sc_cfg_hdl;
+    struct app_cache_stat stat;
+};
+
+/*
+ * LOCAL VARIABLES DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct app_cache_env_tag app_cache_env = {.sc_conhdl = 0xFFFF};
+
+static const char * const app_cache_prf_name[APP_CACHE_PRF_NB] =
+{
+    "GATT", "QPPC", "HRPC", "CSCPC", "RSCPC", "HOGPRH", "ANPC"
+};
+
+/// Client bit of the profiles in the device record, QPPC keeps its own status
+static const uint16_t app_cache_prf_bit[APP_CACHE_PRF_NB] =
+{
+    0, 0, BLE_HR_COLLECTOR_BIT, BLE_CSC_COLLECTOR_BIT, BLE_RSC_COLLECTOR_BIT,
+    BLE_HID_REPORT_HOST_BIT, BLE_AN_CLIENT_BIT
+};
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Get the device record index and the bonded slot of a connection
+ *
+ * The address of a peer using a resolvable private address is the one resolved on this
+ * connection.
+ ****************************************************************************************
+ */
+static uint8_t app_cache_slot(uint16_t conhdl, uint8_t *idx)
+{
+    struct bd_addr addr;
+
+    *idx = app_get_bd_addr_by_conhdl(conhdl, &addr);
+    if (*idx == GAP_INVALID_CONIDX)
+        return GAP_INVALID_CONIDX;
+    return app_find_bonded_dev(&addr);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the identity of the bonded device of a slot
+ *
+ * The identity resolving key does not change with the private address of the peer, the
+ * address is used when the peer has not distributed it.
+ ****************************************************************************************
+ */
+static void app_cache_id(uint8_t slot, uint8_t *id)
+{
+    struct app_bonded_info const *info = &app_env.bonded_info[slot];
+
+    if (app_get_bond_status(slot, SMP_KDIST_IDKEY))
+        memcpy(id, info->pair_info.irk.key, APP_CACHE_ID_LEN);
+    else
+        memcpy(id, info->peer_addr.addr, APP_CACHE_ID_LEN);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Read a record of the peer in the record buffer, return the content length
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_cache_read(uint8_t slot, uint8_t prf)
+{
+    uint8_t id[APP_CACHE_ID_LEN];
+    uint8_t len = sizeof(struct app_cache_rec);
+
+    app_cache_id(slot, id);
+    if (app_store_read(APP_CACHE_ID(slot, prf), &app_cache_env.rec, &len) != APP_STORE_OK
+        || len < APP_CACHE_HDR_LEN
+        || memcmp(id, app_cache_env.rec.id, APP_CACHE_ID_LEN) != 0)
+        return 0;
+    return len - APP_CACHE_HDR_LEN;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Write a record of the peer from the record buffer
+ *
+ ****************************************************************************************
+ */
+static void app_cache_write(uint8_t slot, uint8_t prf, uint8_t len)
+{
+    app_cache_id(slot, app_cache_env.rec.id);
+    if (app_store_write(APP_CACHE_ID(slot, prf), &app_cache_env.rec, APP_CACHE_HDR_LEN + len) == APP_STORE_OK)
+        app_store_flush();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Check if the client of a profile is enabled on a connection
+ *
+ ****************************************************************************************
+ */
+static bool app_cache_enabled(uint8_t idx, uint8_t prf)
+{
+    if (prf == APP_CACHE_QPPC)
+        return app_get_qpp_client_service_status(idx);
+    return app_cache_prf_bit[prf] != 0 && app_get_client_service_status(idx, app_cache_prf_bit[prf]);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Disable the client of a profile, the discovery runs on its disable indication
+ *
+ ****************************************************************************************
+ */
+static void app_cache_disable(uint16_t conhdl, uint8_t prf)
+{
+    switch (prf)
+    {
+#if BLE_QPP_CLIENT
+        case APP_CACHE_QPPC:
+            app_qppc_disable_req(conhdl);
+            break;
+#endif
+#if BLE_HR_COLLECTOR
+        case APP_CACHE_HRPC:
+            app_hrpc_disable_req(conhdl);
+            break;
+#endif
+#if BLE_CSC_COLLECTOR
+        case APP_CACHE_CSCPC:
+            app_cscpc_disable_req(conhdl);
+            break;
+#endif
+#if BLE_RSC_COLLECTOR
+        case APP_CACHE_RSCPC:
+            app_rscpc_disable_req(conhdl);
+            break;
+#endif
+#if BLE_HID_REPORT_HOST
+        case APP_CACHE_HOGPRH:
+            app_hogprh_disable_req(conhdl);
+            break;
+#endif
+#if BLE_AN_CLIENT
+        case APP_CACHE_ANPC:
+            app_anpc_disable_req(conhdl);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Enable the client of a profile with the discovery of the peer service
+ *
+ ****************************************************************************************
+ */
+static void app_cache_discover(uint16_t conhdl, uint8_t prf)
+{
+    switch (prf)
+    {
+#if BLE_QPP_CLIENT
+        case APP_CACHE_QPPC:
+            app_qppc_enable_req(NULL, conhdl);
+            break;
+#endif
+#if BLE_HR_COLLECTOR
+        case APP_CACHE_HRPC:
+            app_hrpc_enable_req(NULL, conhdl);
+            break;
+#endif
+#if BLE_CSC_COLLECTOR
+        case APP_CACHE_CSCPC:
+            app_cscpc_enable_req(NULL, conhdl);
+            break;
+#endif
+#if BLE_RSC_COLLECTOR
+        case APP_CACHE_RSCPC:
+            app_rscpc_enable_req(NULL, conhdl);
+            break;
+#endif
+#if BLE_HID_REPORT_HOST
+        case APP_CACHE_HOGPRH:
+            app_hogprh_enable_req(0, NULL, conhdl);
+            break;
+#endif
+#if BLE_AN_CLIENT
+        case APP_CACHE_ANPC:
+        {
+            struct anp_cat_id_bit_mask new_alert_enable;
+            struct anp_cat_id_bit_mask unread_alert_enable;
+
+            new_alert_enable.cat_id_mask_0 = CAT_ID_ALL_SUPPORTED_CAT;
+            new_alert_enable.cat_id_mask_1 = ANP_CAT_ID_1_MASK;
+            unread_alert_enable.cat_id_mask_0 = CAT_ID_ALL_SUPPORTED_CAT;
+            unread_alert_enable.cat_id_mask_1 = ANP_CAT_ID_1_MASK;
+            app_anpc_enable_req(&new_alert_enable, &unread_alert_enable, NULL, conhdl);
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Start the Service Changed setup of the peer, find the GATT service first
+ *
+ ****************************************************************************************
+ */
+static void app_cache_sc_disc(uint16_t conhdl)
+{
+    struct gatt_disc_svc_req *msg = KE_MSG_ALLOC(GATT_DISC_SVC_REQ, TASK_GATT, TASK_APP,
+                                                 gatt_disc_svc_req);
+
+    msg->conhdl = conhdl;
+    msg->req_type = GATT_DISC_BY_UUID_SVC;
+    msg->start_hdl = 0x0001;
+    msg->end_hdl = GATT_MAX_ATTR_HDL;
+    msg->desired_svc.value_size = ATT_UUID_16_LEN;
+    co_write16p(&msg->desired_svc.value[0], ATT_SVC_GENERIC_ATTRIBUTE);
+    ke_msg_send(msg);
+
+    app_cache_env.sc_conhdl = conhdl;
+    app_cache_env.sc_step = APP_CACHE_SC_SVC;
+    app_cache_env.sc_shdl = 0;
+    app_cache_env.sc_ehdl = 0;
+    app_cache_env.sc_hdl = 0;
+    app_cache_env.sc_cfg_hdl = 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Find the Service Changed characteristic in the GATT service range
+ *
+ ****************************************************************************************
+ */
+static void app_cache_sc_char(void)
+{
+    struct gatt_disc_char_req *msg = KE_MSG_ALLOC(GATT_DISC_CHAR_REQ, TASK_GATT, TASK_APP,
+                                                  gatt_disc_char_req);
+
+    msg->conhdl = app_cache_env.sc_conhdl;
+    msg->req_type = GATT_DISC_BY_UUID_CHAR;
+    msg->start_hdl = app_cache_env.sc_shdl;
+    msg->end_hdl = app_cache_env.sc_ehdl;
+    msg->desired_char.value_size = ATT_UUID_16_LEN;
+    co_write16p(&msg->desired_char.value[0], ATT_CHAR_SERVICE_CHANGED);
+    ke_msg_send(msg);
+
+    app_cache_env.sc_step = APP_CACHE_SC_CHAR;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Find the descriptors following the Service Changed value in the GATT service
+ *
+ ****************************************************************************************
+ */
+static void app_cache_sc_desc(void)
+{
+    struct gatt_disc_char_desc_req *msg = KE_MSG_ALLOC(GATT_DISC_CHAR_DESC_REQ, TASK_GATT, TASK_APP,
+                                                       gatt_disc_char_desc_req);
+
+    msg->conhdl = app_cache_env.sc_conhdl;
+    msg->start_hdl = app_cache_env.sc_hdl + 1;
+    msg->end_hdl = app_cache_env.sc_ehdl;
+    ke_msg_send(msg);
+
+    app_cache_env.sc_step = APP_CACHE_SC_DESC;
+    app_cache_env.sc_desc_end = false;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Keep the Service Changed value handle of the peer, 0 if it has none
+ *
+ ****************************************************************************************
+ */
+static void app_cache_sc_done(uint16_t conhdl, uint16_t sc_hdl, uint16_t cfg_hdl)
+{
+    uint8_t idx;
+    uint8_t slot = app_cache_slot(conhdl, &idx);
+
+    app_cache_env.sc_conhdl = 0xFFFF;
+    app_cache_env.sc_step = APP_CACHE_SC_IDLE;
+    if (slot == GAP_INVALID_CONIDX)
+        return;
+
+    app_cache_env.rec.shdl = sc_hdl;
+    app_cache_env.rec.ehdl = cfg_hdl;
+    app_cache_env.rec.nb = 1;
+    co_write16p(app_cache_env.rec.data, sc_hdl);
+    app_cache_write(slot, APP_CACHE_GATT, sizeof(uint16_t));
+}
+
+/**
+ ****************************************************************************************
+ * @brief End a step of the Service Changed setup and start the next one
+ *
+ ****************************************************************************************
+ */
+static void app_cache_sc_step_end(uint8_t status)
+{
+    uint16_t conhdl = app_cache_env.sc_conhdl;
+    uint8_t cfg[2];
+
+    switch (app_cache_env.sc_step)
+    {
+        case APP_CACHE_SC_SVC:
+            if (app_cache_env.sc_ehdl != 0)
+            {
+                app_cache_sc_char();
+                return;
+            }
+            break;
+
+        case APP_CACHE_SC_CHAR:
+            if (app_cache_env.sc_hdl != 0 && app_cache_env.sc_hdl < app_cache_env.sc_ehdl)
+            {
+                app_cache_sc_desc();
+                return;
+            }
+            break;
+
+        case APP_CACHE_SC_DESC:
+            if (app_cache_env.sc_cfg_hdl != 0)
+            {
+                co_write16p(cfg, PRF_CLI_START_IND);
+                app_gatt_write_char_req(GATT_WRITE_CHAR, conhdl, app_cache_env.sc_cfg_hdl, sizeof(cfg), cfg);
+                app_cache_env.sc_step = APP_CACHE_SC_WRITE;
+                return;
+            }
+            break;
+
+        case APP_CACHE_SC_WRITE:
+            if (status == ATT_ERR_NO_ERROR)
+            {
+                app_cache_sc_done(conhdl, app_cache_env.sc_hdl, app_cache_env.sc_cfg_hdl);
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if ((app_cache_env.sc_step == APP_CACHE_SC_SVC || app_cache_env.sc_step == APP_CACHE_SC_CHAR)
+        && status == ATT_ERR_ATTRIBUTE_NOT_FOUND && app_cache_env.sc_hdl == 0)
+    {
+        // without Service Changed characteristic the peer database shall not change
+        app_cache_sc_done(conhdl, 0, 0);
+        return;
+    }
+
+    // unknown, try again on the next discovery
+    app_cache_env.sc_conhdl = 0xFFFF;
+    app_cache_env.sc_step = APP_CACHE_SC_IDLE;
+}
+
+/*
+ * EXPORTED FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Start the enable latency measurement of a new connection
+ *
+ ****************************************************************************************
+ */
+void app_cache_conn(uint16_t conhdl)
+{
+    uint8_t idx = app_get_bd_addr_by_conhdl(conhdl, NULL);
+
+    if (idx != GAP_INVALID_CONIDX)
+    {
+        app_cache_env.link[idx].conn_time = ke_time();
+        app_cache_env.link[idx].hit = 0;
+        app_cache_env.link[idx].redisc = 0;
+    }
+
+    // the link of the Service Changed setup is lost
+    if (app_cache_env.sc_conhdl != 0xFFFF
+        && app_get_bd_addr_by_conhdl(app_cache_env.sc_conhdl, NULL) == GAP_INVALID_CONIDX)
+    {
+        app_cache_env.sc_conhdl = 0xFFFF;
+        app_cache_env.sc_step = APP_CACHE_SC_IDLE;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the cached content of a profile, made of nb items of size bytes
+ *
+ ****************************************************************************************
+ */
+void *app_cache_get(uint16_t conhdl, uint8_t prf, uint8_t size, uint8_t *nb)
+{
+    uint8_t idx, len;
+    uint8_t slot = app_cache_slot(conhdl, &idx);
+
+    if (slot == GAP_INVALID_CONIDX)
+        return NULL;
+
+    // the handles are trusted once the Service Changed indication is set up
+    if (app_cache_read(slot, APP_CACHE_GATT) != sizeof(uint16_t))
+        return NULL;
+
+    len = app_cache_read(slot, prf);
+    if (len == 0 || len != app_cache_env.rec.nb * size || (nb == NULL && app_cache_env.rec.nb != 1))
+        return NULL;
+
+    if (nb != NULL)
+        *nb = app_cache_env.rec.nb;
+    app_cache_env.link[idx].hit |= 1 << prf;
+    return app_cache_env.rec.data;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Store the discovered content of a profile, each item starts with struct prf_svc
+ *
+ ****************************************************************************************
+ */
+void app_cache_store(uint16_t conhdl, uint8_t prf, void const *content, uint8_t size, uint8_t nb)
+{
+    struct prf_svc const *svc;
+    uint16_t len = size * nb;
+    uint8_t idx, i;
+    uint8_t slot = app_cache_slot(conhdl, &idx);
+
+    // only the content found by a discovery on a bonded peer
+    if (slot == GAP_INVALID_CONIDX || (app_cache_env.link[idx].hit & (1 << prf))
+        || nb == 0 || len > APP_CACHE_DATA_MAX)
+        return;
+
+    app_cache_env.rec.shdl = 0xFFFF;
+    app_cache_env.rec.ehdl = 0;
+    for (i = 0; i < nb; i++)
+    {
+        svc = (struct prf_svc const *)((uint8_t const *)content + i * size);
+        if (app_cache_env.rec.shdl > svc->shdl)
+            app_cache_env.rec.shdl = svc->shdl;
+        if (app_cache_env.rec.ehdl < svc->ehdl)
+            app_cache_env.rec.ehdl = svc->ehdl;
+    }
+    app_cache_env.rec.nb = nb;
+    memcpy(app_cache_env.rec.data, content, len);
+    app_cache_write(slot, prf, len);
+
+    if (app_cache_read(slot, APP_CACHE_GATT) == 0 && app_cache_env.sc_conhdl == 0xFFFF)
+        app_cache_sc_disc(conhdl);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Report the enable completion of a profile
+ *
+ ****************************************************************************************
+ */
+void app_cache_ready(uint16_t conhdl, uint8_t prf)
+{
+    struct app_cache_stat *stat = &app_cache_env.stat;
+    uint8_t idx = app_get_bd_addr_by_conhdl(conhdl, NULL);
+    uint32_t t;
+    bool hit;
+
+    if (idx == GAP_INVALID_CONIDX)
+        return;
+
+    t = (ke_time() - app_cache_env.link[idx].conn_time) & APP_CACHE_TIME_MASK;
+    hit = (app_cache_env.link[idx].hit & (1 << prf)) != 0;
+    if (hit)
+    {
+        stat->hit_nb++;
+        stat->hit_time += t;
+    }
+    else
+    {
+        stat->miss_nb++;
+        stat->miss_time += t;
+    }
+
+    QPRINTF("%s ready %d ms after connection, %s. Average cached %d ms, discovered %d ms.\r\n",
+            app_cache_prf_name[prf], t * 10, hit ? "cached" : "discovered",
+            stat->hit_nb ? stat->hit_time * 10 / stat->hit_nb : 0,
+            stat->miss_nb ? stat->miss_time * 10 / stat->miss_nb : 0);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Handle a peer indication, drop the records changed by a Service Changed indication
+ *
+ * The clients enabled on the link with a dropped record use handles which may have changed,
+ * they are disabled and enabled again with the discovery.
+ ****************************************************************************************
+ */
+void app_cache_svc_changed(uint16_t conhdl, uint16_t charhdl, uint8_t const *value, uint8_t size)
+{
+    uint16_t shdl, ehdl;
+    uint8_t idx, prf, nb = 0;
+    uint8_t slot = app_cache_slot(conhdl, &idx);
+
+    if (slot == GAP_INVALID_CONIDX || size != 4
+        || app_cache_read(slot, APP_CACHE_GATT) != sizeof(uint16_t)
+        || co_read16p(app_cache_env.rec.data) != charhdl || charhdl == 0)
+        return;
+
+    shdl = co_read16p(value);
+    ehdl = co_read16p(value + 2);
+    for (prf = 0; prf < APP_CACHE_PRF_NB; prf++)
+    {
+        if (app_cache_read(slot, prf) != 0
+            && app_cache_env.rec.shdl <= ehdl && app_cache_env.rec.ehdl >= shdl)
+        {
+            app_store_delete(APP_CACHE_ID(slot, prf));
+            nb++;
+
+            if (app_cache_enabled(idx, prf) && !(app_cache_env.link[idx].redisc & (1 << prf)))
+            {
+                app_cache_env.link[idx].redisc |= 1 << prf;
+                app_cache_disable(conhdl, prf);
+            }
+        }
+    }
+    app_store_flush();
+
+    QPRINTF("Service changed 0x%04X-0x%04X, %d cached records dropped.\r\n", shdl, ehdl, nb);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Handle the disable indication of a client, discover the service again if it was
+ * disabled by a Service Changed indication
+ *
+ ****************************************************************************************
+ */
+void app_cache_disabled(uint16_t conhdl, uint8_t prf)
+{
+    uint8_t idx = app_get_rec_idx_by_conhdl(conhdl);
+
+    if (idx == GAP_INVALID_CONIDX || !(app_cache_env.link[idx].redisc & (1 << prf)))
+        return;
+
+    app_cache_env.link[idx].redisc &= ~(1 << prf);
+    // the discovered content is stored again
+    app_cache_env.link[idx].hit &= ~(1 << prf);
+    if (app_cache_prf_bit[prf] != 0)
+        app_set_client_service_status(idx, app_cache_prf_bit[prf], false);
+
+    QPRINTF("%s disabled, discover again.\r\n", app_cache_prf_name[prf]);
+    app_cache_discover(conhdl, prf);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Handle a GATT event, return true if it belongs to the Service Changed setup
+ *
+ * The event shall come from the link of the setup and match the procedure of its step. The
+ * results of the other GATT procedures are left to the application.
+ ****************************************************************************************
+ */
+bool app_cache_gatt_evt(ke_msg_id_t const msgid, void const *param, ke_task_id_t const src_id)
+{
+    uint8_t i;
+
+    if (app_cache_env.sc_step == APP_CACHE_SC_IDLE
+        || app_get_conhdl_by_idx(KE_IDX_GET(src_id)) != app_cache_env.sc_conhdl)
+        return false;
+
+    switch (msgid)
+    {
+        case GATT_DISC_SVC_BY_UUID_CMP_EVT:
+        {
+            struct gatt_disc_svc_by_uuid_cmp_evt const *evt = param;
+
+            if (app_cache_env.sc_step != APP_CACHE_SC_SVC)
+                return false;
+            if (evt->status == ATT_ERR_NO_ERROR && evt->nb_resp != 0 && app_cache_env.sc_ehdl == 0)
+            {
+                app_cache_env.sc_shdl = evt->list[0].start_hdl;
+                app_cache_env.sc_ehdl = evt->list[0].end_hdl;
+            }
+            return true;
+        }
+
+        case GATT_DISC_CHAR_BY_UUID_CMP_EVT:
+        {
+            struct gatt_disc_char_by_uuid_cmp_evt const *evt = param;
+
+            if (app_cache_env.sc_step != APP_CACHE_SC_CHAR)
+                return false;
+            for (i = 0; i < evt->nb_entry; i++)
+            {
+                if (evt->list[i].uuid == ATT_CHAR_SERVICE_CHANGED)
+                    app_cache_env.sc_hdl = evt->list[i].pointer_hdl;
+            }
+            return true;
+        }
+
+        case GATT_DISC_CHAR_DESC_CMP_EVT:
+        {
+            struct gatt_disc_char_desc_cmp_evt const *evt = param;
+
+            if (app_cache_env.sc_step != APP_CACHE_SC_DESC)
+                return false;
+            // the descriptors of the characteristic end at the next declaration
+            for (i = 0; i < evt->nb_entry && !app_cache_env.sc_desc_end; i++)
+            {
+                if (evt->list[i].attr_hdl <= app_cache_env.sc_hdl)
+                    continue;
+                if (evt->list[i].desc_hdl >= ATT_DECL_PRIMARY_SERVICE
+                    && evt->list[i].desc_hdl <= ATT_DECL_CHARACTERISTIC)
+                    app_cache_env.sc_desc_end = true;
+                else if (evt->list[i].desc_hdl == ATT_DESC_CLIENT_CHAR_CFG)
+                    app_cache_env.sc_cfg_hdl = evt->list[i].attr_hdl;
+            }
+            return true;
+        }
+
+        case GATT_DISC_CMP_EVT:
+            if (app_cache_env.sc_step == APP_CACHE_SC_WRITE)
+                return false;
+            app_cache_sc_step_end(((struct gatt_disc_cmp_evt const *)param)->status);
+            return true;
+
+        case GATT_WRITE_CHAR_RESP:
+            if (app_cache_env.sc_step != APP_CACHE_SC_WRITE)
+                return false;
+            app_cache_sc_step_end(((struct gatt_write_char_resp const *)param)->status);
+            return true;
+
+        case GATT_CMP_EVT:
+            // a procedure ended with an error
+            app_cache_sc_step_end(((struct gatt_cmp_evt const *)param)->status);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Enable the clients of a bonded peer whose content is cached
+ *
+ * Called when the link is encrypted. The clients without cached content are left to the
+ * application, their enable runs the discovery.
+ ****************************************************************************************
+ */
+void app_cache_enable(uint16_t conhdl)
+{
+    uint8_t idx = app_get_rec_idx_by_conhdl(conhdl);
+
+    if (idx == GAP_INVALID_CONIDX)
+        return;
+
+#if BLE_QPP_CLIENT
+    if (false == app_get_qpp_client_service_status(idx))
+    {
+        struct qpps_content *qpps = APP_CACHE_GET(conhdl, APP_CACHE_QPPC, struct qpps_content);
+
+        if (qpps != NULL)
+            app_qppc_enable_req(qpps, conhdl);
+    }
+#endif
+#if BLE_HR_COLLECTOR
+    if (false == app_get_client_service_status(idx, BLE_HR_COLLECTOR_BIT))
+    {
+        struct hrs_content *hrs = APP_CACHE_GET(conhdl, APP_CACHE_HRPC, struct hrs_content);
+
+        if (hrs != NULL)
+            app_hrpc_enable_req(hrs, conhdl);
+    }
+#endif
+#if BLE_CSC_COLLECTOR
+    if (false == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
+    {
+        struct cscpc_cscs_content *cscs = APP_CACHE_GET(conhdl, APP_CACHE_CSCPC, struct cscpc_cscs_content);
+
+        if (cscs != NULL)
+            app_cscpc_enable_req(cscs, conhdl);
+    }
+#endif
+#if BLE_RSC_COLLECTOR
+    if (false == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
+    {
+        struct rscpc_rscs_content *rscs = APP_CACHE_GET(conhdl, APP_CACHE_RSCPC, struct rscpc_rscs_content);
+
+        if (rscs != NULL)
+            app_rscpc_enable_req(rscs, conhdl);
+    }
+#endif
+#if BLE_HID_REPORT_HOST
+    if (false == app_get_client_service_status(idx, BLE_HID_REPORT_HOST_BIT))
+    {
+        uint8_t hids_nb = 0;
+        struct hogprh_hids_content *hids = app_cache_get(conhdl, APP_CACHE_HOGPRH,
+                                                         sizeof(struct hogprh_hids_content), &hids_nb);
+
+        if (hids != NULL)
+            app_hogprh_enable_req(hids_nb, hids, conhdl);
+    }
+#endif
+#if BLE_AN_CLIENT
+    if (false == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
+    {
+        struct anpc_ans_content *ans = APP_CACHE_GET(conhdl, APP_CACHE_ANPC, struct anpc_ans_content);
+        struct anp_cat_id_bit_mask new_alert_enable;
+        struct anp_cat_id_bit_mask unread_alert_enable;
+
+        if (ans != NULL)
+        {
+            new_alert_enable.cat_id_mask_0 = CAT_ID_ALL_SUPPORTED_CAT;
+            new_alert_enable.cat_id_mask_1 = ANP_CAT_ID_1_MASK;
+            unread_alert_enable.cat_id_mask_0 = CAT_ID_ALL_SUPPORTED_CAT;
+            unread_alert_enable.cat_id_mask_1 = ANP_CAT_ID_1_MASK;
+            app_anpc_enable_req(&new_alert_enable, &unread_alert_enable, ans, conhdl);
+        }
+    }
+#endif
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the enable latency statistics
+ *
+ ****************************************************************************************
+ */
+struct app_cache_stat const *app_cache_get_stat(void)
+{
+    return &app_cache_env.stat;
+}
+
+#endif // QN_DISC_CACHE
+
+/// @} APP_CACHE
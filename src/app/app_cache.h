@@ -0,0 +1,200 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_cache.h
+ *
+ * @brief Application GATT Discovery Cache API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_CACHE_H_
+#define _APP_CACHE_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_CACHE GATT Discovery Cache API
+ * @ingroup APP
+ * @brief Discovered handles of the bonded peers kept in the record store
+ *
+ * The content found by the discovery of a profile client (service range, characteristic
+ * and descriptor handles) is stored per bonded device slot and profile. When the client is
+ * enabled again on the same peer, the stored content is passed with PRF_CON_NORMAL and the
+ * discovery is skipped. Each record keeps the identity of the bonded device, its identity
+ * resolving key or its address when it has not distributed it, so a peer using a resolvable
+ * private address finds its records on each connection and a record left by a replaced
+ * bonded device is not used.
+ *
+ * The stored handles are valid as long as the peer database does not change. After the first
+ * discovery the Service Changed characteristic is found in the GATT service of the peer, its
+ * Client Characteristic Configuration descriptor is discovered and the indication is enabled.
+ * A bonded peer indicates the changed handle range on the next connection, the records
+ * overlapping the range are dropped and the next enable runs the discovery. The clients
+ * already enabled on the link with a dropped record are disabled and enabled again with the
+ * discovery. A peer without Service Changed characteristic shall not change its database.
+ * The cache is not used for a peer until this step is done. Only the GATT events of the link
+ * and procedure of the setup are taken by the cache.
+ *
+ * When the link of a bonded peer is encrypted, the clients with cached content are enabled.
+ *
+ * The time from the connection to the enable completion of each profile is reported, with
+ * the average of the cached and the discovered enables.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "gatt_task.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// First record id of the cache in the record store
+#define APP_CACHE_ID_BASE               0xC000
+/// Record id of a profile of a bonded device slot
+#define APP_CACHE_ID(slot, prf)         (APP_CACHE_ID_BASE + ((slot) << 4) + (prf))
+/// Record header size (bonded device identity, handle range, count)
+#define APP_CACHE_HDR_LEN               12
+/// Maximum content size of a profile
+#define APP_CACHE_DATA_MAX              (APP_STORE_MAX_DATA_LEN - APP_CACHE_HDR_LEN)
+
+/// Get the cached content of a profile, NULL if the discovery has to be done
+#define APP_CACHE_GET(conhdl, prf, type)    ((type *)app_cache_get(conhdl, prf, sizeof(type), NULL))
+
+#if !QN_REC_STORE || !QN_SVC_DISC_USED || !QN_SECURITY_ON
+    #error "The discovery cache needs CFG_REC_STORE, CFG_SVC_DISC and the security"
+#endif
+
+/*
+ * ENUMERATION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Cached profiles, 16 at most
+enum app_cache_prf
+{
+    /// Service Changed value handle of the peer
+    APP_CACHE_GATT = 0,
+    APP_CACHE_QPPC,
+    APP_CACHE_HRPC,
+    APP_CACHE_CSCPC,
+    APP_CACHE_RSCPC,
+    APP_CACHE_HOGPRH,
+    APP_CACHE_ANPC,
+    APP_CACHE_PRF_NB
+};
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Enable latency statistics, times are in kernel time unit (10ms)
+struct app_cache_stat
+{
+    /// Enables with the cached content
+    uint16_t hit_nb;
+    /// Enables with discovery
+    uint16_t miss_nb;
+    /// Total time from the connection to the enable completion with the cached content
+    uint32_t hit_time;
+    /// Total time from the connection to the enable completion with discovery
+    uint32_t miss_time;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/*
+ ****************************************************************************************
+ * @brief Start the enable latency measurement of a new connection
+ *
+ ****************************************************************************************
+ */
+void app_cache_conn(uint16_t conhdl);
+
+/*
+ ****************************************************************************************
+ * @brief Get the cached content of a profile, made of nb items of size bytes
+ *
+ * If nb is NULL, the content shall be exactly one item. The content is valid until the next
+ * call of the cache API.
+ ****************************************************************************************
+ */
+void *app_cache_get(uint16_t conhdl, uint8_t prf, uint8_t size, uint8_t *nb);
+
+/*
+ ****************************************************************************************
+ * @brief Store the discovered content of a profile, each item starts with struct prf_svc
+ *
+ ****************************************************************************************
+ */
+void app_cache_store(uint16_t conhdl, uint8_t prf, void const *content, uint8_t size, uint8_t nb);
+
+/*
+ ****************************************************************************************
+ * @brief Report the enable completion of a profile
+ *
+ ****************************************************************************************
+ */
+void app_cache_ready(uint16_t conhdl, uint8_t prf);
+
+/*
+ ****************************************************************************************
+ * @brief Handle a peer indication, drop the records changed by a Service Changed indication
+ *
+ ****************************************************************************************
+ */
+void app_cache_svc_changed(uint16_t conhdl, uint16_t charhdl, uint8_t const *value, uint8_t size);
+
+/*
+ ****************************************************************************************
+ * @brief Handle the disable indication of a client, discover the service again if it was
+ * disabled by a Service Changed indication
+ *
+ ****************************************************************************************
+ */
+void app_cache_disabled(uint16_t conhdl, uint8_t prf);
+
+/*
+ ****************************************************************************************
+ * @brief Handle a GATT event, return true if it belongs to the Service Changed setup
+ *
+ ****************************************************************************************
+ */
+bool app_cache_gatt_evt(ke_msg_id_t const msgid, void const *param, ke_task_id_t const src_id);
+
+/*
+ ****************************************************************************************
+ * @brief Enable the clients of a bonded peer whose content is cached
+ *
+ ****************************************************************************************
+ */
+void app_cache_enable(uint16_t conhdl);
+
+/*
+ ****************************************************************************************
+ * @brief Get the enable latency statistics
+ *
+ ****************************************************************************************
+ */
+struct app_cache_stat const *app_cache_get_stat(void);
+
+/// @} APP_CACHE
+
+#endif // _APP_CACHE_H_
@@ -137,6 +137,107 @@
     #define QN_NVDS_WRITE           0
 #endif
 
+/// Record store
+#if (defined(CFG_REC_STORE))
+    #define QN_REC_STORE            1
+    #if (defined(CFG_REC_STORE_BASE_ADDR))
+        #define QN_REC_STORE_BASE_ADDR      CFG_REC_STORE_BASE_ADDR
+    #else
+        #define QN_REC_STORE_BASE_ADDR      0x1A000
+    #endif
+    #if (defined(CFG_REC_STORE_SECTOR_NUM))
+        #define QN_REC_STORE_SECTOR_NUM     CFG_REC_STORE_SECTOR_NUM
+    #else
+        #define QN_REC_STORE_SECTOR_NUM     4
+    #endif
+    #if (defined(CFG_REC_STORE_MAX_RECORDS))
+        #define QN_REC_STORE_MAX_RECORDS    CFG_REC_STORE_MAX_RECORDS
+    #else
+        #define QN_REC_STORE_MAX_RECORDS    32
+    #endif
+#else
+    #define QN_REC_STORE            0
+#endif
+
+/// GATT discovery cache
+#if (defined(CFG_DISC_CACHE))
+    #define QN_DISC_CACHE           1
+#else
+    #define QN_DISC_CACHE           0
+#endif
+
+/// Glucose record store
+#if (defined(CFG_GLPS_REC))
+    #define QN_GLPS_REC             1
+    #if (defined(CFG_GLPS_REC_BASE_ADDR))
+        #define QN_GLPS_REC_BASE_ADDR       CFG_GLPS_REC_BASE_ADDR
+    #else
+        #define QN_GLPS_REC_BASE_ADDR       0x16000
+    #endif
+    #if (defined(CFG_GLPS_REC_SECTOR_NUM))
+        #define QN_GLPS_REC_SECTOR_NUM      CFG_GLPS_REC_SECTOR_NUM
+    #else
+        #define QN_GLPS_REC_SECTOR_NUM      4
+    #endif
+#else
+    #define QN_GLPS_REC             0
+#endif
+
+/// Beacon scanner
+#if (defined(CFG_BEACON_SCAN))
+    #define QN_BEACON_SCAN          1
+    #if (defined(CFG_BEACON_SCAN_SIZE))
+        #define QN_BEACON_SCAN_SIZE         CFG_BEACON_SCAN_SIZE
+    #else
+        #define QN_BEACON_SCAN_SIZE         64
+    #endif
+    #if (defined(CFG_BEACON_SCAN_REPORT))
+        #define QN_BEACON_SCAN_REPORT       CFG_BEACON_SCAN_REPORT
+    #else
+        #define QN_BEACON_SCAN_REPORT       10
+    #endif
+    #if (defined(CFG_BEACON_SCAN_AGE))
+        #define QN_BEACON_SCAN_AGE          CFG_BEACON_SCAN_AGE
+    #else
+        #define QN_BEACON_SCAN_AGE          30
+    #endif
+#else
+    #define QN_BEACON_SCAN          0
+#endif
+
+/// Measurement notification scheduler
+#if (defined(CFG_NTF_SCHED))
+    #define QN_NTF_SCHED            1
+    #if (defined(CFG_NTF_SCHED_SIZE))
+        #define QN_NTF_SCHED_SIZE           CFG_NTF_SCHED_SIZE
+    #else
+        #define QN_NTF_SCHED_SIZE           8
+    #endif
+    #if (defined(CFG_NTF_SCHED_CREDITS))
+        #define QN_NTF_SCHED_CREDITS        CFG_NTF_SCHED_CREDITS
+    #else
+        #define QN_NTF_SCHED_CREDITS        4
+    #endif
+    // The scheduler submits the next measurement when GATT has taken the value
+    #define PRF_NTF_GET_DATA_CFM    1
+#else
+    #define QN_NTF_SCHED            0
+#endif
+
+/// Kernel message profiler
+#if (defined(CFG_MSG_PROF))
+    #define QN_MSG_PROF             1
+#else
+    #define QN_MSG_PROF             0
+#endif
+
+/// BLE heap monitor
+#if (defined(CFG_HEAP_MON))
+    #define QN_HEAP_MON             1
+#else
+    #define QN_HEAP_MON             0
+#endif
+
 /// Test controll pin
 #if (defined(CFG_TEST_CTRL_PIN))
     #define QN_TEST_CTRL_PIN CFG_TEST_CTRL_PIN
@@ -151,6 +252,13 @@
     #define QN_MEM_UNRETENTION      0
 #endif
 
+/// Memory map
+#if (defined(CFG_MEM_MAP))
+    #define QN_MEM_MAP              1
+#else
+    #define QN_MEM_MAP              0
+#endif
+
 /// Deep sleep
 #if (defined(CFG_DEEP_SLEEP))
     #define QN_DEEP_SLEEP           PM_DEEP_SLEEP
@@ -243,11 +351,25 @@
         // Less Trace level
         #define QN_DBG_TRACE_MORE   0
     #endif
+
+    #if (defined(CFG_DBG_TOKEN))
+        // Tokenized QPRINTF
+        #define QN_DBG_TOKEN        1
+        #if (defined(CFG_DBG_TOKEN_BUF_SIZE))
+            #define QN_DBG_TOKEN_BUF_SIZE   CFG_DBG_TOKEN_BUF_SIZE
+        #else
+            #define QN_DBG_TOKEN_BUF_SIZE   512
+        #endif
+    #else
+        #define QN_DBG_TOKEN        0
+    #endif
 #else
     // QPRINTF disable
     #define QN_DBG_PRINT            0
     // Less Trace level
     #define QN_DBG_TRACE_MORE       0
+    // Tokenized QPRINTF disable
+    #define QN_DBG_TOKEN            0
 #endif
 
 /// Debug information
@@ -149,6 +149,9 @@ static void app_glps_init(void)
     app_glps_env->conhdl = 0xFFFF;
     app_glps_env->evt_cfg = 0;
     app_glps_env->records_idx = 0;
+#if QN_GLPS_REC
+    app_glps_rec_init();
+#endif
 }
 #endif
 
@@ -172,7 +175,7 @@ static void app_hogpd_init(void)
                                               #endif
                                               HOGPD_CFG_BOOT_MOUSE_WR;
     app_hogpd_env->features[0].report_nb = 1;
-    app_hogpd_env->features[0].report_char_cfg[0] = HOGPD_CFG_REPORT_IN | HOGPD_CFG_REPORT_WR;
+    app_hogpd_env->features[0].report_char_cfg[0] = HOGPD_CFG_REPORT_IN | HOGPD_CFG_REPORT_WR | HOGPD_CFG_REPORT_MOUSE;
     app_hogpd_env->proto_mode[0] = HOGP_REPORT_PROTOCOL_MODE;
 #else
     app_hogpd_env->features[0].svc_features = HOGPD_CFG_KEYBOARD |
@@ -224,6 +227,23 @@ static void app_htpt_init(void)
 }
 #endif
 
+/*
+ ****************************************************************************************
+ * @brief Initiate the ANCS notification consumer enviroment - at initiation   *//**
+ * @description
+ * The attribute caches do not belong to a bonded peer.
+ ****************************************************************************************
+ */
+#if BLE_ANCS_NC
+static void app_ancsc_init(void)
+{
+    for (uint8_t idx = 0; idx < BLE_CONNECTION_MAX; idx++)
+    {
+        app_ancsc_env[idx].cache_slot = GAP_INVALID_CONIDX;
+    }
+}
+#endif
+
 /*
  ****************************************************************************************
  * @brief Initiate the proximity reporter enviroment - at initiation   *//**
@@ -326,20 +346,7 @@ static void app_smp_init(void)
     if (NVDS_OK != nvds_get(NVDS_TAG_LTK_KEY, &length, app_env.ltk))
         memcpy(app_env.ltk, QN_SMP_LTK, KEY_LEN);
     // Get the paired device information
-    length = 1;
-    if (NVDS_OK != nvds_get(APP_NVDS_DB_COUNT_TAG, &length, &app_env.bonded_count))
-    {
-        app_env.bonded_count = 0;
-    }
-    length = sizeof(struct app_bonded_info);
-    for (uint8_t i = 0; i < app_env.bonded_count; i++)
-    {
-        if (NVDS_OK != nvds_get(APP_NVDS_DB_START_TAG + i, &length, (uint8_t *)(app_env.bonded_info + i)))
-        {
-            app_env.bonded_count = i;
-            break;
-        }
-    }
+    app_load_bonded_dev();
 #else
     // Fix TK not used
     app_env.tk_type = 1; 
@@ -403,6 +410,9 @@ void app_init(void)
 #endif    
     ke_state_set(TASK_APP, APP_INIT);
 
+#if QN_REC_STORE
+    app_store_init();
+#endif
 #if BLE_AN_SERVER
     app_anps_init();
 #endif
@@ -439,6 +449,9 @@ void app_init(void)
 #if BLE_HID_DEVICE
     app_hogpd_init();
 #endif
+#if BLE_ANCS_NC
+    app_ancsc_init();
+#endif
 
 #if QN_DBG_PRINT
     app_uart_init();
@@ -38,6 +38,24 @@
 #if !QN_WORK_MODE
 #include "nvds.h"
 #endif
+#if QN_REC_STORE
+#include "app_store.h"
+#endif
+#if QN_DISC_CACHE
+#include "app_cache.h"
+#endif
+#if QN_BEACON_SCAN
+#include "app_scan.h"
+#endif
+#if QN_MSG_PROF
+#include "app_prof.h"
+#endif
+#if QN_HEAP_MON
+#include "app_heap.h"
+#endif
+#if QN_MEM_MAP
+#include "app_mem.h"
+#endif
 
 #if BLE_HT_COLLECTOR
 #include "app_htpc.h"
@@ -132,6 +150,9 @@
 #if BLE_AN_SERVER
 #include "app_anps.h"
 #endif
+#if QN_NTF_SCHED
+#include "app_ntf.h"
+#endif
 
 #if BLE_QPP_CLIENT
 #include "app_qppc.h"
@@ -173,14 +194,34 @@
  */
 #define APP_IDX_MAX                                 0x01
 
+#if (defined(CFG_BONDED_DEV_NUM))
+#define APP_MAX_BONDED_DEVICE_NUMBER                CFG_BONDED_DEV_NUM
+#else
 #define APP_MAX_BONDED_DEVICE_NUMBER                1
+#endif
 
 // The TAG value after 100 reserved for application
-// Store bonded number
+// Store bonded number (not used any more, the bonded number is the number of stored slots)
 #define APP_NVDS_DB_COUNT_TAG                       (50)
-// Store bonded information
+// Store bonded information, one tag per slot
 #define APP_NVDS_DB_START_TAG                       (APP_NVDS_DB_COUNT_TAG + 1)
 #define APP_NVDS_DB_END_TAG                         (APP_NVDS_DB_COUNT_TAG + APP_MAX_BONDED_DEVICE_NUMBER)
+#if (APP_NVDS_DB_END_TAG >= 100)
+    #error "Too many bonded devices, the NVDS TAG value after 100 reserved for application"
+#endif
+
+// Bonded device address hash table size, power of 2 and at least twice the slot number
+#if (APP_MAX_BONDED_DEVICE_NUMBER <= 4)
+#define APP_BONDED_HASH_SIZE                        8
+#elif (APP_MAX_BONDED_DEVICE_NUMBER <= 8)
+#define APP_BONDED_HASH_SIZE                        16
+#elif (APP_MAX_BONDED_DEVICE_NUMBER <= 16)
+#define APP_BONDED_HASH_SIZE                        32
+#elif (APP_MAX_BONDED_DEVICE_NUMBER <= 32)
+#define APP_BONDED_HASH_SIZE                        64
+#else
+#define APP_BONDED_HASH_SIZE                        128
+#endif
 
 // Aligned to 4 bytes
 #define BONDED_DB_SIZE  ((sizeof(struct app_bonded_info) * APP_MAX_BONDED_DEVICE_NUMBER - 1) / sizeof(uint32_t) + 1)
@@ -188,6 +229,17 @@
 // Invalid index for profile client
 #define APP_INVALID_INDEX                           (0xFF)
 
+// Address hash table size of the connected devices, power of 2
+#if (BLE_CONNECTION_MAX <= 4)
+#define APP_REC_HASH_SIZE                           8
+#else
+#define APP_REC_HASH_SIZE                           16
+#endif
+
+#if (BLE_CONNECTION_MAX > 8)
+    #error "The device record table supports up to 8 connections"
+#endif
+
 /// Service Record Structure
 struct app_svc_record
 {
@@ -220,6 +272,14 @@ struct app_bonded_info
     struct app_pair_info pair_info;
 };
 
+/// Bonded Information Stored in NVDS
+struct app_bonded_rec
+{
+    struct app_bonded_info info;
+    /// use sequence of the slot
+    uint32_t seq;
+};
+
 /// Connected Device Record Structure
 struct app_dev_record
 {
@@ -234,6 +294,8 @@ struct app_dev_record
 
     uint16_t conhdl;
     bool free;
+    /// Enabled clients (BLE_xxx_BIT)
+    uint16_t client_flag;
 };
 
 #if (defined(CFG_EACI))
@@ -288,6 +350,12 @@ struct app_env_tag
     struct app_bonded_info *bonded_info;
     // Bonded Database
     uint32_t bonded_db[BONDED_DB_SIZE]; 
+    // Use sequence of each slot, the least recently used slot is replaced when the database is full
+    uint32_t bonded_seq[APP_MAX_BONDED_DEVICE_NUMBER];
+    // Last use sequence
+    uint32_t bonded_seq_cnt;
+    // Address hash table of the bonded database, slot index + 1, 0 is empty
+    uint8_t bonded_hash[APP_BONDED_HASH_SIZE];
 #endif
 
 #if (BLE_CENTRAL || BLE_OBSERVER)
@@ -306,6 +374,10 @@ struct app_env_tag
     uint8_t cn_count;
     // Connected Device Record
     struct app_dev_record dev_rec[BLE_CONNECTION_MAX];
+    // Connection handle to device record index + 1, 0 is unused
+    uint8_t conhdl_map[BLE_CONNECTION_MAX];
+    // Address hash table of the connected devices, device record index + 1, 0 is empty
+    uint8_t rec_hash[APP_REC_HASH_SIZE];
 
 #if BLE_AN_CLIENT
     struct app_anpc_env_tag anpc_ev[BLE_CONNECTION_MAX];
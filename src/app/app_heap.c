@@ -0,0 +1,263 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_heap.c
+ *
+ * @brief Application BLE Heap Monitor API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_HEAP
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include "app_env.h"
+#if QN_HEAP_MON
+#include "ke_mem.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Kernel environment of the ROM
+#define APP_HEAP_KE_ENV                 ((struct app_heap_ke_env const *)_ke_env)
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Free block of the kernel heap, the free list is in address order
+struct app_heap_mblock_free
+{
+    /// Next free block, NULL for the last one
+    struct app_heap_mblock_free *next;
+    /// Block size, including this header
+    uint32_t size;
+};
+
+/// Head of the kernel environment of the ROM, the free list follows the message queues
+struct app_heap_ke_env
+{
+    struct co_list queue_sent;
+    struct co_list queue_saved;
+    struct co_list queue_timer;
+    struct app_heap_mblock_free *mblock_first;
+};
+
+/// Heap monitor environment
+struct app_heap_env_tag
+{
+    uint32_t *heap;
+    uint16_t size;
+    struct app_heap_stat stat;
+};
+
+/*
+ * LOCAL VARIABLES DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct app_heap_env_tag app_heap_env;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Get the size class of an allocation
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_heap_class(uint32_t size)
+{
+    uint8_t c = 0;
+
+    if (size <= 16)
+        return 0;
+    for (size = (size - 1) >> 4; size && c < APP_HEAP_CLASS_NUM - 1; size >>= 1)
+        c++;
+    return c;
+}
+
+/*
+ * EXPORTED FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Paint the heap, shall be called before ble_init()
+ *
+ ****************************************************************************************
+ */
+void app_heap_paint(uint8_t *heap, uint16_t size)
+{
+    uint16_t i;
+
+    app_heap_env.heap = (uint32_t *)heap;
+    app_heap_env.size = size;
+    for (i = 0; i < size / 4; i++)
+        app_heap_env.heap[i] = APP_HEAP_PAINT;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Counted ke_malloc()
+ *
+ ****************************************************************************************
+ */
+void *app_heap_malloc(uint32_t size)
+{
+    void *p = ((p_ke_malloc)(_ke_malloc))(size);
+
+    app_heap_env.stat.malloc_cnt[app_heap_class(size)]++;
+    if (p == NULL)
+        app_heap_env.stat.fail_cnt++;
+    return p;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Counted ke_free()
+ *
+ ****************************************************************************************
+ */
+void app_heap_free(void *mem_ptr)
+{
+    app_heap_env.stat.free_cnt++;
+    ((p_ke_free)(_ke_free))(mem_ptr);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Counted ke_msg_alloc()
+ *
+ ****************************************************************************************
+ */
+void *app_heap_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                         ke_task_id_t const src_id, uint16_t const param_len)
+{
+    void *p = ((p_ke_msg_alloc)(_ke_msg_alloc))(id, dest_id, src_id, param_len);
+
+    app_heap_env.stat.msg_cnt[app_heap_class(param_len)]++;
+    if (p == NULL)
+        app_heap_env.stat.fail_cnt++;
+    return p;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the allocation statistics
+ *
+ ****************************************************************************************
+ */
+struct app_heap_stat const *app_heap_get_stat(void)
+{
+    return &app_heap_env.stat;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Probe the peak usage and the free blocks of the heap
+ *
+ * The free list is walked with interrupts disabled, nothing is allocated. A block out of
+ * the heap or out of address order stops the walk.
+ ****************************************************************************************
+ */
+bool app_heap_probe(struct app_heap_probe *probe)
+{
+    struct app_heap_mblock_free const *node;
+    uint32_t start = (uint32_t)app_heap_env.heap;
+    uint32_t end = start + app_heap_env.size;
+    uint32_t last = 0;
+    uint16_t i, unused = 0;
+    bool ok = true;
+
+    probe->size = app_heap_env.size;
+
+    // a word still holding the paint has never been allocated
+    for (i = 0; i < app_heap_env.size / 4; i++)
+    {
+        if (app_heap_env.heap[i] == APP_HEAP_PAINT)
+            unused++;
+    }
+    probe->peak = app_heap_env.size - unused * 4;
+
+    probe->free = 0;
+    probe->largest = 0;
+    probe->blocks = 0;
+
+    GLOBAL_INT_DISABLE();
+    for (node = APP_HEAP_KE_ENV->mblock_first; node != NULL; node = node->next)
+    {
+        if ((uint32_t)node < start || (uint32_t)node >= end || (uint32_t)node <= last
+            || ((uint32_t)node & 3) || node->size < sizeof(struct app_heap_mblock_free)
+            || node->size > end - (uint32_t)node)
+        {
+            ok = false;
+            break;
+        }
+        last = (uint32_t)node;
+        probe->blocks++;
+        probe->free += node->size;
+        if (probe->largest < node->size)
+            probe->largest = node->size;
+    }
+    GLOBAL_INT_RESTORE();
+
+    // an allocation leaves the free block header in place and adds a used block header
+    if (probe->largest >= sizeof(struct app_heap_mblock_free) + sizeof(uint32_t))
+        probe->largest -= sizeof(struct app_heap_mblock_free) + sizeof(uint32_t);
+    else
+        probe->largest = 0;
+
+    return ok;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Print the heap statistics and the probe result
+ *
+ ****************************************************************************************
+ */
+void app_heap_dump(void)
+{
+    struct app_heap_probe probe;
+    uint8_t i;
+
+    if (!app_heap_probe(&probe))
+        QPRINTF("Heap free list broken after %d blocks\r\n", probe.blocks);
+
+    QPRINTF("Heap %d, peak %d, used %d, free %d in %d blocks, largest ke_malloc %d\r\n",
+            probe.size, probe.peak, probe.size - probe.free, probe.free, probe.blocks, probe.largest);
+    QPRINTF("ke_malloc %d failed, ke_free %d\r\n", app_heap_env.stat.fail_cnt, app_heap_env.stat.free_cnt);
+    QPRINTF("Size   <=16  <=32  <=64 <=128 <=256  >256\r\n");
+    QPRINTF("malloc");
+    for (i = 0; i < APP_HEAP_CLASS_NUM; i++)
+        QPRINTF("%6d", app_heap_env.stat.malloc_cnt[i]);
+    QPRINTF("\r\nmsg   ");
+    for (i = 0; i < APP_HEAP_CLASS_NUM; i++)
+        QPRINTF("%6d", app_heap_env.stat.msg_cnt[i]);
+    QPRINTF("\r\n");
+}
+
+#endif // QN_HEAP_MON
+
+/// @} APP_HEAP
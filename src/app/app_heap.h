@@ -0,0 +1,157 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_heap.h
+ *
+ * @brief Application BLE Heap Monitor API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_HEAP_H_
+#define _APP_HEAP_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_HEAP BLE Heap Monitor API
+ * @ingroup APP
+ * @brief BLE heap monitor
+ *
+ * The BLE heap is filled with a pattern before ble_init(). Memory ever allocated by the
+ * stack or the application is overwritten, so the peak usage is found by counting the words
+ * which still hold the pattern. It is an upper bound, a block may be allocated at different
+ * places over time. ke_malloc(), ke_free() and ke_msg_alloc() of the application and the profiles
+ * are redirected to this module to count the allocations by size class and the failures.
+ * The probe walks the free list of the kernel heap of the ROM, which is in address order
+ * from ke_env. It allocates nothing: the ROM ke_malloc() asserts when the heap is
+ * exhausted, and a trial allocation would raise the peak. The current usage is the heap
+ * size less the free blocks.
+ *
+ * Allocations inside the ROM stack are seen by the peak usage and the probe only.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "ke_msg.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Heap paint pattern
+#define APP_HEAP_PAINT                  0xDEADBEEF
+/// Number of allocation size classes: <=16, <=32, <=64, <=128, <=256, >256 bytes
+#define APP_HEAP_CLASS_NUM              6
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// BLE heap statistics
+struct app_heap_stat
+{
+    /// ke_malloc() calls by size class
+    uint32_t malloc_cnt[APP_HEAP_CLASS_NUM];
+    /// ke_msg_alloc() calls by parameter size class
+    uint32_t msg_cnt[APP_HEAP_CLASS_NUM];
+    /// ke_free() calls
+    uint32_t free_cnt;
+    /// ke_malloc() and ke_msg_alloc() failures
+    uint16_t fail_cnt;
+};
+
+/// BLE heap probe result
+struct app_heap_probe
+{
+    /// Heap size
+    uint16_t size;
+    /// Peak usage of the whole heap, from the paint
+    uint16_t peak;
+    /// Sum of the free blocks
+    uint16_t free;
+    /// Largest size ke_malloc() can allocate
+    uint16_t largest;
+    /// Number of free blocks
+    uint16_t blocks;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/*
+ ****************************************************************************************
+ * @brief Paint the heap, shall be called before ble_init()
+ *
+ ****************************************************************************************
+ */
+void app_heap_paint(uint8_t *heap, uint16_t size);
+
+/*
+ ****************************************************************************************
+ * @brief Counted ke_malloc()
+ *
+ ****************************************************************************************
+ */
+void *app_heap_malloc(uint32_t size);
+
+/*
+ ****************************************************************************************
+ * @brief Counted ke_free()
+ *
+ ****************************************************************************************
+ */
+void app_heap_free(void *mem_ptr);
+
+/*
+ ****************************************************************************************
+ * @brief Counted ke_msg_alloc()
+ *
+ ****************************************************************************************
+ */
+void *app_heap_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                         ke_task_id_t const src_id, uint16_t const param_len);
+
+/*
+ ****************************************************************************************
+ * @brief Get the allocation statistics
+ *
+ ****************************************************************************************
+ */
+struct app_heap_stat const *app_heap_get_stat(void);
+
+/*
+ ****************************************************************************************
+ * @brief Probe the peak usage and the free blocks of the heap
+ *
+ * @return false if the free list is not consistent, the blocks before are in the result
+ ****************************************************************************************
+ */
+bool app_heap_probe(struct app_heap_probe *probe);
+
+/*
+ ****************************************************************************************
+ * @brief Print the heap statistics and the probe result
+ *
+ ****************************************************************************************
+ */
+void app_heap_dump(void);
+
+/// @} APP_HEAP
+
+#endif // _APP_HEAP_H_
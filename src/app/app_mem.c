@@ -0,0 +1,186 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_mem.c
+ *
+ * @brief Application Memory Map API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_MEM
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include "app_env.h"
+#if QN_MEM_MAP
+#include "sleep.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// End of the retained image and bounds of the section .noretention
+#if defined(__CC_ARM)
+extern uint8_t Image$$APP_CODE$$ZI$$Limit[];
+extern uint8_t Image$$RW_NORET$$ZI$$Base[];
+extern uint8_t Image$$RW_NORET$$ZI$$Limit[];
+#define APP_MEM_IMAGE_END           ((uint32_t)Image$$APP_CODE$$ZI$$Limit)
+#define APP_MEM_NORET_BEGIN         ((uint32_t)Image$$RW_NORET$$ZI$$Base)
+#define APP_MEM_NORET_END           ((uint32_t)Image$$RW_NORET$$ZI$$Limit)
+#elif defined(__ICCARM__)
+#pragma section = "BLK1"
+#pragma section = "NORET"
+#define APP_MEM_IMAGE_END           ((uint32_t)__section_end("BLK1"))
+#define APP_MEM_NORET_BEGIN         ((uint32_t)__section_begin("NORET"))
+#define APP_MEM_NORET_END           ((uint32_t)__section_end("NORET"))
+#elif !defined(APP_MEM_IMAGE_END)
+#error "The memory map needs the linker symbols of Keil or IAR"
+#endif
+
+/// SRAM end address
+#define APP_MEM_RAM_END             (APP_MEM_RAM_BASE + APP_MEM_BANK_NB * APP_MEM_BANK_SIZE)
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Get the bytes of an area inside a bank
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_mem_overlap(uint8_t bank, uint32_t begin, uint32_t end)
+{
+    uint32_t lo = APP_MEM_RAM_BASE + bank * APP_MEM_BANK_SIZE;
+    uint32_t hi = lo + APP_MEM_BANK_SIZE;
+
+    if (lo < begin)
+        lo = begin;
+    if (hi > end)
+        hi = end;
+    return (hi > lo) ? (uint16_t)(hi - lo) : 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Count the banks of a retention setting, bank0 included
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_mem_bank_count(uint32_t banks)
+{
+    uint8_t n = 1;
+
+    for (banks &= 0xfe; banks; banks &= banks - 1)
+        n++;
+    return n;
+}
+
+/*
+ * EXPORTED FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Build the memory map from the linker symbols
+ *
+ ****************************************************************************************
+ */
+void app_mem_get_map(struct app_mem_map *map)
+{
+    uint8_t i;
+
+    map->retention = 0;
+    map->active_only = 0;
+    for (i = 0; i < APP_MEM_BANK_NB; i++)
+    {
+        map->retained[i] = app_mem_overlap(i, APP_MEM_RAM_BASE, APP_MEM_IMAGE_END)
+                         + app_mem_overlap(i, APP_MEM_BLE_BASE, APP_MEM_RAM_END);
+        map->active[i] = app_mem_overlap(i, APP_MEM_NORET_BEGIN, APP_MEM_NORET_END);
+
+        if (map->retained[i])
+            map->retention |= 1 << i;
+        else if (map->active[i])
+            map->active_only |= 1 << i;
+    }
+    // bank0 is always retained
+    map->retention &= 0xfe;
+    map->active_only &= 0xfe;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Retain only the banks in use in sleep, shall be called after sleep_init()
+ *
+ ****************************************************************************************
+ */
+void app_mem_retention_config(void)
+{
+    struct app_mem_map map;
+
+    app_mem_get_map(&map);
+    sleep_set_mem_retention(map.retention, map.active_only);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Estimate the sleep current in nA of a bank retention setting
+ *
+ * The result is illustrative, see APP_MEM_SLEEP_CUR_BASE.
+ ****************************************************************************************
+ */
+uint32_t app_mem_sleep_current(uint32_t retention)
+{
+    return APP_MEM_SLEEP_CUR_BASE + app_mem_bank_count(retention) * APP_MEM_SLEEP_CUR_BANK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Print the memory map and the illustrative sleep current estimate
+ *
+ ****************************************************************************************
+ */
+void app_mem_dump(void)
+{
+    struct app_mem_map map;
+    uint32_t cur, all;
+    uint8_t i;
+
+    app_mem_get_map(&map);
+
+    QPRINTF("Bank Address    Retained Active\r\n");
+    for (i = 0; i < APP_MEM_BANK_NB; i++)
+    {
+        QPRINTF("%d    0x%08X %8d %6d %s\r\n", i, APP_MEM_RAM_BASE + i * APP_MEM_BANK_SIZE,
+                map.retained[i], map.active[i],
+                (i == 0 || (map.retention & (1 << i))) ? "retained"
+                : (map.active_only & (1 << i)) ? "active" : "off");
+    }
+
+    cur = app_mem_sleep_current(sleep_env.retention_modules);
+    all = app_mem_sleep_current(0xfe);
+    QPRINTF("Retention 0x%02X (map 0x%02X), illustrative sleep current %d.%02d uA, saves %d.%02d uA\r\n",
+            sleep_env.retention_modules & 0xfe, map.retention,
+            cur / 1000, cur % 1000 / 10, (all - cur) / 1000, (all - cur) % 1000 / 10);
+}
+
+#endif // QN_MEM_MAP
+
+/// @} APP_MEM
@@ -0,0 +1,136 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_mem.h
+ *
+ * @brief Application Memory Map API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_MEM_H_
+#define _APP_MEM_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_MEM Memory Map API
+ * @ingroup APP
+ * @brief SRAM bank occupancy and retention
+ *
+ * The SRAM has 8 banks of 8K bytes. The application image (code, data, stack and BLE heap)
+ * is linked from the start of the SRAM and the BLE stack keeps its data from 0x1000CDB0 to
+ * the end. The banks touched by these two areas must be retained in sleep, the others hold
+ * nothing and can be powered down.
+ *
+ * Data declared with APP_MEM_NORETENTION is linked in the section .noretention which starts
+ * at the first bank boundary after the image. Its banks are powered in active mode only, the
+ * content is lost in sleep. It suits scratch buffers which are not used across a sleep.
+ *
+ * The area ends are read from the linker symbols, so the map follows the image without
+ * configuration. app_mem_retention_config() applies it in place of CFG_MEM_RETENTION.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include "app_config.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// SRAM start address
+#define APP_MEM_RAM_BASE                0x10000000
+/// Number of SRAM banks
+#define APP_MEM_BANK_NB                 8
+/// SRAM bank size
+#define APP_MEM_BANK_SIZE               0x2000
+/// Start address of the BLE stack data
+#define APP_MEM_BLE_BASE                0x1000CDB0
+
+/// Sleep current without memory, in nA. Illustrative values, they are not from the QN9020
+/// datasheet: measure the sleep current on the board and set them before using the estimate.
+#define APP_MEM_SLEEP_CUR_BASE          1000
+/// Sleep current of one retained bank, in nA, illustrative
+#define APP_MEM_SLEEP_CUR_BANK          250
+
+/// Place a variable in a bank which is not retained in sleep
+#if QN_MEM_MAP
+#if defined(__CC_ARM)
+    #define APP_MEM_NORETENTION         __attribute__((section(".bss.noretention"), zero_init))
+#elif defined(__ICCARM__)
+    #define APP_MEM_NORETENTION         _Pragma("location=\".noretention\"") __no_init
+#endif
+#else
+    #define APP_MEM_NORETENTION
+#endif
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// SRAM memory map
+struct app_mem_map
+{
+    /// Bytes of each bank to be retained in sleep
+    uint16_t retained[APP_MEM_BANK_NB];
+    /// Bytes of each bank used in active mode only
+    uint16_t active[APP_MEM_BANK_NB];
+    /// Banks to be retained in sleep, MEM_BLOCK1 ~ MEM_BLOCK7
+    uint32_t retention;
+    /// Banks used in active mode only, MEM_BLOCK1 ~ MEM_BLOCK7
+    uint32_t active_only;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/*
+ ****************************************************************************************
+ * @brief Build the memory map from the linker symbols
+ *
+ ****************************************************************************************
+ */
+void app_mem_get_map(struct app_mem_map *map);
+
+/*
+ ****************************************************************************************
+ * @brief Retain only the banks in use in sleep, shall be called after sleep_init()
+ *
+ ****************************************************************************************
+ */
+void app_mem_retention_config(void);
+
+/*
+ ****************************************************************************************
+ * @brief Estimate the sleep current in nA of a bank retention setting, illustrative
+ *
+ ****************************************************************************************
+ */
+uint32_t app_mem_sleep_current(uint32_t retention);
+
+/*
+ ****************************************************************************************
+ * @brief Print the memory map and the illustrative sleep current estimate
+ *
+ ****************************************************************************************
+ */
+void app_mem_dump(void);
+
+/// @} APP_MEM
+
+#endif // _APP_MEM_H_
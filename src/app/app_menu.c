@@ -21,6 +21,7 @@
 
 #if QN_DEMO_MENU
 #include "app_menu.h"
+#include "sleep.h"
 
 static void app_menu_show_line(void)
 {
@@ -91,12 +92,80 @@ static void app_menu_show_main(void)
 #endif
 #if BLE_QPP_CLIENT
     QPRINTF("* h. QPPC  Menu\r\n");
+#endif
+#if SLEEP_STAT_EN==TRUE
+    QPRINTF("* p. PM    Statistics\r\n");
+#endif
+#if QN_MSG_PROF
+    QPRINTF("* m. Message Profile\r\n");
+#endif
+#if QN_HEAP_MON
+    QPRINTF("* u. Heap  Usage\r\n");
+#endif
+#if QN_MEM_MAP
+    QPRINTF("* v. Memory Map\r\n");
+#endif
+#if BLE_GL_SENSOR && QN_GLPS_REC
+    QPRINTF("* k. Glucose Records\r\n");
+#endif
+#if BLE_HID_DEVICE
+    QPRINTF("* l. HID   Latency\r\n");
+#endif
+#if QN_BEACON_SCAN
+    QPRINTF("* o. Beacon Scan Start/Stop\r\n");
+#endif
+#if QN_NTF_SCHED
+    QPRINTF("* n. Notification Scheduler\r\n");
 #endif
     QPRINTF("* r. Upper Menu\r\n");
     QPRINTF("* s. Show  Menu\r\n");
 	app_menu_show_line();
 }
 
+#if SLEEP_STAT_EN==TRUE
+static void app_menu_show_pm_stat(void)
+{
+    static const char *refuse_name[SLEEP_REFUSE_NUM] = {
+        "KE timer", "Device", "GPIO", "ACMP", "UART TX", "HCI", "XTAL32", "32K clock"
+    };
+    uint32_t elapsed = sleep_stat_elapsed();
+    uint32_t active = elapsed - sleep_stat.residency[SLEEP_CPU_CLK_OFF]
+                    - sleep_stat.residency[SLEEP_NORMAL] - sleep_stat.residency[SLEEP_DEEP];
+    uint8_t i;
+
+    app_menu_show_line();
+    // the kernel time stops in deep sleep
+    QPRINTF("* Elapsed %d0ms without deep sleep, active %d0ms\r\n", elapsed, active);
+    QPRINTF("* Clock off  %d times, %d0ms\r\n", sleep_stat.entry[SLEEP_CPU_CLK_OFF], sleep_stat.residency[SLEEP_CPU_CLK_OFF]);
+    QPRINTF("* Sleep      %d times, %d0ms\r\n", sleep_stat.entry[SLEEP_NORMAL], sleep_stat.residency[SLEEP_NORMAL]);
+    QPRINTF("* Deep sleep %d times\r\n", sleep_stat.entry[SLEEP_DEEP]);
+    for (i = 0; i < SLEEP_REFUSE_NUM; i++) {
+        if (sleep_stat.refuse[i]) {
+            QPRINTF("* Refused by %s: %d\r\n", refuse_name[i], sleep_stat.refuse[i]);
+        }
+    }
+    for (i = 0; i < 32; i++) {
+        if (sleep_stat.wakeup[i]) {
+            QPRINTF("* Wakeup by IRQ %d: %d\r\n", i, sleep_stat.wakeup[i]);
+        }
+    }
+    sleep_stat_reset();
+}
+#endif
+
+#if BLE_HID_DEVICE
+static void app_menu_show_hid_stat(void)
+{
+    struct hogpd_ntf_stat const *stat = hogpd_ntf_stat_get();
+
+    app_menu_show_line();
+    QPRINTF("* Reports notified %d, merged %d, refused %d\r\n", stat->ntf_nb, stat->merged_nb, stat->full_nb);
+    QPRINTF("* Latency average %dus, max %dus\r\n",
+            stat->ntf_nb ? (uint32_t)(stat->lat_total / stat->ntf_nb) : 0, stat->lat_max);
+    hogpd_ntf_stat_reset();
+}
+#endif
+
 static void app_menu_handler_main(void)
 {
     switch (app_env.input[0])
@@ -193,6 +262,54 @@ static void app_menu_handler_main(void)
     case 'h':
         app_env.menu_id = menu_qppc;
         break;
+#endif
+#if SLEEP_STAT_EN==TRUE
+    case 'p':
+        app_menu_show_pm_stat();
+        break;
+#endif
+#if QN_MSG_PROF
+    case 'm':
+        app_prof_dump(10);
+        app_prof_reset();
+        break;
+#endif
+#if QN_HEAP_MON
+    case 'u':
+        app_heap_dump();
+        break;
+#endif
+#if QN_MEM_MAP
+    case 'v':
+        app_mem_dump();
+        break;
+#endif
+#if BLE_GL_SENSOR && QN_GLPS_REC
+    case 'k':
+        app_glps_rec_bench(APP_GLPS_REC_CAPACITY);
+        break;
+#endif
+#if BLE_HID_DEVICE
+    case 'l':
+        app_menu_show_hid_stat();
+        break;
+#endif
+#if QN_BEACON_SCAN
+    case 'o':
+        if (app_scan_is_running())
+        {
+            app_scan_stop();
+        }
+        else
+        {
+            app_scan_start();
+        }
+        break;
+#endif
+#if QN_NTF_SCHED
+    case 'n':
+        app_ntf_dump();
+        break;
 #endif
     case 'r':
     case 's':
@@ -830,7 +947,7 @@ static void app_menu_handler_paspc(void)
 
         if (0xFFFF != conhdl
             &&
-            false == app_get_client_service_status(idx, ATT_SVC_PHONE_ALERT_STATUS))
+            false == app_get_client_service_status(idx, BLE_PASP_CLIENT_BIT))
         {
             app_paspc_enable_req(NULL, conhdl);
         }
@@ -929,7 +1046,11 @@ static void app_menu_handler_qppc(void)
         if (0xFFFF != conhdl && idx < BLE_CONNECTION_MAX
             && false == app_get_qpp_client_service_status(idx))
         {
+#if QN_DISC_CACHE
+            app_qppc_enable_req(APP_CACHE_GET(conhdl, APP_CACHE_QPPC, struct qpps_content), conhdl);
+#else
             app_qppc_enable_req(NULL, conhdl);
+#endif
         }
         else
             QPRINTF("Enable QPPC disallowed.\r\n");
@@ -985,7 +1106,7 @@ static void app_menu_handler_anpc(void)
 
         if (0xFFFF != conhdl
             &&
-            false == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+            false == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             struct anp_cat_id_bit_mask new_alert_enable;
             struct anp_cat_id_bit_mask unread_alert_enable;
@@ -994,7 +1115,12 @@ static void app_menu_handler_anpc(void)
             unread_alert_enable.cat_id_mask_0 = CAT_ID_ALL_SUPPORTED_CAT;
             unread_alert_enable.cat_id_mask_1 = ANP_CAT_ID_1_MASK;
             
+#if QN_DISC_CACHE
+            app_anpc_enable_req(&new_alert_enable, &unread_alert_enable,
+                                APP_CACHE_GET(conhdl, APP_CACHE_ANPC, struct anpc_ans_content), conhdl);
+#else
             app_anpc_enable_req(&new_alert_enable, &unread_alert_enable, NULL, conhdl);
+#endif
         }
         else
             QPRINTF("Enable ANPC disallowed.\r\n");
@@ -1002,7 +1128,7 @@ static void app_menu_handler_anpc(void)
     }
     case '2':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             app_anpc_rd_char_req(ANPC_RD_WR_NEW_ALERT_CFG, conhdl);
@@ -1011,7 +1137,7 @@ static void app_menu_handler_anpc(void)
     }
     case '3':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             app_anpc_rd_char_req(ANPC_RD_WR_UNREAD_ALERT_STATUS_CFG, conhdl);
@@ -1020,7 +1146,7 @@ static void app_menu_handler_anpc(void)
     }
     case '4':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1031,7 +1157,7 @@ static void app_menu_handler_anpc(void)
     }
     case '5':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1042,7 +1168,7 @@ static void app_menu_handler_anpc(void)
     }
     case '6':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1053,7 +1179,7 @@ static void app_menu_handler_anpc(void)
     }
     case '7':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1097,7 +1223,7 @@ static void app_menu_handler_anpc_alert(void)
     {
     case '1':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1111,7 +1237,7 @@ static void app_menu_handler_anpc_alert(void)
     }
     case '2':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1123,7 +1249,7 @@ static void app_menu_handler_anpc_alert(void)
     }
     case '3':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1135,7 +1261,7 @@ static void app_menu_handler_anpc_alert(void)
     }
     case '4':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1147,7 +1273,7 @@ static void app_menu_handler_anpc_alert(void)
     }
     case '5':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1159,7 +1285,7 @@ static void app_menu_handler_anpc_alert(void)
     }
     case '6':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_ALERT_NTF))
+        if (true == app_get_client_service_status(idx, BLE_AN_CLIENT_BIT))
         {
             uint16_t conhdl = app_get_conhdl_by_idx(idx);
             union anpc_write_value_tag value;
@@ -1211,7 +1337,7 @@ static void app_menu_handler_htpc(void)
 
         if (0xFFFF != conhdl
             &&
-            false == app_get_client_service_status(idx, ATT_SVC_HEALTH_THERMOM))
+            false == app_get_client_service_status(idx, BLE_HT_COLLECTOR_BIT))
         {
             app_htpc_enable_req(NULL, conhdl);
         }
@@ -1220,7 +1346,7 @@ static void app_menu_handler_htpc(void)
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEALTH_THERMOM))
+        if (true == app_get_client_service_status(idx, BLE_HT_COLLECTOR_BIT))
         {
             app_htpc_cfg_indntf_req(HTPC_CHAR_HTS_TEMP_MEAS, PRF_CLI_STOP_NTFIND, app_htpc_env[idx].conhdl);
             app_htpc_cfg_indntf_req(HTPC_CHAR_HTS_INTM_TEMP, PRF_CLI_STOP_NTFIND, app_htpc_env[idx].conhdl);
@@ -1228,13 +1354,13 @@ static void app_menu_handler_htpc(void)
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEALTH_THERMOM))
+        if (true == app_get_client_service_status(idx, BLE_HT_COLLECTOR_BIT))
         {
             app_htpc_rd_char_req(HTPC_RD_HTS_MEAS_INTV, app_htpc_env[idx].conhdl);
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEALTH_THERMOM))
+        if (true == app_get_client_service_status(idx, BLE_HT_COLLECTOR_BIT))
         {
             // 10 seconds
             app_htpc_wr_meas_intv_req(10, app_htpc_env[idx].conhdl);
@@ -1242,21 +1368,21 @@ static void app_menu_handler_htpc(void)
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEALTH_THERMOM))
+        if (true == app_get_client_service_status(idx, BLE_HT_COLLECTOR_BIT))
         {
             app_htpc_cfg_indntf_req(HTPC_CHAR_HTS_TEMP_MEAS, PRF_CLI_START_IND, app_htpc_env[idx].conhdl);
             app_htpc_env[idx].cur_code = 2;
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEALTH_THERMOM))
+        if (true == app_get_client_service_status(idx, BLE_HT_COLLECTOR_BIT))
         {
             app_htpc_cfg_indntf_req(HTPC_CHAR_HTS_INTM_TEMP, PRF_CLI_START_NTF, app_htpc_env[idx].conhdl);
             app_htpc_env[idx].cur_code = 3;
         }
         break;
     case '7':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEALTH_THERMOM))
+        if (true == app_get_client_service_status(idx, BLE_HT_COLLECTOR_BIT))
         {
             app_htpc_cfg_indntf_req(HTPC_CHAR_HTS_MEAS_INTV, PRF_CLI_START_IND, app_htpc_env[idx].conhdl);
             app_htpc_env[idx].cur_code = 4;
@@ -1301,7 +1427,7 @@ static void app_menu_handler_blpc(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_BLOOD_PRESSURE))
+            && false == app_get_client_service_status(idx, BLE_BP_COLLECTOR_BIT))
         {
             app_blpc_enable_req(NULL, conhdl);
         }
@@ -1310,42 +1436,42 @@ static void app_menu_handler_blpc(void)
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BLOOD_PRESSURE))
+        if (true == app_get_client_service_status(idx, BLE_BP_COLLECTOR_BIT))
         {
             app_blpc_cfg_indntf_req(BPS_BP_MEAS_CODE, PRF_CLI_STOP_NTFIND, app_blpc_env[idx].conhdl);
             app_blpc_cfg_indntf_req(BPS_INTERM_CP_CODE, PRF_CLI_STOP_NTFIND, app_blpc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BLOOD_PRESSURE))
+        if (true == app_get_client_service_status(idx, BLE_BP_COLLECTOR_BIT))
         {
             app_blpc_rd_char_req(BLPC_RD_BPS_FEATURE, app_blpc_env[idx].conhdl);
             //app_blpc_env[idx].cur_code = 1;
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BLOOD_PRESSURE))
+        if (true == app_get_client_service_status(idx, BLE_BP_COLLECTOR_BIT))
         {
             app_blpc_cfg_indntf_req(BPS_BP_MEAS_CODE, PRF_CLI_START_IND, app_blpc_env[idx].conhdl);
             //app_blpc_env[idx].cur_code = 4;
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BLOOD_PRESSURE))
+        if (true == app_get_client_service_status(idx, BLE_BP_COLLECTOR_BIT))
         {
             app_blpc_cfg_indntf_req(BPS_INTERM_CP_CODE, PRF_CLI_START_NTF, app_blpc_env[idx].conhdl);
             //app_blpc_env[idx].cur_code = 5;
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BLOOD_PRESSURE))
+        if (true == app_get_client_service_status(idx, BLE_BP_COLLECTOR_BIT))
         {
             app_blpc_rd_char_req(BLPC_RD_BPS_BP_MEAS_CFG, app_blpc_env[idx].conhdl);
             //app_blpc_env[idx].cur_code = 2;
         }
         break;
     case '7':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BLOOD_PRESSURE))
+        if (true == app_get_client_service_status(idx, BLE_BP_COLLECTOR_BIT))
         {
             app_blpc_rd_char_req(BLPC_RD_BPS_CP_MEAS_CFG, app_blpc_env[idx].conhdl);
             //app_blpc_env[idx].cur_code = 3;
@@ -1391,43 +1517,47 @@ static void app_menu_handler_hrpc(void)
         uint16_t conhdl = app_get_conhdl_by_idx(app_env.select_idx);
 
         if (0xFFFF != conhdl && idx < BLE_CONNECTION_MAX
-            && false == app_get_client_service_status(idx, ATT_SVC_HEART_RATE))
+            && false == app_get_client_service_status(idx, BLE_HR_COLLECTOR_BIT))
         {
+#if QN_DISC_CACHE
+            app_hrpc_enable_req(APP_CACHE_GET(conhdl, APP_CACHE_HRPC, struct hrs_content), conhdl);
+#else
             app_hrpc_enable_req(NULL, conhdl);
+#endif
         }
         else
             QPRINTF("Enable HRPC disallowed.\r\n");
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEART_RATE))
+        if (true == app_get_client_service_status(idx, BLE_HR_COLLECTOR_BIT))
         {
             app_hrpc_cfg_indntf_req(PRF_CLI_STOP_NTFIND, app_hrpc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEART_RATE))
+        if (true == app_get_client_service_status(idx, BLE_HR_COLLECTOR_BIT))
         {
             app_hrpc_rd_char_req(HRPC_RD_HRS_BODY_SENSOR_LOC, app_hrpc_env[idx].conhdl);
             app_hrpc_env[idx].cur_code = 1;
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEART_RATE))
+        if (true == app_get_client_service_status(idx, BLE_HR_COLLECTOR_BIT))
         {
             app_hrpc_rd_char_req(HRPC_RD_HRS_HR_MEAS_CFG, app_hrpc_env[idx].conhdl);
             app_hrpc_env[idx].cur_code = 2;
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEART_RATE))
+        if (true == app_get_client_service_status(idx, BLE_HR_COLLECTOR_BIT))
         {
             app_hrpc_cfg_indntf_req(PRF_CLI_START_NTF, app_hrpc_env[idx].conhdl);
             app_hrpc_env[idx].cur_code = 3;
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_HEART_RATE))
+        if (true == app_get_client_service_status(idx, BLE_HR_COLLECTOR_BIT))
         {
             app_hrpc_wr_cntl_point_req(1, app_hrpc_env[idx].conhdl);
         }
@@ -1473,7 +1603,7 @@ static void app_menu_handler_glpc(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_GLUCOSE))
+            && false == app_get_client_service_status(idx, BLE_GL_COLLECTOR_BIT))
         {
             app_glpc_enable_req(NULL, conhdl);
         }
@@ -1482,13 +1612,13 @@ static void app_menu_handler_glpc(void)
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_GLUCOSE))
+        if (true == app_get_client_service_status(idx, BLE_GL_COLLECTOR_BIT))
         {
             app_glpc_register_req(false, app_glpc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_GLUCOSE))
+        if (true == app_get_client_service_status(idx, BLE_GL_COLLECTOR_BIT))
         {
             if (app_glpc_env[idx].op_state == OPERATION_STATE_IDLE)
             {
@@ -1500,14 +1630,14 @@ static void app_menu_handler_glpc(void)
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_GLUCOSE))
+        if (true == app_get_client_service_status(idx, BLE_GL_COLLECTOR_BIT))
         {
             // Register Notify should before RACP request 
             app_glpc_register_req(true, app_glpc_env[idx].conhdl);
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_GLUCOSE))
+        if (true == app_get_client_service_status(idx, BLE_GL_COLLECTOR_BIT))
         {
             if (app_glpc_env[idx].op_state == OPERATION_STATE_IDLE)
             {
@@ -1526,7 +1656,7 @@ static void app_menu_handler_glpc(void)
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_GLUCOSE))
+        if (true == app_get_client_service_status(idx, BLE_GL_COLLECTOR_BIT))
         {
             if (app_glpc_env[idx].op_state == OPERATION_STATE_IDLE)
             {
@@ -1545,7 +1675,7 @@ static void app_menu_handler_glpc(void)
         }
         break;
     case '7':
-        if (true == app_get_client_service_status(idx, ATT_SVC_GLUCOSE))
+        if (true == app_get_client_service_status(idx, BLE_GL_COLLECTOR_BIT))
         {
             struct glp_racp_req req;
             req.op_code = GLP_REQ_ABORT_OP;
@@ -1594,7 +1724,7 @@ static void app_menu_handler_findl(void)
         uint16_t conhdl = app_get_conhdl_by_idx(app_env.select_idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_IMMEDIATE_ALERT))
+            && false == app_get_client_service_status(idx, BLE_FINDME_LOCATOR_BIT))
             app_findl_enable_req(NULL, conhdl);
         else
             QPRINTF("Enable FMPL disallowed.\r\n");
@@ -1603,7 +1733,7 @@ static void app_menu_handler_findl(void)
     case '2':
     case '3':
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_IMMEDIATE_ALERT))
+        if (true == app_get_client_service_status(idx, BLE_FINDME_LOCATOR_BIT))
             app_findl_set_alert_req(app_env.input[0]-'2', app_findl_env[idx].conhdl);
         break;
     case 'r':
@@ -1649,7 +1779,7 @@ static void app_menu_handler_proxm(void)
         uint16_t conhdl = app_get_conhdl_by_idx(app_env.select_idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_LINK_LOSS))
+            && false == app_get_client_service_status(idx, BLE_PROX_MONITOR_BIT))
         {
             app_proxm_enable_req(NULL, NULL, NULL, conhdl);
         }
@@ -1660,24 +1790,24 @@ static void app_menu_handler_proxm(void)
     case '2':
     case '3':
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_LINK_LOSS))
+        if (true == app_get_client_service_status(idx, BLE_PROX_MONITOR_BIT))
             app_proxm_wr_alert_lvl_req(PROXM_SET_LK_LOSS_ALERT, app_env.input[0]-'2', app_proxm_env[idx].conhdl);
         break;
     case '5':
     case '6':
     case '7':
-        if (true == app_get_client_service_status(idx, ATT_SVC_LINK_LOSS))
+        if (true == app_get_client_service_status(idx, BLE_PROX_MONITOR_BIT))
             app_proxm_wr_alert_lvl_req(PROXM_SET_IMMDT_ALERT, app_env.input[0]-'5', app_proxm_env[idx].conhdl);
         break;
     case '8':
-        if (true == app_get_client_service_status(idx, ATT_SVC_LINK_LOSS))
+        if (true == app_get_client_service_status(idx, BLE_PROX_MONITOR_BIT))
         {
             app_proxm_rd_alert_lvl_req(app_proxm_env[idx].conhdl);
             app_proxm_env[idx].cur_code = 1;
         }
         break;
     case '9':
-        if (true == app_get_client_service_status(idx, ATT_SVC_LINK_LOSS))
+        if (true == app_get_client_service_status(idx, BLE_PROX_MONITOR_BIT))
         {
             app_proxm_rd_txpw_lvl_req(app_proxm_env[idx].conhdl);
             app_proxm_env[idx].cur_code = 0;
@@ -1726,7 +1856,7 @@ static void app_menu_handler_tipc(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl && idx < BLE_CONNECTION_MAX
-            && false == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+            && false == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             app_tipc_enable_req(NULL, NULL, NULL, conhdl);
         }
@@ -1735,55 +1865,55 @@ static void app_menu_handler_tipc(void)
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             app_tipc_ct_ntf_cfg_req(PRF_CLI_STOP_NTFIND, app_tipc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             ///Read CTS Current Time
             app_tipc_rd_char_req(TIPC_RD_CTS_CURR_TIME, app_tipc_env[idx].conhdl);
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             ///Configuring the Current Time Characteristic on the Server
             app_tipc_ct_ntf_cfg_req(PRF_CLI_START_NTF, app_tipc_env[idx].conhdl);
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             ///Read CTS Local Time Info
             app_tipc_rd_char_req(TIPC_RD_CTS_LOCAL_TIME_INFO, app_tipc_env[idx].conhdl);
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             ///Read CTS Reference Time Info
             app_tipc_rd_char_req(TIPC_RD_CTS_REF_TIME_INFO, app_tipc_env[idx].conhdl);
         }
         break;
     case '7':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             ///Writing the Time Update Control Point on the Server
             app_tipc_wr_time_udp_ctnl_pt_req(TIPS_TIME_UPD_CTNL_PT_GET, app_tipc_env[idx].conhdl);
         }
         break;
     case '8':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             ///Read RTUS Time With DST
             app_tipc_rd_char_req(TIPC_RD_NDCS_TIME_WITH_DST, app_tipc_env[idx].conhdl);
         }
         break;
     case '9':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             ///Read RTUS Time Update State
             app_tipc_rd_char_req(TIPC_RD_RTUS_TIME_UPD_STATE, app_tipc_env[idx].conhdl);
@@ -1791,7 +1921,7 @@ static void app_menu_handler_tipc(void)
         break;
 #if 0
     case 'a':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CURRENT_TIME))
+        if (true == app_get_client_service_status(idx, BLE_TIP_CLIENT_BIT))
         {
             ///Read CTS Current Time Client Cfg. Desc
             app_tipc_rd_char_req(TIPC_RD_CTS_CURR_TIME_CLI_CFG, app_tipc_env[idx].conhdl);
@@ -1841,7 +1971,7 @@ static void app_menu_handler_hogph(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_HID))
+            && false == app_get_client_service_status(idx, BLE_HID_BOOT_HOST_BIT))
         {
             app_hogpbh_enable_req(0, NULL, conhdl);
         }        
@@ -1852,7 +1982,7 @@ static void app_menu_handler_hogph(void)
     }
     case '2':
 #if BLE_HID_BOOT_HOST
-        if (true == app_get_client_service_status(idx, ATT_SVC_HID))
+        if (true == app_get_client_service_status(idx, BLE_HID_BOOT_HOST_BIT))
         {               
             if (app_hogpbh_env[idx].hids_kb < HOGPBH_NB_HIDS_INST_MAX)
                 app_hogpbh_cfg_ntf_req(HOGPBH_DESC_BOOT_KB_IN_REPORT_CFG, PRF_CLI_STOP_NTFIND, 
@@ -1870,9 +2000,16 @@ static void app_menu_handler_hogph(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_HID))
+            && false == app_get_client_service_status(idx, BLE_HID_REPORT_HOST_BIT))
         {
+#if QN_DISC_CACHE
+            uint8_t hids_nb = 0;
+            struct hogprh_hids_content *hids = app_cache_get(conhdl, APP_CACHE_HOGPRH,
+                                                             sizeof(struct hogprh_hids_content), &hids_nb);
+            app_hogprh_enable_req(hids_nb, hids, conhdl);
+#else
             app_hogprh_enable_req(0, NULL, conhdl);
+#endif
         }        
         else
             QPRINTF("Enable HID Report Host disallowed.\r\n");
@@ -1881,7 +2018,7 @@ static void app_menu_handler_hogph(void)
     }
     case '4':
 #if BLE_HID_REPORT_HOST
-        if (true == app_get_client_service_status(idx, ATT_SVC_HID))
+        if (true == app_get_client_service_status(idx, BLE_HID_REPORT_HOST_BIT))
         {               
             app_hogprh_cfg_ntf_req(0, PRF_CLI_STOP_NTFIND, 0, app_hogprh_env[idx].conhdl);
             app_hogprh_disable_req(app_hogprh_env[idx].conhdl);
@@ -1927,7 +2064,7 @@ static void app_menu_handler_scppc(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_SCAN_PARAMETERS))
+            && false == app_get_client_service_status(idx, BLE_SP_CLIENT_BIT))
         {
             app_scppc_enable_req(0x0012, 0x0012, NULL, conhdl);
         }
@@ -1936,25 +2073,25 @@ static void app_menu_handler_scppc(void)
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_SCAN_PARAMETERS))
+        if (true == app_get_client_service_status(idx, BLE_SP_CLIENT_BIT))
         {
             app_scppc_wr_meas_intv_req(PRF_CLI_STOP_NTFIND, app_scppc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_SCAN_PARAMETERS))
+        if (true == app_get_client_service_status(idx, BLE_SP_CLIENT_BIT))
         {
             app_scppc_scan_refresh_ntf_cfg_rd_req(app_scppc_env[idx].conhdl);
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_SCAN_PARAMETERS))
+        if (true == app_get_client_service_status(idx, BLE_SP_CLIENT_BIT))
         {
             app_scppc_scan_intv_wd_wr_req(GAP_SCAN_FAST_INTV, GAP_SCAN_FAST_WIND, app_scppc_env[idx].conhdl);
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_SCAN_PARAMETERS))
+        if (true == app_get_client_service_status(idx, BLE_SP_CLIENT_BIT))
         {
             app_scppc_wr_meas_intv_req(PRF_CLI_START_NTF, app_scppc_env[idx].conhdl);
         }
@@ -2002,7 +2139,7 @@ static void app_menu_handler_disc(void)
     {
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+            && false == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_enable_req(NULL, conhdl);
         }
@@ -2011,55 +2148,55 @@ static void app_menu_handler_disc(void)
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_MANUFACTURER_NAME_CHAR, app_disc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_MODEL_NB_STR_CHAR, app_disc_env[idx].conhdl);
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_SERIAL_NB_STR_CHAR, app_disc_env[idx].conhdl);
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_HARD_REV_STR_CHAR, app_disc_env[idx].conhdl);
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_FIRM_REV_STR_CHAR, app_disc_env[idx].conhdl);
         }
         break;
     case '7':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_SW_REV_STR_CHAR, app_disc_env[idx].conhdl);
         }
         break;
     case '8':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_SYSTEM_ID_CHAR, app_disc_env[idx].conhdl);
         }
         break;
     case '9':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_IEEE_CHAR, app_disc_env[idx].conhdl);
         }
         break;
     case 'a':
-        if (true == app_get_client_service_status(idx, ATT_SVC_DEVICE_INFO))
+        if (true == app_get_client_service_status(idx, BLE_DIS_CLIENT_BIT))
         {
             app_disc_rd_char_req(DISC_PNP_ID_CHAR, app_disc_env[idx].conhdl);
         }
@@ -2104,7 +2241,7 @@ static void app_menu_handler_basc(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl && idx < BLE_CONNECTION_MAX
-            && false == app_get_client_service_status(idx, ATT_SVC_BATTERY_SERVICE))
+            && false == app_get_client_service_status(idx, BLE_BATT_CLIENT_BIT))
         {
             app_basc_enable_req(0, NULL, conhdl);
         }        
@@ -2113,33 +2250,33 @@ static void app_menu_handler_basc(void)
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BATTERY_SERVICE))
+        if (true == app_get_client_service_status(idx, BLE_BATT_CLIENT_BIT))
         {
             app_basc_cfg_indntf_req(PRF_CLI_STOP_NTFIND, 0, app_basc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BATTERY_SERVICE))
+        if (true == app_get_client_service_status(idx, BLE_BATT_CLIENT_BIT))
         {
             app_basc_rd_char_req(BASC_RD_BAS_BATT_LEVEL_PRES_FORMAT, 0, app_basc_env[idx].conhdl);
             //app_basc_env[idx].cur_code = 1;
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BATTERY_SERVICE))
+        if (true == app_get_client_service_status(idx, BLE_BATT_CLIENT_BIT))
         {
             app_basc_rd_char_req(BASC_RD_BAS_BATT_LEVEL, 0, app_basc_env[idx].conhdl);
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BATTERY_SERVICE))
+        if (true == app_get_client_service_status(idx, BLE_BATT_CLIENT_BIT))
         {
             app_basc_cfg_indntf_req(PRF_CLI_START_NTF, 0, app_basc_env[idx].conhdl);
             //app_basc_env[idx].cur_code = 0;
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_BATTERY_SERVICE))
+        if (true == app_get_client_service_status(idx, BLE_BATT_CLIENT_BIT))
         {
             app_basc_rd_char_req(BASC_RD_BAS_BATT_LEVEL_CLI_CFG, 0, app_basc_env[idx].conhdl);
             //app_basc_env[idx].cur_code = 2;
@@ -2186,40 +2323,44 @@ static void app_menu_handler_cscpc(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+            && false == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
+#if QN_DISC_CACHE
+            app_cscpc_enable_req(APP_CACHE_GET(conhdl, APP_CACHE_CSCPC, struct cscpc_cscs_content), conhdl);
+#else
             app_cscpc_enable_req(NULL, conhdl);
+#endif
         }
         else
             QPRINTF("Enable CSCPC disallowed.\r\n");
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
             app_cscpc_cfg_ntfind_req(CSCPC_RD_WR_CSC_MEAS_CFG, PRF_CLI_STOP_NTFIND, app_cscpc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
             app_cscpc_read_req(CSCPC_RD_CSC_FEAT, app_cscpc_env[idx].conhdl);
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
             app_cscpc_read_req(CSCPC_RD_SENSOR_LOC, app_cscpc_env[idx].conhdl);
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
             app_cscpc_cfg_ntfind_req(CSCPC_RD_WR_CSC_MEAS_CFG, PRF_CLI_START_NTF, app_cscpc_env[idx].conhdl);
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
             app_cscpc_cfg_ntfind_req(CSCPC_RD_WR_SC_CTNL_PT_CFG, PRF_CLI_START_IND, app_cscpc_env[idx].conhdl);
         }
@@ -2254,7 +2395,7 @@ static void app_menu_handler_cscpc_ctnl_pt(void)
     {
     case '1':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
             struct cscp_sc_ctnl_pt_req sc_ctnl_pt;
 
@@ -2266,7 +2407,7 @@ static void app_menu_handler_cscpc_ctnl_pt(void)
     }
     case '2':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
             struct cscp_sc_ctnl_pt_req sc_ctnl_pt;
 
@@ -2278,7 +2419,7 @@ static void app_menu_handler_cscpc_ctnl_pt(void)
     }
     case '3':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_CYCLING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_CSC_COLLECTOR_BIT))
         {
             struct cscp_sc_ctnl_pt_req sc_ctnl_pt;
 
@@ -2329,40 +2470,44 @@ static void app_menu_handler_rscpc(void)
         uint16_t conhdl = app_get_conhdl_by_idx(idx);
 
         if (0xFFFF != conhdl
-            && false == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+            && false == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
+#if QN_DISC_CACHE
+            app_rscpc_enable_req(APP_CACHE_GET(conhdl, APP_CACHE_RSCPC, struct rscpc_rscs_content), conhdl);
+#else
             app_rscpc_enable_req(NULL, conhdl);
+#endif
         }
         else
             QPRINTF("Enable RSCPC disallowed.\r\n");
         break;
     }
     case '2':
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             app_rscpc_cfg_ntfind_req(RSCPC_RD_WR_RSC_MEAS_CFG, PRF_CLI_STOP_NTFIND, app_rscpc_env[idx].conhdl);
         }
         break;
     case '3':
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             app_rscpc_read_req(RSCPC_RD_RSC_FEAT, app_rscpc_env[idx].conhdl);
         }
         break;
     case '4':
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             app_rscpc_read_req(RSCPC_RD_SENSOR_LOC, app_rscpc_env[idx].conhdl);
         }
         break;
     case '5':
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             app_rscpc_cfg_ntfind_req(RSCPC_RD_WR_RSC_MEAS_CFG, PRF_CLI_START_NTF, app_rscpc_env[idx].conhdl);
         }
         break;
     case '6':
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             app_rscpc_cfg_ntfind_req(RSCPC_RD_WR_SC_CTNL_PT_CFG, PRF_CLI_START_IND, app_rscpc_env[idx].conhdl);
         }
@@ -2398,7 +2543,7 @@ static void app_menu_handler_rscpc_ctnl_pt(void)
     {
     case '1':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             struct rscp_sc_ctnl_pt_req sc_ctnl_pt;
 
@@ -2410,7 +2555,7 @@ static void app_menu_handler_rscpc_ctnl_pt(void)
     }
     case '2':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             struct rscp_sc_ctnl_pt_req sc_ctnl_pt;
 
@@ -2421,7 +2566,7 @@ static void app_menu_handler_rscpc_ctnl_pt(void)
     }
     case '3':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             struct rscp_sc_ctnl_pt_req sc_ctnl_pt;
 
@@ -2433,7 +2578,7 @@ static void app_menu_handler_rscpc_ctnl_pt(void)
     }
     case '4':
     {
-        if (true == app_get_client_service_status(idx, ATT_SVC_RUNNING_SPEED_CADENCE))
+        if (true == app_get_client_service_status(idx, BLE_RSC_COLLECTOR_BIT))
         {
             struct rscp_sc_ctnl_pt_req sc_ctnl_pt;
 
@@ -0,0 +1,420 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_ntf.c
+ *
+ * @brief Application Measurement Notification Scheduler API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_NTF
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include "app_env.h"
+#if QN_NTF_SCHED
+#include "lib.h"
+#include "bletime.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Kernel time mask
+#define APP_NTF_TIME_MASK               0x7FFFFF
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Queued measurement
+struct app_ntf_entry
+{
+    /// Measurement kind (enum app_ntf_kind)
+    uint8_t kind;
+    /// Connection handle
+    uint16_t conhdl;
+    /// qn_clock_us() of the enqueue, 32 bits
+    uint32_t time;
+    /// Kernel time of the deadline
+    uint32_t deadline;
+    /// Measurement value
+    union
+    {
+#if BLE_HR_SENSOR
+        struct hrs_hr_meas hr;
+#endif
+#if BLE_HT_THERMOM
+        struct htp_temp_meas ht;
+#endif
+#if BLE_BP_SENSOR
+        struct bps_bp_meas bp;
+#endif
+    } meas;
+};
+
+/// Service state
+struct app_ntf_svc_tag
+{
+    /// A value has been submitted to the profile and not taken by GATT yet
+    bool busy;
+    /// Values in flight, oldest first
+    uint8_t head;
+    uint8_t nb;
+    /// Kind, enqueue time and deadline of the values in flight
+    uint8_t kind[APP_NTF_CREDITS];
+    uint32_t time[APP_NTF_CREDITS];
+    uint32_t deadline[APP_NTF_CREDITS];
+    struct app_ntf_stat stat;
+};
+
+/// Notification scheduler environment
+struct app_ntf_env_tag
+{
+    /// Queued measurements, in deadline order
+    struct app_ntf_entry queue[APP_NTF_QUEUE_SIZE];
+    uint8_t queue_nb;
+    /// Values in flight on the link
+    uint8_t credit_used;
+    struct app_ntf_svc_tag svc[APP_NTF_SVC_NB];
+};
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct app_ntf_env_tag app_ntf_env;
+
+/// Service of each measurement kind
+static const uint8_t app_ntf_kind_svc[APP_NTF_KIND_NB] =
+{
+    APP_NTF_HRPS, APP_NTF_HTPT, APP_NTF_HTPT, APP_NTF_BLPS, APP_NTF_BLPS
+};
+
+/// Deadline budget of each measurement kind
+static const uint16_t app_ntf_budget[APP_NTF_KIND_NB] =
+{
+    APP_NTF_HR_MEAS_BUDGET, APP_NTF_HT_INTERM_BUDGET, APP_NTF_HT_TEMP_BUDGET,
+    APP_NTF_BP_INTERM_BUDGET, APP_NTF_BP_MEAS_BUDGET
+};
+
+/// Service names of the statistics
+static const char *app_ntf_svc_name[APP_NTF_SVC_NB] = {"HRPS", "HTPT", "BLPS"};
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Return true if kernel time a is before kernel time b
+static bool app_ntf_before(uint32_t a, uint32_t b)
+{
+    return ((a - b) & APP_NTF_TIME_MASK) > (APP_NTF_TIME_MASK >> 1);
+}
+
+/// Insert a measurement in deadline order, after the ones with the same deadline
+static struct app_ntf_entry *app_ntf_add(uint8_t kind, uint16_t conhdl)
+{
+    struct app_ntf_stat *stat = &app_ntf_env.svc[app_ntf_kind_svc[kind]].stat;
+    struct app_ntf_entry *e;
+    uint32_t now = ke_time();
+    uint32_t deadline = (now + app_ntf_budget[kind]) & APP_NTF_TIME_MASK;
+    uint8_t i;
+
+    if (app_ntf_env.queue_nb >= APP_NTF_QUEUE_SIZE)
+    {
+        stat->full_nb++;
+        return NULL;
+    }
+
+    for (i = app_ntf_env.queue_nb; i > 0; i--)
+    {
+        if (!app_ntf_before(deadline, app_ntf_env.queue[i - 1].deadline))
+        {
+            break;
+        }
+    }
+    e = &app_ntf_env.queue[i];
+    memmove(e + 1, e, (app_ntf_env.queue_nb - i) * sizeof(struct app_ntf_entry));
+    app_ntf_env.queue_nb++;
+
+    e->kind = kind;
+    e->conhdl = conhdl;
+    e->time = (uint32_t)qn_clock_us();
+    e->deadline = deadline;
+
+    if (++stat->q_nb > stat->q_max)
+    {
+        stat->q_max = stat->q_nb;
+    }
+
+    return e;
+}
+
+/// Remove a measurement from the queue
+static void app_ntf_remove(uint8_t i)
+{
+    app_ntf_env.svc[app_ntf_kind_svc[app_ntf_env.queue[i].kind]].stat.q_nb--;
+    app_ntf_env.queue_nb--;
+    memmove(&app_ntf_env.queue[i], &app_ntf_env.queue[i + 1],
+            (app_ntf_env.queue_nb - i) * sizeof(struct app_ntf_entry));
+}
+
+/// Submit a measurement to its profile
+static void app_ntf_submit(uint8_t i)
+{
+    struct app_ntf_entry e = app_ntf_env.queue[i];
+    struct app_ntf_svc_tag *s = &app_ntf_env.svc[app_ntf_kind_svc[e.kind]];
+    uint8_t slot = (s->head + s->nb) % APP_NTF_CREDITS;
+
+    app_ntf_remove(i);
+
+    s->busy = true;
+    s->kind[slot] = e.kind;
+    s->time[slot] = e.time;
+    s->deadline[slot] = e.deadline;
+    s->nb++;
+    app_ntf_env.credit_used++;
+
+    switch (e.kind)
+    {
+#if BLE_HR_SENSOR
+        case APP_NTF_HR_MEAS:
+            app_hrps_measurement_send(e.conhdl, &e.meas.hr);
+            break;
+#endif
+#if BLE_HT_THERMOM
+        case APP_NTF_HT_INTERM:
+        case APP_NTF_HT_TEMP:
+            app_htpt_temp_send(e.conhdl, &e.meas.ht, e.kind == APP_NTF_HT_TEMP);
+            break;
+#endif
+#if BLE_BP_SENSOR
+        case APP_NTF_BP_INTERM:
+        case APP_NTF_BP_MEAS:
+            app_blps_pressure_send_req(e.conhdl, e.kind == APP_NTF_BP_INTERM, &e.meas.bp);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+/// Submit the earliest measurements of the free services while the link has credits
+static void app_ntf_schedule(void)
+{
+    uint8_t i = 0;
+
+    while ((app_ntf_env.credit_used < APP_NTF_CREDITS) && (i < app_ntf_env.queue_nb))
+    {
+        if (app_ntf_env.svc[app_ntf_kind_svc[app_ntf_env.queue[i].kind]].busy)
+        {
+            i++;
+        }
+        else
+        {
+            // The next measurement moves to slot i
+            app_ntf_submit(i);
+        }
+    }
+}
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+#if BLE_HR_SENSOR
+bool app_ntf_hrps_send(uint16_t conhdl, struct hrs_hr_meas const *meas_val)
+{
+    struct app_ntf_entry *e = app_ntf_add(APP_NTF_HR_MEAS, conhdl);
+
+    if (e == NULL)
+    {
+        return false;
+    }
+
+    e->meas.hr = *meas_val;
+    app_ntf_schedule();
+    return true;
+}
+#endif
+
+#if BLE_HT_THERMOM
+bool app_ntf_htpt_send(uint16_t conhdl, struct htp_temp_meas const *temp_meas, uint8_t flag_stable_meas)
+{
+    struct app_ntf_entry *e = app_ntf_add(flag_stable_meas ? APP_NTF_HT_TEMP : APP_NTF_HT_INTERM, conhdl);
+
+    if (e == NULL)
+    {
+        return false;
+    }
+
+    e->meas.ht = *temp_meas;
+    app_ntf_schedule();
+    return true;
+}
+#endif
+
+#if BLE_BP_SENSOR
+bool app_ntf_blps_send(uint16_t conhdl, uint8_t flag_interm, struct bps_bp_meas const *meas_val)
+{
+    struct app_ntf_entry *e = app_ntf_add(flag_interm ? APP_NTF_BP_INTERM : APP_NTF_BP_MEAS, conhdl);
+
+    if (e == NULL)
+    {
+        return false;
+    }
+
+    e->meas.bp = *meas_val;
+    app_ntf_schedule();
+    return true;
+}
+#endif
+
+void app_ntf_send_cfm(uint8_t svc, uint8_t status)
+{
+    struct app_ntf_svc_tag *s = &app_ntf_env.svc[svc];
+    uint32_t now = ke_time();
+    uint32_t lat;
+    uint8_t slot;
+
+    if (status == GATT_NOTIFY_GET_DATA)
+    {
+        // GATT has taken the notification, the service may submit the next value
+        s->busy = false;
+    }
+    else if (s->nb != 0)
+    {
+        if (status >= PRF_APP_ERROR)
+        {
+            // Refused by the profile, it is the last submitted value
+            slot = (s->head + s->nb - 1) % APP_NTF_CREDITS;
+            s->busy = false;
+        }
+        else
+        {
+            slot = s->head;
+            s->head = (s->head + 1) % APP_NTF_CREDITS;
+            if (s->nb == 1)
+            {
+                s->busy = false;
+            }
+        }
+        s->nb--;
+        app_ntf_env.credit_used--;
+
+        if (status == PRF_ERR_OK)
+        {
+            lat = (uint32_t)qn_clock_us() - s->time[slot];
+            s->stat.sent_nb++;
+            s->stat.lat_total += lat;
+            if (lat > s->stat.lat_max)
+            {
+                s->stat.lat_max = lat;
+            }
+            if (app_ntf_before(s->deadline[slot], now))
+            {
+                s->stat.late_nb++;
+            }
+        }
+        else
+        {
+            s->stat.err_nb++;
+        }
+    }
+
+    app_ntf_schedule();
+}
+
+bool app_ntf_ind_pending(uint8_t svc)
+{
+    struct app_ntf_svc_tag *s = &app_ntf_env.svc[svc];
+    uint8_t kind;
+    uint8_t i;
+
+    for (i = 0; i < s->nb; i++)
+    {
+        kind = s->kind[(s->head + i) % APP_NTF_CREDITS];
+        if ((kind == APP_NTF_HT_TEMP) || (kind == APP_NTF_BP_MEAS))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void app_ntf_flush(uint8_t svc)
+{
+    struct app_ntf_svc_tag *s = &app_ntf_env.svc[svc];
+    uint8_t i = 0;
+
+    while (i < app_ntf_env.queue_nb)
+    {
+        if (app_ntf_kind_svc[app_ntf_env.queue[i].kind] == svc)
+        {
+            app_ntf_remove(i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    app_ntf_env.credit_used -= s->nb;
+    s->head = 0;
+    s->nb = 0;
+    s->busy = false;
+
+    app_ntf_schedule();
+}
+
+struct app_ntf_stat *app_ntf_get_stat(uint8_t svc)
+{
+    return &app_ntf_env.svc[svc].stat;
+}
+
+void app_ntf_dump(void)
+{
+    struct app_ntf_stat *stat;
+    uint8_t i;
+
+    QPRINTF("Svc  Queue  Max Full  Sent  Err Late  Avg(us) Max(us)\r\n");
+    for (i = 0; i < APP_NTF_SVC_NB; i++)
+    {
+        stat = &app_ntf_env.svc[i].stat;
+        QPRINTF("%s %5d %4d %4d %5d %4d %4d %8d %7d\r\n", app_ntf_svc_name[i],
+                stat->q_nb, stat->q_max, stat->full_nb, stat->sent_nb, stat->err_nb, stat->late_nb,
+                stat->sent_nb ? (uint32_t)(stat->lat_total / stat->sent_nb) : 0, stat->lat_max);
+
+        stat->q_max = stat->q_nb;
+        stat->full_nb = 0;
+        stat->sent_nb = 0;
+        stat->err_nb = 0;
+        stat->late_nb = 0;
+        stat->lat_max = 0;
+        stat->lat_total = 0;
+    }
+    QPRINTF("%d in flight, %d credits\r\n", app_ntf_env.credit_used, APP_NTF_CREDITS);
+}
+
+#endif // QN_NTF_SCHED
+
+/// @} APP_NTF
@@ -0,0 +1,222 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_ntf.h
+ *
+ * @brief Application Measurement Notification Scheduler API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_NTF_H_
+#define _APP_NTF_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_NTF Measurement Notification Scheduler API
+ * @ingroup APP
+ * @brief Shared queue of the HRPS, HTPT and BLPS measurements
+ *
+ * The measurements of the heart rate, thermometer and blood pressure servers are queued
+ * with a deadline (enqueue time + budget of the measurement kind) instead of being sent
+ * to the profiles one by one. A measurement is submitted to its profile when the profile
+ * has no value waiting to be taken by GATT, the earliest deadline first.
+ *
+ * With QN_MULTI_NOTIFICATION_IN_ONE_EVENT, the profiles report GATT_NOTIFY_GET_DATA when
+ * GATT takes a notification, the next measurement of the service is submitted at once and
+ * up to APP_NTF_CREDITS PDUs are in flight, so several of them are sent in one connection
+ * event. An indication keeps its service busy until it is confirmed by the peer.
+ *
+ * Per service, the queue depth and the latency from the enqueue to the completion of the
+ * notification (or the confirmation of the indication) are measured. The latencies are read
+ * from the RTC clock of bletime, started by qn_time_init().
+ *
+ * The scheduler sets PRF_NTF_GET_DATA_CFM, so that HRPS, HTPT and BLPS give it the
+ * GATT_NOTIFY_GET_DATA status in their send confirmations.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "ke_msg.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Queue size
+#define APP_NTF_QUEUE_SIZE              QN_NTF_SCHED_SIZE
+/// PDUs in flight on the link
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+#define APP_NTF_CREDITS                 QN_NTF_SCHED_CREDITS
+#else
+#define APP_NTF_CREDITS                 1
+#endif
+
+/// Deadline budgets in kernel time unit (10ms)
+#define APP_NTF_HR_MEAS_BUDGET          50
+#define APP_NTF_HT_INTERM_BUDGET        100
+#define APP_NTF_HT_TEMP_BUDGET          300
+#define APP_NTF_BP_INTERM_BUDGET        50
+#define APP_NTF_BP_MEAS_BUDGET          300
+
+#if (APP_NTF_QUEUE_SIZE > 255) || (APP_NTF_CREDITS > 16)
+    #error "The notification scheduler supports up to 255 queued measurements and 16 credits"
+#endif
+
+#if !BLE_HR_SENSOR && !BLE_HT_THERMOM && !BLE_BP_SENSOR
+    #error "The notification scheduler needs CFG_PRF_HRPS, CFG_PRF_HTPT or CFG_PRF_BLPS"
+#endif
+
+/*
+ * ENUMERATION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Services of the scheduler
+enum app_ntf_svc
+{
+    APP_NTF_HRPS = 0,
+    APP_NTF_HTPT,
+    APP_NTF_BLPS,
+    APP_NTF_SVC_NB
+};
+
+/// Measurement kinds
+enum app_ntf_kind
+{
+    /// Heart Rate Measurement, notified
+    APP_NTF_HR_MEAS = 0,
+    /// Intermediate Temperature, notified
+    APP_NTF_HT_INTERM,
+    /// Temperature Measurement, indicated
+    APP_NTF_HT_TEMP,
+    /// Intermediate Cuff Pressure, notified
+    APP_NTF_BP_INTERM,
+    /// Blood Pressure Measurement, indicated
+    APP_NTF_BP_MEAS,
+    APP_NTF_KIND_NB
+};
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Statistics of a service since the last reset
+struct app_ntf_stat
+{
+    /// Measurements in the queue
+    uint8_t q_nb;
+    /// Largest queue depth
+    uint8_t q_max;
+    /// Measurements refused because the queue was full
+    uint16_t full_nb;
+    /// Measurements sent
+    uint16_t sent_nb;
+    /// Measurements refused by the profile or not sent by GATT
+    uint16_t err_nb;
+    /// Measurements completed after their deadline
+    uint16_t late_nb;
+    /// Largest latency in us
+    uint32_t lat_max;
+    /// Total latency of the sent measurements in us
+    uint64_t lat_total;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+#if BLE_HR_SENSOR
+/*
+ ****************************************************************************************
+ * @brief Queue a Heart Rate Measurement, return false if the queue is full
+ *
+ ****************************************************************************************
+ */
+bool app_ntf_hrps_send(uint16_t conhdl, struct hrs_hr_meas const *meas_val);
+#endif
+
+#if BLE_HT_THERMOM
+/*
+ ****************************************************************************************
+ * @brief Queue a stable or intermediate temperature, return false if the queue is full
+ *
+ ****************************************************************************************
+ */
+bool app_ntf_htpt_send(uint16_t conhdl, struct htp_temp_meas const *temp_meas, uint8_t flag_stable_meas);
+#endif
+
+#if BLE_BP_SENSOR
+/*
+ ****************************************************************************************
+ * @brief Queue a blood pressure or intermediate cuff pressure, return false if the queue is full
+ *
+ ****************************************************************************************
+ */
+bool app_ntf_blps_send(uint16_t conhdl, uint8_t flag_interm, struct bps_bp_meas const *meas_val);
+#endif
+
+/*
+ ****************************************************************************************
+ * @brief Handle the send confirmation of a service and submit the next measurements
+ *
+ * GATT_NOTIFY_GET_DATA frees the service, the other status complete the oldest value in
+ * flight, or the last submitted one for a profile error (PRF_APP_ERROR and above).
+ *
+ ****************************************************************************************
+ */
+void app_ntf_send_cfm(uint8_t svc, uint8_t status);
+
+/*
+ ****************************************************************************************
+ * @brief Return true if an indicated measurement of a service waits for its confirmation
+ *
+ * The profile confirms its other indications (HTPT Measurement Interval) with the same
+ * message, they must not be given to app_ntf_send_cfm().
+ *
+ ****************************************************************************************
+ */
+bool app_ntf_ind_pending(uint8_t svc);
+
+/*
+ ****************************************************************************************
+ * @brief Drop the queued and in flight measurements of a service, when it is disabled
+ *
+ ****************************************************************************************
+ */
+void app_ntf_flush(uint8_t svc);
+
+/*
+ ****************************************************************************************
+ * @brief Get the statistics of a service
+ *
+ ****************************************************************************************
+ */
+struct app_ntf_stat *app_ntf_get_stat(uint8_t svc);
+
+/*
+ ****************************************************************************************
+ * @brief Print the statistics of the services and reset them
+ *
+ ****************************************************************************************
+ */
+void app_ntf_dump(void);
+
+/// @} APP_NTF
+
+#endif // _APP_NTF_H_
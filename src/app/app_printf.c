@@ -19,6 +19,9 @@
  */
 #include "app_env.h"
 #include "uart.h"
+#if QN_DBG_TOKEN
+#include "intc.h"
+#endif
 
 /*
  * DEFINES
@@ -425,6 +428,18 @@ int qsprintf(char *buf, const char *fmt, va_list args)
 // used by QPRINTF()
 char print_buff[128];
 
+#if QN_DBG_TOKEN
+///Tokenized print environment
+static struct
+{
+    uint8_t             ring[QN_DBG_TOKEN_BUF_SIZE];
+    uint16_t            head;       // next byte to write
+    uint16_t            tail;       // next byte to send
+    uint16_t            tx_len;     // bytes in transmission, 0 if UART is idle
+    uint32_t            lost;       // records dropped since the last lost record
+} qlog_env;
+#endif
+
 #if !QN_STD_PRINTF
 /**
  ****************************************************************************************
@@ -444,37 +459,328 @@ int qprintf(const char *fmt, ... )
 }
 #endif
 
+#if QN_DBG_TOKEN
+/**
+ ****************************************************************************************
+ * @brief Put a LEB128 number to the record
+ *
+ ****************************************************************************************
+ */
+static uint8_t *qlog_put_num(uint8_t *p, uint8_t *end, uint32_t v)
+{
+    while (p < end)
+    {
+        if (v < 0x80)
+        {
+            *p++ = v;
+            break;
+        }
+        *p++ = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    return p;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Start UART transmission of the queued bytes
+ *
+ ****************************************************************************************
+ */
+static void qlog_tx_start(void);
+
+/**
+ ****************************************************************************************
+ * @brief UART transmission done callback
+ *
+ ****************************************************************************************
+ */
+static void qlog_tx_done(void)
+{
+    qlog_env.tail += qlog_env.tx_len;
+    if (qlog_env.tail == QN_DBG_TOKEN_BUF_SIZE)
+        qlog_env.tail = 0;
+    qlog_env.tx_len = 0;
+
+    qlog_tx_start();
+}
+
+static void qlog_tx_start(void)
+{
+    // send all contiguous bytes in one transmission
+    if (qlog_env.head != qlog_env.tail)
+    {
+        qlog_env.tx_len = (qlog_env.head > qlog_env.tail ? qlog_env.head : QN_DBG_TOKEN_BUF_SIZE)
+                        - qlog_env.tail;
+        uart_write(QN_DEBUG_UART, &qlog_env.ring[qlog_env.tail], qlog_env.tx_len, qlog_tx_done);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Queue a record
+ *
+ ****************************************************************************************
+ */
+static bool qlog_push(uint8_t *rec, uint16_t len)
+{
+    uint16_t used = (qlog_env.head + QN_DBG_TOKEN_BUF_SIZE - qlog_env.tail) % QN_DBG_TOKEN_BUF_SIZE;
+    uint16_t n;
+
+    if (len >= QN_DBG_TOKEN_BUF_SIZE - used)
+        return false;
+
+    while (len)
+    {
+        n = QN_DBG_TOKEN_BUF_SIZE - qlog_env.head;
+        if (n > len)
+            n = len;
+        memcpy(&qlog_env.ring[qlog_env.head], rec, n);
+        qlog_env.head = (qlog_env.head + n) % QN_DBG_TOKEN_BUF_SIZE;
+        rec += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Tokenized print function
+ *
+ * The format string is scanned for the conversions only, no text is formatted.
+ ****************************************************************************************
+ */
+int qlog(const char *fmt, ... )
+{
+    uint8_t rec[QLOG_REC_MAX];
+    uint8_t *p = rec + 2;
+    uint8_t *end = rec + QLOG_REC_MAX;
+    uint32_t addr = (uint32_t)fmt;
+    int32_t v;
+    uint8_t *s;
+    uint8_t i, n, qualifier, arg;
+    va_list args;
+
+    for (i = 0; i < 4; i++)
+        *p++ = addr >> (i * 8);
+
+    va_start(args, fmt);
+    for (; *fmt; fmt++)
+    {
+        if (*fmt != '%')
+            continue;
+
+        // skip flags, field width and precision
+        while (*++fmt && strchr(QLOG_FLAG_CHARS, *fmt))
+        {
+            if (*fmt == '*')
+                p = qlog_put_num(p, end, va_arg(args, int));
+        }
+
+        qualifier = 0;
+        if (*fmt == 'h' || *fmt == 'l' || *fmt == 'L')
+            qualifier = *fmt++;
+
+        if (*fmt == '\0')
+            break;
+
+        switch (*fmt)
+        {
+            QLOG_CONV_TABLE(QLOG_CONV_CASE)
+            default:
+                arg = QLOG_ARG_NONE;
+                break;
+        }
+
+        switch (arg)
+        {
+            case QLOG_ARG_ZIGZAG:
+                v = va_arg(args, int);
+                p = qlog_put_num(p, end, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+                break;
+            case QLOG_ARG_NUM:
+                p = qlog_put_num(p, end, va_arg(args, unsigned int));
+                break;
+            case QLOG_ARG_STR:
+                s = va_arg(args, uint8_t *);
+                for (n = 0; (n < QLOG_STR_MAX) && s[n] && (p < end - 1); n++)
+                    *p++ = s[n];
+                if (p < end)
+                    *p++ = 0;
+                break;
+            case QLOG_ARG_ADDR:
+                s = va_arg(args, uint8_t *);
+                for (n = 0; (n < QLOG_ADDR_LEN(qualifier)) && (p < end); n++)
+                    *p++ = s[n];
+                break;
+            case QLOG_ARG_SKIP:
+                (void)va_arg(args, int *);
+                break;
+            default:
+                break;
+        }
+    }
+    va_end(args);
+
+    rec[0] = QLOG_SYNC;
+    rec[1] = (p - rec) - 2;
+
+    GLOBAL_INT_DISABLE();
+    if (qlog_env.lost)
+    {
+        // report the lost records before the next one
+        uint8_t lost[QLOG_HDR_LEN + 6] = {QLOG_SYNC, 0, QLOG_LOST_ADDR, 0, 0, 0};
+        uint8_t *q = qlog_put_num(&lost[QLOG_HDR_LEN], &lost[sizeof(lost)], qlog_env.lost);
+
+        lost[1] = (q - lost) - 2;
+        if (qlog_push(lost, q - lost))
+            qlog_env.lost = 0;
+    }
+    if (qlog_env.lost || !qlog_push(rec, p - rec))
+        qlog_env.lost++;
+    if (qlog_env.tx_len == 0)
+        qlog_tx_start();
+    GLOBAL_INT_RESTORE();
+
+    return 0;
+}
+#endif
+
+/**
+ ****************************************************************************************
+ * @brief Send the trace text in print_buff
+ *
+ ****************************************************************************************
+ */
+static void qtrace_flush(char *end)
+{
+    *end = '\0';
+#if QN_DBG_TOKEN
+    // a tokenized string argument is limited, send the text in pieces
+    for (char *p = print_buff; p < end; p += QLOG_STR_MAX)
+        qlog("%s", p);
+#else
+    QN_PRINTF((uint8_t *)print_buff);
+#endif
+}
+
 /**
  ****************************************************************************************
  * @brief Trace data with length and format
  *
+ * The text of the whole buffer is formatted in one pass and sent once per print_buff, the
+ * hexadecimal digits are looked up from the digit table. %x is printed in 2 digits.
  ****************************************************************************************
  */
 void qtrace(uint8_t *data, uint16_t len, bool dir, uint8_t fmt)
 {
+    char *str = print_buff;
+    uint8_t c;
+
     if (len == 0)
     {
         QPRINTF("NULL");
+        return;
     }
-    else
+
+    for (uint16_t i = 0; i < len; i++)
     {
-        for (uint16_t i = 0; i < len; i++)
+        // the longest item is 3 characters
+        if (str > &print_buff[sizeof(print_buff) - 4])
+        {
+            qtrace_flush(str);
+            str = print_buff;
+        }
+
+        c = dir==0 ? data[i] : data[len-i-1];
+        switch (fmt)
+        {
+            case 0: // %c
+            default:
+                *str++ = c;
+                break;
+            case 1: // %d
+                if (c >= 100)
+                    *str++ = digits[c / 100];
+                if (c >= 10)
+                    *str++ = digits[(c / 10) % 10];
+                *str++ = digits[c % 10];
+                break;
+            case 2: // %x
+                *str++ = digits[c >> 4];
+                *str++ = digits[c & 0x0F];
+                break;
+        }
+    }
+    qtrace_flush(str);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Dump data in hexadecimal lines of QDUMP_LINE_LEN bytes
+ *
+ * e.g. with QDUMP_OFFSET and QDUMP_ASCII:
+ * 0010: 48 65 6c 6c 6f 00 01 02 03 04 05 06 07 08 09 0a |Hello...........|
+ ****************************************************************************************
+ */
+void qdump(const uint8_t *data, uint16_t len, uint8_t flags)
+{
+    char *str = print_buff;
+    uint16_t i, n;
+    uint8_t c;
+    // offset, hex and ASCII columns and the line end
+    uint8_t line_len = ((flags & QDUMP_OFFSET) ? 6 : 0) + QDUMP_LINE_LEN * 3
+                     + ((flags & QDUMP_ASCII) ? QDUMP_LINE_LEN + 2 : 0) + 2;
+
+    for (i = 0; i < len; i += QDUMP_LINE_LEN)
+    {
+        // as many lines as print_buff holds with the terminating null
+        if (str + line_len > &print_buff[sizeof(print_buff) - 1])
+        {
+            qtrace_flush(str);
+            str = print_buff;
+        }
+
+        n = (len - i > QDUMP_LINE_LEN) ? QDUMP_LINE_LEN : (len - i);
+        if (flags & QDUMP_OFFSET)
+        {
+            *str++ = digits[(i >> 12) & 0x0F];
+            *str++ = digits[(i >> 8) & 0x0F];
+            *str++ = digits[(i >> 4) & 0x0F];
+            *str++ = digits[i & 0x0F];
+            *str++ = ':';
+            *str++ = ' ';
+        }
+        for (uint16_t j = 0; j < QDUMP_LINE_LEN; j++)
+        {
+            if (j < n)
+            {
+                *str++ = digits[data[i+j] >> 4];
+                *str++ = digits[data[i+j] & 0x0F];
+                *str++ = ' ';
+            }
+            else if (flags & QDUMP_ASCII)
+            {
+                // keep the ASCII column aligned
+                *str++ = ' ';
+                *str++ = ' ';
+                *str++ = ' ';
+            }
+        }
+        if (flags & QDUMP_ASCII)
         {
-            switch (fmt)
+            *str++ = '|';
+            for (uint16_t j = 0; j < n; j++)
             {
-                case 0: // %c
-                default:
-                    QPRINTF("%c", dir==0 ? data[i] : data[len-i-1]);
-                    break;
-                case 1: // %d
-                    QPRINTF("%d", dir==0 ? data[i] : data[len-i-1]);
-                    break;
-                case 2: // %x
-                    QPRINTF("%x", dir==0 ? data[i] : data[len-i-1]);
-                    break;
+                c = data[i+j];
+                *str++ = (c >= 0x20 && c < 0x7F) ? c : '.';
             }
+            *str++ = '|';
         }
+        *str++ = '\r';
+        *str++ = '\n';
     }
+    qtrace_flush(str);
 }
 
 #endif // QN_DBG_PRINT
@@ -24,19 +24,23 @@
 
 #define QSPRINTF qsprintf
 
-#if QN_STD_PRINTF
+#if QN_DBG_TOKEN
+    #define QPRINTF qlog
+#elif QN_STD_PRINTF
     #define QPRINTF printf
 #else
     #define QPRINTF qprintf
 #endif
 
 #define QTRACE qtrace
+#define QDUMP qdump
 
 #else
 
 #define QSPRINTF(buf, fmt, args)
 #define QPRINTF(fmt, ...)
 #define QTRACE(data, len, dir, fmt)
+#define QDUMP(data, len, flags)
 
 #endif
 
@@ -63,6 +67,21 @@ extern int qsprintf(char *buf, const char *fmt, va_list args);
 extern int qprintf(const char *fmt, ... );
 #endif
 
+#if QN_DBG_TOKEN
+#include "app_qlog.h"
+
+/*
+ ****************************************************************************************
+ * @brief Tokenized print function
+ *
+ * A record is queued to a RAM ring and sent to the debug UART in the background, the
+ * record format is in app_qlog.h. tools/qlog_decode prints the records with the format
+ * strings of the ELF image.
+ ****************************************************************************************
+ */
+extern int qlog(const char *fmt, ... );
+#endif
+
 /*
  ****************************************************************************************
  * @brief Trace data with length and format
@@ -70,6 +89,24 @@ extern int qprintf(const char *fmt, ... );
  */
 extern void qtrace(uint8_t *data, uint16_t len, bool dir, uint8_t fmt);
 
+/// Bytes of a qdump line
+#define QDUMP_LINE_LEN          16
+/// qdump flag: print the offset column
+#define QDUMP_OFFSET            0x01
+/// qdump flag: print the ASCII column
+#define QDUMP_ASCII             0x02
+
+/*
+ ****************************************************************************************
+ * @brief Dump data in hexadecimal lines
+ *
+ * The lines are sent in one UART transmit per print_buff (128 bytes): 2 lines per transmit
+ * without QDUMP_ASCII, 1 line with it (up to 74 characters), so a 20-byte payload dumped
+ * with QDUMP_ASCII takes 2 transmits.
+ ****************************************************************************************
+ */
+extern void qdump(const uint8_t *data, uint16_t len, uint8_t flags);
+
 #endif
 
 #endif
@@ -0,0 +1,505 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_prof.c
+ *
+ * @brief Application Kernel Message Profiler API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_PROF
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include "app_env.h"
+#if QN_MSG_PROF
+#include "lib.h"
+#include "syscon.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// SysTick counts down on 24 bits
+#define APP_PROF_TICK_MASK              0x00FFFFFF
+/// Current SysTick value
+#define APP_PROF_TICK()                 (SysTick->VAL)
+/// Cycles from tick a to the later tick b
+#define APP_PROF_CYCLES(a, b)           (((a) - (b)) & APP_PROF_TICK_MASK)
+/// Kernel time mask
+#define APP_PROF_TIME_MASK              0x7FFFFF
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Profiled task
+struct app_prof_task
+{
+    /// Task type
+    uint8_t task_id;
+    /// Original task descriptor
+    struct ke_task_desc desc;
+};
+
+/// Message in flight
+struct app_prof_sent
+{
+    /// Message, NULL if the entry is free
+    struct ke_msg const *msg;
+    /// SysTick value and kernel time when the message is sent
+    uint32_t tick;
+    uint32_t time;
+    /// Message id and destination when the message is sent
+    ke_msg_id_t id;
+    ke_task_id_t dest_id;
+};
+
+/// Profiler environment
+struct app_prof_env_tag
+{
+    struct app_prof_task task[APP_PROF_TASK_MAX];
+    struct ke_msg_handler handler[APP_PROF_HANDLER_MAX];
+    struct ke_state_handler state[APP_PROF_STATE_MAX];
+    struct app_prof_msg msg[APP_PROF_MSG_MAX];
+    struct app_prof_sent sent[APP_PROF_SENT_MAX];
+    /// Send times dropped for a newer message when the table is full
+    uint32_t sent_evict_nb;
+    /// SysTick was running with another reload value, the times are not measured
+    bool tick_off;
+    uint8_t task_nb;
+    uint8_t msg_nb;
+    uint16_t handler_nb;
+    uint8_t state_nb;
+};
+
+/*
+ * LOCAL VARIABLES DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct app_prof_env_tag app_prof_env;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Cycles from a SysTick value and kernel time to now
+ *
+ * SysTick wraps every 2^24 cycles (0.5s at 32MHz). When the kernel time shows that it
+ * may have wrapped, the time is taken from the kernel time in 10ms, saturated on 32 bits.
+ ****************************************************************************************
+ */
+static uint32_t app_prof_elapsed(uint32_t tick, uint32_t time)
+{
+    uint32_t now = APP_PROF_TICK();
+    uint32_t cycles_10ms = g_AhbClock / 100;
+    uint32_t elapsed = (ke_time() - time) & APP_PROF_TIME_MASK;
+    uint64_t cycles;
+
+    if (app_prof_env.tick_off)
+        return 0;
+
+    if ((uint64_t)(elapsed + 1) * cycles_10ms > APP_PROF_TICK_MASK)
+    {
+        cycles = (uint64_t)elapsed * cycles_10ms;
+        return (cycles > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)cycles;
+    }
+
+    return APP_PROF_CYCLES(tick, now);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Look up the handler of a message in a state handler
+ *
+ ****************************************************************************************
+ */
+static ke_msg_func_t app_prof_find(struct ke_state_handler const *hdl, ke_msg_id_t msgid)
+{
+    uint16_t i;
+
+    if (hdl != NULL && hdl->msg_table != NULL)
+    {
+        for (i = 0; i < hdl->msg_cnt; i++)
+        {
+            if (hdl->msg_table[i].id == msgid)
+                return hdl->msg_table[i].func;
+        }
+    }
+    return NULL;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the profiled task of a task type, NULL if the task is not profiled
+ *
+ ****************************************************************************************
+ */
+static struct app_prof_task const *app_prof_get_task(uint8_t task_type)
+{
+    uint8_t i;
+
+    for (i = 0; i < app_prof_env.task_nb; i++)
+    {
+        if (app_prof_env.task[i].task_id == task_type)
+            return &app_prof_env.task[i];
+    }
+    return NULL;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the statistics entry of a message id
+ *
+ ****************************************************************************************
+ */
+static struct app_prof_msg *app_prof_get_msg(ke_msg_id_t msgid, uint8_t task)
+{
+    uint8_t i;
+
+    for (i = 0; i < app_prof_env.msg_nb; i++)
+    {
+        if (app_prof_env.msg[i].id == msgid && app_prof_env.msg[i].task == task)
+            return &app_prof_env.msg[i];
+    }
+
+    if (app_prof_env.msg_nb == APP_PROF_MSG_MAX)
+        return NULL;
+
+    app_prof_env.msg[i].id = msgid;
+    app_prof_env.msg[i].task = task;
+    app_prof_env.msg_nb++;
+    return &app_prof_env.msg[i];
+}
+
+/**
+ ****************************************************************************************
+ * @brief Record the send time of a message
+ *
+ * The entry of the message is reused, else a free one, else the oldest one is evicted.
+ ****************************************************************************************
+ */
+static void app_prof_sent_add(struct ke_msg const *msg, uint32_t tick, uint32_t time)
+{
+    struct app_prof_sent *sent = NULL;
+    uint8_t i;
+
+    GLOBAL_INT_DISABLE();
+    for (i = 0; i < APP_PROF_SENT_MAX; i++)
+    {
+        if (app_prof_env.sent[i].msg == msg)
+        {
+            sent = &app_prof_env.sent[i];
+            break;
+        }
+        if (sent == NULL || (sent->msg != NULL && (app_prof_env.sent[i].msg == NULL
+            || APP_PROF_CYCLES(app_prof_env.sent[i].tick, tick) > APP_PROF_CYCLES(sent->tick, tick))))
+        {
+            sent = &app_prof_env.sent[i];
+        }
+    }
+    if (sent->msg != NULL && sent->msg != msg)
+        app_prof_env.sent_evict_nb++;
+    sent->msg = msg;
+    sent->tick = tick;
+    sent->time = time;
+    sent->id = msg->id;
+    sent->dest_id = msg->dest_id;
+    GLOBAL_INT_RESTORE();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Take the send time of a message out of the table
+ *
+ * @return true if the send time is known
+ ****************************************************************************************
+ */
+static bool app_prof_sent_take(struct ke_msg const *msg, uint32_t *tick, uint32_t *time)
+{
+    bool found = false;
+    uint8_t i;
+
+    GLOBAL_INT_DISABLE();
+    for (i = 0; i < APP_PROF_SENT_MAX; i++)
+    {
+        if (app_prof_env.sent[i].msg == msg)
+        {
+            // an other id or destination is a reuse of the buffer the profiler did not see
+            found = app_prof_env.sent[i].id == msg->id && app_prof_env.sent[i].dest_id == msg->dest_id;
+            *tick = app_prof_env.sent[i].tick;
+            *time = app_prof_env.sent[i].time;
+            app_prof_env.sent[i].msg = NULL;
+            break;
+        }
+    }
+    GLOBAL_INT_RESTORE();
+
+    return found;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Message handler of all the profiled tasks
+ *
+ * The original handler is looked up in the current state and then in the default state.
+ ****************************************************************************************
+ */
+static int app_prof_handler(ke_msg_id_t const msgid, void const *param,
+                            ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    struct app_prof_task const *task;
+    struct app_prof_msg *stat;
+    struct ke_msg const *msg = ke_param2msg(param);
+    ke_msg_func_t func = NULL;
+    ke_state_t state;
+    uint32_t start, start_time, tick, time, queue = 0;
+    bool sent;
+    int ret;
+
+    task = app_prof_get_task(KE_TYPE_GET(dest_id));
+    ASSERT_ERR(task != NULL);
+
+    state = ke_state_get(dest_id);
+    if (state < task->desc.state_max && task->desc.state_handler != NULL)
+        func = app_prof_find(&task->desc.state_handler[state], msgid);
+    if (func == NULL)
+        func = app_prof_find(task->desc.default_handler, msgid);
+
+    // the entry is freed before the handler, which may free the message and send a new one
+    sent = app_prof_sent_take(msg, &tick, &time);
+    if (sent)
+        queue = app_prof_elapsed(tick, time);
+
+    if (func == NULL)
+        return KE_MSG_CONSUMED;
+
+    start = APP_PROF_TICK();
+    start_time = ke_time();
+    ret = func(msgid, param, dest_id, src_id);
+    start = app_prof_elapsed(start, start_time);
+
+    // a saved message is handled again later, its residency goes on
+    if (sent && ret == KE_MSG_SAVED)
+        app_prof_sent_add(msg, tick, time);
+
+    stat = app_prof_get_msg(msgid, KE_TYPE_GET(dest_id));
+    if (stat != NULL)
+    {
+        stat->count++;
+        stat->cycles += start;
+        if (stat->cycles_max < start)
+            stat->cycles_max = start;
+        if (stat->queue_max < queue)
+            stat->queue_max = queue;
+    }
+
+    return ret;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Copy a state handler with the profiler handler
+ *
+ ****************************************************************************************
+ */
+static bool app_prof_hook(struct ke_state_handler *dst, struct ke_state_handler const *src)
+{
+    uint16_t i;
+
+    dst->msg_table = NULL;
+    dst->msg_cnt = 0;
+    if (src == NULL || src->msg_table == NULL)
+        return true;
+
+    if (app_prof_env.handler_nb + src->msg_cnt > APP_PROF_HANDLER_MAX)
+        return false;
+
+    for (i = 0; i < src->msg_cnt; i++)
+    {
+        app_prof_env.handler[app_prof_env.handler_nb + i].id = src->msg_table[i].id;
+        app_prof_env.handler[app_prof_env.handler_nb + i].func = (ke_msg_func_t)app_prof_handler;
+    }
+    dst->msg_table = &app_prof_env.handler[app_prof_env.handler_nb];
+    dst->msg_cnt = src->msg_cnt;
+    app_prof_env.handler_nb += src->msg_cnt;
+    return true;
+}
+
+/*
+ * EXPORTED FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Register a task with profiled message handlers
+ *
+ * If the profiler tables are full, the task is registered without profiling.
+ ****************************************************************************************
+ */
+void app_prof_task_register(uint8_t task_id, struct ke_task_desc task_desc)
+{
+    struct ke_task_desc desc = task_desc;
+    uint16_t handler_nb = app_prof_env.handler_nb;
+    uint8_t state_nb = app_prof_env.state_nb;
+    bool ok = true;
+    uint16_t i;
+
+    if (!(SysTick->CTRL & SysTick_CTRL_ENABLE_Msk))
+    {
+        // free running on the processor clock
+        SysTick->LOAD = APP_PROF_TICK_MASK;
+        SysTick->VAL = 0;
+        SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+    }
+    else if (SysTick->LOAD != APP_PROF_TICK_MASK)
+    {
+        // used by the application with another period, the cycle differences would be wrong
+        app_prof_env.tick_off = true;
+    }
+
+    if (app_prof_env.task_nb == APP_PROF_TASK_MAX
+        || app_prof_env.state_nb + task_desc.state_max + 1 > APP_PROF_STATE_MAX)
+    {
+        ok = false;
+    }
+    else
+    {
+        if (task_desc.state_handler != NULL)
+        {
+            desc.state_handler = &app_prof_env.state[app_prof_env.state_nb];
+            for (i = 0; ok && i < task_desc.state_max; i++)
+                ok = app_prof_hook(&app_prof_env.state[app_prof_env.state_nb++], &task_desc.state_handler[i]);
+        }
+        if (ok && task_desc.default_handler != NULL)
+        {
+            desc.default_handler = &app_prof_env.state[app_prof_env.state_nb];
+            ok = app_prof_hook(&app_prof_env.state[app_prof_env.state_nb++], task_desc.default_handler);
+        }
+    }
+
+    if (ok)
+    {
+        app_prof_env.task[app_prof_env.task_nb].task_id = task_id;
+        app_prof_env.task[app_prof_env.task_nb].desc = task_desc;
+        app_prof_env.task_nb++;
+    }
+    else
+    {
+        // roll back the tables of this task
+        app_prof_env.handler_nb = handler_nb;
+        app_prof_env.state_nb = state_nb;
+        desc = task_desc;
+    }
+
+    ((p_task_desc_register)(_task_desc_register))(task_id, desc);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Send a message and record the send time
+ *
+ ****************************************************************************************
+ */
+void app_prof_msg_send(void const *param_ptr)
+{
+    struct ke_msg const *msg = ke_param2msg(param_ptr);
+
+    // only the messages handled by app_prof_handler() free their entry
+    if (app_prof_get_task(KE_TYPE_GET(msg->dest_id)) != NULL)
+        app_prof_sent_add(msg, APP_PROF_TICK(), ke_time());
+
+    ((p_ke_msg_send)(_ke_msg_send))(param_ptr);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Free a message and drop its send time
+ *
+ ****************************************************************************************
+ */
+void app_prof_msg_free(struct ke_msg const *msg)
+{
+    uint32_t tick, time;
+
+    app_prof_sent_take(msg, &tick, &time);
+    ((p_ke_msg_free)(_ke_msg_free))(msg);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Clear the message statistics
+ *
+ ****************************************************************************************
+ */
+void app_prof_reset(void)
+{
+    app_prof_env.msg_nb = 0;
+    memset(app_prof_env.msg, 0, sizeof(app_prof_env.msg));
+    GLOBAL_INT_DISABLE();
+    memset(app_prof_env.sent, 0, sizeof(app_prof_env.sent));
+    app_prof_env.sent_evict_nb = 0;
+    GLOBAL_INT_RESTORE();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Print the n message ids of the most handler cycles
+ *
+ ****************************************************************************************
+ */
+void app_prof_dump(uint8_t n)
+{
+    uint64_t printed = 0;
+    struct app_prof_msg const *m;
+    uint8_t i, top;
+
+    QPRINTF("TASK MSGID     COUNT    CYCLES       AVG       MAX     QUEUE\r\n");
+    while (n--)
+    {
+        // select the next largest, the printed ones are marked in a bit field
+        top = APP_PROF_MSG_MAX;
+        for (i = 0; i < app_prof_env.msg_nb; i++)
+        {
+            if (!(printed & ((uint64_t)1 << i))
+                && (top == APP_PROF_MSG_MAX || app_prof_env.msg[i].cycles > app_prof_env.msg[top].cycles))
+            {
+                top = i;
+            }
+        }
+        if (top == APP_PROF_MSG_MAX)
+            break;
+        printed |= (uint64_t)1 << top;
+
+        m = &app_prof_env.msg[top];
+        QPRINTF("%4d %04x %9d %9d %9d %9d %9d\r\n", m->task, m->id, m->count, m->cycles,
+                m->cycles / m->count, m->cycles_max, m->queue_max);
+    }
+    QPRINTF("%d send times evicted\r\n", app_prof_env.sent_evict_nb);
+    if (app_prof_env.tick_off)
+        QPRINTF("SysTick is used with another period, no times\r\n");
+}
+
+#endif // QN_MSG_PROF
+
+/// @} APP_PROF
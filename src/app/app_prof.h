@@ -0,0 +1,138 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_prof.h
+ *
+ * @brief Application Kernel Message Profiler API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_PROF_H_
+#define _APP_PROF_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_PROF Kernel Message Profiler API
+ * @ingroup APP
+ * @brief Kernel message profiler
+ *
+ * task_desc_register() is redirected to app_prof_task_register(), which registers copies
+ * of the task message handler tables whose handlers are all app_prof_handler(). It looks
+ * up the original handler like the kernel does, and measures it with SysTick. ke_msg_send()
+ * is redirected to app_prof_msg_send(), which records the send time of a message to a
+ * profiled task, so the queue residency is known when it is handled. The send time is
+ * keyed by the message and dropped when the message is handled or freed by
+ * app_prof_msg_free(), the ke_msg_free() of the application. A message discarded by the
+ * kernel keeps its entry until the buffer is sent again or the entry is evicted for a
+ * newer message. Messages sent by the ROM stack are counted and measured, but have no
+ * residency.
+ *
+ * Times are in SysTick cycles (AHB clock). SysTick does not count in sleep, so a message
+ * queued across sleep shows less residency. SysTick wraps every 2^24 cycles (0.5s at 32MHz):
+ * a longer time is taken from ke_time() in 10ms steps. If SysTick already runs with another
+ * reload value, it is left alone and only the counts are measured.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include "ke_task.h"
+#include "ke_msg.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Maximum number of profiled tasks
+#define APP_PROF_TASK_MAX               8
+/// Maximum number of message handlers of all the profiled tasks
+#define APP_PROF_HANDLER_MAX            160
+/// Maximum number of state handlers of all the profiled tasks
+#define APP_PROF_STATE_MAX              32
+/// Maximum number of message ids with statistics
+#define APP_PROF_MSG_MAX                48
+/// Maximum number of messages in flight with send time, the oldest one is evicted
+#define APP_PROF_SENT_MAX               8
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Statistics of a message id
+struct app_prof_msg
+{
+    /// Message id
+    ke_msg_id_t id;
+    /// Destination task type
+    uint8_t task;
+    /// Handled count
+    uint32_t count;
+    /// Total handler cycles
+    uint32_t cycles;
+    /// Maximum handler cycles
+    uint32_t cycles_max;
+    /// Maximum cycles from send to handler
+    uint32_t queue_max;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/*
+ ****************************************************************************************
+ * @brief Register a task with profiled message handlers
+ *
+ ****************************************************************************************
+ */
+void app_prof_task_register(uint8_t task_id, struct ke_task_desc task_desc);
+
+/*
+ ****************************************************************************************
+ * @brief Send a message and record the send time
+ *
+ ****************************************************************************************
+ */
+void app_prof_msg_send(void const *param_ptr);
+
+/*
+ ****************************************************************************************
+ * @brief Free a message and drop its send time
+ *
+ ****************************************************************************************
+ */
+void app_prof_msg_free(struct ke_msg const *msg);
+
+/*
+ ****************************************************************************************
+ * @brief Clear the message statistics
+ *
+ ****************************************************************************************
+ */
+void app_prof_reset(void);
+
+/*
+ ****************************************************************************************
+ * @brief Print the n message ids of the most handler cycles
+ *
+ ****************************************************************************************
+ */
+void app_prof_dump(uint8_t n);
+
+/// @} APP_PROF
+
+#endif // _APP_PROF_H_
@@ -0,0 +1,82 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_qlog.h
+ *
+ * @brief Tokenized print record format, shared by qlog() and the host decoder
+ * (tools/qlog_decode.c)
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+#ifndef _APP_QLOG_H_
+#define _APP_QLOG_H_
+
+/*
+ * A record:
+ *  - sync byte QLOG_SYNC
+ *  - length of the rest of the record
+ *  - address of the format string, 4 bytes little endian, QLOG_LOST_ADDR for a lost
+ *    records count
+ *  - arguments in the order of the format string, '*' of the width and precision as
+ *    QLOG_ARG_NUM, then the conversion as encoded in QLOG_CONV_TABLE
+ * The host decoder reads the format string at the address from the ELF image.
+ *
+ * No firmware header is included, the host decoder builds with this file only.
+ */
+
+/// Tokenized print record sync byte
+#define QLOG_SYNC               0xA5
+/// Maximum tokenized print record size, including sync and length
+#define QLOG_REC_MAX            64
+/// Record header size: sync, length and format string address
+#define QLOG_HDR_LEN            6
+/// Format address of a lost records count, the count is the only argument
+#define QLOG_LOST_ADDR          0
+/// Maximum string bytes of a %s argument
+#define QLOG_STR_MAX            32
+/// Flag, width and precision characters between '%' and the qualifier
+#define QLOG_FLAG_CHARS         "-+ #0123456789.*"
+/// Bytes of a %a argument, 6 with the 'l' qualifier
+#define QLOG_ADDR_LEN(qualifier)    ((qualifier) == 'l' ? 6 : 4)
+
+/// Argument encodings
+enum qlog_arg
+{
+    /// No argument: %% and unknown conversions
+    QLOG_ARG_NONE,
+    /// Argument taken from the list but not sent: %n
+    QLOG_ARG_SKIP,
+    /// Signed integer, zigzag LEB128
+    QLOG_ARG_ZIGZAG,
+    /// Unsigned integer, LEB128
+    QLOG_ARG_NUM,
+    /// String bytes (at most QLOG_STR_MAX) and 0
+    QLOG_ARG_STR,
+    /// QLOG_ADDR_LEN() address bytes
+    QLOG_ARG_ADDR,
+};
+
+/// Argument encoding of each conversion, X(conversion, encoding)
+#define QLOG_CONV_TABLE(X)              \
+    X('d', QLOG_ARG_ZIGZAG)             \
+    X('i', QLOG_ARG_ZIGZAG)             \
+    X('c', QLOG_ARG_NUM)                \
+    X('o', QLOG_ARG_NUM)                \
+    X('x', QLOG_ARG_NUM)                \
+    X('X', QLOG_ARG_NUM)                \
+    X('u', QLOG_ARG_NUM)                \
+    X('p', QLOG_ARG_NUM)                \
+    X('s', QLOG_ARG_STR)                \
+    X('a', QLOG_ARG_ADDR)               \
+    X('A', QLOG_ARG_ADDR)               \
+    X('n', QLOG_ARG_SKIP)
+
+/// Case of a switch on the conversion setting the encoding, QLOG_CONV_TABLE(QLOG_CONV_CASE)
+#define QLOG_CONV_CASE(conv, enc)   case conv: arg = enc; break;
+
+#endif
@@ -0,0 +1,361 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_scan.c
+ *
+ * @brief Application Beacon Scanner API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_SCAN
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include "app_env.h"
+#if QN_BEACON_SCAN
+#include "lib.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Kernel time mask
+#define APP_SCAN_TIME_MASK              0x7FFFFF
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Beacon scanner environment
+struct app_scan_env_tag
+{
+    /// Hash table of the devices
+    struct app_scan_dev dev[APP_SCAN_TABLE_SIZE];
+    /// Number of devices in the table
+    uint8_t dev_nb;
+    /// Scanner running
+    bool running;
+    struct app_scan_stat stat;
+};
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct app_scan_env_tag app_scan_env;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Home slot of an address
+static uint8_t app_scan_hash(struct bd_addr const *addr)
+{
+    uint32_t h = co_read32p(&addr->addr[0]) ^ ((uint32_t)co_read16p(&addr->addr[4]) << 11);
+
+    // Fibonacci hashing, the random addresses differ in all their bits
+    return (uint8_t)((h * 2654435761u) >> 24) & (APP_SCAN_TABLE_SIZE - 1);
+}
+
+/// Find the slot of an address, or the empty slot where it shall be added
+static uint8_t app_scan_find(struct bd_addr const *addr)
+{
+    uint8_t i = app_scan_hash(addr);
+
+    // Linear probing, the table is never full
+    while ((app_scan_env.dev[i].addr_type != APP_SCAN_EMPTY)
+        && (memcmp(app_scan_env.dev[i].addr.addr, addr->addr, BD_ADDR_LEN) != 0))
+    {
+        i = (i + 1) & (APP_SCAN_TABLE_SIZE - 1);
+    }
+
+    return i;
+}
+
+/// Remove the device of a slot, the following devices of the cluster are moved back
+static void app_scan_remove(uint8_t i)
+{
+    uint8_t j = i;
+    uint8_t home;
+
+    for (;;)
+    {
+        app_scan_env.dev[i].addr_type = APP_SCAN_EMPTY;
+
+        // Find a device of the cluster which may fill the hole
+        for (;;)
+        {
+            j = (j + 1) & (APP_SCAN_TABLE_SIZE - 1);
+            if (app_scan_env.dev[j].addr_type == APP_SCAN_EMPTY)
+            {
+                app_scan_env.dev_nb--;
+                return;
+            }
+
+            // It may fill the hole unless its home slot is cyclically in ]i, j]
+            home = app_scan_hash(&app_scan_env.dev[j].addr);
+            if (((j - home) & (APP_SCAN_TABLE_SIZE - 1)) >= ((j - i) & (APP_SCAN_TABLE_SIZE - 1)))
+            {
+                break;
+            }
+        }
+
+        app_scan_env.dev[i] = app_scan_env.dev[j];
+        i = j;
+    }
+}
+
+/// Decode the iBeacon and Eddystone frames of the advertising data
+static void app_scan_decode(struct app_scan_dev *dev, uint8_t const *data, uint8_t len)
+{
+    struct app_ad_iter it;
+    struct app_ad_struct ad;
+    struct app_ibeacon ib;
+    struct app_eddystone ed;
+
+    app_ad_iter_init(&it, data, len);
+    while (app_ad_next(&it, &ad))
+    {
+        if (app_ad_ibeacon(&ad, &ib))
+        {
+            memcpy(dev->uuid, ib.uuid, 16);
+            dev->major = ib.major;
+            dev->minor = ib.minor;
+            dev->tx_power = ib.tx_power;
+            dev->beacon |= APP_SCAN_IBEACON;
+        }
+        else if (app_ad_eddystone(&ad, &ed))
+        {
+            switch (ed.frame)
+            {
+                case APP_AD_EDDYSTONE_UID:
+                    dev->tx_power = ed.tx_power;
+                    memcpy(dev->uuid, ed.id, 16);
+                    dev->beacon |= APP_SCAN_EDDYSTONE_UID;
+                    break;
+                case APP_AD_EDDYSTONE_URL:
+                    dev->tx_power = ed.tx_power;
+                    dev->url_len = ed.url_len;
+                    memcpy(dev->url, ed.id, ed.url_len);
+                    dev->beacon |= APP_SCAN_EDDYSTONE_URL;
+                    break;
+                default:
+                    dev->vbatt = ed.vbatt;
+                    dev->temp = ed.temp;
+                    dev->beacon |= APP_SCAN_EDDYSTONE_TLM;
+                    break;
+            }
+        }
+    }
+}
+
+/// Print a device of the summary
+static void app_scan_show_dev(struct app_scan_dev const *dev)
+{
+    uint8_t i;
+
+    QPRINTF("%c %02X%02X%02X%02X%02X%02X %4d %5d",
+            dev->addr_type ? 'R' : 'P',
+            dev->addr.addr[5], dev->addr.addr[4], dev->addr.addr[3],
+            dev->addr.addr[2], dev->addr.addr[1], dev->addr.addr[0],
+            dev->rssi_avg / 16, dev->rpt_nb);
+
+    if (dev->beacon & APP_SCAN_IBEACON)
+    {
+        QPRINTF(" iB %04X..%02X%02X %d/%d %d", (dev->uuid[0] << 8) | dev->uuid[1],
+                dev->uuid[14], dev->uuid[15], dev->major, dev->minor, dev->tx_power);
+    }
+    if (dev->beacon & APP_SCAN_EDDYSTONE_UID)
+    {
+        QPRINTF(" UID ");
+        for (i = 10; i < 16; i++)
+        {
+            QPRINTF("%02X", dev->uuid[i]);
+        }
+    }
+    if (dev->beacon & APP_SCAN_EDDYSTONE_URL)
+    {
+        QPRINTF(" URL %d:", dev->url[0]);
+        for (i = 1; i < dev->url_len; i++)
+        {
+            QPRINTF("%c", (dev->url[i] >= 0x20) ? dev->url[i] : '.');
+        }
+    }
+    if (dev->beacon & APP_SCAN_EDDYSTONE_TLM)
+    {
+        QPRINTF(" TLM %dmV %dC", dev->vbatt, dev->temp / 256);
+    }
+    QPRINTF("\r\n");
+}
+
+/*
+ * FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+void app_scan_start(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < APP_SCAN_TABLE_SIZE; i++)
+    {
+        app_scan_env.dev[i].addr_type = APP_SCAN_EMPTY;
+    }
+    app_scan_env.dev_nb = 0;
+    memset(&app_scan_env.stat, 0, sizeof(app_scan_env.stat));
+    app_scan_env.stat.time = ke_time();
+    app_scan_env.running = true;
+
+#if (BLE_OBSERVER)
+    app_gap_set_scan_mode_req(SCAN_PASSIVE, GAP_SCAN_FAST_INTV, GAP_SCAN_FAST_WIND);
+    app_gap_scan_req(SCAN_EN);
+#else
+    app_gap_dev_inq_req(GAP_GEN_INQ_TYPE, QN_ADDR_TYPE);
+#endif
+
+    ke_timer_set(APP_SCAN_REPORT_TIMER, TASK_APP, APP_SCAN_REPORT_TIME);
+}
+
+void app_scan_stop(void)
+{
+    app_scan_env.running = false;
+    ke_timer_clear(APP_SCAN_REPORT_TIMER, TASK_APP);
+
+#if (BLE_OBSERVER)
+    app_gap_scan_req(SCAN_DIS);
+#else
+    app_gap_dev_inq_cancel_req();
+#endif
+
+    app_scan_report_timer_handler(APP_SCAN_REPORT_TIMER, NULL, TASK_APP, TASK_APP);
+}
+
+bool app_scan_is_running(void)
+{
+    return app_scan_env.running;
+}
+
+void app_scan_report(struct adv_report const *rep)
+{
+    struct app_scan_dev *dev;
+    int16_t rssi;
+    uint8_t i;
+
+    if (!app_scan_env.running)
+    {
+        return;
+    }
+
+    app_scan_env.stat.rpt_nb++;
+    rssi = app_correct_rssi(rep->rssi) * 16;
+    i = app_scan_find(&rep->adv_addr);
+    dev = &app_scan_env.dev[i];
+
+    if (dev->addr_type == APP_SCAN_EMPTY)
+    {
+        if (app_scan_env.dev_nb >= APP_SCAN_DEV_MAX)
+        {
+            app_scan_env.stat.full_nb++;
+            return;
+        }
+
+        memset(dev, 0, sizeof(struct app_scan_dev));
+        dev->addr = rep->adv_addr;
+        dev->addr_type = rep->adv_addr_type;
+        dev->rssi_avg = rssi;
+        app_scan_env.dev_nb++;
+        app_scan_env.stat.new_nb++;
+    }
+    else
+    {
+        dev->rssi_avg += (rssi - dev->rssi_avg) >> APP_SCAN_RSSI_SHIFT;
+    }
+
+    dev->last_seen = ke_time();
+    dev->rpt_nb++;
+    app_scan_decode(dev, rep->data, rep->data_len);
+}
+
+void app_scan_inq_cmp(void)
+{
+#if (!BLE_OBSERVER)
+    if (app_scan_env.running)
+    {
+        app_gap_dev_inq_req(GAP_GEN_INQ_TYPE, QN_ADDR_TYPE);
+    }
+#endif
+}
+
+int app_scan_report_timer_handler(ke_msg_id_t const msgid, void const *param,
+                                  ke_task_id_t const dest_id, ke_task_id_t const src_id)
+{
+    struct app_scan_dev *dev;
+    uint32_t now = ke_time();
+    uint32_t period = (now - app_scan_env.stat.time) & APP_SCAN_TIME_MASK;
+    uint16_t i;
+
+    QPRINTF("\r\nBeacon scan: %d devices, %d reports/s, %d new, %d full\r\n",
+            app_scan_env.dev_nb,
+            period ? (app_scan_env.stat.rpt_nb * 100 / period) : 0,
+            app_scan_env.stat.new_nb, app_scan_env.stat.full_nb);
+
+    app_scan_env.stat.aged_nb = 0;
+    for (i = 0; i < APP_SCAN_TABLE_SIZE; )
+    {
+        dev = &app_scan_env.dev[i];
+        if (dev->addr_type == APP_SCAN_EMPTY)
+        {
+            i++;
+        }
+        else if (((now - dev->last_seen) & APP_SCAN_TIME_MASK) > APP_SCAN_AGE_TIME)
+        {
+            // The slot is filled again by the next device of the cluster, check it again
+            app_scan_remove(i);
+            app_scan_env.stat.aged_nb++;
+        }
+        else
+        {
+            if (dev->rpt_nb != 0)
+            {
+                app_scan_show_dev(dev);
+                dev->rpt_nb = 0;
+            }
+            i++;
+        }
+    }
+
+    QPRINTF("%d aged out\r\n", app_scan_env.stat.aged_nb);
+
+    app_scan_env.stat.rpt_nb = 0;
+    app_scan_env.stat.new_nb = 0;
+    app_scan_env.stat.full_nb = 0;
+    app_scan_env.stat.time = now;
+
+    if (app_scan_env.running)
+    {
+        ke_timer_set(APP_SCAN_REPORT_TIMER, TASK_APP, APP_SCAN_REPORT_TIME);
+    }
+
+    return (KE_MSG_CONSUMED);
+}
+
+#endif // QN_BEACON_SCAN
+
+/// @} APP_SCAN
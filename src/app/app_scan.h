@@ -0,0 +1,196 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_scan.h
+ *
+ * @brief Application Beacon Scanner API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_SCAN_H_
+#define _APP_SCAN_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_SCAN Beacon Scanner API
+ * @ingroup APP
+ * @brief Advertisers seen by the scan, with averaged RSSI and decoded beacon fields
+ *
+ * The advertising reports of the observer scan (or of the central inquiry) are looked up by
+ * address in an open-addressed hash table with linear probing. Each device keeps a running
+ * RSSI average of the corrected RSSI, the time it was last seen and the fields of its last
+ * iBeacon and Eddystone (UID, URL, TLM) frames. Nothing is printed per report.
+ *
+ * Every QN_BEACON_SCAN_REPORT seconds a summary of the table is printed, the report counts
+ * are cleared and the devices not seen for QN_BEACON_SCAN_AGE seconds are removed. A new
+ * device is not added when the table is 3/4 full.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "co_bt.h"
+#include "ke_msg.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Hash table size, power of 2
+#define APP_SCAN_TABLE_SIZE             QN_BEACON_SCAN_SIZE
+/// Maximum number of devices in the table
+#define APP_SCAN_DEV_MAX                (APP_SCAN_TABLE_SIZE * 3 / 4)
+/// Summary period in kernel time unit (10ms)
+#define APP_SCAN_REPORT_TIME            (QN_BEACON_SCAN_REPORT * 100)
+/// Age-out time in kernel time unit (10ms)
+#define APP_SCAN_AGE_TIME               (QN_BEACON_SCAN_AGE * 100)
+/// Weight of a new RSSI sample in the average, 1/2^APP_SCAN_RSSI_SHIFT
+#define APP_SCAN_RSSI_SHIFT             3
+/// Maximum length of the encoded Eddystone URL, scheme included
+#define APP_SCAN_URL_MAX                APP_AD_EDDYSTONE_URL_MAX
+/// Empty slot marker in the address type
+#define APP_SCAN_EMPTY                  0xFF
+
+#if (APP_SCAN_TABLE_SIZE & (APP_SCAN_TABLE_SIZE - 1)) || (APP_SCAN_TABLE_SIZE > 256)
+    #error "The beacon scanner table size shall be a power of 2 up to 256"
+#endif
+
+#if !BLE_OBSERVER && !BLE_CENTRAL
+    #error "The beacon scanner needs CFG_OBSERVER or CFG_CENTRAL"
+#endif
+
+/*
+ * ENUMERATION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Beacon frames received from a device
+enum app_scan_beacon
+{
+    APP_SCAN_IBEACON        = 0x01,
+    APP_SCAN_EDDYSTONE_UID  = 0x02,
+    APP_SCAN_EDDYSTONE_URL  = 0x04,
+    APP_SCAN_EDDYSTONE_TLM  = 0x08
+};
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Device seen by the scan
+struct app_scan_dev
+{
+    /// Device address
+    struct bd_addr addr;
+    /// Address type, APP_SCAN_EMPTY for an empty slot
+    uint8_t addr_type;
+    /// Beacon frames received (enum app_scan_beacon)
+    uint8_t beacon;
+    /// Kernel time of the last report
+    uint32_t last_seen;
+    /// Average RSSI in 1/16 dBm
+    int16_t rssi_avg;
+    /// Reports since the last summary
+    uint16_t rpt_nb;
+    /// Calibrated TX power of the last beacon frame (1m iBeacon, 0m Eddystone)
+    int8_t tx_power;
+    /// Length of the encoded Eddystone URL
+    uint8_t url_len;
+    /// iBeacon major and minor
+    uint16_t major;
+    uint16_t minor;
+    /// Eddystone TLM battery voltage (mV) and temperature (8.8 fixed point degrees)
+    uint16_t vbatt;
+    int16_t temp;
+    /// iBeacon proximity UUID, or Eddystone namespace (10 bytes) and instance (6 bytes)
+    uint8_t uuid[16];
+    /// Eddystone URL scheme and encoded URL
+    uint8_t url[APP_SCAN_URL_MAX];
+};
+
+/// Scanner statistics since the last summary
+struct app_scan_stat
+{
+    /// Advertising reports
+    uint32_t rpt_nb;
+    /// Devices added
+    uint16_t new_nb;
+    /// Devices removed by the age-out
+    uint16_t aged_nb;
+    /// Devices not added because the table was full
+    uint16_t full_nb;
+    /// Kernel time of the last summary
+    uint32_t time;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/*
+ ****************************************************************************************
+ * @brief Clear the table and start the scan and the periodic summary
+ *
+ ****************************************************************************************
+ */
+void app_scan_start(void);
+
+/*
+ ****************************************************************************************
+ * @brief Stop the scan and print the last summary
+ *
+ ****************************************************************************************
+ */
+void app_scan_stop(void);
+
+/*
+ ****************************************************************************************
+ * @brief Return true if the scanner is running
+ *
+ ****************************************************************************************
+ */
+bool app_scan_is_running(void);
+
+/*
+ ****************************************************************************************
+ * @brief Add an advertising report to the table
+ *
+ ****************************************************************************************
+ */
+void app_scan_report(struct adv_report const *rep);
+
+/*
+ ****************************************************************************************
+ * @brief Handle the end of an inquiry, the inquiry is restarted while the scanner runs
+ *
+ ****************************************************************************************
+ */
+void app_scan_inq_cmp(void);
+
+/*
+ ****************************************************************************************
+ * @brief Handle the summary timer: print the table and remove the aged devices
+ *
+ ****************************************************************************************
+ */
+int app_scan_report_timer_handler(ke_msg_id_t const msgid, void const *param,
+                                  ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+/// @} APP_SCAN
+
+#endif // _APP_SCAN_H_
@@ -0,0 +1,696 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_store.c
+ *
+ * @brief Application Record Store API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_STORE
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include "app_env.h"
+#if QN_REC_STORE
+#include "serialflash.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Sector header magic word
+#define APP_STORE_MAGIC                 0x4753514E
+/// Erased flash word
+#define APP_STORE_ERASED                0xFFFFFFFF
+/// Invalid page index
+#define APP_STORE_NO_PAGE               0xFFFF
+/// Invalid sector index
+#define APP_STORE_NO_SECTOR             0xFF
+/// Initial value of the record checksum, an all-zero record is not valid
+#define APP_STORE_CHK_INIT              0x5A
+
+/// Size of a record in flash, data is padded to 4 bytes
+#define APP_STORE_REC_SIZE(len)         (APP_STORE_REC_HDR_LEN + (((len) + 3) & ~3))
+/// Record location: page index in the region and word offset in the page
+#define APP_STORE_LOC(page, off)        ((uint16_t)(((page) << 6) | ((off) >> 2)))
+#define APP_STORE_LOC_PAGE(loc)         ((loc) >> 6)
+#define APP_STORE_LOC_OFF(loc)          (((loc) & 0x3F) << 2)
+/// Flash address of a page
+#define APP_STORE_PAGE_ADDR(page)       (QN_REC_STORE_BASE_ADDR + (uint32_t)(page) * APP_STORE_PAGE_SIZE)
+/// Sector index of a page
+#define APP_STORE_SECTOR_OF(page)       ((page) / APP_STORE_SECTOR_PAGES)
+
+// The firmware 2 and the data of the OTA take the flash from the firmware 2 address
+#if (BLE_OTA_SERVER) && (QN_REC_STORE_BASE_ADDR + QN_REC_STORE_SECTOR_NUM * APP_STORE_SECTOR_SIZE > OTAS_FW2_ADDRESS)
+    #error "The record store overlaps the OTA firmware 2 area"
+#endif
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Record index entry
+struct app_store_idx
+{
+    uint16_t id;
+    uint16_t loc;
+    uint8_t len;
+};
+
+/// Record store environment
+struct app_store_env_tag
+{
+    /// Page buffer of the log head
+    uint32_t page[APP_STORE_PAGE_SIZE / 4];
+    /// Read cache of one flash page
+    uint32_t cache[APP_STORE_PAGE_SIZE / 4];
+    /// Sequence number of each sector, 0 means the sector is free
+    uint32_t sector_seq[QN_REC_STORE_SECTOR_NUM];
+    /// Last sequence number used
+    uint32_t seq;
+    /// Bytes of the live records in flash
+    uint32_t live_bytes;
+    /// Page in the read cache
+    uint16_t cache_page;
+    /// Page in the page buffer
+    uint16_t head_page;
+    /// Write offset in the page buffer
+    uint16_t head_off;
+    /// Number of records in the index
+    uint16_t rec_nb;
+    /// The page buffer holds records not programmed yet
+    bool dirty;
+    /// Index sorted by record id
+    struct app_store_idx idx[QN_REC_STORE_MAX_RECORDS];
+    /// Counters
+    struct app_store_stat stat;
+};
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct app_store_env_tag app_store_env;
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+static bool app_store_next_page(void);
+
+/**
+ ****************************************************************************************
+ * @brief Calculate the record checksum
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_store_chk(uint16_t id, uint8_t len, uint8_t const *data)
+{
+    uint8_t chk = APP_STORE_CHK_INIT;
+
+    chk = ((chk << 1) | (chk >> 7)) ^ (uint8_t)id;
+    chk = ((chk << 1) | (chk >> 7)) ^ (uint8_t)(id >> 8);
+    chk = ((chk << 1) | (chk >> 7)) ^ len;
+    while (len--)
+    {
+        chk = ((chk << 1) | (chk >> 7)) ^ *data++;
+    }
+
+    return chk;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Binary search of the index, returns the position of id or where to insert it
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_store_find(uint16_t id, bool *found)
+{
+    uint16_t lo = 0;
+    uint16_t hi = app_store_env.rec_nb;
+    uint16_t mid;
+
+    while (lo < hi)
+    {
+        mid = (lo + hi) >> 1;
+        if (app_store_env.idx[mid].id < id)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    *found = (lo < app_store_env.rec_nb) && (app_store_env.idx[lo].id == id);
+    return lo;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the content of a page, from the page buffer or through the read cache
+ *
+ ****************************************************************************************
+ */
+static uint8_t const *app_store_page_get(uint16_t page)
+{
+    if (page == app_store_env.head_page)
+        return (uint8_t const *)app_store_env.page;
+
+    if (page != app_store_env.cache_page)
+    {
+        APP_STORE_FLASH_READ(APP_STORE_PAGE_ADDR(page), app_store_env.cache, APP_STORE_PAGE_SIZE);
+        app_store_env.cache_page = page;
+    }
+
+    return (uint8_t const *)app_store_env.cache;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Erase a sector and mark it free
+ *
+ ****************************************************************************************
+ */
+static void app_store_sector_erase(uint8_t sector)
+{
+    APP_STORE_FLASH_ERASE(QN_REC_STORE_BASE_ADDR + sector * APP_STORE_SECTOR_SIZE);
+    app_store_env.stat.sector_erases++;
+    app_store_env.sector_seq[sector] = 0;
+
+    if (app_store_env.cache_page != APP_STORE_NO_PAGE
+        && APP_STORE_SECTOR_OF(app_store_env.cache_page) == sector)
+        app_store_env.cache_page = APP_STORE_NO_PAGE;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Start the log head at the first page of a free sector
+ *
+ ****************************************************************************************
+ */
+static void app_store_sector_open(uint8_t sector)
+{
+    app_store_env.sector_seq[sector] = ++app_store_env.seq;
+    app_store_env.head_page = sector * APP_STORE_SECTOR_PAGES;
+    memset(app_store_env.page, 0xFF, APP_STORE_PAGE_SIZE);
+    app_store_env.page[0] = APP_STORE_MAGIC;
+    app_store_env.page[1] = app_store_env.seq;
+    app_store_env.head_off = APP_STORE_SECTOR_HDR_LEN;
+    app_store_env.dirty = false;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Append a record to the page buffer
+ *
+ ****************************************************************************************
+ */
+static bool app_store_append(uint16_t id, uint8_t const *data, uint8_t len, uint16_t *loc)
+{
+    uint16_t size = APP_STORE_REC_SIZE(len);
+    uint8_t *p;
+
+    // Opening a new sector may copy records of the oldest sector to the head
+    while (app_store_env.head_off + size > APP_STORE_PAGE_SIZE)
+    {
+        if (!app_store_next_page())
+            return false;
+    }
+
+    p = (uint8_t *)app_store_env.page + app_store_env.head_off;
+    p[0] = (uint8_t)id;
+    p[1] = (uint8_t)(id >> 8);
+    p[2] = len;
+    p[3] = app_store_chk(id, len, data);
+    if (len)
+        memcpy(p + APP_STORE_REC_HDR_LEN, data, len);
+
+    *loc = APP_STORE_LOC(app_store_env.head_page, app_store_env.head_off);
+    app_store_env.head_off += size;
+    app_store_env.dirty = true;
+
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Copy the live records of a sector to the log head, then erase the sector
+ *
+ * The records are copied in flash order. The copies of a page never take more than one
+ * page, so the collection always fits when it starts in a freshly opened head sector.
+ * Returns false if the head sector is full, the collected sector is kept.
+ ****************************************************************************************
+ */
+static bool app_store_gc(uint8_t sector)
+{
+    struct app_store_idx *rec;
+    uint8_t const *p;
+    uint16_t page = sector * APP_STORE_SECTOR_PAGES;
+    uint16_t off, id, pos;
+    bool found;
+
+    for (uint8_t n = 0; n < APP_STORE_SECTOR_PAGES; n++, page++)
+    {
+        off = (n == 0) ? APP_STORE_SECTOR_HDR_LEN : 0;
+        while (off + APP_STORE_REC_HDR_LEN <= APP_STORE_PAGE_SIZE)
+        {
+            // The page is read again, the copy may have moved the log head
+            p = app_store_page_get(page) + off;
+            id = p[0] | (p[1] << 8);
+            if (id == APP_STORE_INVALID_ID)
+                break;
+
+            // Only the current version of a record is copied, a torn record is never current
+            pos = app_store_find(id, &found);
+            rec = &app_store_env.idx[pos];
+            if (found && rec->loc == APP_STORE_LOC(page, off))
+            {
+                if (!app_store_append(id, p + APP_STORE_REC_HDR_LEN, rec->len, &rec->loc))
+                {
+                    QPRINTF("Record store GC failed\r\n");
+                    return false;
+                }
+                app_store_env.stat.gc_copies++;
+            }
+            off += APP_STORE_REC_SIZE(p[2]);
+        }
+    }
+
+    // The copies shall be in flash before the originals are erased
+    if (app_store_env.dirty)
+        app_store_next_page();
+
+    app_store_sector_erase(sector);
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Drop the copies of a garbage collection that did not fit
+ *
+ * The head sector only holds copies of the collected sector, which is still intact. It is
+ * erased and the store mounted again, the previous sector becomes the full head and the
+ * collection starts over in an empty sector at the next write.
+ ****************************************************************************************
+ */
+static void app_store_gc_rollback(uint8_t head)
+{
+    struct app_store_stat stat;
+
+    app_store_sector_erase(head);
+    stat = app_store_env.stat;
+    app_store_init();
+    app_store_env.stat = stat;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Program the page buffer and move the log head to the next page
+ *
+ ****************************************************************************************
+ */
+static bool app_store_next_page(void)
+{
+    uint8_t next, sector;
+
+    if (app_store_env.dirty)
+    {
+        APP_STORE_FLASH_WRITE(APP_STORE_PAGE_ADDR(app_store_env.head_page), app_store_env.page, APP_STORE_PAGE_SIZE);
+        app_store_env.stat.page_writes++;
+        app_store_env.dirty = false;
+    }
+
+    if (((app_store_env.head_page + 1) % APP_STORE_SECTOR_PAGES) != 0)
+    {
+        app_store_env.head_page++;
+        app_store_env.head_off = 0;
+        memset(app_store_env.page, 0xFF, APP_STORE_PAGE_SIZE);
+        return true;
+    }
+
+    next = (APP_STORE_SECTOR_OF(app_store_env.head_page) + 1) % QN_REC_STORE_SECTOR_NUM;
+    if (app_store_env.sector_seq[next] != 0)
+    {
+        // Only while the next sector is being collected
+        app_store_env.head_off = APP_STORE_PAGE_SIZE;
+        return false;
+    }
+
+    app_store_sector_open(next);
+
+    // Keep the sector after the head free
+    sector = (next + 1) % QN_REC_STORE_SECTOR_NUM;
+    if (app_store_env.sector_seq[sector] != 0 && !app_store_gc(sector))
+    {
+        app_store_gc_rollback(next);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Apply a record found in flash to the index
+ *
+ ****************************************************************************************
+ */
+static void app_store_replay(uint16_t id, uint8_t len, uint16_t loc)
+{
+    bool found;
+    uint16_t pos = app_store_find(id, &found);
+    struct app_store_idx *rec = &app_store_env.idx[pos];
+
+    if (found)
+        app_store_env.live_bytes -= APP_STORE_REC_SIZE(rec->len);
+
+    if (len == 0)
+    {
+        // Deleted
+        if (found)
+        {
+            app_store_env.rec_nb--;
+            memmove(rec, rec + 1, (app_store_env.rec_nb - pos) * sizeof(struct app_store_idx));
+        }
+        return;
+    }
+
+    if (!found)
+    {
+        if (app_store_env.rec_nb >= QN_REC_STORE_MAX_RECORDS)
+            return;
+        memmove(rec + 1, rec, (app_store_env.rec_nb - pos) * sizeof(struct app_store_idx));
+        app_store_env.rec_nb++;
+        rec->id = id;
+    }
+
+    rec->loc = loc;
+    rec->len = len;
+    app_store_env.live_bytes += APP_STORE_REC_SIZE(len);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Replay the records of one sector, returns the last programmed page
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_store_sector_replay(uint8_t sector)
+{
+    uint16_t page = sector * APP_STORE_SECTOR_PAGES;
+    uint16_t last = page;
+    uint8_t const *p;
+    uint16_t off, id;
+    uint8_t len;
+
+    for (uint8_t n = 0; n < APP_STORE_SECTOR_PAGES; n++, page++)
+    {
+        p = app_store_page_get(page);
+        if (*(uint32_t const *)p == APP_STORE_ERASED)
+            continue;
+
+        last = page;
+        off = (n == 0) ? APP_STORE_SECTOR_HDR_LEN : 0;
+        while (off + APP_STORE_REC_HDR_LEN <= APP_STORE_PAGE_SIZE)
+        {
+            id = p[off] | (p[off + 1] << 8);
+            len = p[off + 2];
+            if (id == APP_STORE_INVALID_ID)
+                break;
+
+            // Stop at a torn record, the rest of the page is not trusted
+            if (len > APP_STORE_MAX_DATA_LEN
+                || off + APP_STORE_REC_SIZE(len) > APP_STORE_PAGE_SIZE
+                || p[off + 3] != app_store_chk(id, len, p + off + APP_STORE_REC_HDR_LEN))
+                break;
+
+            app_store_replay(id, len, APP_STORE_LOC(page, off));
+            off += APP_STORE_REC_SIZE(len);
+        }
+    }
+
+    return last;
+}
+
+/*
+ * EXPORTED FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Mount the record store and rebuild the index from flash
+ *
+ ****************************************************************************************
+ */
+void app_store_init(void)
+{
+    uint32_t const *hdr;
+    uint32_t min_seq, last_seq;
+    uint16_t last_page = 0;
+    uint8_t sector, head;
+    uint8_t n;
+
+    memset(&app_store_env, 0, sizeof(app_store_env));
+    app_store_env.cache_page = APP_STORE_NO_PAGE;
+    app_store_env.head_page = APP_STORE_NO_PAGE;
+
+    // Find the used sectors, erase the ones left over by an interrupted erase
+    for (sector = 0; sector < QN_REC_STORE_SECTOR_NUM; sector++)
+    {
+        hdr = (uint32_t const *)app_store_page_get(sector * APP_STORE_SECTOR_PAGES);
+        if (hdr[0] == APP_STORE_MAGIC && hdr[1] != 0 && hdr[1] != APP_STORE_ERASED)
+        {
+            app_store_env.sector_seq[sector] = hdr[1];
+            if (hdr[1] > app_store_env.seq)
+                app_store_env.seq = hdr[1];
+            continue;
+        }
+
+        for (n = 0; n < APP_STORE_SECTOR_PAGES; n++)
+        {
+            hdr = (uint32_t const *)app_store_page_get(sector * APP_STORE_SECTOR_PAGES + n);
+            if (hdr[0] != APP_STORE_ERASED)
+            {
+                app_store_sector_erase(sector);
+                break;
+            }
+        }
+    }
+
+    // Replay the sectors from the oldest to the newest
+    head = APP_STORE_NO_SECTOR;
+    last_seq = 0;
+    while (1)
+    {
+        min_seq = APP_STORE_ERASED;
+        sector = APP_STORE_NO_SECTOR;
+        for (n = 0; n < QN_REC_STORE_SECTOR_NUM; n++)
+        {
+            if (app_store_env.sector_seq[n] > last_seq && app_store_env.sector_seq[n] < min_seq)
+            {
+                min_seq = app_store_env.sector_seq[n];
+                sector = n;
+            }
+        }
+        if (sector == APP_STORE_NO_SECTOR)
+            break;
+
+        last_page = app_store_sector_replay(sector);
+        last_seq = min_seq;
+        head = sector;
+    }
+
+    if (head == APP_STORE_NO_SECTOR)
+    {
+        app_store_sector_open(0);
+        return;
+    }
+
+    // Continue after the last programmed page of the newest sector
+    memset(app_store_env.page, 0xFF, APP_STORE_PAGE_SIZE);
+    if (((last_page + 1) % APP_STORE_SECTOR_PAGES) != 0)
+    {
+        app_store_env.head_page = last_page + 1;
+        app_store_env.head_off = 0;
+    }
+    else
+    {
+        // The sector is full, the page buffer keeps the content of its last page for reading
+        app_store_env.head_page = last_page;
+        app_store_env.head_off = APP_STORE_PAGE_SIZE;
+        APP_STORE_FLASH_READ(APP_STORE_PAGE_ADDR(last_page), app_store_env.page, APP_STORE_PAGE_SIZE);
+    }
+
+    // Finish a garbage collection interrupted before the erase, or roll it back when the
+    // copies made before the reset leave too little room in the head sector
+    sector = (head + 1) % QN_REC_STORE_SECTOR_NUM;
+    if (app_store_env.sector_seq[sector] != 0 && !app_store_gc(sector))
+        app_store_gc_rollback(head);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Write a record, replaces the previous version of the same id
+ *
+ ****************************************************************************************
+ */
+uint8_t app_store_write(uint16_t id, void const *data, uint8_t len)
+{
+    struct app_store_idx *rec;
+    uint16_t pos, loc, old_size;
+    bool found;
+
+    if (id == APP_STORE_INVALID_ID || len == 0 || len > APP_STORE_MAX_DATA_LEN)
+        return APP_STORE_INVALID_PARAM;
+
+    pos = app_store_find(id, &found);
+    if (!found && app_store_env.rec_nb >= QN_REC_STORE_MAX_RECORDS)
+        return APP_STORE_INDEX_FULL;
+
+    old_size = found ? APP_STORE_REC_SIZE(app_store_env.idx[pos].len) : 0;
+    if (app_store_env.live_bytes - old_size + APP_STORE_REC_SIZE(len) > APP_STORE_LIVE_MAX)
+        return APP_STORE_NO_SPACE;
+
+    // The garbage collection does not change the order of the index, pos stays valid
+    if (!app_store_append(id, (uint8_t const *)data, len, &loc))
+        return APP_STORE_NO_SPACE;
+
+    rec = &app_store_env.idx[pos];
+    if (!found)
+    {
+        memmove(rec + 1, rec, (app_store_env.rec_nb - pos) * sizeof(struct app_store_idx));
+        app_store_env.rec_nb++;
+        rec->id = id;
+    }
+    rec->loc = loc;
+    rec->len = len;
+
+    app_store_env.live_bytes += APP_STORE_REC_SIZE(len) - old_size;
+    app_store_env.stat.user_bytes += len;
+
+    return APP_STORE_OK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Read a record, len is the buffer size on input and the record length on output
+ *
+ ****************************************************************************************
+ */
+uint8_t app_store_read(uint16_t id, void *data, uint8_t *len)
+{
+    struct app_store_idx *rec;
+    uint8_t const *p;
+    uint16_t pos;
+    bool found;
+
+    pos = app_store_find(id, &found);
+    if (!found)
+        return APP_STORE_NOT_FOUND;
+
+    rec = &app_store_env.idx[pos];
+    if (*len < rec->len)
+        return APP_STORE_INVALID_PARAM;
+
+    p = app_store_page_get(APP_STORE_LOC_PAGE(rec->loc)) + APP_STORE_LOC_OFF(rec->loc);
+    memcpy(data, p + APP_STORE_REC_HDR_LEN, rec->len);
+    *len = rec->len;
+
+    return APP_STORE_OK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Delete a record
+ *
+ ****************************************************************************************
+ */
+uint8_t app_store_delete(uint16_t id)
+{
+    uint16_t pos, loc;
+    bool found;
+
+    pos = app_store_find(id, &found);
+    if (!found)
+        return APP_STORE_NOT_FOUND;
+
+    if (!app_store_append(id, NULL, 0, &loc))
+        return APP_STORE_NO_SPACE;
+
+    app_store_env.live_bytes -= APP_STORE_REC_SIZE(app_store_env.idx[pos].len);
+    app_store_env.rec_nb--;
+    memmove(&app_store_env.idx[pos], &app_store_env.idx[pos + 1],
+            (app_store_env.rec_nb - pos) * sizeof(struct app_store_idx));
+
+    return APP_STORE_OK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Program the page buffer to flash
+ *
+ ****************************************************************************************
+ */
+void app_store_flush(void)
+{
+    // A programmed page can not be appended, the rest of it is left unused
+    if (app_store_env.dirty)
+        app_store_next_page();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the number of records
+ *
+ ****************************************************************************************
+ */
+uint16_t app_store_get_rec_nb(void)
+{
+    return app_store_env.rec_nb;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the n-th record id in ascending id order
+ *
+ ****************************************************************************************
+ */
+uint16_t app_store_get_id(uint16_t n)
+{
+    if (n >= app_store_env.rec_nb)
+        return APP_STORE_INVALID_ID;
+
+    return app_store_env.idx[n].id;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the record store counters
+ *
+ ****************************************************************************************
+ */
+struct app_store_stat const *app_store_get_stat(void)
+{
+    return &app_store_env.stat;
+}
+
+#endif // QN_REC_STORE
+/// @} APP_STORE
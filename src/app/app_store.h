@@ -0,0 +1,199 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_store.h
+ *
+ * @brief Application Record Store API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#ifndef _APP_STORE_H_
+#define _APP_STORE_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_STORE Record Store API
+ * @ingroup APP
+ * @brief Log-structured record store on serial flash
+ *
+ * Records are identified by a 16-bit id and appended to a circular log in a flash region.
+ * Writes are collected in a RAM page buffer and programmed one full page (256 bytes) at a
+ * time, which is what the flash controller requires above 0x1000. A RAM index maps every
+ * record id to the location of its latest version. When the log head enters a new sector,
+ * the live records of the oldest sector are copied to the head and the sector is erased,
+ * so one sector is always free. The index is rebuilt from the log by app_store_init(), and
+ * records with a bad checksum (torn page write) are skipped. A collection interrupted by a
+ * reset is finished by app_store_init(), or rolled back if the head sector is too full.
+ *
+ * Only records programmed to flash survive a reset. Call app_store_flush() to program the
+ * page buffer before the power may go away.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Flash page size
+#define APP_STORE_PAGE_SIZE             256
+/// Flash sector size
+#define APP_STORE_SECTOR_SIZE           0x1000
+/// Pages in one sector
+#define APP_STORE_SECTOR_PAGES          (APP_STORE_SECTOR_SIZE / APP_STORE_PAGE_SIZE)
+/// Total pages of the region
+#define APP_STORE_PAGE_NUM              (QN_REC_STORE_SECTOR_NUM * APP_STORE_SECTOR_PAGES)
+/// Sector header size (magic + sequence number)
+#define APP_STORE_SECTOR_HDR_LEN        8
+/// Record header size (id + length + checksum)
+#define APP_STORE_REC_HDR_LEN           4
+/// Maximum record data length, a record never crosses a page
+#define APP_STORE_MAX_DATA_LEN          (APP_STORE_PAGE_SIZE - APP_STORE_SECTOR_HDR_LEN - APP_STORE_REC_HDR_LEN)
+/// Invalid record id, also marks the end of the records in a page
+#define APP_STORE_INVALID_ID            0xFFFF
+/// Live data limit. The head sector and a free sector are not counted, and half of the
+/// other sectors is left to the stale records so a garbage collection always frees space.
+#define APP_STORE_LIVE_MAX              ((QN_REC_STORE_SECTOR_NUM - 2) * (APP_STORE_SECTOR_SIZE / 2))
+/// Flash size of the smallest record (4 bytes of data)
+#define APP_STORE_MIN_REC_SIZE          (APP_STORE_REC_HDR_LEN + 4)
+
+/// Flash access used by the store, can be redefined to run the store on a RAM flash model
+#ifndef APP_STORE_FLASH_READ
+#define APP_STORE_FLASH_READ(addr, buf, len)    read_flash(addr, buf, len)
+#define APP_STORE_FLASH_WRITE(addr, buf, len)   write_flash(addr, buf, len)
+#define APP_STORE_FLASH_ERASE(addr)             sector_erase_flash(addr, 1)
+#endif
+
+#if (QN_REC_STORE_BASE_ADDR < 0x1000) || (QN_REC_STORE_BASE_ADDR % APP_STORE_SECTOR_SIZE)
+    #error "The record store shall start at a sector boundary above the NVDS area"
+#endif
+#if (QN_REC_STORE_SECTOR_NUM < 3)
+    #error "The record store needs at least 3 sectors"
+#endif
+#if (QN_REC_STORE_BASE_ADDR + QN_REC_STORE_SECTOR_NUM * APP_STORE_SECTOR_SIZE > 0x20000)
+    #error "The record store shall end in the 128KB flash"
+#endif
+#if (QN_REC_STORE_MAX_RECORDS * APP_STORE_MIN_REC_SIZE > APP_STORE_LIVE_MAX)
+    #error "The record store sectors can not hold QN_REC_STORE_MAX_RECORDS records besides the head and the spare sector"
+#endif
+
+/*
+ * ENUMERATION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Record store status
+enum app_store_status
+{
+    APP_STORE_OK = 0,
+    APP_STORE_NOT_FOUND,
+    APP_STORE_NO_SPACE,
+    APP_STORE_INDEX_FULL,
+    APP_STORE_INVALID_PARAM
+};
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Record store counters
+struct app_store_stat
+{
+    /// Record data bytes written by the user
+    uint32_t user_bytes;
+    /// Pages programmed, write amplification is page_writes * APP_STORE_PAGE_SIZE / user_bytes
+    uint32_t page_writes;
+    /// Sectors erased
+    uint16_t sector_erases;
+    /// Records copied by garbage collection
+    uint16_t gc_copies;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/*
+ ****************************************************************************************
+ * @brief Mount the record store and rebuild the index from flash
+ *
+ ****************************************************************************************
+ */
+void app_store_init(void);
+
+/*
+ ****************************************************************************************
+ * @brief Write a record, replaces the previous version of the same id
+ *
+ ****************************************************************************************
+ */
+uint8_t app_store_write(uint16_t id, void const *data, uint8_t len);
+
+/*
+ ****************************************************************************************
+ * @brief Read a record, len is the buffer size on input and the record length on output
+ *
+ ****************************************************************************************
+ */
+uint8_t app_store_read(uint16_t id, void *data, uint8_t *len);
+
+/*
+ ****************************************************************************************
+ * @brief Delete a record
+ *
+ ****************************************************************************************
+ */
+uint8_t app_store_delete(uint16_t id);
+
+/*
+ ****************************************************************************************
+ * @brief Program the page buffer to flash
+ *
+ ****************************************************************************************
+ */
+void app_store_flush(void);
+
+/*
+ ****************************************************************************************
+ * @brief Get the number of records
+ *
+ ****************************************************************************************
+ */
+uint16_t app_store_get_rec_nb(void);
+
+/*
+ ****************************************************************************************
+ * @brief Get the n-th record id in ascending id order
+ *
+ ****************************************************************************************
+ */
+uint16_t app_store_get_id(uint16_t n);
+
+/*
+ ****************************************************************************************
+ * @brief Get the record store counters
+ *
+ ****************************************************************************************
+ */
+struct app_store_stat const *app_store_get_stat(void);
+
+/// @} APP_STORE
+
+#endif // _APP_STORE_H_
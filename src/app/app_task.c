@@ -158,10 +158,6 @@ static int app_32k_xtal_wakeup_timer(ke_msg_id_t const msgid, void const *param,
 /* default State handlers definition. */
 const struct ke_msg_handler app_default_state[] =
 {
-#ifdef QN_BLE_TIME_SUPPORT
-    {APP_SYS_TIME_CHECK_TIMER,              (ke_msg_func_t) app_sys_time_check_timer_handler},
-#endif
-
 #if (QN_EACI || QN_DEMO_MENU)
     {APP_SYS_UART_DATA_IND,                 (ke_msg_func_t) app_uart_data_ind_handler},
 #endif
@@ -206,6 +202,9 @@ const struct ke_msg_handler app_default_state[] =
 #if (BLE_OBSERVER)
     {GAP_ADV_REPORT_EVT,                    (ke_msg_func_t) app_gap_dev_scan_result_handler},
 #endif
+#if (QN_BEACON_SCAN)
+    {APP_SCAN_REPORT_TIMER,                 (ke_msg_func_t) app_scan_report_timer_handler},
+#endif
 #if (BLE_CENTRAL)
     {GAP_DEV_INQ_RESULT_EVT,                (ke_msg_func_t) app_gap_dev_inq_result_handler},
     {GAP_SCAN_REQ_CMP_EVT,                  (ke_msg_func_t) app_gap_scan_req_cmp_evt_handler},
@@ -609,6 +608,8 @@ const struct ke_msg_handler app_default_state[] =
     {ANCSC_DISABLE_IND,                     (ke_msg_func_t) app_ancsc_disable_ind_handler},
     {ANCS_ENABLE_SUVPER_TIMER0,             (ke_msg_func_t) app_ancsc_enable_reset_timer_handler},
     {ANCS_ENABLE_SUVPER_TIMER1,             (ke_msg_func_t) app_ancsc_enable_reset_timer_handler},
+    {ANCS_FETCH_TIMER0,                     (ke_msg_func_t) app_ancsc_fetch_timer_handler},
+    {ANCS_FETCH_TIMER1,                     (ke_msg_func_t) app_ancsc_fetch_timer_handler},
  
 #endif
 };
@@ -72,13 +72,13 @@ enum
     APP_SYS_RCO_CAL_TIMER,
     APP_SYS_32K_XTAL_WAKEUP_TIMER,
 
-    APP_SYS_TIME_CHECK_TIMER,
-
     APP_SYS_BUTTON_1_TIMER,
     APP_SYS_BUTTON_2_TIMER,
     // for ancsc
     ANCS_ENABLE_SUVPER_TIMER0,
     ANCS_ENABLE_SUVPER_TIMER1,
+    ANCS_FETCH_TIMER0,
+    ANCS_FETCH_TIMER1,
     // end
     APP_HTPT_PERIOD_MEAS_TIMER,
     APP_HTPT_IDLE_CONNECTION_TIMEOUT_TIMER,
@@ -99,6 +99,7 @@ enum
     APP_HOGPD_BOOT_MOUSE_IN_REPORT_TIMER,
     APP_HOGPD_REPORT_TIMER,
 		APP_BEACON_CHG_CTX_TIMER,
+    APP_SCAN_REPORT_TIMER,
     APP_MSG_MAX
 };
 
@@ -66,6 +66,46 @@ uint8_t app_get_role(void)
     return app_env.role;
 }
 
+/**
+ ****************************************************************************************
+ * @brief Hash of the device address for the device record
+ *
+ * The table has at most 16 slots, two address bytes are enough and it is cheaper than
+ * one more address compare.
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_rec_hash(struct bd_addr const *addr)
+{
+    return (addr->addr[0] ^ addr->addr[3]) & (APP_REC_HASH_SIZE - 1);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Rebuild the address hash table of the connected devices
+ *
+ ****************************************************************************************
+ */
+static void app_rebuild_rec_hash(void)
+{
+    uint8_t h;
+
+    memset(app_env.rec_hash, 0, APP_REC_HASH_SIZE);
+    for (uint8_t i = 0; i < BLE_CONNECTION_MAX; i++)
+    {
+        if (app_env.dev_rec[i].free)
+            continue;
+
+        // Linear probing
+        h = app_rec_hash(&app_env.dev_rec[i].bonded_info.peer_addr);
+        while (app_env.rec_hash[h] != 0)
+        {
+            h = (h + 1) & (APP_REC_HASH_SIZE - 1);
+        }
+        app_env.rec_hash[h] = i + 1;
+    }
+}
+
 /**
  ****************************************************************************************
  * @brief Get Device Record Index by connection handle
@@ -76,6 +116,14 @@ uint8_t app_get_rec_idx_by_conhdl(uint16_t conhdl)
 {
     uint8_t idx;
 
+    // The connection handles are allocated by the stack below BLE_CONNECTION_MAX
+    if (conhdl < BLE_CONNECTION_MAX)
+    {
+        idx = app_env.conhdl_map[conhdl];
+        return (idx != 0) ? (idx - 1) : GAP_INVALID_CONIDX;
+    }
+
+    // Any other handle, 0xFFFF finds a free record
     for (idx = 0; idx < BLE_CONNECTION_MAX; idx++)
     {
         if (app_env.dev_rec[idx].conhdl == conhdl)
@@ -109,15 +157,19 @@ uint16_t app_get_conhdl_by_idx(uint8_t idx)
  */
 uint16_t app_get_conhdl_by_bdaddr(struct bd_addr const *addr, uint8_t *idx)
 {
-    for (uint8_t i = 0; i < BLE_CONNECTION_MAX; i++)
+    uint8_t h = app_rec_hash(addr);
+    uint8_t i;
+
+    while ((i = app_env.rec_hash[h]) != 0)
     {
-        if (co_bt_bdaddr_compare(addr, &app_env.dev_rec[i].bonded_info.peer_addr) == true)
+        if (co_bt_bdaddr_compare(addr, &app_env.dev_rec[i - 1].bonded_info.peer_addr) == true)
         {
-            ASSERT_ERR(app_env.dev_rec[i].free == false);
-            *idx = i;
+            ASSERT_ERR(app_env.dev_rec[i - 1].free == false);
+            *idx = i - 1;
 
-            return app_env.dev_rec[i].conhdl;
+            return app_env.dev_rec[i - 1].conhdl;
         }
+        h = (h + 1) & (APP_REC_HASH_SIZE - 1);
     }
 
     *idx = GAP_INVALID_CONIDX;
@@ -132,18 +184,10 @@ uint16_t app_get_conhdl_by_bdaddr(struct bd_addr const *addr, uint8_t *idx)
  */
 uint8_t app_get_bd_addr_by_conhdl(uint16_t conhdl, struct bd_addr *addr)
 {
-    uint8_t idx = GAP_INVALID_CONIDX;
+    uint8_t idx = app_get_rec_idx_by_conhdl(conhdl);
 
-    for (uint8_t i = 0; i < BLE_CONNECTION_MAX; i++)
-    {
-        if (app_env.dev_rec[i].conhdl == conhdl)
-        {
-            if (addr)
-                *addr = app_env.dev_rec[i].bonded_info.peer_addr;
-            idx = i;
-            break;
-        }
-    }
+    if ((idx != GAP_INVALID_CONIDX) && addr)
+        *addr = app_env.dev_rec[idx].bonded_info.peer_addr;
 
     return idx;
 }        
@@ -222,20 +266,28 @@ void app_set_link_status_by_conhdl(uint16_t conhdl, struct gap_link_info const *
         {
             app_env.dev_rec[idx].free = false;
             app_env.dev_rec[idx].conhdl = conhdl;
+            app_env.dev_rec[idx].client_flag = 0;
             app_env.dev_rec[idx].bonded_info.addr_type = conn_info->peer_addr_type;
             app_env.dev_rec[idx].bonded_info.peer_addr = conn_info->peer_addr;
+            if (conhdl < BLE_CONNECTION_MAX)
+                app_env.conhdl_map[conhdl] = idx + 1;
             app_env.cn_count++;
+            app_rebuild_rec_hash();
         }
     }
     else
     {
-        uint8_t idx = app_get_bd_addr_by_conhdl(conhdl, NULL);
+        uint8_t idx = app_get_rec_idx_by_conhdl(conhdl);
         if (idx != GAP_INVALID_CONIDX)
         {
             app_env.dev_rec[idx].free = true;
             app_env.dev_rec[idx].conhdl = 0xFFFF;
+            app_env.dev_rec[idx].client_flag = 0;
             memset(&app_env.dev_rec[idx].bonded_info, 0, sizeof(struct app_bonded_info));
+            if (conhdl < BLE_CONNECTION_MAX)
+                app_env.conhdl_map[conhdl] = 0;
             app_env.cn_count--;
+            app_rebuild_rec_hash();
         }
     }
 }
@@ -281,50 +333,183 @@ bool app_get_bond_status(uint8_t idx, uint8_t key_flag)
 
 /**
  ****************************************************************************************
- * @brief Add the bonded device
+ * @brief Hash of the device address for the bonded database
  *
  ****************************************************************************************
  */
 #if (QN_SECURITY_ON)
-bool app_add_bonded_dev(void *bonded_dev)
+static uint8_t app_bonded_hash(struct bd_addr const *addr)
 {
-    if (app_env.bonded_count < APP_MAX_BONDED_DEVICE_NUMBER)
+    uint8_t h = 0;
+
+    for (uint8_t i = 0; i < BD_ADDR_LEN; i++)
     {
-        app_env.bonded_info[app_env.bonded_count++] = *(struct app_bonded_info *)bonded_dev;
-#if (QN_NVDS_WRITE)
-        if (NVDS_OK == nvds_put(APP_NVDS_DB_START_TAG + app_env.bonded_count - 1, sizeof(struct app_bonded_info), (uint8_t *)bonded_dev))
+        h = ((h << 3) | (h >> 5)) ^ addr->addr[i];
+    }
+    return h & (APP_BONDED_HASH_SIZE - 1);
+}
+#endif
+
+/**
+ ****************************************************************************************
+ * @brief Rebuild the address hash table of the bonded database
+ *
+ ****************************************************************************************
+ */
+#if (QN_SECURITY_ON)
+void app_rebuild_bonded_hash(void)
+{
+    uint8_t h;
+
+    memset(app_env.bonded_hash, 0, APP_BONDED_HASH_SIZE);
+    for (uint8_t i = 0; i < app_env.bonded_count; i++)
+    {
+        // Linear probing
+        h = app_bonded_hash(&app_env.bonded_info[i].peer_addr);
+        while (app_env.bonded_hash[h] != 0)
         {
-            uint8_t num = app_env.bonded_count;
-            if (NVDS_OK == nvds_put(APP_NVDS_DB_COUNT_TAG, sizeof(num), &num))
-            {
-                return true;
-            }
+            h = (h + 1) & (APP_BONDED_HASH_SIZE - 1);
         }
-        app_env.bonded_count--;
-        return false;
+        app_env.bonded_hash[h] = i + 1;
+    }
+}
 #endif
+
+/**
+ ****************************************************************************************
+ * @brief Load the bonded database from NVDS, slots are filled in order
+ *
+ ****************************************************************************************
+ */
+#if (QN_SECURITY_ON)
+void app_load_bonded_dev(void)
+{
+    struct app_bonded_rec rec;
+    nvds_tag_len_t length;
+
+    app_env.bonded_count = 0;
+    app_env.bonded_seq_cnt = 0;
+    for (uint8_t i = 0; i < APP_MAX_BONDED_DEVICE_NUMBER; i++)
+    {
+        length = sizeof(struct app_bonded_rec);
+        if (NVDS_OK != nvds_get(APP_NVDS_DB_START_TAG + i, &length, (uint8_t *)&rec))
+        {
+            break;
+        }
+        app_env.bonded_info[i] = rec.info;
+        // The slot written by older version has no use sequence
+        app_env.bonded_seq[i] = (length == sizeof(struct app_bonded_rec)) ? rec.seq : 0;
+        if (app_env.bonded_seq[i] > app_env.bonded_seq_cnt)
+        {
+            app_env.bonded_seq_cnt = app_env.bonded_seq[i];
+        }
+        app_env.bonded_count++;
     }
-    else
+    app_rebuild_bonded_hash();
+}
+#endif
+
+/**
+ ****************************************************************************************
+ * @brief Mark the bonded device as used, it is the last one to be replaced
+ *
+ * The use sequence is written to the NVDS slot, so the order survives a reset. Nothing is
+ * written when the device is already the most recently used one.
+ *
+ ****************************************************************************************
+ */
+#if (QN_SECURITY_ON)
+void app_update_bonded_dev_lru(uint8_t idx)
+{
+    if (idx >= app_env.bonded_count || app_env.bonded_seq[idx] == app_env.bonded_seq_cnt)
     {
+        return;
+    }
+
 #if (QN_NVDS_WRITE)
-        // Replace one item
-        nvds_tag_len_t length = sizeof(struct app_bonded_info);
+    struct app_bonded_rec rec;
+    nvds_tag_len_t length = sizeof(struct app_bonded_rec);
+
+    // The slot in NVDS is rewritten as stored, the address in RAM may be a resolved one
+    if (NVDS_OK == nvds_get(APP_NVDS_DB_START_TAG + idx, &length, (uint8_t *)&rec))
+    {
+        rec.seq = app_env.bonded_seq_cnt + 1;
+        if (NVDS_OK != nvds_put(APP_NVDS_DB_START_TAG + idx, sizeof(struct app_bonded_rec), (uint8_t *)&rec))
+        {
+            return;
+        }
+    }
+#endif
+
+    app_env.bonded_seq[idx] = ++app_env.bonded_seq_cnt;
+}
+#endif
+
+/**
+ ****************************************************************************************
+ * @brief Add the bonded device
+ *
+ * A bonded device already in the database is updated in its slot. Otherwise a new slot is
+ * used, or the least recently used slot is replaced when the database is full. Only the
+ * updated slot is written to NVDS.
+ *
+ ****************************************************************************************
+ */
+#if (QN_SECURITY_ON)
+bool app_add_bonded_dev(void *bonded_dev)
+{
+    struct app_bonded_info *dev = (struct app_bonded_info *)bonded_dev;
+    uint8_t idx = app_find_bonded_dev(&dev->peer_addr);
+    bool new_addr = false;
 
-        for (uint8_t i = 1; i < (app_env.bonded_count - 1); i++)
+    if (idx == GAP_INVALID_CONIDX)
+    {
+        new_addr = true;
+        if (app_env.bonded_count < APP_MAX_BONDED_DEVICE_NUMBER)
+        {
+            idx = app_env.bonded_count;
+        }
+        else
         {
-            if (NVDS_OK != nvds_put(APP_NVDS_DB_COUNT_TAG + i - 1, length, (uint8_t *)&app_env.bonded_info[i]))
+            // Replace the least recently used slot
+            idx = 0;
+            for (uint8_t i = 1; i < app_env.bonded_count; i++)
             {
-                return false;
+                if (app_env.bonded_seq[i] < app_env.bonded_seq[idx])
+                {
+                    idx = i;
+                }
             }
-            app_env.bonded_info[i - 1] = app_env.bonded_info[i];
         }
-        if (NVDS_OK != nvds_put(APP_NVDS_DB_START_TAG + app_env.bonded_count - 1, length, (uint8_t *)bonded_dev))
+    }
+
+#if (QN_NVDS_WRITE)
+    struct app_bonded_rec rec;
+
+    rec.info = *dev;
+    rec.seq = app_env.bonded_seq_cnt + 1;
+    if (NVDS_OK != nvds_put(APP_NVDS_DB_START_TAG + idx, sizeof(struct app_bonded_rec), (uint8_t *)&rec))
+    {
+        return false;
+    }
+#endif
+
+    app_env.bonded_info[idx] = *dev;
+    app_env.bonded_seq[idx] = ++app_env.bonded_seq_cnt;
+    if (new_addr)
+    {
+        if (idx == app_env.bonded_count)
         {
-            return false;
+            app_env.bonded_count++;
         }
-        app_env.bonded_info[app_env.bonded_count - 1] = *(struct app_bonded_info *)bonded_dev;
+        app_rebuild_bonded_hash();
+#if (BLE_ANCS_NC)
+        // The attribute cache of a replaced peer is not for the new one
+        app_ancsc_cache_drop(idx);
 #endif
     }
+    QPRINTF("Bonded device is stored in slot %d.\r\n", idx);
+
     return true;
 }
 #endif
@@ -338,14 +523,16 @@ bool app_add_bonded_dev(void *bonded_dev)
 #if (QN_SECURITY_ON)
 uint8_t app_find_bonded_dev(struct bd_addr const *addr)
 {
-    int i;
+    uint8_t h = app_bonded_hash(addr);
+    uint8_t idx;
 
-    for (i = 0; i < app_env.bonded_count; i++)
+    while ((idx = app_env.bonded_hash[h]) != 0)
     {
-        if (true == co_bt_bdaddr_compare(addr, &app_env.bonded_info[i].peer_addr))
+        if (true == co_bt_bdaddr_compare(addr, &app_env.bonded_info[idx - 1].peer_addr))
         {
-            return i;
+            return idx - 1;
         }
+        h = (h + 1) & (APP_BONDED_HASH_SIZE - 1);
     }
     return GAP_INVALID_CONIDX;
 }
@@ -471,124 +658,17 @@ bool app_get_remote_service_status(uint8_t idx, uint16_t uuid)
 
 /**
  ****************************************************************************************
- * @brief Get the client index by connection handle and uuid.
+ * @brief Get the index of the connection with the client enabled by connection handle
  *
  ****************************************************************************************
  */
 #if (BLE_CENTRAL)
-uint8_t app_get_client_idx_by_conhdl(uint16_t conhdl, uint16_t uuid)
+uint8_t app_get_client_idx_by_conhdl(uint16_t conhdl, uint16_t clt_bit)
 {
-    uint8_t idx = 0, stop = false;
+    uint8_t idx = app_get_rec_idx_by_conhdl(conhdl);
 
-    for (; idx < BLE_CONNECTION_MAX; idx++)
-    {
-        switch (uuid)
-        {
-#if BLE_CSC_COLLECTOR
-            case ATT_SVC_CYCLING_SPEED_CADENCE:
-                if (app_cscpc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;    
-#endif
-#if BLE_RSC_COLLECTOR
-            case ATT_SVC_RUNNING_SPEED_CADENCE:
-                if (app_rscpc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;    
-#endif
-#if BLE_PAS_CLIENT
-            case ATT_SVC_PHONE_ALERT_STATUS:
-                if (app_paspc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;    
-#endif
-#if BLE_AN_CLIENT
-            case ATT_SVC_ALERT_NTF:
-                if (app_anpc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;    
-#endif
-#if BLE_HT_COLLECTOR
-            case ATT_SVC_HEALTH_THERMOM:
-                if (app_htpc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;    
-#endif    
-#if BLE_BP_COLLECTOR
-            case ATT_SVC_BLOOD_PRESSURE:
-                if (app_blpc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;  
-#endif 
-#if BLE_HR_COLLECTOR
-            case ATT_SVC_HEART_RATE:
-                if (app_hrpc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;
-#endif 
-#if BLE_GL_COLLECTOR
-            case ATT_SVC_GLUCOSE:
-                if (app_glpc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;
-#endif 
-#if BLE_FINDME_LOCATOR
-            case ATT_SVC_IMMEDIATE_ALERT:
-                if (app_findl_env[idx].conhdl == conhdl)
-                    stop = true;
-                break; 
-#endif 
-#if BLE_PROX_MONITOR
-            case ATT_SVC_LINK_LOSS:
-                if (app_proxm_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;
-#endif
-#if BLE_TIP_CLIENT
-            case ATT_SVC_CURRENT_TIME:
-                if (app_tipc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break; 
-#endif
-#if BLE_SP_CLIENT
-            case ATT_SVC_SCAN_PARAMETERS:
-                if (app_scppc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;
-#endif
-#if BLE_DIS_CLIENT
-            case ATT_SVC_DEVICE_INFO:
-                if (app_disc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;
-#endif
-#if BLE_BATT_CLIENT
-            case ATT_SVC_BATTERY_SERVICE:
-                if (app_basc_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;
-#endif
-#if BLE_HID_BOOT_HOST
-            case ATT_SVC_HID:
-                if (app_hogpbh_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;
-#endif
-#if BLE_HID_REPORT_HOST
-            case ATT_SVC_HID:
-                if (app_hogprh_env[idx].conhdl == conhdl)
-                    stop = true;
-                break;
-#endif               
-                
-            default:
-                QPRINTF("Unknown UUID\r\n");
-                break;
-        }
-
-        if (stop == true)
-            return idx;
-    }
+    if ((idx != GAP_INVALID_CONIDX) && (app_env.dev_rec[idx].client_flag & clt_bit))
+        return idx;
 
     return APP_INVALID_INDEX;
 }
@@ -596,7 +676,7 @@ uint8_t app_get_client_idx_by_conhdl(uint16_t conhdl, uint16_t uuid)
 
 /**
  ****************************************************************************************
- * @brief Get the client service UUID enable status from application device record
+ * @brief Get the client enable status from application device record
  *
  ****************************************************************************************
  */
@@ -612,99 +692,13 @@ uint8_t app_get_qpp_client_service_status(uint8_t idx)
     return enabled;
 }
 
-uint8_t app_get_client_service_status(uint8_t idx, uint16_t uuid)
+/*
+ * The client of the profile task instance idx is enabled on the connection of device
+ * record idx, the stack allocates both with the connection index.
+ */
+bool app_get_client_service_status(uint8_t idx, uint16_t clt_bit)
 {
-    uint8_t enabled = 0;
-    switch (uuid)
-    {
-#if BLE_PAS_CLIENT
-        case ATT_SVC_PHONE_ALERT_STATUS:
-            enabled = app_paspc_env[idx].enabled;
-            break;
-#endif
-#if BLE_AN_CLIENT
-        case ATT_SVC_ALERT_NTF:
-            enabled = app_anpc_env[idx].enabled;
-            break;
-#endif
-#if BLE_HT_COLLECTOR
-        case ATT_SVC_HEALTH_THERMOM:
-            enabled = app_htpc_env[idx].enabled;
-            break;
-#endif
-#if BLE_BP_COLLECTOR
-        case ATT_SVC_BLOOD_PRESSURE:
-            enabled = app_blpc_env[idx].enabled;
-            break;
-#endif
-#if BLE_HR_COLLECTOR
-        case ATT_SVC_HEART_RATE:
-            enabled = app_hrpc_env[idx].enabled;
-            break;
-#endif
-#if BLE_GL_COLLECTOR
-        case ATT_SVC_GLUCOSE:
-            enabled = app_glpc_env[idx].enabled;
-            break;
-#endif
-#if BLE_FINDME_LOCATOR
-        case ATT_SVC_IMMEDIATE_ALERT:
-            enabled = app_findl_env[idx].enabled;
-            break;
-#endif
-#if BLE_TIP_CLIENT
-        case ATT_SVC_CURRENT_TIME:
-        case ATT_SVC_REF_TIME_UPDATE:
-        case ATT_SVC_NEXT_DST_CHANGE:
-            enabled = app_tipc_env[idx].enabled;
-            break;
-#endif
-#if BLE_PROX_MONITOR
-        case ATT_SVC_LINK_LOSS:
-        case ATT_SVC_TX_POWER:
-            enabled = app_proxm_env[idx].enabled;
-            break;
-#endif
-#if BLE_HID_BOOT_HOST
-        case ATT_SVC_HID:
-            enabled = app_hogpbh_env[idx].enabled;
-            break;
-#endif
-#if BLE_HID_REPORT_HOST
-        case ATT_SVC_HID:
-            enabled = app_hogprh_env[idx].enabled;
-            break;
-#endif
-#if BLE_SP_CLIENT
-        case ATT_SVC_SCAN_PARAMETERS:
-            enabled = app_scppc_env[idx].enabled;
-            break;
-#endif
-#if BLE_DIS_CLIENT
-        case ATT_SVC_DEVICE_INFO:
-            enabled = app_disc_env[idx].enabled;
-            break;
-#endif
-#if BLE_BATT_CLIENT
-        case ATT_SVC_BATTERY_SERVICE:
-            enabled = app_basc_env[idx].enabled;
-            break;
-#endif
-#if BLE_CSC_COLLECTOR
-        case ATT_SVC_CYCLING_SPEED_CADENCE:
-            enabled = app_cscpc_env[idx].enabled;
-            break;
-#endif
-#if BLE_RSC_COLLECTOR
-        case ATT_SVC_RUNNING_SPEED_CADENCE:
-            enabled = app_rscpc_env[idx].enabled;;
-            break;
-#endif
-        default:
-            break;
-    }
-   
-    return enabled;
+    return (bool)((app_env.dev_rec[idx].client_flag & clt_bit) != 0);
 }
 #endif
 
@@ -730,109 +724,12 @@ void app_set_qpp_client_service_status(uint16_t conhdl)
     }
 }
 
-void app_set_client_service_status(uint16_t conhdl)
+void app_set_client_service_status(uint8_t idx, uint16_t clt_bit, bool enabled)
 {
-    uint8_t idx;
-
-    for (idx = 0; idx < BLE_CONNECTION_MAX; idx++)
-    {
-#if BLE_PAS_CLIENT
-        if (conhdl == app_paspc_env[idx].conhdl)
-        {
-            app_paspc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_AN_CLIENT
-        if (conhdl == app_anpc_env[idx].conhdl)
-        {
-            app_anpc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_HT_COLLECTOR
-        if (conhdl == app_htpc_env[idx].conhdl)
-        {
-            app_htpc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_BP_COLLECTOR
-        if (conhdl == app_blpc_env[idx].conhdl)
-        {
-            app_blpc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_HR_COLLECTOR
-        if (conhdl == app_hrpc_env[idx].conhdl)
-        {
-            app_hrpc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_GL_COLLECTOR
-        if (conhdl == app_glpc_env[idx].conhdl)
-        {
-            app_glpc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_FINDME_LOCATOR
-        if (conhdl == app_findl_env[idx].conhdl)
-        {
-            app_findl_env[idx].enabled = false;
-        }
-#endif
-#if BLE_TIP_CLIENT
-        if (conhdl == app_tipc_env[idx].conhdl)
-        {
-            app_tipc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_PROX_MONITOR
-        if (conhdl == app_proxm_env[idx].conhdl)
-        {
-            app_proxm_env[idx].enabled = false;
-        }
-#endif
-#if BLE_HID_BOOT_HOST
-        if (conhdl == app_hogpbh_env->conhdl)
-        {
-            app_hogpbh_env[idx].enabled = false;
-        }
-#endif
-#if BLE_HID_REPORT_HOST
-        if (conhdl == app_hogprh_env->conhdl)
-        {
-            app_hogprh_env[idx].enabled = false;
-        }
-#endif
-#if BLE_SP_CLIENT
-        if (conhdl == app_scppc_env[idx].conhdl)
-        {
-            app_scppc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_DIS_CLIENT
-        if (conhdl == app_disc_env[idx].conhdl)
-        {
-            app_disc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_BATT_CLIENT
-        if (conhdl == app_basc_env[idx].conhdl)
-        {
-            app_basc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_CSC_COLLECTOR
-        if (conhdl == app_cscpc_env[idx].conhdl)
-        {
-            app_cscpc_env[idx].enabled = false;
-        }
-#endif
-#if BLE_RSC_COLLECTOR
-        if (conhdl == app_rscpc_env[idx].conhdl)
-        {
-            app_rscpc_env[idx].enabled = false;
-        }
-#endif
-    }
+    if (enabled)
+        app_env.dev_rec[idx].client_flag |= clt_bit;
+    else
+        app_env.dev_rec[idx].client_flag &= ~clt_bit;
 }
 #endif
 
@@ -1584,40 +1481,216 @@ uint8_t app_set_scan_rsp_data(uint16_t srv_flag)
 #if (BLE_CENTRAL || BLE_OBSERVER)
 bool app_parser_adv_data(uint8_t *pdata, uint8_t total_len, struct app_adv_data *padv)
 {
-    uint8_t *pend = pdata + total_len;
+    struct app_ad_iter it;
+    struct app_ad_struct ad;
 
-    memset(padv, 0, sizeof(struct app_adv_data));
-    while (pdata < pend)
-    {
-        uint8_t data_len = *pdata++; // Data length include advertising type
+    // Only the fields flagged are valid, the arrays are not cleared
+    padv->flag = 0;
+    padv->uuid_num = 0;
+    padv->name[0] = '\0';
 
-        if ((pdata + data_len) > pend)
-            return false;
-
-        switch (*pdata)
+    app_ad_iter_init(&it, pdata, total_len);
+    while (app_ad_next(&it, &ad))
+    {
+        switch (ad.kind)
         {
-            case GAP_AD_TYPE_SHORTENED_NAME:
-            case GAP_AD_TYPE_COMPLETE_NAME:
-                memcpy(padv->name, pdata + 1, data_len - 1);
-                padv->name[data_len] = '\0';
+            case APP_AD_NAME:
+            {
+                uint8_t len = ad.len;
+
+                if (len > sizeof(padv->name) - 1)
+                    len = sizeof(padv->name) - 1;
+                memcpy(padv->name, ad.data, len);
+                padv->name[len] = '\0';
                 padv->flag |= AD_TYPE_NAME_BIT;
                 break;
-            case GAP_AD_TYPE_MORE_16_BIT_UUID:
-            case GAP_AD_TYPE_COMPLETE_LIST_16_BIT_UUID:
-            {
-                uint16_t *puuid = &(padv->uuid[0]);
-                for (uint8_t i = 0; i < (data_len - 1); i += 2)
+            }
+            case APP_AD_UUID16:
+                for (uint8_t i = 0; (i < ad.nb) && (padv->uuid_num < (sizeof(padv->uuid) / sizeof(uint16_t))); i++)
                 {
-                   *puuid++ = (uint16_t)(pdata[i + 1] | (pdata[i + 2] << 8));
-                    padv->uuid_num++;
+                    padv->uuid[padv->uuid_num++] = co_read16p(&ad.data[i << 1]);
                 }
                 padv->flag |= AD_TYPE_16bitUUID_BIT;
                 break;
-            }
             default:
                 break;
         }
-        pdata += data_len;
+    }
+
+    return !app_ad_iter_error(&it);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Start iterating over the AD structures of Advertising or Scan response data
+ *
+ ****************************************************************************************
+ */
+void app_ad_iter_init(struct app_ad_iter *it, uint8_t const *data, uint8_t len)
+{
+    it->p = data;
+    it->end = data + len;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the view of the next AD structure
+ *
+ * The AD structure is classified by its type, the typed fields are set when the payload is
+ * long enough for the type. Nothing is copied, the view points into the parsed buffer.
+ *
+ ****************************************************************************************
+ */
+bool app_ad_next(struct app_ad_iter *it, struct app_ad_struct *ad)
+{
+    uint8_t const *p = it->p;
+    uint8_t ad_len;
+
+    // A zero length ends the significant part, the rest is padding
+    if ((p >= it->end) || (p[0] == 0))
+    {
+        it->p = it->end;
+        return false;
+    }
+
+    // Truncated AD structure, the iterator stays on it
+    ad_len = p[0];
+    if (ad_len >= (it->end - p))
+        return false;
+    it->p = p + 1 + ad_len;
+
+    ad->type = p[1];
+    ad->kind = APP_AD_OTHER;
+    ad->len = ad_len - 1;
+    ad->nb = 0;
+    ad->id = 0;
+    ad->data = p + 2;
+
+    switch (ad->type)
+    {
+        case GAP_AD_TYPE_FLAGS:
+            if (ad->len >= 1)
+            {
+                ad->kind = APP_AD_FLAGS;
+                ad->id = ad->data[0];
+            }
+            break;
+        case GAP_AD_TYPE_SHORTENED_NAME:
+        case GAP_AD_TYPE_COMPLETE_NAME:
+            ad->kind = APP_AD_NAME;
+            break;
+        case GAP_AD_TYPE_MORE_16_BIT_UUID:
+        case GAP_AD_TYPE_COMPLETE_LIST_16_BIT_UUID:
+            ad->kind = APP_AD_UUID16;
+            ad->nb = ad->len >> 1;
+            break;
+        case GAP_AD_TYPE_MORE_32_BIT_UUID:
+        case GAP_AD_TYPE_COMPLETE_LIST_32_BIT_UUID:
+            ad->kind = APP_AD_UUID32;
+            ad->nb = ad->len >> 2;
+            break;
+        case GAP_AD_TYPE_MORE_128_BIT_UUID:
+        case GAP_AD_TYPE_COMPLETE_LIST_128_BIT_UUID:
+            ad->kind = APP_AD_UUID128;
+            ad->nb = ad->len >> 4;
+            break;
+        case GAP_AD_TYPE_MANU_SPECIFIC_DATA:
+        case GAP_AD_TYPE_SERVICE_DATA:
+            // Company ID or 16-bit service UUID first
+            if (ad->len >= 2)
+            {
+                ad->kind = (ad->type == GAP_AD_TYPE_SERVICE_DATA) ? APP_AD_SERVICE_DATA : APP_AD_MANU_DATA;
+                ad->id = co_read16p(ad->data);
+                ad->data += 2;
+                ad->len -= 2;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Return true if the iteration stopped on a truncated AD structure
+ *
+ ****************************************************************************************
+ */
+bool app_ad_iter_error(struct app_ad_iter const *it)
+{
+    return (it->p != it->end);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Decode an iBeacon frame from a manufacturer data view
+ *
+ * Apple company ID, type 0x02, length 0x15, UUID, major, minor (big endian), TX power.
+ *
+ ****************************************************************************************
+ */
+bool app_ad_ibeacon(struct app_ad_struct const *ad, struct app_ibeacon *ib)
+{
+    uint8_t const *p = ad->data;
+
+    if ((ad->kind != APP_AD_MANU_DATA) || (ad->len != 23) || (ad->id != APP_AD_COMPANY_APPLE)
+        || (p[0] != APP_AD_IBEACON_TYPE) || (p[1] != APP_AD_IBEACON_LEN))
+        return false;
+
+    ib->uuid = &p[2];
+    ib->major = (p[18] << 8) | p[19];
+    ib->minor = (p[20] << 8) | p[21];
+    ib->tx_power = (int8_t)p[22];
+
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Decode an Eddystone UID, URL or TLM frame from a service data view
+ *
+ * The multi-byte fields are big endian. Only the unencrypted TLM (version 0) is decoded.
+ *
+ ****************************************************************************************
+ */
+bool app_ad_eddystone(struct app_ad_struct const *ad, struct app_eddystone *ed)
+{
+    uint8_t const *p = ad->data;
+
+    if ((ad->kind != APP_AD_SERVICE_DATA) || (ad->id != APP_AD_EDDYSTONE_UUID) || (ad->len < 2))
+        return false;
+
+    ed->frame = p[0];
+    switch (p[0])
+    {
+        case APP_AD_EDDYSTONE_UID:
+            // TX power, namespace, instance, the 2 reserved bytes may be omitted
+            if (ad->len < 18)
+                return false;
+            ed->tx_power = (int8_t)p[1];
+            ed->id = &p[2];
+            break;
+        case APP_AD_EDDYSTONE_URL:
+            // TX power, scheme, encoded URL
+            if ((ad->len < 3) || (ad->len - 2 > APP_AD_EDDYSTONE_URL_MAX))
+                return false;
+            ed->tx_power = (int8_t)p[1];
+            ed->url_len = ad->len - 2;
+            ed->id = &p[2];
+            break;
+        case APP_AD_EDDYSTONE_TLM:
+            // Version, battery voltage, temperature, advertising count, time since boot
+            if ((ad->len < 14) || (p[1] != 0))
+                return false;
+            ed->vbatt = (p[2] << 8) | p[3];
+            ed->temp = (int16_t)((p[4] << 8) | p[5]);
+            ed->adv_cnt = ((uint32_t)p[6] << 24) | ((uint32_t)p[7] << 16) | (p[8] << 8) | p[9];
+            ed->sec_cnt = ((uint32_t)p[10] << 24) | ((uint32_t)p[11] << 16) | (p[12] << 8) | p[13];
+            break;
+        default:
+            return false;
     }
 
     return true;
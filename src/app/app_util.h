@@ -43,6 +43,24 @@
 #define BLE_RSCP_SERVER_BIT         0x4000
 #define BLE_QPPS_SERVER_BIT         0x8000
 
+// Client enabled FLAG, in the client_flag of the device record
+#define BLE_PASP_CLIENT_BIT         0x0001
+#define BLE_AN_CLIENT_BIT           0x0002
+#define BLE_HT_COLLECTOR_BIT        0x0004
+#define BLE_BP_COLLECTOR_BIT        0x0008
+#define BLE_HR_COLLECTOR_BIT        0x0010
+#define BLE_GL_COLLECTOR_BIT        0x0020
+#define BLE_FINDME_LOCATOR_BIT      0x0040
+#define BLE_TIP_CLIENT_BIT          0x0080
+#define BLE_PROX_MONITOR_BIT        0x0100
+#define BLE_HID_BOOT_HOST_BIT       0x0200
+#define BLE_HID_REPORT_HOST_BIT     0x0400
+#define BLE_SP_CLIENT_BIT           0x0800
+#define BLE_DIS_CLIENT_BIT          0x1000
+#define BLE_BATT_CLIENT_BIT         0x2000
+#define BLE_CSC_COLLECTOR_BIT       0x4000
+#define BLE_RSC_COLLECTOR_BIT       0x8000
+
 // Advertising data FLAG
 #define AD_TYPE_NAME_BIT            0x0001
 #define AD_TYPE_16bitUUID_BIT       0x0002
@@ -56,6 +74,90 @@ struct app_adv_data
     uint16_t uuid[ADV_DATA_LEN/2 - 1]; 
 };
 
+// Beacon formats
+#define APP_AD_COMPANY_APPLE        0x004C
+#define APP_AD_IBEACON_TYPE         0x02
+#define APP_AD_IBEACON_LEN          0x15
+#define APP_AD_EDDYSTONE_UUID       0xFEAA
+#define APP_AD_EDDYSTONE_UID        0x00
+#define APP_AD_EDDYSTONE_URL        0x10
+#define APP_AD_EDDYSTONE_TLM        0x20
+#define APP_AD_EDDYSTONE_URL_MAX    18
+
+/// Kind of an AD structure view
+enum app_ad_kind
+{
+    /// Other AD type, or a typed structure too short for its type
+    APP_AD_OTHER = 0,
+    /// Flags, id is the flags value
+    APP_AD_FLAGS,
+    /// Shortened or complete local name, data is not null terminated
+    APP_AD_NAME,
+    /// List of 16-bit, 32-bit or 128-bit service UUIDs, nb is the number of UUIDs
+    APP_AD_UUID16,
+    APP_AD_UUID32,
+    APP_AD_UUID128,
+    /// Manufacturer specific data, id is the company ID, data follows it
+    APP_AD_MANU_DATA,
+    /// 16-bit UUID service data, id is the service UUID, data follows it
+    APP_AD_SERVICE_DATA
+};
+
+/// AD structure view, data points into the parsed buffer
+struct app_ad_struct
+{
+    /// AD type
+    uint8_t type;
+    /// Kind of the view (enum app_ad_kind)
+    uint8_t kind;
+    /// Payload length
+    uint8_t len;
+    /// Number of UUIDs of a UUID list
+    uint8_t nb;
+    /// Flags value, company ID or service UUID
+    uint16_t id;
+    /// Payload
+    uint8_t const *data;
+};
+
+/// AD structure iterator
+struct app_ad_iter
+{
+    /// Next AD structure
+    uint8_t const *p;
+    /// End of the advertising data
+    uint8_t const *end;
+};
+
+/// iBeacon frame, uuid points into the parsed buffer
+struct app_ibeacon
+{
+    /// Proximity UUID (16 bytes)
+    uint8_t const *uuid;
+    uint16_t major;
+    uint16_t minor;
+    /// Calibrated TX power at 1m
+    int8_t tx_power;
+};
+
+/// Eddystone frame, id points into the parsed buffer
+struct app_eddystone
+{
+    /// Frame type
+    uint8_t frame;
+    /// Calibrated TX power at 0m (UID and URL)
+    int8_t tx_power;
+    /// Length of the URL scheme and encoded URL
+    uint8_t url_len;
+    /// UID namespace (10 bytes) and instance (6 bytes), or URL scheme and encoded URL
+    uint8_t const *id;
+    /// TLM battery voltage (mV), temperature (8.8 fixed point degrees) and counters
+    uint16_t vbatt;
+    int16_t temp;
+    uint32_t adv_cnt;
+    uint32_t sec_cnt;
+};
+
 /*
  * FUNCTION DECLARATIONS
  ****************************************************************************************
@@ -189,6 +291,30 @@ bool app_get_bond_status(uint8_t idx, uint8_t key_flag);
  */
 bool app_add_bonded_dev(void *bonded_dev);
 
+/*
+ ****************************************************************************************
+ * @brief Rebuild the address hash table of the bonded database
+ *
+ ****************************************************************************************
+ */
+void app_rebuild_bonded_hash(void);
+
+/*
+ ****************************************************************************************
+ * @brief Load the bonded database from NVDS
+ *
+ ****************************************************************************************
+ */
+void app_load_bonded_dev(void);
+
+/*
+ ****************************************************************************************
+ * @brief Mark the bonded device as used, the use order is kept in NVDS
+ *
+ ****************************************************************************************
+ */
+void app_update_bonded_dev_lru(uint8_t idx);
+
 /**
  ****************************************************************************************
  * @brief Find the bonded device by device address
@@ -231,11 +357,11 @@ bool app_get_remote_service_status(uint8_t idx, uint16_t uuid);
 
 /**
  ****************************************************************************************
- * @brief Get the client index by connection handle and uuid.
+ * @brief Get the index of the connection with the client enabled by connection handle
  *
  ****************************************************************************************
  */
-uint8_t app_get_client_idx_by_conhdl(uint16_t conhdl, uint16_t uuid);
+uint8_t app_get_client_idx_by_conhdl(uint16_t conhdl, uint16_t clt_bit);
 
 /*
  ****************************************************************************************
@@ -247,11 +373,11 @@ bool app_get_remote_service_status(uint8_t idx, uint16_t uuid);
 
 /*
  ****************************************************************************************
- * @brief Get the client service UUID enable status from application device record
+ * @brief Get the client enable status (BLE_xxx_BIT) from application device record
  *
  ****************************************************************************************
  */
-uint8_t app_get_client_service_status(uint8_t idx, uint16_t uuid);
+bool app_get_client_service_status(uint8_t idx, uint16_t clt_bit);
 
 /*
  ****************************************************************************************
@@ -271,11 +397,11 @@ void app_set_qpp_client_service_status(uint16_t conhdl);
 
 /*
  ****************************************************************************************
- * @brief Set the client service enable status from application device record
+ * @brief Set the client enable status (BLE_xxx_BIT) in application device record
  *
  ****************************************************************************************
  */
-void app_set_client_service_status(uint16_t conhdl);
+void app_set_client_service_status(uint8_t idx, uint16_t clt_bit, bool enabled);
 
 /*
  ****************************************************************************************
@@ -317,6 +443,48 @@ uint8_t app_set_scan_rsp_data(uint16_t srv_flag);
  */
 bool app_parser_adv_data(uint8_t *pdata, uint8_t total_len, struct app_adv_data *padv);
 
+/*
+ ****************************************************************************************
+ * @brief Start iterating over the AD structures of Advertising or Scan response data
+ *
+ ****************************************************************************************
+ */
+void app_ad_iter_init(struct app_ad_iter *it, uint8_t const *data, uint8_t len);
+
+/*
+ ****************************************************************************************
+ * @brief Get the view of the next AD structure
+ *
+ * @return false at the end of the data, or if the next AD structure is truncated
+ *         (app_ad_iter_error() is then true)
+ ****************************************************************************************
+ */
+bool app_ad_next(struct app_ad_iter *it, struct app_ad_struct *ad);
+
+/*
+ ****************************************************************************************
+ * @brief Return true if the iteration stopped on a truncated AD structure
+ *
+ ****************************************************************************************
+ */
+bool app_ad_iter_error(struct app_ad_iter const *it);
+
+/*
+ ****************************************************************************************
+ * @brief Decode an iBeacon frame from a manufacturer data view
+ *
+ ****************************************************************************************
+ */
+bool app_ad_ibeacon(struct app_ad_struct const *ad, struct app_ibeacon *ib);
+
+/*
+ ****************************************************************************************
+ * @brief Decode an Eddystone UID, URL or TLM frame from a service data view
+ *
+ ****************************************************************************************
+ */
+bool app_ad_eddystone(struct app_ad_struct const *ad, struct app_eddystone *ed);
+
 /**
  ****************************************************************************************
  * @brief Check Updated Connection Parameters is acceptable or not
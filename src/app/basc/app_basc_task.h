@@ -38,8 +38,6 @@
 /// Battery Service Client environment variable
 struct app_basc_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
     ///Number of BAS instances found
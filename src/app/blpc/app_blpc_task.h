@@ -38,8 +38,6 @@
 /// Blood Pressure Profile Client environment variable
 struct app_blpc_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
     uint8_t cur_code;    
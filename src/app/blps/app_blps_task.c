@@ -93,6 +93,9 @@ int app_blps_disable_ind_handler(ke_msg_id_t const msgid,
 {
     app_blps_env->enabled = false;
     app_blps_env->ntf_sending = 0;
+#if QN_NTF_SCHED
+    app_ntf_flush(APP_NTF_BLPS);
+#endif
     app_task_msg_hdl(msgid, param);
 
     return (KE_MSG_CONSUMED);
@@ -168,6 +171,14 @@ int app_blps_meas_send_cfm_handler(ke_msg_id_t const msgid,
                                    ke_task_id_t const src_id)
 {
     app_blps_env->ntf_sending = false;
+#if QN_NTF_SCHED
+    app_ntf_send_cfm(APP_NTF_BLPS, param->status);
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+    // The value has only been taken by GATT
+    if (param->status == GATT_NOTIFY_GET_DATA)
+        return (KE_MSG_CONSUMED);
+#endif
+#endif
     app_task_msg_hdl(msgid, param);
     return (KE_MSG_CONSUMED);
 }
@@ -80,6 +80,31 @@ void app_cscpc_enable_req(struct cscpc_cscs_content *cscs, uint16_t conhdl)
     ke_msg_send(msg);
 }
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Cycling Speed and Cadence Collector role without disconnection. *//**
+ * @param[in] conhdl        Connection handle for which the profile Cycling Speed and Cadence Collector role is enabled.
+ * @response  CSCPC_DISABLE_IND
+ * @description
+ *
+ *  This API is used for disabling the role on a connection which is kept, for example to discover
+ *  again the peer service after a change of the peer database. The role is enabled again with
+ *  app_cscpc_enable_req().
+ *
+ ****************************************************************************************
+ */
+void app_cscpc_disable_req(uint16_t conhdl)
+{
+    struct cscpc_disable_req *msg = KE_MSG_ALLOC(CSCPC_DISABLE_REQ, KE_BUILD_ID(TASK_CSCPC, conhdl), TASK_APP,
+                                                 cscpc_disable_req);
+
+    ///Connection handle
+    msg->conhdl = conhdl;
+
+    // Send the message
+    ke_msg_send(msg);
+}
+
 /*
  ****************************************************************************************
  * @brief Read the value of an attribute in the peer device database. *//**
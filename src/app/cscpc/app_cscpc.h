@@ -75,6 +75,14 @@
  */
 void app_cscpc_enable_req(struct cscpc_cscs_content *cscs, uint16_t conhdl);
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Cycling Speed and Cadence Collector role without disconnection
+ *
+ ****************************************************************************************
+ */
+void app_cscpc_disable_req(uint16_t conhdl);
+
 /*
  ****************************************************************************************
  * @brief Rread the value of an attribute in the peer device database.
@@ -68,8 +68,11 @@ int app_cscpc_cscs_content_ind_handler(ke_msg_id_t const msgid,
     uint8_t idx = KE_IDX_GET(src_id);
 
     app_cscpc_env[idx].conhdl = param->conhdl;
-    app_cscpc_env[idx].enabled = true;
+    app_set_client_service_status(idx, BLE_CSC_COLLECTOR_BIT, true);
     //app_cscpc_env[app_env.select_idx].cscs = param->cscs;
+#if QN_DISC_CACHE
+    app_cache_store(param->conhdl, APP_CACHE_CSCPC, &param->cscs, sizeof(struct cscpc_cscs_content), 1);
+#endif
     return (KE_MSG_CONSUMED);
 }
 
@@ -181,6 +184,12 @@ int app_cscpc_cmp_evt_handler(ke_msg_id_t const msgid,
             if (param->status == PRF_ERR_OK)
             {
                 QPRINTF("Enable complete\r\n");
+#if QN_DISC_CACHE
+                // no content indication when enabled with the cached content
+                app_cscpc_env[KE_IDX_GET(src_id)].conhdl = param->conhdl;
+                app_set_client_service_status(KE_IDX_GET(src_id), BLE_CSC_COLLECTOR_BIT, true);
+                app_cache_ready(param->conhdl, APP_CACHE_CSCPC);
+#endif
             }
             else
             {
@@ -225,6 +234,10 @@ int app_cscpc_disable_ind_handler(ke_msg_id_t const msgid,
                                   ke_task_id_t const dest_id,
                                   ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    app_cache_disabled(param->conhdl, APP_CACHE_CSCPC);
+#endif
+
     return (KE_MSG_CONSUMED);
 }
 
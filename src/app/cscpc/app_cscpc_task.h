@@ -38,8 +38,6 @@
 /// Cycling Speed and Cadence Profile Collector environment variable
 struct app_cscpc_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
     uint8_t cur_code;
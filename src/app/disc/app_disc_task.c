@@ -72,7 +72,7 @@ int app_disc_enable_cfm_handler(ke_msg_id_t const msgid,
         uint8_t idx = KE_IDX_GET(src_id);
 
         app_disc_env[idx].conhdl = param->conhdl;
-        app_disc_env[idx].enabled = true;
+        app_set_client_service_status(idx, BLE_DIS_CLIENT_BIT, true);
     }
     app_task_msg_hdl(msgid, param);
 
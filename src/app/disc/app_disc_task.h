@@ -38,8 +38,6 @@
 /// Device Information Profile Client environment variable
 struct app_disc_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
 };
@@ -40,8 +40,6 @@
 /// Find Me Profile Locator environment variable
 struct app_findl_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
 };
@@ -204,7 +204,12 @@ void app_gap_scan_req(uint8_t scan_en)
                                                 gap_scan_req);
 
     msg->scan_en.scan_en = scan_en;
+#if (QN_BEACON_SCAN)
+    // Every report is used by the RSSI average and the age-out of the beacon scanner
+    msg->scan_en.filter_duplic_en = SCAN_FILT_DUPLIC_DIS;
+#else
     msg->scan_en.filter_duplic_en = SCAN_FILT_DUPLIC_EN;
+#endif
 
     // Send the message
     ke_msg_send(msg);
@@ -466,7 +471,7 @@ void app_gap_security_req(struct bd_addr *addr)
     uint8_t bonded_dev_idx = 0;
     uint8_t idx = 0;
 
-    if (app_get_conhdl_by_bdaddr(addr, &idx) == GAP_INVALID_CONIDX)
+    if (app_get_conhdl_by_bdaddr(addr, &idx) == 0xFFFF)
         return;
 
     if ((bonded_dev_idx = app_find_bonded_dev(addr)) == GAP_INVALID_CONIDX)
@@ -283,6 +283,15 @@ int app_gap_dev_inq_result_handler(ke_msg_id_t const msgid,
     bool found = false;
     const int8_t rssi = app_correct_rssi(param->adv_rep.rssi);
     
+#if (QN_BEACON_SCAN)
+    // The devices are listed by the periodic summary
+    if (app_scan_is_running())
+    {
+        app_scan_report(&param->adv_rep);
+        return (KE_MSG_CONSUMED);
+    }
+#endif
+
     for (uint8_t i = 0; i < app_env.inq_idx; i++)
     {
         if (true == co_bt_bdaddr_compare(&app_env.inq_addr[i], &param->adv_rep.adv_addr))
@@ -346,6 +355,18 @@ int app_gap_dev_scan_result_handler(ke_msg_id_t const msgid,
                                    ke_task_id_t const src_id)
 {
     struct app_adv_data adv_data;
+
+#if (QN_BEACON_SCAN)
+    // The devices are listed by the periodic summary
+    if (app_scan_is_running())
+    {
+        for (uint8_t i = 0; i < param->evt.nb_reports; i++)
+        {
+            app_scan_report(&param->evt.adv_rep[i]);
+        }
+        return (KE_MSG_CONSUMED);
+    }
+#endif
     
     QPRINTF("%d. %c %02X%02X%02X%02X%02X%02X", 
         app_env.inq_idx,
@@ -393,6 +414,9 @@ int app_gap_dev_inq_cmp_handler(ke_msg_id_t const msgid,
     QPRINTF("Total %d devices found.\r\n", app_env.inq_idx);
     ke_state_set(TASK_APP, APP_IDLE);
     app_task_msg_hdl(msgid, param);
+#if (QN_BEACON_SCAN)
+    app_scan_inq_cmp();
+#endif
 
     return(KE_MSG_CONSUMED);
 }
@@ -549,6 +573,9 @@ int app_gap_le_create_conn_req_cmp_evt_handler(ke_msg_id_t const msgid, struct g
     if (param->conn_info.status == CO_ERROR_NO_ERROR)
     {
         app_set_link_status_by_conhdl(param->conn_info.conhdl, &param->conn_info, true);
+#if QN_DISC_CACHE
+        app_cache_conn(param->conn_info.conhdl);
+#endif
 
         // Enable service here, for Server init phase 2
 #if (BLE_PERIPHERAL)
@@ -620,9 +647,6 @@ int app_gap_discon_cmp_evt_handler(ke_msg_id_t const msgid, struct gap_discon_cm
                     param->reason);
     
         app_set_link_status_by_conhdl(param->conhdl, NULL, false);
-        #if (BLE_CENTRAL)
-        app_set_client_service_status(param->conhdl);
-        #endif
         #if (BLE_PERIPHERAL)
         app_enable_server_service(false, param->conhdl);
         #endif
@@ -85,6 +85,14 @@ int app_gap_read_ver_req_cmp_evt_handler(ke_msg_id_t const msgid, struct gap_rea
 int app_gap_read_bdaddr_req_cmp_evt_handler(ke_msg_id_t const msgid, struct gap_read_bdaddr_req_cmp_evt const *param,
                                  ke_task_id_t const dest_id, ke_task_id_t const src_id);
 
+/*
+ ****************************************************************************************
+ * @brief calibrate rssi
+ *
+ ****************************************************************************************
+ */
+int8_t app_correct_rssi(int8_t rssi);
+
 /*
  ****************************************************************************************
  * @brief Handles inquiry result from the GAP.
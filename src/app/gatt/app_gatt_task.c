@@ -98,6 +98,10 @@ int app_gatt_disc_svc_all_cmp_evt_handler(ke_msg_id_t const msgid, struct gatt_d
 int app_gatt_disc_svc_by_uuid_cmp_evt_handler(ke_msg_id_t const msgid, struct gatt_disc_svc_by_uuid_cmp_evt const *param,
                                ke_task_id_t const dest_id, ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    if (app_cache_gatt_evt(msgid, param, src_id))
+        return (KE_MSG_CONSUMED);
+#endif
     if (param->nb_resp != 0)
     {
         for (uint8_t i = 0; i < param->nb_resp; i++)
@@ -233,6 +237,10 @@ int app_gatt_disc_char_all_cmp_evt_handler(ke_msg_id_t const msgid, struct gatt_
 int app_gatt_disc_char_by_uuid_cmp_evt_handler(ke_msg_id_t const msgid, struct gatt_disc_char_by_uuid_cmp_evt const *param,
                                ke_task_id_t const dest_id, ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    if (app_cache_gatt_evt(msgid, param, src_id))
+        return (KE_MSG_CONSUMED);
+#endif
     if (param->nb_entry != 0)
     {
         for (uint8_t i = 0; i < param->nb_entry; i++)
@@ -331,6 +339,10 @@ int app_gatt_disc_char_by_uuid_128_cmp_evt_handler(ke_msg_id_t const msgid, stru
 int app_gatt_disc_char_desc_cmp_evt_handler(ke_msg_id_t const msgid, struct gatt_disc_char_desc_cmp_evt const *param,
                                ke_task_id_t const dest_id, ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    if (app_cache_gatt_evt(msgid, param, src_id))
+        return (KE_MSG_CONSUMED);
+#endif
     if (param->nb_entry != 0)
     {
         for (uint8_t i = 0; i < param->nb_entry; i++)
@@ -458,6 +470,10 @@ int app_gatt_read_char_mult_resp_handler(ke_msg_id_t const msgid, struct gatt_re
 int app_gatt_write_char_resp_handler(ke_msg_id_t const msgid, struct gatt_write_char_resp const *param,
                                ke_task_id_t const dest_id, ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    if (app_cache_gatt_evt(msgid, param, src_id))
+        return (KE_MSG_CONSUMED);
+#endif
     if (param->status == ATT_ERR_NO_ERROR)
     {
         QPRINTF("Gatt write sucess\r\n");
@@ -598,6 +614,9 @@ int app_gatt_handle_value_ind_handler(ke_msg_id_t const msgid, struct gatt_handl
     for (uint8_t i = 0; i < param->size; i++)
         QPRINTF("%02x", param->value[i]);
     QPRINTF("\r\n");
+#if QN_DISC_CACHE
+    app_cache_svc_changed(param->conhdl, param->charhdl, param->value, param->size);
+#endif
 
     return (KE_MSG_CONSUMED);
 }
@@ -644,6 +663,10 @@ int app_gatt_handle_value_cfm_handler(ke_msg_id_t const msgid, struct gatt_handl
 int app_gatt_disc_cmp_evt_handler(ke_msg_id_t const msgid, struct gatt_disc_cmp_evt const *param,
                                ke_task_id_t const dest_id, ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    if (app_cache_gatt_evt(msgid, param, src_id))
+        return (KE_MSG_CONSUMED);
+#endif
     QPRINTF("Discovery Services finished.\r\n");
 
     return (KE_MSG_CONSUMED);
@@ -667,6 +690,10 @@ int app_gatt_disc_cmp_evt_handler(ke_msg_id_t const msgid, struct gatt_disc_cmp_
 int app_gatt_cmp_evt_handler(ke_msg_id_t const msgid, struct gatt_cmp_evt const *param,
                           ke_task_id_t const dest_id, ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    if (app_cache_gatt_evt(msgid, param, src_id))
+        return (KE_MSG_CONSUMED);
+#endif
     QPRINTF("Gatt command ");
     if (param->status == ATT_ERR_NO_ERROR)
         QPRINTF("success.\r\n");
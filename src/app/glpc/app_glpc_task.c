@@ -75,7 +75,7 @@ int app_glpc_enable_cfm_handler(ke_msg_id_t const msgid,
         uint8_t idx = KE_IDX_GET(src_id);
         
         app_glpc_env[idx].conhdl = param->conhdl;
-        app_glpc_env[idx].enabled = true;
+        app_set_client_service_status(idx, BLE_GL_COLLECTOR_BIT, true);
         app_glpc_env[idx].op_state = OPERATION_STATE_IDLE;
     }
     app_task_msg_hdl(msgid, param);
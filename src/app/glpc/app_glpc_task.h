@@ -46,8 +46,6 @@ enum
 /// Blood Pressure Profile Client environment variable
 struct app_glpc_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
     /// Glucose sensor features
@@ -47,6 +47,9 @@
 #include "glps.h"
 #include "glps_task.h"
 #include "app_glps_task.h"
+#if QN_GLPS_REC
+#include "app_glps_rec.h"
+#endif
 
 /*
  * FUNCTION DECLARATIONS
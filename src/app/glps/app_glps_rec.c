@@ -0,0 +1,1234 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_glps_rec.c
+ *
+ * @brief Application Glucose Record Store API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_GLPS_REC
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include "app_env.h"
+#if BLE_GL_SENSOR && QN_GLPS_REC
+#include "serialflash.h"
+#include "lib.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Sector header magic word
+#define APP_GLPS_REC_MAGIC              0x53504C47
+/// Record types above the sequence numbers
+#define APP_GLPS_REC_HDR                0xFFFD
+#define APP_GLPS_REC_DEL                0xFFFE
+#define APP_GLPS_REC_FREE               0xFFFF
+/// Invalid page index
+#define APP_GLPS_REC_NO_PAGE            0xFFFF
+/// Deletion ranges found in one pass
+#define APP_GLPS_REC_DEL_RUNS           4
+/// Repetitions of each timed operation of the benchmark
+#define APP_GLPS_REC_BENCH_LOOP         50
+/// Kernel time mask
+#define APP_GLPS_REC_TIME_MASK          0x7FFFFF
+/// Records of a report sent to GLPS and not completed
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+#define APP_GLPS_REC_WINDOW             GLPS_MEAS_QUEUE_NB
+#else
+#define APP_GLPS_REC_WINDOW             1
+#endif
+
+/// Flash address of a page
+#define APP_GLPS_REC_PAGE_ADDR(page)    (QN_GLPS_REC_BASE_ADDR + (uint32_t)(page) * APP_GLPS_REC_PAGE_SIZE)
+/// Sector index of a page
+#define APP_GLPS_REC_SECTOR_OF(page)    ((page) / APP_GLPS_REC_SECTOR_PAGES)
+
+// The firmware 2 and the data of the OTA take the flash from the firmware 2 address
+#if (BLE_OTA_SERVER) && (QN_GLPS_REC_BASE_ADDR + QN_GLPS_REC_SECTOR_NUM * APP_GLPS_REC_SECTOR_SIZE > OTAS_FW2_ADDRESS)
+    #error "The glucose record store overlaps the OTA firmware 2 area"
+#endif
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Sector header record, first record of a sector
+struct app_glps_rec_hdr
+{
+    uint16_t type;
+    uint16_t rsv;
+    uint32_t magic;
+    uint32_t seq;
+};
+
+/// Deletion record
+struct app_glps_rec_del
+{
+    uint16_t type;
+    uint16_t seq_min;
+    uint16_t seq_max;
+};
+
+/// Page table entry
+struct app_glps_rec_page
+{
+    /// Range of the user facing time of the measurements
+    uint32_t time_min;
+    uint32_t time_max;
+    /// Sequence number of the first measurement
+    uint16_t seq;
+    /// Slots holding a measurement
+    uint8_t meas;
+    /// Deleted measurements
+    uint8_t del;
+};
+
+/// Record filter, a range of sequence numbers or of user facing times
+struct app_glps_rec_query
+{
+    bool by_time;
+    uint32_t min;
+    uint32_t max;
+};
+
+/// Sequence number range to delete
+struct app_glps_rec_run
+{
+    uint16_t lo;
+    uint16_t hi;
+};
+
+/// Glucose record store environment
+struct app_glps_rec_env_tag
+{
+    /// Page buffer of the log head
+    uint32_t buf[APP_GLPS_REC_PAGE_SIZE / 4];
+    /// Read cache of one flash page
+    uint32_t cache[APP_GLPS_REC_PAGE_SIZE / 4];
+    /// Page table
+    struct app_glps_rec_page page[APP_GLPS_REC_PAGE_NUM];
+    /// Sequence number of each sector, 0 means the sector is free
+    uint32_t sector_seq[QN_GLPS_REC_SECTOR_NUM];
+    /// Last sector sequence number used
+    uint32_t seq;
+    /// Page in the read cache
+    uint16_t cache_page;
+    /// Page in the page buffer
+    uint16_t head_page;
+    /// Next sequence number
+    uint16_t next_seq;
+    /// Number of stored measurements
+    uint16_t rec_nb;
+    /// Oldest sector
+    uint8_t tail;
+    /// Next record slot in the page buffer
+    uint8_t head_slot;
+    /// The page buffer holds records not programmed yet
+    bool dirty;
+
+    /// Report on going
+    bool report;
+    /// The next record to send is read
+    bool next_valid;
+    /// Connection of the report
+    uint16_t conhdl;
+    /// Report filter
+    struct app_glps_rec_query query;
+    /// Page of the report cursor and its matching records not sent yet
+    uint16_t cur_page;
+    uint8_t cur_mask;
+    /// Records sent to GLPS and not completed, also after an abort
+    uint8_t pend_nb;
+    /// Records sent and start time of the report
+    uint16_t sent_nb;
+    uint32_t start_time;
+    /// Next record to send
+    struct app_glps_rec next;
+};
+
+/*
+ * LOCAL VARIABLE DEFINITIONS
+ ****************************************************************************************
+ */
+
+static struct app_glps_rec_env_tag app_glps_rec_env;
+
+/// Days before each month in a common year
+static const uint16_t app_glps_rec_mdays[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+/*
+ * LOCAL FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Count the bits of a slot mask
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_glps_rec_bits(uint8_t mask)
+{
+    uint8_t n = 0;
+
+    for (; mask; mask &= mask - 1)
+        n++;
+    return n;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the user facing time in seconds from 2000, 0 if the base time is unknown
+ *
+ ****************************************************************************************
+ */
+static uint32_t app_glps_rec_time(struct prf_date_time const *base, int16_t offset)
+{
+    uint32_t y, days;
+    int32_t t;
+
+    if (base->year < 2000 || base->month < 1 || base->month > 12)
+        return 0;
+
+    y = base->year - 2000;
+    days = y * 365 + (y + 3) / 4 + app_glps_rec_mdays[base->month - 1] + base->day - 1;
+    if (base->month > 2 && (y % 4) == 0)
+        days++;
+
+    t = (int32_t)(days * 86400 + base->hour * 3600 + base->min * 60 + base->sec) + offset * 60;
+    return (t > 0) ? (uint32_t)t : 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the user facing time of a stored measurement
+ *
+ ****************************************************************************************
+ */
+static uint32_t app_glps_rec_rec_time(struct app_glps_rec const *rec)
+{
+    struct prf_date_time base;
+
+    base.year = rec->year;
+    base.month = rec->month;
+    base.day = rec->day;
+    base.hour = rec->hour;
+    base.min = rec->min;
+    base.sec = rec->sec;
+    return app_glps_rec_time(&base, rec->time_offset);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the records of a page, from the page buffer or through the read cache
+ *
+ ****************************************************************************************
+ */
+static struct app_glps_rec const *app_glps_rec_page_get(uint16_t page)
+{
+    if (page == app_glps_rec_env.head_page)
+        return (struct app_glps_rec const *)app_glps_rec_env.buf;
+
+    if (page != app_glps_rec_env.cache_page)
+    {
+        read_flash(APP_GLPS_REC_PAGE_ADDR(page), app_glps_rec_env.cache, APP_GLPS_REC_PAGE_SIZE);
+        app_glps_rec_env.cache_page = page;
+    }
+
+    return (struct app_glps_rec const *)app_glps_rec_env.cache;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the first page of the log
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_glps_rec_first_page(void)
+{
+    return app_glps_rec_env.tail * APP_GLPS_REC_SECTOR_PAGES;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the page after a page in log order, APP_GLPS_REC_NO_PAGE after the head
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_glps_rec_next_page(uint16_t page)
+{
+    if (page == app_glps_rec_env.head_page)
+        return APP_GLPS_REC_NO_PAGE;
+
+    return (page + 1) % APP_GLPS_REC_PAGE_NUM;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the page before a page in log order, APP_GLPS_REC_NO_PAGE before the tail
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_glps_rec_prev_page(uint16_t page)
+{
+    if (page == app_glps_rec_first_page())
+        return APP_GLPS_REC_NO_PAGE;
+
+    return (page + APP_GLPS_REC_PAGE_NUM - 1) % APP_GLPS_REC_PAGE_NUM;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Add a measurement of a slot to the page table
+ *
+ ****************************************************************************************
+ */
+static void app_glps_rec_page_add(uint16_t page, uint8_t slot, struct app_glps_rec const *rec)
+{
+    struct app_glps_rec_page *p = &app_glps_rec_env.page[page];
+    uint32_t t = app_glps_rec_rec_time(rec);
+
+    if (p->meas == 0)
+    {
+        p->seq = rec->seq_num;
+        p->time_min = t;
+        p->time_max = t;
+    }
+    else if (t < p->time_min)
+        p->time_min = t;
+    else if (t > p->time_max)
+        p->time_max = t;
+
+    p->meas |= 1 << slot;
+    app_glps_rec_env.rec_nb++;
+    app_glps_rec_env.next_seq = rec->seq_num + 1;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Mark the measurements of a sequence number range deleted
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_glps_rec_del_apply(uint16_t lo, uint16_t hi)
+{
+    struct app_glps_rec_page *p;
+    uint16_t page, seq, nb = 0;
+    uint8_t i;
+
+    for (page = app_glps_rec_first_page(); page != APP_GLPS_REC_NO_PAGE; page = app_glps_rec_next_page(page))
+    {
+        p = &app_glps_rec_env.page[page];
+        if (p->meas == 0 || p->seq > hi
+            || p->seq + app_glps_rec_bits(p->meas) - 1 < lo)
+            continue;
+
+        for (i = 0, seq = p->seq; i < APP_GLPS_REC_PAGE_RECS; i++)
+        {
+            if (!(p->meas & (1 << i)))
+                continue;
+            if (seq >= lo && seq <= hi && !(p->del & (1 << i)))
+            {
+                p->del |= 1 << i;
+                nb++;
+            }
+            seq++;
+        }
+    }
+
+    app_glps_rec_env.rec_nb -= nb;
+    return nb;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Drop a sector from the page table
+ *
+ ****************************************************************************************
+ */
+static void app_glps_rec_sector_drop(uint8_t sector)
+{
+    struct app_glps_rec_page *p = &app_glps_rec_env.page[sector * APP_GLPS_REC_SECTOR_PAGES];
+    uint8_t i;
+
+    for (i = 0; i < APP_GLPS_REC_SECTOR_PAGES; i++, p++)
+    {
+        app_glps_rec_env.rec_nb -= app_glps_rec_bits(p->meas & ~p->del);
+        p->meas = 0;
+        p->del = 0;
+    }
+
+    app_glps_rec_env.sector_seq[sector] = 0;
+    if (sector == app_glps_rec_env.tail)
+        app_glps_rec_env.tail = (sector + 1) % QN_GLPS_REC_SECTOR_NUM;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Erase a sector and start the log head at its first page
+ *
+ ****************************************************************************************
+ */
+static void app_glps_rec_sector_open(uint8_t sector)
+{
+    struct app_glps_rec_hdr *hdr = (struct app_glps_rec_hdr *)app_glps_rec_env.buf;
+
+    sector_erase_flash(QN_GLPS_REC_BASE_ADDR + sector * APP_GLPS_REC_SECTOR_SIZE, 1);
+    if (app_glps_rec_env.cache_page != APP_GLPS_REC_NO_PAGE
+        && APP_GLPS_REC_SECTOR_OF(app_glps_rec_env.cache_page) == sector)
+        app_glps_rec_env.cache_page = APP_GLPS_REC_NO_PAGE;
+
+    app_glps_rec_env.sector_seq[sector] = ++app_glps_rec_env.seq;
+    app_glps_rec_env.head_page = sector * APP_GLPS_REC_SECTOR_PAGES;
+    memset(app_glps_rec_env.buf, 0xFF, APP_GLPS_REC_PAGE_SIZE);
+    hdr->type = APP_GLPS_REC_HDR;
+    hdr->rsv = 0;
+    hdr->magic = APP_GLPS_REC_MAGIC;
+    hdr->seq = app_glps_rec_env.seq;
+    app_glps_rec_env.head_slot = 1;
+    app_glps_rec_env.dirty = true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Program the page buffer and move the log head to the next page
+ *
+ * Entering a used sector drops its measurements, it is the oldest sector.
+ ****************************************************************************************
+ */
+static void app_glps_rec_head_next(void)
+{
+    uint8_t next;
+
+    if (app_glps_rec_env.dirty)
+    {
+        write_flash(APP_GLPS_REC_PAGE_ADDR(app_glps_rec_env.head_page), app_glps_rec_env.buf, APP_GLPS_REC_PAGE_SIZE);
+        app_glps_rec_env.dirty = false;
+    }
+
+    if (((app_glps_rec_env.head_page + 1) % APP_GLPS_REC_SECTOR_PAGES) != 0)
+    {
+        app_glps_rec_env.head_page++;
+        app_glps_rec_env.head_slot = 0;
+        memset(app_glps_rec_env.buf, 0xFF, APP_GLPS_REC_PAGE_SIZE);
+        return;
+    }
+
+    next = (APP_GLPS_REC_SECTOR_OF(app_glps_rec_env.head_page) + 1) % QN_GLPS_REC_SECTOR_NUM;
+    if (app_glps_rec_env.sector_seq[next] != 0)
+        app_glps_rec_sector_drop(next);
+    app_glps_rec_sector_open(next);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Append a record to the page buffer, return its page slot
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_glps_rec_append(void const *rec)
+{
+    uint8_t slot;
+
+    if (app_glps_rec_env.head_slot == APP_GLPS_REC_PAGE_RECS)
+        app_glps_rec_head_next();
+
+    slot = app_glps_rec_env.head_slot++;
+    memcpy((uint8_t *)app_glps_rec_env.buf + slot * APP_GLPS_REC_SIZE, rec, APP_GLPS_REC_SIZE);
+    app_glps_rec_env.dirty = true;
+
+    return slot;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Erase the oldest sectors without live measurement
+ *
+ ****************************************************************************************
+ */
+static void app_glps_rec_reclaim(void)
+{
+    struct app_glps_rec_page const *p;
+    uint8_t i;
+
+    while (app_glps_rec_env.tail != APP_GLPS_REC_SECTOR_OF(app_glps_rec_env.head_page))
+    {
+        p = &app_glps_rec_env.page[app_glps_rec_env.tail * APP_GLPS_REC_SECTOR_PAGES];
+        for (i = 0; i < APP_GLPS_REC_SECTOR_PAGES; i++, p++)
+        {
+            if (p->meas & ~p->del)
+                return;
+        }
+        // The sector is erased when the log head enters it again
+        app_glps_rec_sector_drop(app_glps_rec_env.tail);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the live measurements of a page matching a filter
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_glps_rec_page_match(uint16_t page, struct app_glps_rec_query const *q)
+{
+    struct app_glps_rec_page const *p = &app_glps_rec_env.page[page];
+    struct app_glps_rec const *rec;
+    uint8_t live = p->meas & ~p->del;
+    uint8_t mask = 0;
+    uint32_t v;
+    uint8_t i;
+
+    if (live == 0)
+        return 0;
+
+    if (q->by_time)
+    {
+        if (p->time_max < q->min || p->time_min > q->max)
+            return 0;
+        if (p->time_min >= q->min && p->time_max <= q->max)
+            return live;
+
+        // The page range is partially inside, check each record
+        rec = app_glps_rec_page_get(page);
+        for (i = 0; i < APP_GLPS_REC_PAGE_RECS; i++)
+        {
+            if (!(live & (1 << i)))
+                continue;
+            v = app_glps_rec_rec_time(&rec[i]);
+            if (v >= q->min && v <= q->max)
+                mask |= 1 << i;
+        }
+    }
+    else
+    {
+        for (i = 0, v = p->seq; i < APP_GLPS_REC_PAGE_RECS; i++)
+        {
+            if (!(p->meas & (1 << i)))
+                continue;
+            if ((live & (1 << i)) && v >= q->min && v <= q->max)
+                mask |= 1 << i;
+            v++;
+        }
+    }
+
+    return mask;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Find the sequence number of the oldest or of the most recent measurement
+ *
+ ****************************************************************************************
+ */
+static bool app_glps_rec_edge(bool last, uint16_t *seq)
+{
+    struct app_glps_rec_page const *p;
+    uint16_t page = last ? app_glps_rec_env.head_page : app_glps_rec_first_page();
+    uint8_t live, i, n;
+
+    for (; page != APP_GLPS_REC_NO_PAGE;
+         page = last ? app_glps_rec_prev_page(page) : app_glps_rec_next_page(page))
+    {
+        p = &app_glps_rec_env.page[page];
+        live = p->meas & ~p->del;
+        if (live == 0)
+            continue;
+
+        for (i = 0, n = 0; i < APP_GLPS_REC_PAGE_RECS; i++)
+        {
+            if (!(p->meas & (1 << i)))
+                continue;
+            if (live & (1 << i))
+            {
+                *seq = p->seq + n;
+                if (!last)
+                    return true;
+            }
+            n++;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Build the record filter of a RACP request, return a RACP response code
+ *
+ ****************************************************************************************
+ */
+static uint8_t app_glps_rec_query_set(struct glp_filter const *f, struct app_glps_rec_query *q)
+{
+    uint16_t seq;
+    uint32_t min, max;
+
+    q->by_time = false;
+    q->min = 0;
+    q->max = 0xFFFFFFFF;
+
+    switch (f->operator)
+    {
+    case GLP_OP_ALL_RECS:
+        break;
+
+    case GLP_OP_FIRST_REC:
+    case GLP_OP_LAST_REC:
+        if (app_glps_rec_edge(f->operator == GLP_OP_LAST_REC, &seq))
+        {
+            q->min = seq;
+            q->max = seq;
+        }
+        else
+        {
+            // empty filter
+            q->min = 1;
+            q->max = 0;
+        }
+        break;
+
+    case GLP_OP_LT_OR_EQ:
+    case GLP_OP_GT_OR_EQ:
+    case GLP_OP_WITHIN_RANGE_OF:
+        if (f->filter_type == GLP_FILTER_SEQ_NUMBER)
+        {
+            min = f->val.seq_num.min;
+            max = f->val.seq_num.max;
+        }
+        else
+        {
+            q->by_time = true;
+            min = app_glps_rec_time(&f->val.time.base_min, (int16_t)f->val.time.offset_min);
+            max = app_glps_rec_time(&f->val.time.base_max, (int16_t)f->val.time.offset_max);
+        }
+
+        if (f->operator != GLP_OP_LT_OR_EQ)
+            q->min = min;
+        if (f->operator != GLP_OP_GT_OR_EQ)
+            q->max = max;
+        if (q->min > q->max)
+            return GLP_RSP_INVALID_OPERAND;
+        break;
+
+    default:
+        return GLP_RSP_OPERATOR_NOT_SUP;
+    }
+
+    return GLP_RSP_SUCCESS;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Count the measurements matching a filter
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_glps_rec_count(struct app_glps_rec_query const *q)
+{
+    uint16_t page, nb = 0;
+
+    for (page = app_glps_rec_first_page(); page != APP_GLPS_REC_NO_PAGE; page = app_glps_rec_next_page(page))
+        nb += app_glps_rec_bits(app_glps_rec_page_match(page, q));
+
+    return nb;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Find the sequence number ranges to delete from a sequence number
+ *
+ * A range covers matching and already deleted measurements, a live measurement not
+ * matching the filter ends it.
+ ****************************************************************************************
+ */
+static uint8_t app_glps_rec_runs_find(struct app_glps_rec_query const *q, uint32_t from,
+                                      struct app_glps_rec_run *run)
+{
+    struct app_glps_rec_page const *p;
+    uint16_t page, seq;
+    uint8_t mask, i, n = 0;
+    bool open = false;
+
+    for (page = app_glps_rec_first_page(); page != APP_GLPS_REC_NO_PAGE; page = app_glps_rec_next_page(page))
+    {
+        p = &app_glps_rec_env.page[page];
+        if (p->meas == 0 || p->seq + app_glps_rec_bits(p->meas) <= from)
+            continue;
+
+        mask = app_glps_rec_page_match(page, q);
+        for (i = 0, seq = p->seq; i < APP_GLPS_REC_PAGE_RECS; i++)
+        {
+            if (!(p->meas & (1 << i)))
+                continue;
+            if (seq >= from)
+            {
+                if (mask & (1 << i))
+                {
+                    if (!open)
+                    {
+                        run[n].lo = seq;
+                        open = true;
+                    }
+                    run[n].hi = seq;
+                }
+                else if (open && !(p->del & (1 << i)))
+                {
+                    open = false;
+                    if (++n == APP_GLPS_REC_DEL_RUNS)
+                        return n;
+                }
+            }
+            seq++;
+        }
+    }
+
+    return open ? n + 1 : n;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Delete the measurements matching a filter
+ *
+ ****************************************************************************************
+ */
+static uint16_t app_glps_rec_delete(struct app_glps_rec_query const *q)
+{
+    struct app_glps_rec_run run[APP_GLPS_REC_DEL_RUNS];
+    struct app_glps_rec rec;
+    struct app_glps_rec_del *del = (struct app_glps_rec_del *)&rec;
+    uint32_t from = 0;
+    uint16_t nb = 0;
+    uint8_t n, i;
+
+    memset(&rec, 0xFF, sizeof(rec));
+    del->type = APP_GLPS_REC_DEL;
+
+    do
+    {
+        n = app_glps_rec_runs_find(q, from, run);
+        for (i = 0; i < n; i++)
+        {
+            del->seq_min = run[i].lo;
+            del->seq_max = run[i].hi;
+            app_glps_rec_append(&rec);
+            nb += app_glps_rec_del_apply(run[i].lo, run[i].hi);
+        }
+        if (n)
+            from = run[n - 1].hi + 1;
+    } while (n == APP_GLPS_REC_DEL_RUNS);
+
+    if (nb)
+    {
+        app_glps_rec_flush();
+        app_glps_rec_reclaim();
+    }
+    return nb;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Read the next record of the report
+ *
+ ****************************************************************************************
+ */
+static bool app_glps_rec_fetch(struct app_glps_rec *rec)
+{
+    uint8_t slot;
+
+    while (app_glps_rec_env.cur_mask == 0)
+    {
+        app_glps_rec_env.cur_page = app_glps_rec_next_page(app_glps_rec_env.cur_page);
+        if (app_glps_rec_env.cur_page == APP_GLPS_REC_NO_PAGE)
+            return false;
+        app_glps_rec_env.cur_mask = app_glps_rec_page_match(app_glps_rec_env.cur_page, &app_glps_rec_env.query);
+    }
+
+    for (slot = 0; !(app_glps_rec_env.cur_mask & (1 << slot)); slot++)
+        ;
+    app_glps_rec_env.cur_mask &= ~(1 << slot);
+    *rec = app_glps_rec_page_get(app_glps_rec_env.cur_page)[slot];
+
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Send a record of the report to GLPS
+ *
+ ****************************************************************************************
+ */
+static void app_glps_rec_send_rec(struct app_glps_rec const *rec)
+{
+    struct glp_meas meas;
+    struct glp_meas_ctx ctx;
+
+    meas.base_time.year = rec->year;
+    meas.base_time.month = rec->month;
+    meas.base_time.day = rec->day;
+    meas.base_time.hour = rec->hour;
+    meas.base_time.min = rec->min;
+    meas.base_time.sec = rec->sec;
+    meas.time_offset = rec->time_offset;
+    meas.concentration = rec->concentration;
+    meas.status = rec->status;
+    meas.type = rec->type;
+    meas.location = rec->location;
+    meas.flags = rec->flags;
+
+    if ((rec->flags & GLP_MEAS_CTX_INF_FOLW) && (app_glps_env->evt_cfg & GLPS_MEAS_CTX_NTF_CFG))
+    {
+        ctx.flags = rec->ctx_flags;
+        ctx.ext_flags = 0;
+        ctx.carbo_id = rec->carbo_id;
+        ctx.carbo_val = rec->carbo_val;
+        ctx.meal = rec->meal;
+        ctx.tester = rec->tester_health & 0x0F;
+        ctx.health = rec->tester_health >> 4;
+        ctx.exercise_dur = rec->exercise_dur;
+        ctx.exercise_intens = rec->exercise_intens;
+        ctx.med_id = rec->med_id;
+        ctx.med_val = rec->med_val;
+        ctx.hba1c_val = rec->hba1c_val;
+        app_glps_meas_with_ctx_req_send(app_glps_rec_env.conhdl, rec->seq_num, &meas, &ctx);
+    }
+    else
+    {
+        meas.flags &= ~GLP_MEAS_CTX_INF_FOLW;
+        app_glps_meas_without_ctx_req_send(app_glps_rec_env.conhdl, rec->seq_num, &meas);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Send the next records of the report to GLPS and read the following one
+ *
+ * With QN_MULTI_NOTIFICATION_IN_ONE_EVENT, GLPS queues the packed values of several records
+ * and notifies them back to back, the window is kept full.
+ ****************************************************************************************
+ */
+static void app_glps_rec_send(void)
+{
+    while (app_glps_rec_env.next_valid && (app_glps_rec_env.pend_nb < APP_GLPS_REC_WINDOW))
+    {
+        app_glps_rec_send_rec(&app_glps_rec_env.next);
+        app_glps_rec_env.pend_nb++;
+        app_glps_rec_env.sent_nb++;
+
+        // Read the next record while this one is notified
+        app_glps_rec_env.next_valid = app_glps_rec_fetch(&app_glps_rec_env.next);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief End the report with a RACP response
+ *
+ ****************************************************************************************
+ */
+static void app_glps_rec_report_end(uint8_t status)
+{
+    uint32_t t = (ke_time() - app_glps_rec_env.start_time) & APP_GLPS_REC_TIME_MASK;
+
+    app_glps_rec_env.report = false;
+    app_glps_racp_rsp_req_send(app_glps_rec_env.conhdl, 0, GLP_REQ_REP_STRD_RECS, status);
+    QPRINTF("GLPS report %d records in %d ms (%d records/s), status %d\r\n",
+            app_glps_rec_env.sent_nb, t * 10, t ? app_glps_rec_env.sent_nb * 100 / t : 0, status);
+}
+
+/*
+ * EXPORTED FUNCTION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/**
+ ****************************************************************************************
+ * @brief Mount the glucose record store and rebuild the page table from flash
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_init(void)
+{
+    struct app_glps_rec_hdr const *hdr;
+    struct app_glps_rec const *rec;
+    struct app_glps_rec_del const *del;
+    uint32_t seq_min = 0xFFFFFFFF;
+    uint16_t page, end, del_max = 0;
+    uint8_t s, head = 0, i;
+
+    memset(&app_glps_rec_env, 0, sizeof(app_glps_rec_env));
+    app_glps_rec_env.cache_page = APP_GLPS_REC_NO_PAGE;
+    app_glps_rec_env.head_page = APP_GLPS_REC_NO_PAGE;
+
+    // Order the sectors by the sequence number of their header
+    for (s = 0; s < QN_GLPS_REC_SECTOR_NUM; s++)
+    {
+        // the first page of the sector is read in the cache, the replay starts on one of them
+        hdr = (struct app_glps_rec_hdr const *)app_glps_rec_page_get(s * APP_GLPS_REC_SECTOR_PAGES);
+        if (hdr->type != APP_GLPS_REC_HDR || hdr->magic != APP_GLPS_REC_MAGIC)
+            continue;
+
+        app_glps_rec_env.sector_seq[s] = hdr->seq;
+        if (hdr->seq < seq_min)
+        {
+            seq_min = hdr->seq;
+            app_glps_rec_env.tail = s;
+        }
+        if (hdr->seq > app_glps_rec_env.seq)
+        {
+            app_glps_rec_env.seq = hdr->seq;
+            head = s;
+        }
+    }
+
+    if (app_glps_rec_env.seq == 0)
+    {
+        app_glps_rec_sector_open(0);
+        app_glps_rec_env.next_seq = 0;
+        return;
+    }
+
+    // Replay the log up to the first page never programmed
+    page = app_glps_rec_first_page();
+    end = (head + 1) * APP_GLPS_REC_SECTOR_PAGES;
+    for (; ; page = (page + 1) % APP_GLPS_REC_PAGE_NUM)
+    {
+        rec = app_glps_rec_page_get(page);
+        if (page >= head * APP_GLPS_REC_SECTOR_PAGES && page < end && rec[0].seq_num == APP_GLPS_REC_FREE)
+        {
+            app_glps_rec_env.head_page = page;
+            app_glps_rec_env.head_slot = 0;
+            memset(app_glps_rec_env.buf, 0xFF, APP_GLPS_REC_PAGE_SIZE);
+            break;
+        }
+
+        for (i = 0; i < APP_GLPS_REC_PAGE_RECS; i++)
+        {
+            if (rec[i].seq_num <= APP_GLPS_REC_SEQ_MAX)
+            {
+                app_glps_rec_page_add(page, i, &rec[i]);
+            }
+            else if (rec[i].seq_num == APP_GLPS_REC_DEL)
+            {
+                del = (struct app_glps_rec_del const *)&rec[i];
+                // Deleted measurements are in this page or before, end the page walk here
+                app_glps_rec_env.head_page = page;
+                app_glps_rec_del_apply(del->seq_min, del->seq_max);
+                if (del->seq_max >= del_max)
+                    del_max = del->seq_max + 1;
+            }
+        }
+
+        if (page == end - 1)
+        {
+            // The head sector is full, the next record opens the next sector
+            app_glps_rec_env.head_page = page;
+            app_glps_rec_env.head_slot = APP_GLPS_REC_PAGE_RECS;
+            memcpy(app_glps_rec_env.buf, rec, APP_GLPS_REC_PAGE_SIZE);
+            break;
+        }
+    }
+    app_glps_rec_env.cache_page = APP_GLPS_REC_NO_PAGE;
+
+    // Sequence numbers of deleted measurements are not used again
+    if (del_max > app_glps_rec_env.next_seq)
+        app_glps_rec_env.next_seq = del_max;
+
+    app_glps_rec_reclaim();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Store a measurement with the next sequence number, ctx may be NULL
+ *
+ ****************************************************************************************
+ */
+uint8_t app_glps_rec_add(struct glp_meas const *meas, struct glp_meas_ctx const *ctx)
+{
+    struct app_glps_rec rec;
+    uint8_t slot;
+
+    if (app_glps_rec_env.report)
+        return APP_GLPS_REC_BUSY;
+    if (app_glps_rec_env.next_seq > APP_GLPS_REC_SEQ_MAX)
+        return APP_GLPS_REC_FULL;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.seq_num = app_glps_rec_env.next_seq;
+    rec.year = meas->base_time.year;
+    rec.month = meas->base_time.month;
+    rec.day = meas->base_time.day;
+    rec.hour = meas->base_time.hour;
+    rec.min = meas->base_time.min;
+    rec.sec = meas->base_time.sec;
+    rec.flags = meas->flags & ~GLP_MEAS_CTX_INF_FOLW;
+    rec.time_offset = meas->time_offset;
+    rec.concentration = meas->concentration;
+    rec.status = meas->status;
+    rec.type = meas->type;
+    rec.location = meas->location;
+
+    if (ctx != NULL)
+    {
+        rec.flags |= GLP_MEAS_CTX_INF_FOLW;
+        rec.ctx_flags = ctx->flags;
+        rec.carbo_id = ctx->carbo_id;
+        rec.carbo_val = ctx->carbo_val;
+        rec.exercise_dur = ctx->exercise_dur;
+        rec.med_val = ctx->med_val;
+        rec.hba1c_val = ctx->hba1c_val;
+        rec.meal = ctx->meal;
+        rec.tester_health = (ctx->tester & 0x0F) | (ctx->health << 4);
+        rec.exercise_intens = ctx->exercise_intens;
+        rec.med_id = ctx->med_id;
+    }
+
+    slot = app_glps_rec_append(&rec);
+    app_glps_rec_page_add(app_glps_rec_env.head_page, slot, &rec);
+
+    return APP_GLPS_REC_OK;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Program the page buffer to flash
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_flush(void)
+{
+    // A programmed page can not be appended, the rest of it is left unused
+    if (app_glps_rec_env.dirty)
+        app_glps_rec_head_next();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the number of stored measurements
+ *
+ ****************************************************************************************
+ */
+uint16_t app_glps_rec_get_nb(void)
+{
+    return app_glps_rec_env.rec_nb;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Execute a RACP request received from GLPS
+ *
+ * GLPS refuses a new request until the response of the current one is sent, except the
+ * abort operation.
+ ****************************************************************************************
+ */
+void app_glps_rec_racp(uint16_t conhdl, struct glp_racp_req const *req)
+{
+    struct app_glps_rec_query *q = &app_glps_rec_env.query;
+    uint8_t status;
+    uint16_t nb;
+
+    if (req->op_code == GLP_REQ_ABORT_OP)
+    {
+        // The records sent to GLPS complete, then nothing else is sent
+        app_glps_rec_env.report = false;
+        app_glps_racp_rsp_req_send(conhdl, 0, GLP_REQ_ABORT_OP, GLP_RSP_SUCCESS);
+        return;
+    }
+
+    status = app_glps_rec_query_set(&req->filter, q);
+    if (status != GLP_RSP_SUCCESS)
+    {
+        app_glps_racp_rsp_req_send(conhdl, 0, req->op_code, status);
+        return;
+    }
+
+    switch (req->op_code)
+    {
+    case GLP_REQ_REP_NUM_OF_STRD_RECS:
+        nb = app_glps_rec_count(q);
+        app_glps_racp_rsp_req_send(conhdl, nb, req->op_code, GLP_RSP_SUCCESS);
+        break;
+
+    case GLP_REQ_DEL_STRD_RECS:
+        nb = app_glps_rec_delete(q);
+        QPRINTF("GLPS deleted %d records\r\n", nb);
+        app_glps_racp_rsp_req_send(conhdl, 0, req->op_code, GLP_RSP_SUCCESS);
+        break;
+
+    case GLP_REQ_REP_STRD_RECS:
+        app_glps_rec_env.conhdl = conhdl;
+        app_glps_rec_env.sent_nb = 0;
+        app_glps_rec_env.start_time = ke_time();
+        app_glps_rec_env.cur_page = app_glps_rec_first_page();
+        app_glps_rec_env.cur_mask = app_glps_rec_page_match(app_glps_rec_env.cur_page, q);
+        if (!app_glps_rec_fetch(&app_glps_rec_env.next))
+        {
+            app_glps_racp_rsp_req_send(conhdl, 0, req->op_code, GLP_RSP_NO_RECS_FOUND);
+            break;
+        }
+        app_glps_rec_env.report = true;
+        app_glps_rec_env.next_valid = true;
+        app_glps_rec_send();
+        break;
+
+    default:
+        app_glps_racp_rsp_req_send(conhdl, 0, req->op_code, GLP_RSP_OP_CODE_NOT_SUP);
+        break;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Handle the completion of a measurement notification, send the next record
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_send_cmp(uint8_t status)
+{
+    if (app_glps_rec_env.pend_nb)
+        app_glps_rec_env.pend_nb--;
+
+    if (!app_glps_rec_env.report)
+        return;
+
+    if (status != PRF_ERR_OK)
+        app_glps_rec_report_end(GLP_RSP_PROCEDURE_NOT_COMPLETED);
+    else if (app_glps_rec_env.next_valid)
+        app_glps_rec_send();
+    else if (app_glps_rec_env.pend_nb == 0)
+        app_glps_rec_report_end(GLP_RSP_SUCCESS);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Stop the on-going report without response, at disconnection
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_stop(void)
+{
+    app_glps_rec_env.report = false;
+    app_glps_rec_env.pend_nb = 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Fill the store up to nb measurements and time the record access operations
+ *
+ * The measurements are 5 minutes apart. Each operation is repeated and its average time
+ * is printed in us, with the kernel time resolution of 10ms over all the repetitions.
+ ****************************************************************************************
+ */
+void app_glps_rec_bench(uint16_t nb)
+{
+    struct glp_meas meas;
+    struct glp_filter f;
+    struct app_glps_rec_query q;
+    uint32_t t, m;
+    uint16_t n, count = 0, first, last;
+    uint8_t op;
+
+    if (app_glps_rec_env.report)
+        return;
+
+    memset(&meas, 0, sizeof(meas));
+    meas.flags = GLP_MEAS_GL_CTR_TYPE_AND_SPL_LOC_PRES;
+    meas.type = GLP_TYPE_CAPILLARY_WHOLE_BLOOD;
+    meas.location = GLP_LOC_FINGER;
+
+    t = ke_time();
+    for (n = app_glps_rec_env.rec_nb; n < nb; n++)
+    {
+        m = app_glps_rec_env.next_seq * 5;
+        meas.base_time.year = 2015 + m / 483840;
+        meas.base_time.month = 1 + (m / 40320) % 12;
+        meas.base_time.day = 1 + (m / 1440) % 28;
+        meas.base_time.hour = (m / 60) % 24;
+        meas.base_time.min = m % 60;
+        meas.concentration = 0xB000 | (80 + app_glps_rec_env.next_seq % 100);
+        if (app_glps_rec_add(&meas, NULL) != APP_GLPS_REC_OK)
+            break;
+    }
+    app_glps_rec_flush();
+    t = (ke_time() - t) & APP_GLPS_REC_TIME_MASK;
+    QPRINTF("GLPS records %d, fill %d ms\r\n", app_glps_rec_env.rec_nb, t * 10);
+
+    t = ke_time();
+    app_glps_rec_init();
+    t = (ke_time() - t) & APP_GLPS_REC_TIME_MASK;
+    QPRINTF("mount %d ms\r\n", t * 10);
+
+    if (!app_glps_rec_edge(false, &first) || !app_glps_rec_edge(true, &last))
+        return;
+
+    for (op = 0; op < 5; op++)
+    {
+        memset(&f, 0, sizeof(f));
+        switch (op)
+        {
+        case 0:
+            f.operator = GLP_OP_ALL_RECS;
+            break;
+        case 1:
+            f.operator = GLP_OP_LAST_REC;
+            break;
+        case 2:
+            // middle half by sequence number
+            f.operator = GLP_OP_WITHIN_RANGE_OF;
+            f.filter_type = GLP_FILTER_SEQ_NUMBER;
+            f.val.seq_num.min = first + (last - first) / 4;
+            f.val.seq_num.max = last - (last - first) / 4;
+            break;
+        default:
+            // middle half by time, the page ranges of the first and last pages are
+            // partially inside with op 4
+            f.operator = GLP_OP_WITHIN_RANGE_OF;
+            f.filter_type = GLP_FILTER_USER_FACING_TIME;
+            m = (first + (last - first) / 4) * 5 + (op == 4 ? 2 : 0);
+            f.val.time.base_min.year = 2015 + m / 483840;
+            f.val.time.base_min.month = 1 + (m / 40320) % 12;
+            f.val.time.base_min.day = 1 + (m / 1440) % 28;
+            f.val.time.base_min.hour = (m / 60) % 24;
+            f.val.time.base_min.min = m % 60;
+            m = (last - (last - first) / 4) * 5;
+            f.val.time.base_max.year = 2015 + m / 483840;
+            f.val.time.base_max.month = 1 + (m / 40320) % 12;
+            f.val.time.base_max.day = 1 + (m / 1440) % 28;
+            f.val.time.base_max.hour = (m / 60) % 24;
+            f.val.time.base_max.min = m % 60;
+            break;
+        }
+
+        app_glps_rec_env.cache_page = APP_GLPS_REC_NO_PAGE;
+        t = ke_time();
+        for (n = 0; n < APP_GLPS_REC_BENCH_LOOP; n++)
+        {
+            app_glps_rec_query_set(&f, &q);
+            count = app_glps_rec_count(&q);
+        }
+        t = (ke_time() - t) & APP_GLPS_REC_TIME_MASK;
+        QPRINTF("count op %d: %d records, %d us\r\n", f.operator, count, t * 10000 / APP_GLPS_REC_BENCH_LOOP);
+    }
+}
+
+#endif // BLE_GL_SENSOR && QN_GLPS_REC
+
+/// @} APP_GLPS_REC
@@ -0,0 +1,233 @@
+/**
+ ****************************************************************************************
+ *
+ * @file app_glps_rec.h
+ *
+ * @brief Application Glucose Record Store API
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#ifndef APP_GLPS_REC_H_
+#define APP_GLPS_REC_H_
+
+/**
+ ****************************************************************************************
+ * @addtogroup APP_GLPS_REC Glucose Record Store
+ * @ingroup APP_GLPS
+ * @brief Stored glucose measurements and Record Access Control Point execution
+ *
+ * Measurements are appended to a circular log of fixed size records (32 bytes, 8 per flash
+ * page) in QN_GLPS_REC_SECTOR_NUM sectors. The first record of each sector is a header with
+ * the sector sequence number. When the log head enters a used sector, the sector (the oldest
+ * one) is erased and its measurements are lost.
+ *
+ * A RAM table keeps for each page the sequence number of its first measurement, the slots
+ * holding a measurement, the deleted slots and the range of user facing time (base time +
+ * time offset) of its measurements. Measurements are stored in sequence number order, so
+ * the sequence number filters, the first and last record and the counts are resolved from
+ * the table, and a time filter only reads the pages whose time range is partially inside.
+ *
+ * A deletion is appended to the log as a record with the deleted sequence number range, it
+ * is applied to the table again when the store is mounted. The oldest sectors without live
+ * measurement are erased.
+ *
+ * The RACP requests are executed by app_glps_rec_racp(). The records of a report are sent
+ * back to back: the next matching record is read while the current one is notified, and is
+ * sent when GLPS completes the notification. With QN_MULTI_NOTIFICATION_IN_ONE_EVENT, GLPS
+ * queues up to GLPS_MEAS_QUEUE_NB records and several of them are notified in one connection
+ * event. The report prints its transfer time and rate.
+ *
+ * Only the records programmed to flash survive a reset, app_glps_rec_flush() programs the
+ * page buffer. Sequence numbers are not wrapped, up to 0xFFFC measurements can be stored.
+ *
+ * @{
+ ****************************************************************************************
+ */
+
+/*
+ * INCLUDE FILES
+ ****************************************************************************************
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include "glp_common.h"
+
+/*
+ * DEFINES
+ ****************************************************************************************
+ */
+
+/// Flash page size
+#define APP_GLPS_REC_PAGE_SIZE          256
+/// Flash sector size
+#define APP_GLPS_REC_SECTOR_SIZE        0x1000
+/// Record size in flash
+#define APP_GLPS_REC_SIZE               32
+/// Records in one page
+#define APP_GLPS_REC_PAGE_RECS          (APP_GLPS_REC_PAGE_SIZE / APP_GLPS_REC_SIZE)
+/// Pages in one sector
+#define APP_GLPS_REC_SECTOR_PAGES       (APP_GLPS_REC_SECTOR_SIZE / APP_GLPS_REC_PAGE_SIZE)
+/// Total pages of the region
+#define APP_GLPS_REC_PAGE_NUM           (QN_GLPS_REC_SECTOR_NUM * APP_GLPS_REC_SECTOR_PAGES)
+/// Measurements kept when the log is full, the header takes one record of each sector
+#define APP_GLPS_REC_CAPACITY           ((QN_GLPS_REC_SECTOR_NUM - 1) * (APP_GLPS_REC_SECTOR_PAGES * APP_GLPS_REC_PAGE_RECS - 1))
+/// Largest measurement sequence number
+#define APP_GLPS_REC_SEQ_MAX            0xFFFC
+
+#if (QN_GLPS_REC_BASE_ADDR < 0x1000) || (QN_GLPS_REC_BASE_ADDR % APP_GLPS_REC_SECTOR_SIZE)
+    #error "The glucose record store shall start at a sector boundary above the NVDS area"
+#endif
+#if (QN_GLPS_REC_SECTOR_NUM < 2)
+    #error "The glucose record store needs at least 2 sectors"
+#endif
+#if (QN_GLPS_REC_BASE_ADDR + QN_GLPS_REC_SECTOR_NUM * APP_GLPS_REC_SECTOR_SIZE > 0x20000)
+    #error "The glucose record store shall end in the 128KB flash"
+#endif
+#if (QN_REC_STORE) && (QN_GLPS_REC_BASE_ADDR + QN_GLPS_REC_SECTOR_NUM * APP_GLPS_REC_SECTOR_SIZE > QN_REC_STORE_BASE_ADDR) \
+    && (QN_GLPS_REC_BASE_ADDR < QN_REC_STORE_BASE_ADDR + QN_REC_STORE_SECTOR_NUM * APP_GLPS_REC_SECTOR_SIZE)
+    #error "The glucose record store overlaps the record store"
+#endif
+
+/*
+ * ENUMERATION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Glucose record store status
+enum app_glps_rec_status
+{
+    APP_GLPS_REC_OK = 0,
+    APP_GLPS_REC_FULL,
+    APP_GLPS_REC_BUSY
+};
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Stored glucose measurement, as programmed in flash
+struct app_glps_rec
+{
+    /// Sequence number, values above APP_GLPS_REC_SEQ_MAX mark the other records
+    uint16_t seq_num;
+    /// Base time
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+    /// Measurement flags
+    uint8_t flags;
+    /// Time offset in minutes
+    int16_t time_offset;
+    /// Glucose concentration
+    prf_sfloat concentration;
+    /// Sensor status annunciation
+    uint16_t status;
+    /// Type
+    uint8_t type;
+    /// Sample location
+    uint8_t location;
+
+    /// Context flags, the context is present if flags has GLP_MEAS_CTX_INF_FOLW
+    uint8_t ctx_flags;
+    /// Carbohydrate ID
+    uint8_t carbo_id;
+    /// Carbohydrate
+    prf_sfloat carbo_val;
+    /// Exercise duration
+    uint16_t exercise_dur;
+    /// Medication
+    prf_sfloat med_val;
+    /// HbA1c
+    prf_sfloat hba1c_val;
+    /// Meal
+    uint8_t meal;
+    /// Tester (bits 0-3) and health (bits 4-7)
+    uint8_t tester_health;
+    /// Exercise intensity
+    uint8_t exercise_intens;
+    /// Medication ID
+    uint8_t med_id;
+};
+
+/*
+ * FUNCTION DECLARATIONS
+ ****************************************************************************************
+ */
+
+/*
+ ****************************************************************************************
+ * @brief Mount the glucose record store and rebuild the page table from flash
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_init(void);
+
+/*
+ ****************************************************************************************
+ * @brief Store a measurement with the next sequence number, ctx may be NULL
+ *
+ ****************************************************************************************
+ */
+uint8_t app_glps_rec_add(struct glp_meas const *meas, struct glp_meas_ctx const *ctx);
+
+/*
+ ****************************************************************************************
+ * @brief Program the page buffer to flash
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_flush(void);
+
+/*
+ ****************************************************************************************
+ * @brief Get the number of stored measurements
+ *
+ ****************************************************************************************
+ */
+uint16_t app_glps_rec_get_nb(void);
+
+/*
+ ****************************************************************************************
+ * @brief Execute a RACP request received from GLPS
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_racp(uint16_t conhdl, struct glp_racp_req const *req);
+
+/*
+ ****************************************************************************************
+ * @brief Handle the completion of a measurement notification, send the next record
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_send_cmp(uint8_t status);
+
+/*
+ ****************************************************************************************
+ * @brief Stop the on-going report without response, at disconnection
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_stop(void);
+
+/*
+ ****************************************************************************************
+ * @brief Fill the store up to nb measurements and time the record access operations
+ *
+ ****************************************************************************************
+ */
+void app_glps_rec_bench(uint16_t nb);
+
+/// @} APP_GLPS_REC
+
+#endif // APP_GLPS_REC_H_
@@ -114,6 +114,9 @@ int app_glps_disable_ind_handler(ke_msg_id_t const msgid,
     app_glps_env->conhdl = 0xFFFF;
     app_glps_env->evt_cfg = param->evt_cfg;
     app_glps_env->enabled = false;
+#if QN_GLPS_REC
+    app_glps_rec_stop();
+#endif
     app_task_msg_hdl(msgid, param);
 
     return (KE_MSG_CONSUMED);
@@ -214,9 +217,13 @@ int app_glps_racp_req_ind_handler(ke_msg_id_t const msgid,
 {
     QPRINTF("RACP op_code %d, operator %d, filter_type %d.\r\n", param->racp_req.op_code, param->racp_req.filter.operator,
                                                               param->racp_req.filter.filter_type);
+#if QN_GLPS_REC
+    app_glps_rec_racp(param->conhdl, &param->racp_req);
+#else
     app_glps_env->racp_req = param->racp_req;
 
     app_task_msg_hdl(msgid, param);
+#endif
 
     return (KE_MSG_CONSUMED);
 }
@@ -245,6 +252,9 @@ int app_glps_req_cmp_evt_handler(ke_msg_id_t const msgid,
     switch (param->request)
     {
         case GLPS_SEND_MEAS_REQ_NTF_CMP:
+#if QN_GLPS_REC
+            app_glps_rec_send_cmp(param->status);
+#endif
             break;
         case GLPS_SEND_RACP_RSP_IND_CMP:
             break;
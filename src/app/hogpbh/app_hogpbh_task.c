@@ -72,7 +72,7 @@ int app_hogpbh_enable_cfm_handler(ke_msg_id_t const msgid,
     {
         uint8_t idx = KE_IDX_GET(src_id);
         app_hogpbh_env[idx].conhdl = param->conhdl;
-        app_hogpbh_env[idx].enabled = true;
+        app_set_client_service_status(idx, BLE_HID_BOOT_HOST_BIT, true);
         app_hogpbh_env[idx].cur_code = 0;
 
         // Get keyboard instance number here
@@ -41,8 +41,6 @@
 /// HID Over GATT Profile Boot Host environment variable
 struct app_hogpbh_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
     /// Instance Number of Mouse
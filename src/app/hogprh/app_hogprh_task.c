@@ -74,7 +74,7 @@ int app_hogprh_enable_cfm_handler(ke_msg_id_t const msgid,
     {
         uint8_t idx = KE_IDX_GET(src_id);
         app_hogprh_env[idx].conhdl = param->conhdl;
-        app_hogprh_env[idx].enabled = true;
+        app_set_client_service_status(idx, BLE_HID_REPORT_HOST_BIT, true);
         app_hogprh_env[idx].hids_nb = param->hids_nb;
 
         for (uint8_t i = 0; i < param->hids_nb; i++)
@@ -83,6 +83,11 @@ int app_hogprh_enable_cfm_handler(ke_msg_id_t const msgid,
             app_hogprh_set_report_proto_mode_req(i, param->conhdl);
         }
         app_hogprh_rd_char_req(HOGPRH_RD_HIDS_REPORT_MAP, 0, 0, param->conhdl);
+#if QN_DISC_CACHE
+        app_cache_store(param->conhdl, APP_CACHE_HOGPRH, param->hids, sizeof(struct hogprh_hids_content),
+                        param->hids_nb);
+        app_cache_ready(param->conhdl, APP_CACHE_HOGPRH);
+#endif
     }
     
     return (KE_MSG_CONSUMED);
@@ -445,6 +450,9 @@ int app_hogprh_disable_ind_handler(ke_msg_id_t const msgid,
                                    ke_task_id_t const src_id)
 {
     QPRINTF("HOGPRH disable ind\r\n");
+#if QN_DISC_CACHE
+    app_cache_disabled(param->conhdl, APP_CACHE_HOGPRH);
+#endif
     return (KE_MSG_CONSUMED);
 }
 
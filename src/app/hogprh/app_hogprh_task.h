@@ -40,8 +40,6 @@
 /// HID Over GATT Profile Boot Host environment variable
 struct app_hogprh_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
     uint8_t hids_nb;
@@ -86,6 +86,31 @@ void app_hrpc_enable_req(struct hrs_content *hrs, uint16_t conhdl)
     ke_msg_send(msg);
 }
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Heart Rate Collector role without disconnection. *//**
+ * @param[in] conhdl        Connection handle for which the profile Heart Rate Collector role is enabled.
+ * @response  HRPC_DISABLE_IND
+ * @description
+ *
+ *  This API is used for disabling the role on a connection which is kept, for example to discover
+ *  again the peer service after a change of the peer database. The role is enabled again with
+ *  app_hrpc_enable_req().
+ *
+ ****************************************************************************************
+ */
+void app_hrpc_disable_req(uint16_t conhdl)
+{
+    struct hrpc_disable_req *msg = KE_MSG_ALLOC(HRPC_DISABLE_REQ, KE_BUILD_ID(TASK_HRPC, conhdl), TASK_APP,
+                                                 hrpc_disable_req);
+
+    ///Connection handle
+    msg->conhdl = conhdl;
+
+    // Send the message
+    ke_msg_send(msg);
+}
+
 /*
  ****************************************************************************************
  * @brief Generic message to read a HRS characteristic value. *//**
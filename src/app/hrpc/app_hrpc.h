@@ -83,6 +83,14 @@
  */
 void app_hrpc_enable_req(struct hrs_content *hrs, uint16_t conhdl);
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Heart Rate Collector role without disconnection
+ *
+ ****************************************************************************************
+ */
+void app_hrpc_disable_req(uint16_t conhdl);
+
 /*
  ****************************************************************************************
  * @brief Generic message to read a HRS characteristic value
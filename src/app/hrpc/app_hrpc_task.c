@@ -70,7 +70,11 @@ int app_hrpc_enable_cfm_handler(ke_msg_id_t const msgid,
     {
         uint8_t idx = KE_IDX_GET(src_id);
         app_hrpc_env[idx].conhdl = param->conhdl;
-        app_hrpc_env[idx].enabled = true;
+        app_set_client_service_status(idx, BLE_HR_COLLECTOR_BIT, true);
+#if QN_DISC_CACHE
+        app_cache_store(param->conhdl, APP_CACHE_HRPC, &param->hrs, sizeof(struct hrs_content), 1);
+        app_cache_ready(param->conhdl, APP_CACHE_HRPC);
+#endif
     }
     app_task_msg_hdl(msgid, param);
 
@@ -287,6 +291,10 @@ int app_hrpc_disable_ind_handler(ke_msg_id_t const msgid,
 {
     QPRINTF("HRPC disable ind\r\n");
 
+#if QN_DISC_CACHE
+    app_cache_disabled(param->conhdl, APP_CACHE_HRPC);
+#endif
+
     return (KE_MSG_CONSUMED);
 }
 
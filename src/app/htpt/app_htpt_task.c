@@ -89,6 +89,9 @@ int app_htpt_disable_ind_handler(ke_msg_id_t const msgid,
 {
     app_htpt_env->conhdl = 0xffff;
     app_htpt_env->enabled = false;
+#if QN_NTF_SCHED
+    app_ntf_flush(APP_NTF_HTPT);
+#endif
     app_task_msg_hdl(msgid, param);
 
     return (KE_MSG_CONSUMED);
@@ -140,6 +143,17 @@ int app_htpt_temp_send_cfm_handler(ke_msg_id_t const msgid,
                                    ke_task_id_t const dest_id,
                                    ke_task_id_t const src_id)
 {
+#if QN_NTF_SCHED
+    // HTPT_CENTRAL_IND_CFM also confirms the Measurement Interval indication, it is the
+    // temperature only while one is waiting for its confirmation
+    if ((param->cfm_type == HTPT_THERM_TEMP_SEND) || app_ntf_ind_pending(APP_NTF_HTPT))
+        app_ntf_send_cfm(APP_NTF_HTPT, param->status);
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+    // The value has only been taken by GATT
+    if (param->status == GATT_NOTIFY_GET_DATA)
+        return (KE_MSG_CONSUMED);
+#endif
+#endif
     app_task_msg_hdl(msgid, param);
     return (KE_MSG_CONSUMED);
 }
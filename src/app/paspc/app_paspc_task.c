@@ -141,7 +141,7 @@ int app_paspc_pass_content_handler(ke_msg_id_t const msgid,
 {
     uint8_t idx = KE_IDX_GET(src_id);
     app_paspc_env[idx].conhdl = param->conhdl;
-    app_paspc_env[idx].enabled = true;
+    app_set_client_service_status(idx, BLE_PASP_CLIENT_BIT, true);
     return (KE_MSG_CONSUMED);
 }
 
@@ -40,8 +40,6 @@
 /// Phone Alert Status Profile Client environment variable
 struct app_paspc_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
 };
@@ -40,8 +40,6 @@
 /// Proximity Monitor Profile environment variable
 struct app_proxm_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
     uint8_t cur_code;
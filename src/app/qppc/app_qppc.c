@@ -80,6 +80,31 @@ void app_qppc_enable_req(struct qpps_content *qpps, uint16_t conhdl)
     ke_msg_send(msg);
 }
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Quintic Private Profile Client role without disconnection. *//**
+ * @param[in] conhdl        Connection handle for which the profile Quintic Private Profile Client role is enabled.
+ * @response  QPPC_DISABLE_IND
+ * @description
+ *
+ *  This API is used for disabling the role on a connection which is kept, for example to discover
+ *  again the peer service after a change of the peer database. The role is enabled again with
+ *  app_qppc_enable_req().
+ *
+ ****************************************************************************************
+ */
+void app_qppc_disable_req(uint16_t conhdl)
+{
+    struct qppc_disable_req *msg = KE_MSG_ALLOC(QPPC_DISABLE_REQ, KE_BUILD_ID(TASK_QPPC, conhdl), TASK_APP,
+                                                 qppc_disable_req);
+
+    ///Connection handle
+    msg->conhdl = conhdl;
+
+    // Send the message
+    ke_msg_send(msg);
+}
+
 /*
  ****************************************************************************************
  * @brief Generic message to read a QPPS characteristic descriptor values. *//**
@@ -79,6 +79,14 @@
  */
 void app_qppc_enable_req(struct qpps_content *hrs, uint16_t conhdl);
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Quintic Private Profile Client role without disconnection
+ *
+ ****************************************************************************************
+ */
+void app_qppc_disable_req(uint16_t conhdl);
+
 /*
  ****************************************************************************************
  * @brief Generic message to read a QPPS characteristic descriptor values
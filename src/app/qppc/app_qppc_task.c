@@ -66,6 +66,10 @@ int app_qppc_enable_cfm_handler(ke_msg_id_t const msgid,
         app_qppc_env[idx].cur_code = QPPC_QPPS_RX_CHAR_VALUE_USER_DESP;
         app_qppc_env[idx].nb_ntf_char = param->nb_ntf_char;
         app_qppc_rd_char_req(app_qppc_env[idx].conhdl, QPPC_QPPS_RX_CHAR_VALUE_USER_DESP);
+#if QN_DISC_CACHE
+        app_cache_store(param->conhdl, APP_CACHE_QPPC, &param->qpps, sizeof(struct qpps_content), 1);
+        app_cache_ready(param->conhdl, APP_CACHE_QPPC);
+#endif
     }
     app_task_msg_hdl(msgid, param);
 
@@ -222,6 +226,10 @@ int app_qppc_disable_ind_handler(ke_msg_id_t const msgid,
     app_qppc_env[idx].enabled = false;
     app_qppc_env[idx].nb_ntf_char = 0;
 
+#if QN_DISC_CACHE
+    app_cache_disabled(param->conhdl, APP_CACHE_QPPC);
+#endif
+
     return (KE_MSG_CONSUMED);
 }
 
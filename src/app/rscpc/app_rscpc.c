@@ -80,6 +80,31 @@ void app_rscpc_enable_req(struct rscpc_rscs_content *rscs, uint16_t conhdl)
     ke_msg_send(msg);
 }
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Running Speed and Cadence Collector role without disconnection. *//**
+ * @param[in] conhdl        Connection handle for which the profile Running Speed and Cadence Collector role is enabled.
+ * @response  RSCPC_DISABLE_IND
+ * @description
+ *
+ *  This API is used for disabling the role on a connection which is kept, for example to discover
+ *  again the peer service after a change of the peer database. The role is enabled again with
+ *  app_rscpc_enable_req().
+ *
+ ****************************************************************************************
+ */
+void app_rscpc_disable_req(uint16_t conhdl)
+{
+    struct rscpc_disable_req *msg = KE_MSG_ALLOC(RSCPC_DISABLE_REQ, KE_BUILD_ID(TASK_RSCPC, conhdl), TASK_APP,
+                                                 rscpc_disable_req);
+
+    ///Connection handle
+    msg->conhdl = conhdl;
+
+    // Send the message
+    ke_msg_send(msg);
+}
+
 /*
  ****************************************************************************************
  * @brief Read the value of an attribute in the peer device database. *//**
@@ -76,6 +76,14 @@
  */
 void app_rscpc_enable_req(struct rscpc_rscs_content *rscs, uint16_t conhdl);
 
+/*
+ ****************************************************************************************
+ * @brief Disable the Running Speed and Cadence Collector role without disconnection
+ *
+ ****************************************************************************************
+ */
+void app_rscpc_disable_req(uint16_t conhdl);
+
 /*
  ****************************************************************************************
  * @brief Read the value of an attribute in the peer device database.
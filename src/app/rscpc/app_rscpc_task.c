@@ -67,8 +67,11 @@ int app_rscpc_rscs_content_ind_handler(ke_msg_id_t const msgid,
 {
     uint8_t idx = KE_IDX_GET(src_id);
     app_rscpc_env[idx].conhdl = param->conhdl;
-    app_rscpc_env[idx].enabled = true;
+    app_set_client_service_status(idx, BLE_RSC_COLLECTOR_BIT, true);
     //app_rscpc_env[app_env.select_idx].rscs = param->rscs;
+#if QN_DISC_CACHE
+    app_cache_store(param->conhdl, APP_CACHE_RSCPC, &param->rscs, sizeof(struct rscpc_rscs_content), 1);
+#endif
     return (KE_MSG_CONSUMED);
 }
 
@@ -178,6 +181,12 @@ int app_rscpc_cmp_evt_handler(ke_msg_id_t const msgid,
             if (param->status == PRF_ERR_OK)
             {
                 QPRINTF("Enable complete\r\n");
+#if QN_DISC_CACHE
+                // no content indication when enabled with the cached content
+                app_rscpc_env[KE_IDX_GET(src_id)].conhdl = param->conhdl;
+                app_set_client_service_status(KE_IDX_GET(src_id), BLE_RSC_COLLECTOR_BIT, true);
+                app_cache_ready(param->conhdl, APP_CACHE_RSCPC);
+#endif
             }
             else
             {
@@ -222,6 +231,10 @@ int app_rscpc_disable_ind_handler(ke_msg_id_t const msgid,
                                   ke_task_id_t const dest_id,
                                   ke_task_id_t const src_id)
 {
+#if QN_DISC_CACHE
+    app_cache_disabled(param->conhdl, APP_CACHE_RSCPC);
+#endif
+
     return (KE_MSG_CONSUMED);
 }
 
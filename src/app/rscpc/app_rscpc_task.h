@@ -40,8 +40,6 @@
 /// Running Speed and Cadence Profile Collector environment variable
 struct app_rscpc_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
 };
@@ -70,7 +70,7 @@ int app_scppc_enable_cfm_handler(ke_msg_id_t const msgid,
     {
         uint8_t idx = KE_IDX_GET(src_id);
         app_scppc_env[idx].conhdl = param->conhdl;
-        app_scppc_env[idx].enabled = true;
+        app_set_client_service_status(idx, BLE_SP_CLIENT_BIT, true);
     }
     app_task_msg_hdl(msgid, param);
 
@@ -39,8 +39,6 @@
 /// Scan Parameter Profile Client environment variable
 struct app_scppc_env_tag
 {
-    /// Profile role state: enabled/disabled
-    uint8_t enabled;
     /// Connection handle
     uint16_t conhdl;
     uint8_t cur_code;    
@@ -260,6 +260,7 @@ int app_smpc_ltk_req_ind_handler(ke_msg_id_t const msgid, struct smpc_ltk_req_in
         // Ask for remote LTK, response here
         if (bonded_dev_idx != GAP_INVALID_CONIDX)
         {
+            app_update_bonded_dev_lru(bonded_dev_idx);
             if(GAP_PERIPHERAL_SLV != app_get_role())
             {
             app_smpc_ltk_req_rsp(param->idx,
@@ -326,6 +327,7 @@ int app_smpc_irk_req_ind_handler(ke_msg_id_t const msgid, struct smpc_irk_req_in
         // We recognised this device, so update address for looking up correct LTK
         // It is no need to write back to NVDS.
         app_env.bonded_info[app_env.irk_pos - 1].peer_addr = app_env.dev_rec[param->idx].bonded_info.peer_addr;
+        app_rebuild_bonded_hash();
         app_env.irk_pos = 0;
         return (KE_MSG_CONSUMED);
     }
@@ -479,6 +481,11 @@ int app_smpc_sec_started_ind_handler(ke_msg_id_t const msgid, struct smpc_sec_st
 {
     QPRINTF("Start encryption complete, idx %d, status %d, key_size %d, sec_prop %d, bonded %d.\r\n", 
                                 param->idx, param->status, param->key_size, param->sec_prop, param->bonded);
+#if QN_DISC_CACHE
+    // the cached handles of a bonded peer are used once the link is encrypted
+    if (param->status == CO_ERROR_NO_ERROR)
+        app_cache_enable(app_get_conhdl_by_idx(param->idx));
+#endif
     app_task_msg_hdl(msgid, param);
 
     return (KE_MSG_CONSUMED);
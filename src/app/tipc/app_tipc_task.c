@@ -73,7 +73,7 @@ int app_tipc_enable_cfm_handler(ke_msg_id_t const msgid,
     {
         uint8_t idx = KE_IDX_GET(src_id);
         app_tipc_env[idx].conhdl = param->conhdl;
-        app_tipc_env[idx].enabled = true;
+        app_set_client_service_status(idx, BLE_TIP_CLIENT_BIT, true);
     }
     app_task_msg_hdl(msgid, param);
 
@@ -32,6 +32,10 @@
 #include "dma.h"
 #endif
 
+#if (ADC_STREAM_EN==TRUE) && (CONFIG_ADC_ENABLE_INTERRUPT==FALSE) && (ADC_DMA_EN==FALSE)
+#error "ADC streaming needs ADC interrupt or ADC DMA"
+#endif
+
 /*
  * STRUCTURE DEFINITIONS
  ****************************************************************************************
@@ -54,6 +58,21 @@ struct adc_env_tag
 #endif
 };
 
+#if ADC_STREAM_EN==TRUE
+///ADC stream environment parameters
+struct adc_stream_env_tag
+{
+    volatile uint8_t    active;
+    uint8_t             idx;        // index of the buffer being filled
+    uint8_t             reduce;
+    uint8_t             deci_ratio;
+    uint16_t            samples;
+    uint16_t            pos;        // write position in interrupt mode
+    int16_t             *buf[2];
+    void                (*callback)(const int16_t *buf, uint16_t samples, const adc_stream_stat *stat);
+};
+#endif
+
 /*
  * GLOBAL VARIABLE DEFINITIONS
  ****************************************************************************************
@@ -62,6 +81,11 @@ struct adc_env_tag
 ///ADC environment variable
 static struct adc_env_tag adc_env;
 
+#if ADC_STREAM_EN==TRUE
+///ADC stream environment variable
+static struct adc_stream_env_tag adc_stream_env;
+#endif
+
 ///ADC SCAN channel number
 static volatile uint8_t scan_ch_num;
 
@@ -89,6 +113,9 @@ extern __QAEABI int64_t __aeabi_lmul(int64_t x, int64_t y);
 static void __adc_cofig(const adc_init_configuration *S);
 static void __adc_calibrate(const adc_init_configuration *S);
 static void __adc_offset_get(void);
+#if ADC_STREAM_EN==TRUE
+static void __adc_stream_buffer_done(int16_t *buf);
+#endif
 
 /*
  * EXPORTED FUNCTION DEFINITIONS
@@ -112,6 +139,18 @@ void ADC_IRQHandler(void)
         {
             /* clear interrupt flag by read data */
             data = adc_adc_GetDATA(QN_ADC);
+#if ADC_STREAM_EN==TRUE
+            if (adc_stream_env.active) {
+                adc_stream_env.buf[adc_stream_env.idx][adc_stream_env.pos++] = data;
+                if (adc_stream_env.pos == adc_stream_env.samples) {
+                    // switch to the other buffer first, then hand over the full one
+                    adc_stream_env.pos = 0;
+                    adc_stream_env.idx ^= 1;
+                    __adc_stream_buffer_done(adc_stream_env.buf[adc_stream_env.idx ^ 1]);
+                }
+                continue;
+            }
+#endif
             if (adc_env.samples > 0) {
                 *adc_env.bufptr++ = data;
                 adc_env.samples--;
@@ -376,6 +415,236 @@ void adc_read(const adc_read_configuration *S, int16_t *buf, uint32_t samples, v
 #endif
 }
 
+#if ADC_STREAM_EN==TRUE
+#if ADC_DMA_EN==TRUE
+/**
+ ****************************************************************************************
+ * @brief  ADC stream DMA done callback
+ * @description
+ *  Re-arm DMA on the other buffer at once (the ADC FIFO holds new samples in the meantime),
+ *  then process the full buffer.
+ *****************************************************************************************
+ */
+static void adc_stream_dma_cb(void)
+{
+    int16_t *full;
+
+    if (!adc_stream_env.active) {
+        return;
+    }
+
+    full = adc_stream_env.buf[adc_stream_env.idx];
+    adc_stream_env.idx ^= 1;
+    dma_rx(DMA_TRANS_HALF_WORD, DMA_ADC, (uint32_t)adc_stream_env.buf[adc_stream_env.idx],
+           adc_stream_env.samples*2, adc_stream_dma_cb);
+
+    __adc_stream_buffer_done(full);
+}
+#endif
+
+/**
+ ****************************************************************************************
+ * @brief  Start double-buffered ADC streaming
+ * @param[in]    S          ADC read configuration, contains work mode, trigger source, start/end channel
+ * @param[in]    stream     ADC stream configuration, contains ping-pong buffers, reduction and callback
+ * @return       false if the sample number is 0 or above ADC_STREAM_MAX_SAMPLES, or is not a multiple
+ *               of the decimation ratio, the stream is then not started
+ * @description
+ *  This function is used to sample continuously into two buffers alternately. While one buffer is
+ *  being filled (by DMA or ADC interrupt), the other one is reduced and passed to the callback.
+ *  The stream runs until adc_stream_stop() is called.
+ * @note
+ *  The work mode shall be CONTINUE_MOD/CONTINUE_SCAN_MOD, or the trigger source shall be timer or
+ *  GPIO, otherwise the conversion is not restarted after the first sample.
+ *****************************************************************************************
+ */
+bool adc_stream_start(const adc_read_configuration *S, const adc_stream_configuration *stream)
+{
+    // The DMA length and the in-place decimation depend on them
+    if ((stream->samples == 0) || (stream->samples > ADC_STREAM_MAX_SAMPLES))
+        return false;
+    if ((stream->reduce & ADC_REDUCE_DECI)
+        && ((stream->deci_ratio == 0) || (stream->samples % stream->deci_ratio != 0)))
+        return false;
+
+    adc_stream_env.buf[0] = stream->buf[0];
+    adc_stream_env.buf[1] = stream->buf[1];
+    adc_stream_env.samples = stream->samples;
+    adc_stream_env.reduce = stream->reduce;
+    adc_stream_env.deci_ratio = stream->deci_ratio;
+    adc_stream_env.callback = stream->callback;
+    adc_stream_env.idx = 0;
+    adc_stream_env.pos = 0;
+    adc_stream_env.active = 1;
+
+#if ADC_DMA_EN==TRUE
+    adc_read(S, stream->buf[0], stream->samples, adc_stream_dma_cb);
+#else
+    adc_read(S, stream->buf[0], stream->samples, NULL);
+#endif
+    return true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Stop ADC streaming
+ * @description
+ *  This function is used to stop ADC streaming. The partly filled buffer is discarded.
+ *****************************************************************************************
+ */
+void adc_stream_stop(void)
+{
+    adc_stream_env.active = 0;
+
+    adc_enable(MASK_DISABLE);
+#if ADC_DMA_EN==TRUE
+    dma_abort();
+#endif
+    adc_clean_fifo();
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Process one full stream buffer
+ * @param[in]    buf        full buffer
+ * @description
+ *  Statistics are calculated on raw samples, then decimation is done in place.
+ *****************************************************************************************
+ */
+static void __adc_stream_buffer_done(int16_t *buf)
+{
+    adc_stream_stat stat;
+    uint16_t samples = adc_stream_env.samples;
+
+    adc_stat_calc(buf, samples, adc_stream_env.reduce, &stat);
+    if (adc_stream_env.reduce & ADC_REDUCE_DECI) {
+        samples = adc_decimate(buf, samples, adc_stream_env.deci_ratio);
+    }
+
+    if (adc_stream_env.callback != NULL) {
+        adc_stream_env.callback(buf, samples, &stat);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Integer square root
+ * @param[in]    x          radicand
+ * @return floor(sqrt(x))
+ *****************************************************************************************
+ */
+static uint16_t __adc_isqrt(uint32_t x)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint16_t)res;
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Calculate statistics of ADC samples
+ * @param[in]    buf        ADC samples
+ * @param[in]    samples    sample number, max ADC_STREAM_MAX_SAMPLES
+ * @param[in]    reduce     reduction mask, combination of enum ADC_STREAM_REDUCE
+ * @param[out]   stat       statistics, fields not selected by reduce are 0
+ * @description
+ *  This function only touches memory, so it can be built and benchmarked on the host.
+ *  A 12-bit sample squared takes up to 24 bits, the square sum is kept on 64 bits.
+ *****************************************************************************************
+ */
+void adc_stat_calc(const int16_t *buf, uint16_t samples, uint8_t reduce, adc_stream_stat *stat)
+{
+    int32_t sum = 0;
+    uint64_t sum_sq = 0;
+    int16_t min = 0x7FFF;
+    int16_t max = -0x7FFF - 1;
+    int16_t v;
+    uint16_t i;
+
+    memset(stat, 0, sizeof(adc_stream_stat));
+    if (samples == 0) {
+        return;
+    }
+
+    if (reduce & (ADC_REDUCE_MEAN | ADC_REDUCE_MIN_MAX)) {
+        for (i = 0; i < samples; i++) {
+            v = buf[i];
+            sum += v;
+            if (v < min) {
+                min = v;
+            }
+            if (v > max) {
+                max = v;
+            }
+        }
+
+        if (reduce & ADC_REDUCE_MEAN) {
+            stat->mean = sum / (int32_t)samples;
+        }
+        if (reduce & ADC_REDUCE_MIN_MAX) {
+            stat->min = min;
+            stat->max = max;
+        }
+    }
+
+    if (reduce & ADC_REDUCE_RMS) {
+        for (i = 0; i < samples; i++) {
+            v = buf[i];
+            sum_sq += (uint32_t)(v * v);
+        }
+        stat->rms = __adc_isqrt((uint32_t)(sum_sq / samples));
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief  N-to-1 decimation of ADC samples
+ * @param[in,out] buf       ADC samples, the decimated samples are written to the head of it
+ * @param[in]    samples    sample number
+ * @param[in]    ratio      decimation ratio N, every N samples are averaged to one
+ * @return decimated sample number, trailing samples less than N are dropped
+ * @description
+ *  This function only touches memory, so it can be built and benchmarked on the host.
+ *****************************************************************************************
+ */
+uint16_t adc_decimate(int16_t *buf, uint16_t samples, uint8_t ratio)
+{
+    int32_t acc;
+    uint16_t i, out;
+    uint8_t j;
+
+    if (ratio <= 1) {
+        return samples;
+    }
+
+    out = 0;
+    for (i = 0; (i + ratio) <= samples; i += ratio) {
+        acc = 0;
+        for (j = 0; j < ratio; j++) {
+            acc += buf[i + j];
+        }
+        buf[out++] = acc / ratio;
+    }
+
+    return out;
+}
+#endif /* ADC_STREAM_EN==TRUE */
+
 /**
  ****************************************************************************************
  * @brief   ADC configuration
@@ -74,6 +74,9 @@ extern "C"{
 /// External reference voltage: mV (CFG_ADC_EXT_REF_VOL = 2*EXT_REF1 or CFG_ADC_EXT_REF_VOL = EXT_REF2)
 #define CFG_ADC_EXT_REF_VOL                         (3000)
 
+/// Maximum samples of one streaming buffer, limited by the DMA transfer size (0x7FF bytes)
+#define ADC_STREAM_MAX_SAMPLES                      (0x7FF / 2)
+
 
 /*
  * ENUMERATION DEFINITIONS
@@ -221,6 +224,16 @@ enum ADC_BUFF_GAIN
 
 
 
+/// ADC stream in-driver reduction
+enum ADC_STREAM_REDUCE
+{
+    ADC_REDUCE_NONE     = 0,            /*!< Deliver raw samples only */
+    ADC_REDUCE_MEAN     = 0x01,         /*!< Calculate mean value of the buffer */
+    ADC_REDUCE_MIN_MAX  = 0x02,         /*!< Calculate minimum and maximum value of the buffer */
+    ADC_REDUCE_RMS      = 0x04,         /*!< Calculate RMS value of the buffer */
+    ADC_REDUCE_DECI     = 0x08          /*!< N-to-1 decimation (box-car average) in place */
+};
+
 ///Instance structure for ADC initial configuration
 typedef struct
 {
@@ -242,6 +255,27 @@ typedef struct
     enum ADC_CH end_ch;                 /*!< ADC end channel */
 } adc_read_configuration;
 
+///Instance structure for ADC stream buffer statistics
+typedef struct
+{
+    int16_t mean;                       /*!< Mean value of the buffer */
+    int16_t min;                        /*!< Minimum value of the buffer */
+    int16_t max;                        /*!< Maximum value of the buffer */
+    uint16_t rms;                       /*!< Root mean square value of the buffer */
+} adc_stream_stat;
+
+///Instance structure for ADC stream configuration
+typedef struct
+{
+    int16_t *buf[2];                    /*!< Ping-pong buffers, filled alternately */
+    uint16_t samples;                   /*!< Sample number of each buffer, max ADC_STREAM_MAX_SAMPLES */
+    uint8_t reduce;                     /*!< Reduction mask, combination of enum ADC_STREAM_REDUCE */
+    uint8_t deci_ratio;                 /*!< Decimation ratio N for ADC_REDUCE_DECI, samples shall be a multiple of N */
+    /// Called when one buffer is full. The driver is already filling the other one, so the buffer
+    /// stays valid until the next call. samples is the number of (decimated) samples in buf.
+    void (*callback)(const int16_t *buf, uint16_t samples, const adc_stream_stat *stat);
+} adc_stream_configuration;
+
 
 /*
  * FUNCTION DEFINITIONS
@@ -372,6 +406,12 @@ extern void adc_buf_gain_set(enum ADC_BUFF_GAIN gain);
 extern void adc_compare_init(enum WCMP_DATA data, int16_t high, int16_t low, void (*callback)(void));
 extern void adc_decimation_enable(enum DECIMATION_RATE rate, uint32_t able);
 extern int16_t ADC_RESULT_mV(int16_t adc_data);
+#if ADC_STREAM_EN==TRUE
+extern void adc_stat_calc(const int16_t *buf, uint16_t samples, uint8_t reduce, adc_stream_stat *stat);
+extern uint16_t adc_decimate(int16_t *buf, uint16_t samples, uint8_t ratio);
+extern bool adc_stream_start(const adc_read_configuration *S, const adc_stream_configuration *stream);
+extern void adc_stream_stop(void);
+#endif
 
 
 #ifdef __cplusplus
@@ -15,72 +15,128 @@
 
 
 #include "bletime.h"
+#include "syscon.h"
+#include "intc.h"
+#include "sleep.h"
 
-// the value range is (0-30000)
-#define SYS_TIME_CHECK_PERIOD   (29999)
+#define BASE_TIME_US_TO_S(n)      (((n) + 500000) / 1000000)  //round-off
+/// RTC count range in 32K ticks, the second counter is 32 bits
+#define RTC_TICK_RANGE            ((uint64_t)0x100000000ULL * QN_CLOCK_HZ)
 
-#define BASE_TIME_CNT_TO_S(n)     (((n) + 50 ) / 100)  //round-off
-#define MAX_TICK_COUNT_10MS       (0x7FFFFF)
+// monotonic clock state, the RTC counter is read and extended to 64 bits lazily
+static uint64_t s_clock_tick = 0;       // monotonic time of the last read in 32K ticks
+static uint64_t s_clock_rtc = 0;        // RTC count of the last read in 32K ticks
 
-static volatile uint32_t s_pre_tick_count_10ms = 0;
-static volatile uint64_t s_tick_count_10ms = 0;
+// wall time base
+static uint64_t s_base_us = 0;
+static time_t s_base_sec = 0;
 
 /**
  ****************************************************************************************
- * @brief Set time with seconds.
+ * @brief Read the RTC as one 32K tick count.
+ *
+ * The second and the sub-second counters are read separately, the second is read again
+ * to detect a carry between the two reads.
  ****************************************************************************************
  */
-void set_time_sec(time_t new_sec)
+static uint64_t rtc_tick_read(void)
 {
-    s_tick_count_10ms = (uint64_t)new_sec * 100;
-    s_pre_tick_count_10ms = ke_time();
+    uint32_t sec, cnt;
+
+    do
+    {
+        sec = rtc_rtc_GetSecVal(QN_RTC);
+        cnt = rtc_rtc_GetCNT(QN_RTC) & RTC_MASK_CNT_VAL;
+    } while (sec != rtc_rtc_GetSecVal(QN_RTC));
+
+    return (uint64_t)sec * QN_CLOCK_HZ + cnt;
 }
 
 /**
  ****************************************************************************************
- * @brief get time with seconds.
+ * @brief RTC ticks elapsed between two reads.
+ *
+ * The RTC count is taken modulo its range, so the wrap of the second counter is counted.
+ * A step of more than half the range is the RTC set backwards, no time has elapsed.
  ****************************************************************************************
  */
-time_t get_time_sec(void)
+static uint64_t rtc_tick_elapsed(uint64_t rtc, uint64_t last)
 {
-    const uint32_t cur_tick_count_10ms = ke_time();
-    uint32_t diff = 0;
+    uint64_t elapsed = rtc >= last ? rtc - last : rtc + RTC_TICK_RANGE - last;
 
-    if(cur_tick_count_10ms >= s_pre_tick_count_10ms)
-    {
-        diff = cur_tick_count_10ms - s_pre_tick_count_10ms;
-    }
-    else // over flow
-    {
-        diff = MAX_TICK_COUNT_10MS - s_pre_tick_count_10ms + cur_tick_count_10ms;
-    }
+    return elapsed > RTC_TICK_RANGE / 2 ? 0 : elapsed;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the monotonic time in 32K ticks.
+ *
+ * @description
+ * The time advances by the RTC count elapsed since the previous read. If the RTC has been
+ * set backwards, the time holds its value instead of going back.
+ ****************************************************************************************
+ */
+uint64_t qn_clock_tick(void)
+{
+    uint64_t rtc;
+    uint64_t tick;
 
-    return BASE_TIME_CNT_TO_S(s_tick_count_10ms + diff);
+    GLOBAL_INT_DISABLE();
+    rtc = rtc_tick_read();
+    s_clock_tick += rtc_tick_elapsed(rtc, s_clock_rtc);
+    s_clock_rtc = rtc;
+    tick = s_clock_tick;
+    GLOBAL_INT_RESTORE();
+
+    return tick;
 }
 
 /**
  ****************************************************************************************
- * @brief trigger time check
+ * @brief Get the monotonic time in microseconds.
  ****************************************************************************************
  */
-void time_check_trigger(void)
+uint64_t qn_clock_us(void)
 {
-    const uint32_t cur_tick_count_10ms = ke_time();
-    uint32_t diff = 0;
+    return QN_CLOCK_TICK_TO_US(qn_clock_tick());
+}
 
-    if(cur_tick_count_10ms >= s_pre_tick_count_10ms)
-    {
-        diff = cur_tick_count_10ms - s_pre_tick_count_10ms;
-    }
-    else // over flow
-    {
-        diff = MAX_TICK_COUNT_10MS - s_pre_tick_count_10ms + cur_tick_count_10ms;
-    }
-    
-    s_tick_count_10ms += diff;
-    s_pre_tick_count_10ms = cur_tick_count_10ms;
+/**
+ ****************************************************************************************
+ * @brief Keep the clock running in low power.
+ *
+ * @description
+ * The RTC stops in deep sleep with the 32K clock. While the clock is kept, deep sleep is
+ * refused. Released, the time skips the deep sleep durations.
+ ****************************************************************************************
+ */
+void qn_clock_keep(bool keep)
+{
+    if (keep)
+        clk32k_prevent_deep_sleep(CLK32K_MASK_BLE_TIME_BIT);
+    else
+        clk32k_allow_deep_sleep(CLK32K_MASK_BLE_TIME_BIT);
+}
 
-    ke_timer_set(APP_SYS_TIME_CHECK_TIMER, TASK_APP, SYS_TIME_CHECK_PERIOD);
+/**
+ ****************************************************************************************
+ * @brief Set time with seconds.
+ ****************************************************************************************
+ */
+void set_time_sec(time_t new_sec)
+{
+    s_base_us = qn_clock_us();
+    s_base_sec = new_sec;
+}
+
+/**
+ ****************************************************************************************
+ * @brief get time with seconds.
+ ****************************************************************************************
+ */
+time_t get_time_sec(void)
+{
+    return s_base_sec + (time_t)BASE_TIME_US_TO_S(qn_clock_us() - s_base_us);
 }
 
 /**
@@ -139,27 +195,29 @@ void qn_time_get(qn_tm_t *ptm)
  ****************************************************************************************
  * @brief ble time initialize function.
  *
- * @description 
- * This function must be called after receive GAP_SET_MODE_REQ_CMP_EVT message, as the same 
- * time the state of "TASK_APP" is "APP_INIT".
+ * @description
+ * This function starts the RTC counter if it is not running yet and restarts the monotonic
+ * clock from 0. No timer is needed afterwards, the clock is extended when it is read. The
+ * clock is kept running, deep sleep is refused until qn_clock_keep(false).
  ****************************************************************************************
  */
 void qn_time_init(void)
 {
-    time_check_trigger();
-}
+    // the RTC runs on the 32K clock
+    syscon_SetCRSC(QN_SYSCON, SYSCON_MASK_GATING_32K_CLK);
+    qn_clock_keep(true);
 
-/**
- ****************************************************************************************
- * @brief ble time check timer
- ****************************************************************************************
- */
-int app_sys_time_check_timer_handler(ke_msg_id_t const msgid, void const *param,
-                                 ke_task_id_t const dest_id, ke_task_id_t const src_id)
-{
-    time_check_trigger();
+    if (!(rtc_rtc_GetCR(QN_RTC) & RTC_MASK_CFG))
+    {
+        // start the RTC counter from 0
+        while (rtc_rtc_GetSR(QN_RTC) & RTC_MASK_SEC_SYNC_BUSY);
+        rtc_rtc_SetSecVal(QN_RTC, 0);
+        while (rtc_rtc_GetSR(QN_RTC) & RTC_MASK_CR_SYNC_BUSY);
+        rtc_rtc_SetCRWithMask(QN_RTC, RTC_MASK_CFG, RTC_MASK_CFG);
+    }
 
-    return (KE_MSG_CONSUMED);
+    s_clock_tick = 0;
+    s_clock_rtc = rtc_tick_read();
+    set_time_sec(0);
 }
 
-
@@ -6,8 +6,11 @@
  * @brief QN9020 time support.
  * 
  * @note
- * 1. Deep sleep will lead to hardware counter stop, so call qn_time_set() 
- *    function to reset it or forbid deep sleep after leave deep sleep.
+ * 1. Deep sleep will lead to hardware counter stop: the time is counted by the RTC on the
+ *    32K clock, which is off in deep sleep. qn_time_init() refuses deep sleep until
+ *    qn_clock_keep(false), after which the time skips the deep sleep durations, so call
+ *    qn_time_set() to reset it. The RTC is owned by this module, do not call
+ *    rtc_time_set() together with it.
  * 2. Please include this file in your "usr_design.h"
  *
  * Copyright(C) 2015 NXP Semiconductors N.V.
@@ -31,6 +34,11 @@
 #include "ke_task.h"
 #include "lib.h"
 
+/// Frequency of the 32K clock counted by the RTC
+#define QN_CLOCK_HZ                 32000
+/// Convert 32K ticks to microseconds, 1000000 / 32000 = 125 / 4
+#define QN_CLOCK_TICK_TO_US(n)      (((uint64_t)(n) * 125) >> 2)
+
 // time struct
 typedef struct
 {
@@ -46,35 +54,48 @@ typedef struct
  ****************************************************************************************
  * @brief ble time initialize function.
  *
- * @description 
- * This function must be called after receive GAP_SET_MODE_REQ_CMP_EVT message, as the same 
- * time the state of "TASK_APP" is "APP_INIT".
+ * @description
+ * This function starts the RTC counter if it is not running yet and restarts the monotonic
+ * clock from 0. Deep sleep is refused while the clock is kept.
  ****************************************************************************************
  */
 extern void qn_time_init(void);
 
 /**
  ****************************************************************************************
- * @brief set time with year,month,day,hour,minute,second
+ * @brief Keep the clock running in low power, deep sleep is refused while it is kept
  ****************************************************************************************
  */
-extern void qn_time_get(qn_tm_t *ptm);
+extern void qn_clock_keep(bool keep);
 
 /**
  ****************************************************************************************
- * @brief set time with year,month,day,hour,minute,second
+ * @brief Get the monotonic time in 32K ticks
  ****************************************************************************************
  */
-extern bool qn_time_set(const qn_tm_t *ptm);
+extern uint64_t qn_clock_tick(void);
 
+/**
+ ****************************************************************************************
+ * @brief Get the monotonic time in microseconds
+ ****************************************************************************************
+ */
+extern uint64_t qn_clock_us(void);
 
 /**
  ****************************************************************************************
- * @brief ble time check timer
+ * @brief set time with year,month,day,hour,minute,second
  ****************************************************************************************
  */
-extern int app_sys_time_check_timer_handler(ke_msg_id_t const msgid, void const *param,
-                                 ke_task_id_t const dest_id, ke_task_id_t const src_id);
+extern void qn_time_get(qn_tm_t *ptm);
+
+/**
+ ****************************************************************************************
+ * @brief set time with year,month,day,hour,minute,second
+ ****************************************************************************************
+ */
+extern bool qn_time_set(const qn_tm_t *ptm);
+
 
 #endif
 
@@ -27,6 +27,9 @@
 #include "gpio.h"
 #if CONFIG_ENABLE_DRIVER_GPIO==TRUE
 #include "sleep.h"
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+#include "bletime.h"
+#endif
 /*
  * STRUCT DEFINITIONS
  ****************************************************************************************
@@ -49,6 +52,23 @@ struct gpio_env_tag
 static struct gpio_env_tag  gpio_env = {NULL};
 #endif
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/// GPIO edge capture environment, the ring buffer has one writer (GPIO interrupt) and one reader
+static struct
+{
+    /// Pins captured
+    uint32_t pins;
+    /// Write count, only written by the interrupt
+    volatile uint8_t head;
+    /// Read count, only written by the reader
+    volatile uint8_t tail;
+    /// Edges lost on a full buffer
+    uint8_t lost;
+    /// Edge buffer
+    struct gpio_edge buf[GPIO_EDGE_BUF_SIZE];
+} gpio_edge_env;
+#endif
+
 /// @cond
 
 
@@ -72,6 +92,64 @@ __STATIC_INLINE int ctz (uint32_t x)
     return n;
 }
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/**
+ ****************************************************************************************
+ * @brief Arm the interrupt of a captured pin for the edge opposite to its level
+ * @param[in]  pin     captured pin
+ * @return  pin level the interrupt is armed from
+ * @description
+ *  The level is read again after the interrupt is armed. If the pin has changed since the
+ *  level used for the arming was read, the armed edge has passed already, and the pin is
+ *  armed again from its new level.
+ ****************************************************************************************
+ */
+static uint8_t gpio_edge_arm(enum gpio_pin pin)
+{
+    uint32_t level;
+
+    do
+    {
+        gpio_wakeup_config(pin, GPIO_WKUP_BY_CHANGE);
+        // level the wakeup and the interrupt are armed from
+        level = (syscon_GetIOWCR(QN_SYSCON) >> 16) & pin;
+    } while (gpio_read_pin_field(pin) != level);
+
+    return (level != 0);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Capture an edge of a pin, called in GPIO interrupt
+ * @param[in]  pin     captured pin
+ * @description
+ *  The interrupt is armed for the opposite edge, then the level it is armed from is stored,
+ *  so a bounce during the capture is seen as a new edge and never lost.
+ ****************************************************************************************
+ */
+static void gpio_edge_capture(enum gpio_pin pin)
+{
+    struct gpio_edge *edge;
+    uint8_t head = gpio_edge_env.head;
+    uint32_t time = (uint32_t)qn_clock_us();
+    uint8_t level = gpio_edge_arm(pin);
+
+    if ((uint8_t)(head - gpio_edge_env.tail) >= GPIO_EDGE_BUF_SIZE)
+    {
+        gpio_edge_env.lost++;
+        return;
+    }
+
+    edge = &gpio_edge_env.buf[head & (GPIO_EDGE_BUF_SIZE - 1)];
+    edge->time = time;
+    edge->pin = pin;
+    edge->level = level;
+
+    // publish the edge after it is written
+    gpio_edge_env.head = head + 1;
+}
+#endif
+
 /**
  ****************************************************************************************
  * @brief Handles GPIO interrupt, polling and process
@@ -102,6 +180,11 @@ void GPIO_IRQHandler(void)
         {
             gpio_gpio_IntClear(QN_GPIO, pin);
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+            if (gpio_edge_env.pins & pin)
+                gpio_edge_capture((enum gpio_pin) pin);
+#endif
+
 #if GPIO_CALLBACK_EN==TRUE
             // Callback handler
             if(gpio_env.callback)
@@ -419,6 +502,71 @@ bool gpio_sleep_allowed(void)
     return TRUE;
 }
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/**
+ ****************************************************************************************
+ * @brief  Enable the edge capture of a pin
+ * @param[in]  pin     Specify pin of GPIO
+ * @description
+ *  Both edges of the pin are captured with the qn_clock_us() timestamp and the pin level in
+ *  the GPIO interrupt, before the GPIO callback is called. The pin also wakes up the chip on
+ *  both edges, so a held button does not keep the chip out of sleep. Only the pins of P0
+ *  and P1 can be captured, they are the wakeup pins. The clock shall be started by
+ *  qn_time_init().
+ *****************************************************************************************
+ */
+void gpio_edge_capture_enable(enum gpio_pin pin)
+{
+    gpio_edge_arm(pin);
+    gpio_edge_env.pins |= pin;
+    gpio_enable_interrupt(pin);
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Disable the edge capture of a pin
+ * @param[in]  pin     Specify pin of GPIO
+ *****************************************************************************************
+ */
+void gpio_edge_capture_disable(enum gpio_pin pin)
+{
+    gpio_disable_interrupt(pin);
+    gpio_edge_env.pins &= ~pin;
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Get the oldest captured edge
+ * @param[out] edge    captured edge
+ * @return  FALSE if no edge is captured
+ * @description
+ *  This function shall be called from one context only, it does not disable the interrupt.
+ *****************************************************************************************
+ */
+bool gpio_edge_get(struct gpio_edge *edge)
+{
+    uint8_t tail = gpio_edge_env.tail;
+
+    if (tail == gpio_edge_env.head)
+        return FALSE;
+
+    *edge = gpio_edge_env.buf[tail & (GPIO_EDGE_BUF_SIZE - 1)];
+    gpio_edge_env.tail = tail + 1;
+
+    return TRUE;
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Get the number of edges lost on a full buffer
+ *****************************************************************************************
+ */
+uint8_t gpio_edge_lost(void)
+{
+    return gpio_edge_env.lost;
+}
+#endif
+
 void gpio_open_drain_out(enum gpio_pin pin, enum gpio_level level)
 {
     if (level == GPIO_LOW) {
@@ -46,6 +46,11 @@
  ****************************************************************************************
  */
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/// Size of the edge capture buffer, power of 2
+#define GPIO_EDGE_BUF_SIZE              16
+#endif
+
 /*
  * ENUMERATION DEFINITIONS
  *****************************************************************************************
@@ -158,6 +163,19 @@ enum gpio_wakeup_type
 /// Callback function pointer type for level detection
 typedef void (*gpio_callback_t)(enum gpio_pin pin);
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/// Captured GPIO edge
+struct gpio_edge
+{
+    /// qn_clock_us() of the edge, low 32 bits
+    uint32_t time;
+    /// Pin of the edge
+    enum gpio_pin pin;
+    /// Pin level after the edge
+    uint8_t level;
+};
+#endif
+
 
 /*
  * FUNCTION DEFINITIONS
@@ -233,6 +251,12 @@ extern void gpio_disable_interrupt(enum gpio_pin pin);
 extern void gpio_pull_set(enum gpio_pin pin, enum gpio_pull pull_state);
 extern void gpio_wakeup_config(enum gpio_pin pin, enum gpio_wakeup_type type);
 extern bool gpio_sleep_allowed(void);
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+extern void gpio_edge_capture_enable(enum gpio_pin pin);
+extern void gpio_edge_capture_disable(enum gpio_pin pin);
+extern bool gpio_edge_get(struct gpio_edge *edge);
+extern uint8_t gpio_edge_lost(void);
+#endif
 
 
 /// @} GPIO
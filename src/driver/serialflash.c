@@ -28,6 +28,12 @@
 #include "syscon.h"
 
 #if CONFIG_ENABLE_DRIVER_SERIAL_FLASH==TRUE
+#if SERIAL_FLASH_DMA_EN==TRUE
+#include "dma.h"
+#endif
+#if SERIAL_FLASH_READ_AHEAD_EN==TRUE
+#include <string.h>
+#endif
 /// Serial flash command list
 uint8_t g_flash_cmd[MAX_FLASH_CMD_NUM]=
 {
@@ -41,6 +47,40 @@ uint8_t g_flash_cmd[MAX_FLASH_CMD_NUM]=
     0x01,       /*!< reserved, the value is not 0x00 and 0xFF */
 };
 
+#if SERIAL_FLASH_DMA_EN==TRUE
+///Serial flash DMA bulk read environment parameters
+struct flash_dma_env_tag
+{
+    uint32_t            src;        // memory mapped source address of next chunk
+    uint32_t            dst;        // destination address of next chunk
+    uint32_t            remain;     // bytes not read yet
+    uint32_t            chunk;      // size of the chunk in transfer
+    void                (*callback)(void);
+    volatile bool       busy;
+};
+
+///Serial flash DMA bulk read environment variable
+static struct flash_dma_env_tag flash_dma_env;
+#endif
+
+#if SERIAL_FLASH_READ_AHEAD_EN==TRUE
+/// Read-ahead cache page is invalid
+#define FLASH_RA_INVALID        0xFFFFFFFF
+/// No read-ahead cache page is being prefetched
+#define FLASH_RA_NONE           0xFF
+
+///Serial flash read-ahead cache
+struct flash_ra_tag
+{
+    uint32_t            buf[2][FLASH_PAGE_SIZE/4];
+    uint32_t            page[2];    // flash address of the page in each buffer
+    volatile uint8_t    fetching;   // buffer being filled by DMA
+};
+
+///Serial flash read-ahead cache variable
+static struct flash_ra_tag flash_ra = {{{0}}, {FLASH_RA_INVALID, FLASH_RA_INVALID}, FLASH_RA_NONE};
+#endif
+
 
 /*
  * LOCAL FUNCTION DEFINITIONS
@@ -125,6 +165,12 @@ uint32_t read_flash_id(void)
 */
 void sector_erase_flash(uint32_t addr, uint32_t n)
 {
+#if SERIAL_FLASH_DMA_EN==TRUE
+    while(flash_dma_env.busy);  //the data length is in use by the bulk read
+#endif
+#if SERIAL_FLASH_READ_AHEAD_EN==TRUE
+    flash_read_ahead_reset();
+#endif
     while (n--)
     {
         flash_write_enable(); //set the Write Enable Latch bit
@@ -145,6 +191,12 @@ void sector_erase_flash(uint32_t addr, uint32_t n)
 */
 void block_erase_flash(uint32_t addr, uint32_t block_size, uint32_t n)
 {
+#if SERIAL_FLASH_DMA_EN==TRUE
+    while(flash_dma_env.busy);  //the data length is in use by the bulk read
+#endif
+#if SERIAL_FLASH_READ_AHEAD_EN==TRUE
+    flash_read_ahead_reset();
+#endif
     while (n--)
     {
         flash_write_enable(); //set the Write Enable Latch bit
@@ -177,6 +229,9 @@ void block_erase_flash(uint32_t addr, uint32_t block_size, uint32_t n)
 */
 void read_flash(uint32_t addr, uint32_t *pBuf, uint32_t nByte)
 {
+#if SERIAL_FLASH_DMA_EN==TRUE
+    while(flash_dma_env.busy);  //the data length is in use by the bulk read
+#endif
     addr += QN_FLASH_BASE;   //get the data register address of flash control register
     while(is_flash_busy());  //wait the flash is free.
     sf_ctrl_SetDataLen(QN_SF_CTRL, nByte);
@@ -212,6 +267,12 @@ void read_flash(uint32_t addr, uint32_t *pBuf, uint32_t nByte)
 */
 void write_flash(uint32_t addr, const uint32_t *pBuf, uint32_t nByte)
 {
+#if SERIAL_FLASH_DMA_EN==TRUE
+    while(flash_dma_env.busy);  //the data length is in use by the bulk read
+#endif
+#if SERIAL_FLASH_READ_AHEAD_EN==TRUE
+    flash_read_ahead_reset();
+#endif
     addr += QN_FLASH_BASE;     //get the data register address of flash control register
     sf_ctrl_SetDataLen(QN_SF_CTRL, nByte);
     flash_write_enable();      //set the Write Enable Latch bit
@@ -223,6 +284,186 @@ void write_flash(uint32_t addr, const uint32_t *pBuf, uint32_t nByte)
     }
 }
 
+#if SERIAL_FLASH_DMA_EN==TRUE
+/**
+****************************************************************************************
+* @brief  Start DMA transfer of the next chunk of a bulk read
+*****************************************************************************************
+*/
+static void flash_dma_next(void);
+
+/**
+****************************************************************************************
+* @brief  DMA done callback of a bulk read chunk
+*****************************************************************************************
+*/
+static void flash_dma_done(void)
+{
+    flash_dma_env.src += flash_dma_env.chunk;
+    flash_dma_env.dst += flash_dma_env.chunk;
+    flash_dma_env.remain -= flash_dma_env.chunk;
+
+    if (flash_dma_env.remain) {
+        flash_dma_next();
+    }
+    else {
+        flash_dma_env.busy = false;
+        if (flash_dma_env.callback != NULL) {
+            flash_dma_env.callback();
+        }
+    }
+}
+
+static void flash_dma_next(void)
+{
+    // the controller data length is limited to one page
+    flash_dma_env.chunk = (flash_dma_env.remain > FLASH_PAGE_SIZE) ? FLASH_PAGE_SIZE : flash_dma_env.remain;
+
+    while(is_flash_busy());  //wait the flash is free.
+    sf_ctrl_SetDataLen(QN_SF_CTRL, flash_dma_env.chunk);
+    dma_memory_copy(flash_dma_env.src, flash_dma_env.dst, flash_dma_env.chunk, flash_dma_done);
+}
+
+/**
+****************************************************************************************
+* @brief  Read data form flash by DMA
+* @param[in]  addr        flash address(3 bytes), 256 integer times in code area
+* @param[in]  pBuf        pointer to read data buffer address
+* @param[in]  nByte       read size, 4 integer times, 256 integer times in code area
+* @param[in]  callback    callback after all the data is read
+* @description
+*  This function is used to read a large region of serial flash without CPU copy. The region
+*  is transferred by dma_memory_copy() one page at a time, as the controller data length is
+*  limited to one page. The function returns at once, and the callback is called in DMA
+*  interrupt context when all the data is read. The DMA controller and the flash shall not
+*  be used by others until then.
+*****************************************************************************************
+*/
+void read_flash_dma(uint32_t addr, uint32_t *pBuf, uint32_t nByte, void (*callback)(void))
+{
+    while(flash_dma_env.busy);
+
+    flash_dma_env.src = addr + QN_FLASH_BASE;
+    flash_dma_env.dst = (uint32_t)pBuf;
+    flash_dma_env.remain = nByte;
+    flash_dma_env.callback = callback;
+    flash_dma_env.busy = true;
+
+    dma_init();
+    flash_dma_next();
+}
+
+/**
+****************************************************************************************
+* @brief  Check whether a DMA bulk read is in progress
+* @return true if the bulk read is not finished
+*****************************************************************************************
+*/
+bool is_flash_dma_busy(void)
+{
+    return flash_dma_env.busy;
+}
+#endif /* SERIAL_FLASH_DMA_EN==TRUE */
+
+#if SERIAL_FLASH_READ_AHEAD_EN==TRUE
+/**
+****************************************************************************************
+* @brief  Read-ahead prefetch done callback
+*****************************************************************************************
+*/
+static void flash_ra_done(void)
+{
+    flash_ra.fetching = FLASH_RA_NONE;
+}
+
+/**
+****************************************************************************************
+* @brief  Get the cache buffer of a flash page, read it by CPU if it is not cached
+* @param[in]  page        flash page address
+* @return index of the cache buffer
+*****************************************************************************************
+*/
+static uint8_t flash_ra_get(uint32_t page)
+{
+    uint8_t i;
+
+    for (i = 0; i < 2; i++) {
+        if (flash_ra.page[i] == page) {
+            // wait for the prefetch of this page
+            while (flash_ra.fetching == i);
+            return i;
+        }
+    }
+
+    // the flash controller is shared with the prefetch
+    while (flash_ra.fetching != FLASH_RA_NONE);
+
+    i = 0;
+    read_flash(page, flash_ra.buf[i], FLASH_PAGE_SIZE);
+    flash_ra.page[i] = page;
+    return i;
+}
+
+/**
+****************************************************************************************
+* @brief  Read data from flash with read-ahead
+* @param[in]  addr        flash address(3 bytes), any alignment
+* @param[in]  pBuf        pointer to read data buffer address
+* @param[in]  nByte       read size, any length
+* @description
+*  This function is used by sequential readers (OTA image, stored logs). The data is
+*  served from a two-page cache. When the reader enters a page, the next page is
+*  prefetched by DMA into the other buffer, so the flash access overlaps with the
+*  processing of the current page. The prefetch is skipped if the DMA is in use.
+*****************************************************************************************
+*/
+void read_flash_seq(uint32_t addr, uint8_t *pBuf, uint32_t nByte)
+{
+    uint32_t page, off, len;
+    uint8_t i;
+
+    while (nByte)
+    {
+        page = addr & ~(FLASH_PAGE_SIZE - 1);
+        off = addr - page;
+        len = FLASH_PAGE_SIZE - off;
+        if (len > nByte) {
+            len = nByte;
+        }
+
+        i = flash_ra_get(page);
+
+        // prefetch the next page into the other buffer
+        if ((flash_ra.page[i^1] != page + FLASH_PAGE_SIZE)
+            && (flash_ra.fetching == FLASH_RA_NONE)
+            && (dma_check_status() == DMA_FREE)) {
+            flash_ra.page[i^1] = page + FLASH_PAGE_SIZE;
+            flash_ra.fetching = i^1;
+            read_flash_dma(page + FLASH_PAGE_SIZE, flash_ra.buf[i^1], FLASH_PAGE_SIZE, flash_ra_done);
+        }
+
+        memcpy(pBuf, (uint8_t *)flash_ra.buf[i] + off, len);
+        addr += len;
+        pBuf += len;
+        nByte -= len;
+    }
+}
+
+/**
+****************************************************************************************
+* @brief  Invalidate the read-ahead cache
+* @description
+*  This function is called before flash write and erase, and waits for the prefetch.
+*****************************************************************************************
+*/
+void flash_read_ahead_reset(void)
+{
+    while (flash_ra.fetching != FLASH_RA_NONE);
+    flash_ra.page[0] = FLASH_RA_INVALID;
+    flash_ra.page[1] = FLASH_RA_INVALID;
+}
+#endif /* SERIAL_FLASH_READ_AHEAD_EN==TRUE */
+
 /**
 ****************************************************************************************
 * @brief check whether flash is present
@@ -83,6 +83,13 @@ extern "C"{
 #define FLASH_CMD_DP            0xB9    /*!< DP (Deep Power Down) */
 #define FLASH_CMD_RDP           0xAB    /*!< RDP (Release form Deep Power Down) */
 
+/// Flash page size, the max data length of one read or write access
+#define FLASH_PAGE_SIZE         256
+
+#if (SERIAL_FLASH_READ_AHEAD_EN==TRUE) && (SERIAL_FLASH_DMA_EN==FALSE)
+#error "Serial flash read-ahead needs SERIAL_FLASH_DMA_EN"
+#endif
+
 //Flash setup duration after power on, unit is us.
 #define FLASH_SETUP_DUR_RD      20
 #define FLASH_SETUP_DUR_WR      200
@@ -165,6 +172,14 @@ extern void write_flash(uint32_t addr,const uint32_t *pBuf,uint32_t nbyte);
 extern void sector_erase_flash(uint32_t addr, uint32_t n);
 extern void block_erase_flash(uint32_t addr, uint32_t block_size, uint32_t n);
 extern uint32_t read_flash_id(void);
+#if SERIAL_FLASH_DMA_EN==TRUE
+extern void read_flash_dma(uint32_t addr, uint32_t *pBuf, uint32_t nByte, void (*callback)(void));
+extern bool is_flash_dma_busy(void);
+#endif
+#if SERIAL_FLASH_READ_AHEAD_EN==TRUE
+extern void read_flash_seq(uint32_t addr, uint8_t *pBuf, uint32_t nByte);
+extern void flash_read_ahead_reset(void);
+#endif
 
 // new function
 extern bool is_flash_present(void);
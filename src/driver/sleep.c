@@ -40,11 +40,28 @@
 #include "analog.h"
 #endif
 
+#if SLEEP_STAT_EN==TRUE
+#include <string.h>
+#if !defined(BLE_PRJ)
+    #error "Sleep statistics need the kernel time of BLE project"
+#endif
+#endif
+
 /*
  * MACRO DEFINITIONS
  ****************************************************************************************
  */
 
+/// Kernel time counter is 23 bits
+#define SLEEP_STAT_TIME_MASK    0x7FFFFF
+
+#if SLEEP_STAT_EN==TRUE
+/// Count the interrupts pending at wakeup
+#define SLEEP_STAT_WAKEUP(iconfig)  sleep_stat_wakeup(NVIC->ISPR[0] & (iconfig))
+#else
+#define SLEEP_STAT_WAKEUP(iconfig)
+#endif
+
 #if (defined(QN_T_VERSION))
     #define VREG12_A_SEL    VREG12_A_1_2
 #else
@@ -59,16 +76,40 @@
  * GLOBAL VARIABLE DEFINITIONS
  ****************************************************************************************
  */
-struct sleep_env_tag sleep_env = {QN_DEEP_SLEEP, 0, true, 0, 0};
+struct sleep_env_tag sleep_env = {QN_DEEP_SLEEP, 0, true, 0, 0, 0};
 volatile uint32_t PGCR1_restore;
 volatile uint8_t low_power_mode_en = 0;
 volatile uint32_t ahb_clock_flag = 0;
+/// Memory banks powered in active mode
+static uint32_t sleep_mem_active = QN_MEM_RETENTION;
+#if SLEEP_STAT_EN==TRUE
+struct sleep_stat_tag sleep_stat;
+#endif
 
 /*
  * LOCAL FUNCTION DEFINITIONS
  ****************************************************************************************
  */
 
+#if SLEEP_STAT_EN==TRUE
+/**
+ ****************************************************************************************
+ * @brief   Count the wakeup sources
+ * @param[in]   pending     interrupts pending at wakeup
+ ****************************************************************************************
+ */
+static void sleep_stat_wakeup(uint32_t pending)
+{
+    uint8_t i;
+
+    for (i = 0; pending != 0; i++, pending >>= 1) {
+        if (pending & 0x1) {
+            sleep_stat.wakeup[i]++;
+        }
+    }
+}
+#endif
+
 
 /*
  * EXPORTED FUNCTION DEFINITIONS
@@ -88,9 +129,18 @@ int usr_sleep(void)
     rt = sleep_get_pm();
 
     // If the BLE timer queue is not NULL or BLE event is exist, prevent entering into DEEPSLEEP mode
+    // No timer can wake up the chip from deep sleep, the 32K clock and the sleep timer are off
     if(rt == PM_DEEP_SLEEP && 
        (!ke_timer_empty() || !ble_evt_empty()))
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_KE_TIMER);
+        rt = PM_SLEEP;
+    }
+
+    // The 32K clock is off in deep sleep, the RTC and the sleep timer stop
+    if(rt == PM_DEEP_SLEEP && sleep_env.clk32k_user_bf)
+    {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_32K_CLK);
         rt = PM_SLEEP;
     }
 
@@ -99,17 +149,20 @@ int usr_sleep(void)
        && dev_get_bf())
     {
         // If any devices are still working, the chip cann't enter into SLEEP/DEEPSLEEP mode.
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_DEV);
         rt = PM_IDLE;
     }
 
     if ((rt >= PM_SLEEP) && (!gpio_sleep_allowed()))
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_GPIO);
         return PM_ACTIVE;
     }
 
 #if ACMP_WAKEUP_EN == TRUE
     if ((rt >= PM_SLEEP) && (!acmp_sleep_allowed()))
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_ACMP);
         return PM_ACTIVE;
     }
 #endif
@@ -120,10 +173,12 @@ int usr_sleep(void)
     
     if((rt >= PM_SLEEP) && (uart_tx_st == UART_TX_BUF_BUSY))
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_UART_TX);
         rt = PM_IDLE;
     }
     else if(uart_tx_st == UART_LAST_BYTE_ONGOING)
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_UART_TX);
         return PM_ACTIVE;    // If CLOCK OFF & POWER DOWN is disabled, return immediately
     }
 #endif
@@ -133,6 +188,7 @@ int usr_sleep(void)
         (  (eaci_env.tx_state!=EACI_STATE_TX_IDLE)              // Check EACI UART TX status
         || (eaci_env.rx_state!=EACI_STATE_RX_START)) )          // Check EACI UART RX status
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_HCI);
         rt = PM_IDLE;
     }
 
@@ -141,20 +197,24 @@ int usr_sleep(void)
     tx_st = uart_check_tx_free(QN_HCI_PORT);
     if ((rt >= PM_SLEEP) && (tx_st == UART_TX_BUF_BUSY))
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_HCI);
         rt = PM_IDLE;
     }
     else if (tx_st == UART_LAST_BYTE_ONGOING)
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_HCI);
         return PM_ACTIVE;    // If CLOCK OFF & POWER DOWN is disabled, return immediately
     }
     #elif (defined(CFG_HCI_SPI))
     tx_st = spi_check_tx_free(QN_HCI_PORT);
     if ((rt >= PM_SLEEP) && (tx_st == SPI_TX_BUF_BUSY))
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_HCI);
         rt = PM_IDLE;
     }
     else if (tx_st == SPI_LAST_BYTE_ONGOING)
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_HCI);
         return PM_ACTIVE;    // If CLOCK OFF & POWER DOWN is disabled, return immediately
     }
     #endif
@@ -172,6 +232,7 @@ int usr_sleep(void)
     }
     else if(rt > PM_ACTIVE)
     {
+        SLEEP_STAT_REFUSE(SLEEP_REFUSE_XTAL32);
         rt = PM_ACTIVE;
     }
 #endif
@@ -219,6 +280,34 @@ void sleep_init(void)
                             | SYSCON_MASK_DIS_MEM6
                             | SYSCON_MASK_DIS_MEM7),
                             QN_MEM_UNRETENTION);
+
+#if SLEEP_STAT_EN==TRUE
+    sleep_stat_reset();
+#endif
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Set the memory banks retained in sleep
+ * @param[in]    retention      MEM_BLOCK1 ~ MEM_BLOCK7 retained in sleep
+ * @param[in]    active         MEM_BLOCK1 ~ MEM_BLOCK7 powered in active mode only
+ * @description
+ *  This function is used to power down the memory banks not used by the application. The
+ *  retained banks keep their content in sleep, the active banks lose it, the other banks are
+ *  powered down all the time. Bank0 is always retained. It shall be called after sleep_init().
+ *****************************************************************************************
+ */
+void sleep_set_mem_retention(uint32_t retention, uint32_t active)
+{
+    retention &= 0xfe;
+    active = (active | retention) & 0xfe;
+
+    sleep_env.retention_modules = (sleep_env.retention_modules & ~0xfe) | retention;
+    sleep_mem_active = active;
+
+    // power on the banks in use before powering down the unused ones in sleep
+    syscon_SetPGCR1WithMask(QN_SYSCON, 0xfe, ~active & 0xfe);
+    syscon_SetPGCR0WithMask(QN_SYSCON, 0xfe, ~retention & 0xfe);
 }
 
 /**
@@ -233,6 +322,10 @@ void sleep_init(void)
  */
 void enter_sleep(enum SLEEP_MODE mode, uint32_t iconfig, void (*callback)(void))
 {
+#if SLEEP_STAT_EN==TRUE
+    uint32_t enter_time = ke_time();
+#endif
+
     if (mode == SLEEP_CPU_CLK_OFF) {
         // --------------------------------------------
         // cpu clock disable
@@ -250,6 +343,7 @@ void enter_sleep(enum SLEEP_MODE mode, uint32_t iconfig, void (*callback)(void))
 #endif
         // Wait For Interrupt
         __WFI();  // Enter sleep mode
+        SLEEP_STAT_WAKEUP(iconfig);
 
         // Wakeup when interrupt is triggered
         GLOBAL_INT_RESTORE();
@@ -314,6 +408,7 @@ void enter_sleep(enum SLEEP_MODE mode, uint32_t iconfig, void (*callback)(void))
         // Wait For Interrupt
         __WFI();  // Enter sleep mode
         // Wakeup when sleep timer, comparator or gpio is triggered
+        SLEEP_STAT_WAKEUP(iconfig);
 
         // Disable interrupt in the wakeup procedure.
         NVIC->ICER[0] = iconfig;
@@ -413,6 +508,7 @@ void enter_sleep(enum SLEEP_MODE mode, uint32_t iconfig, void (*callback)(void))
         // Wait For Interrupt
         __WFI();  // Enter sleep mode
         // Wakeup when sleep timer, comparator or gpio is triggered
+        SLEEP_STAT_WAKEUP(iconfig);
 
         // Disable interrupt in the wakeup procedure.
         NVIC->ICER[0] = iconfig;
@@ -454,8 +550,51 @@ void enter_sleep(enum SLEEP_MODE mode, uint32_t iconfig, void (*callback)(void))
     }
 #endif // QN_DEEP_SLEEP_EN
 
+#if SLEEP_STAT_EN==TRUE
+    if (mode < SLEEP_DEEP)
+    {
+        sleep_stat.entry[mode]++;
+        sleep_stat.residency[mode] += (ke_time() - enter_time) & SLEEP_STAT_TIME_MASK;
+    }
+    else if (mode == SLEEP_DEEP)
+    {
+        // The kernel time stops with the 32K clock in deep sleep
+        sleep_stat.entry[mode]++;
+    }
+#endif
 }
 
+#if SLEEP_STAT_EN==TRUE
+/**
+ ****************************************************************************************
+ * @brief  Reset sleep statistics
+ * @description
+ *  The sleep statistics count the entries and the time of each sleep mode in enter_sleep(),
+ *  the wakeup interrupts, and the reasons of refusing sleep in usr_sleep(). The time is
+ *  measured by the kernel time (10ms), the sum over many short sleeps is still unbiased.
+ *  The kernel time runs on the 32K clock, which is off in deep sleep: the deep sleep time
+ *  is neither in its residency nor in the elapsed time.
+ *****************************************************************************************
+ */
+void sleep_stat_reset(void)
+{
+    memset(&sleep_stat, 0, sizeof(sleep_stat));
+    sleep_stat.start = ke_time();
+}
+
+/**
+ ****************************************************************************************
+ * @brief  Get time since sleep statistics reset
+ * @return elapsed kernel time (10ms) without the deep sleep time, the active time is the
+ *  elapsed time less the residency of the other modes. The kernel time wraps in about 23 hours.
+ *****************************************************************************************
+ */
+uint32_t sleep_stat_elapsed(void)
+{
+    return (ke_time() - sleep_stat.start) & SLEEP_STAT_TIME_MASK;
+}
+#endif
+
 #if GPIO_WAKEUP_EN == TRUE
 /**
  ****************************************************************************************
@@ -685,7 +824,7 @@ void enter_low_power_mode(uint32_t en)
          | SYSCON_MASK_DIS_SAR_BUF
          ;
 
-    reg_pgcr1 |= (mask & (~QN_MEM_RETENTION));
+    reg_pgcr1 |= (mask & (~sleep_mem_active));
 
     // set 32k low power flag
     low_power_mode_en = 1;
@@ -92,6 +92,7 @@ extern "C"{
 #define PM_MASK_TIMER3_ACTIVE_BIT       (0x00004000)
 #define PM_MASK_PWM0_ACTIVE_BIT         (0x00008000)
 #define PM_MASK_PWM1_ACTIVE_BIT         (0x00010000)
+
 #define PM_POS_ADC_ACTIVE_BIT           0
 #define PM_POS_DMA_ACTIVE_BIT           1
 #define PM_POS_UART0_TX_ACTIVE_BIT      2
@@ -110,6 +111,9 @@ extern "C"{
 #define PM_POS_PWM0_ACTIVE_BIT          15
 #define PM_POS_PWM1_ACTIVE_BIT          16
 
+/// Users of the 32K clock, it is off in deep sleep
+#define CLK32K_MASK_BLE_TIME_BIT        (0x00000001)
+
 /// Wakeup by all of the system interrupt source
 #define WAKEUP_BY_ALL_IRQ_SOURCE   ( WAKEUP_BY_GPIO          \
                                    | WAKEUP_BY_ACMP0         \
@@ -159,6 +163,20 @@ enum SLEEP_MODE
     SLEEP_DEEP                  /*!< Deep Sleep */
 };
 
+/// Reason of refusing sleep in usr_sleep()
+enum SLEEP_REFUSE
+{
+    SLEEP_REFUSE_KE_TIMER = 0,  /*!< Kernel timer or BLE event pending, no deep sleep */
+    SLEEP_REFUSE_DEV,           /*!< Device active bit field is not 0 */
+    SLEEP_REFUSE_GPIO,          /*!< GPIO does not allow sleep */
+    SLEEP_REFUSE_ACMP,          /*!< Analog comparator does not allow sleep */
+    SLEEP_REFUSE_UART_TX,       /*!< Debug UART TX is busy */
+    SLEEP_REFUSE_HCI,           /*!< EACI UART/SPI is busy */
+    SLEEP_REFUSE_XTAL32,        /*!< 32k xtal is not ready */
+    SLEEP_REFUSE_32K_CLK,       /*!< A user of the 32K clock holds it, no deep sleep */
+    SLEEP_REFUSE_NUM
+};
+
 /// QN9020 wakeup source
 enum WAKEUP_SOURCE
 {                        
@@ -207,10 +225,30 @@ struct sleep_env_tag
 
     int         retention_modules;
     int         wakeup_by_sleeptimer;
+    uint32_t    clk32k_user_bf;
 };
 
 extern struct sleep_env_tag sleep_env;
 
+#if SLEEP_STAT_EN==TRUE
+/// Sleep statistics, times are in kernel time unit (10ms)
+struct sleep_stat_tag
+{
+    uint32_t    start;                          /*!< Kernel time of statistics reset */
+    uint32_t    entry[SLEEP_DEEP+1];            /*!< Entry count of each sleep mode */
+    uint32_t    residency[SLEEP_DEEP+1];        /*!< Time in each sleep mode, active is the rest, deep sleep is not timed */
+    uint32_t    refuse[SLEEP_REFUSE_NUM];       /*!< Sleep checks refused by each reason */
+    uint16_t    wakeup[32];                     /*!< Wakeup count of each interrupt number */
+};
+
+extern struct sleep_stat_tag sleep_stat;
+
+/// Count a refused sleep check
+#define SLEEP_STAT_REFUSE(reason)       (sleep_stat.refuse[(reason)]++)
+#else
+#define SLEEP_STAT_REFUSE(reason)
+#endif
+
 extern volatile uint32_t PGCR1_restore;
 extern volatile uint8_t low_power_mode_en;
 extern volatile uint32_t ahb_clock_flag;
@@ -279,6 +317,28 @@ __STATIC_INLINE uint32_t dev_get_bf(void)
     return sleep_env.dev_active_bf;
 }
 
+/**
+ ****************************************************************************************
+ * @brief   Hold the 32K clock, deep sleep is refused
+ * @param[in]   user_bf  bit field of the 32K clock users
+ ****************************************************************************************
+ */
+__STATIC_INLINE void clk32k_prevent_deep_sleep(uint32_t user_bf)
+{
+    sleep_env.clk32k_user_bf |= user_bf;
+}
+
+/**
+ ****************************************************************************************
+ * @brief   Release the 32K clock, deep sleep is allowed again
+ * @param[in]   user_bf  bit field of the 32K clock users
+ ****************************************************************************************
+ */
+__STATIC_INLINE void clk32k_allow_deep_sleep(uint32_t user_bf)
+{
+    sleep_env.clk32k_user_bf &= (~user_bf);
+}
+
 /**
  ****************************************************************************************
  * @brief  Exit low power mode
@@ -300,6 +360,7 @@ __STATIC_INLINE void exit_low_power_mode(void)
 
 extern int usr_sleep(void);
 extern void sleep_init(void);
+extern void sleep_set_mem_retention(uint32_t retention, uint32_t active);
 extern void enter_sleep(enum SLEEP_MODE mode, uint32_t iconfig, void (*callback)(void));
 #if GPIO_WAKEUP_EN == TRUE
 extern void wakeup_by_gpio(enum gpio_pin pin, enum gpio_wakeup_type type);
@@ -319,6 +380,10 @@ extern void wakeup_32k_xtal_start_timer(void);
 #endif
 
 extern void enter_low_power_mode(uint32_t en);
+#if SLEEP_STAT_EN==TRUE
+extern void sleep_stat_reset(void);
+extern uint32_t sleep_stat_elapsed(void);
+#endif
 extern void restore_from_low_power_mode(void (*callback)(void));
 
 
@@ -27,6 +27,9 @@
 #include "timer.h"
 #if ((CONFIG_ENABLE_DRIVER_TIMER0==TRUE || CONFIG_ENABLE_DRIVER_TIMER1==TRUE \
     || CONFIG_ENABLE_DRIVER_TIMER1==TRUE  || CONFIG_ENABLE_DRIVER_TIMER3==TRUE))
+#if TIMER_WHEEL_EN==TRUE
+#include "intc.h"
+#endif
 
 /*
  * GLOBAL VARIABLE DEFINITIONS
@@ -50,6 +53,20 @@ struct timer_env_tag timer2_env;
 struct timer_env_tag timer3_env;
 #endif
 
+#if TIMER_WHEEL_EN==TRUE
+///Timer wheel environment parameters
+struct timer_wheel_env_tag
+{
+    struct timer_wheel_tag  *head;  // timer of the nearest deadline
+    uint32_t                base;   // timer wheel time at cnt_ref
+    uint32_t                cnt_ref;// hardware counter value when the timer is started
+    bool                    running;
+};
+
+///Timer wheel environment variable
+static struct timer_wheel_env_tag timer_wheel_env;
+#endif
+
 /*
  * FUNCTION DEFINITIONS
  ****************************************************************************************
@@ -597,5 +614,212 @@ void timer_capture_config(QN_TIMER_TypeDef *TIMER, uint32_t cap_mode, uint32_t p
     }
 }
 
+#if TIMER_WHEEL_EN==TRUE
+/**
+ ****************************************************************************************
+ * @brief Insert a timer in deadline order, after the timers of the same deadline
+ * @param[in]    tmr            software timer
+ ****************************************************************************************
+ */
+static void timer_wheel_insert(struct timer_wheel_tag *tmr)
+{
+    struct timer_wheel_tag *prev = NULL;
+    struct timer_wheel_tag *p = timer_wheel_env.head;
+
+    // the deadlines are compared as signed difference, which is valid across wrap around
+    while ((p != NULL) && ((int32_t)(p->expire - tmr->expire) <= 0)) {
+        prev = p;
+        p = p->next;
+    }
+
+    tmr->prev = prev;
+    tmr->next = p;
+    if (p != NULL) {
+        p->prev = tmr;
+    }
+    if (prev != NULL) {
+        prev->next = tmr;
+    }
+    else {
+        timer_wheel_env.head = tmr;
+    }
+    tmr->active = true;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Remove a timer from the timer wheel
+ * @param[in]    tmr            software timer
+ ****************************************************************************************
+ */
+static void timer_wheel_remove(struct timer_wheel_tag *tmr)
+{
+    if (tmr->prev != NULL) {
+        tmr->prev->next = tmr->next;
+    }
+    else {
+        timer_wheel_env.head = tmr->next;
+    }
+    if (tmr->next != NULL) {
+        tmr->next->prev = tmr->prev;
+    }
+    tmr->next = NULL;
+    tmr->prev = NULL;
+    tmr->active = false;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Get the timer wheel time
+ * @return time in micro seconds, it does not advance while the timer wheel is empty
+ ****************************************************************************************
+ */
+uint32_t timer_wheel_time(void)
+{
+    if (timer_wheel_env.running) {
+        return timer_wheel_env.base + (timer_timer_GetCNT(TIMER_WHEEL_TIMER) - timer_wheel_env.cnt_ref);
+    }
+    return timer_wheel_env.base;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Program the hardware timer to the nearest deadline, stop it if no timer is left
+ ****************************************************************************************
+ */
+static void timer_wheel_program(void)
+{
+    struct timer_wheel_tag *head = timer_wheel_env.head;
+
+    if (head == NULL) {
+        if (timer_wheel_env.running) {
+            // stop the timer to allow sleep
+            timer_wheel_env.base = timer_wheel_time();
+            timer_wheel_env.running = false;
+            timer_enable(TIMER_WHEEL_TIMER, MASK_DISABLE);
+        }
+        return;
+    }
+
+    if (!timer_wheel_env.running) {
+        // free running on the full 32-bit range, the deadline is given by the compare register
+        timer_timer_SetTOPR(TIMER_WHEEL_TIMER, 0xFFFFFFFF);
+        timer_timer_SetCR(TIMER_WHEEL_TIMER, CLK_PSCL
+                                           | (TIMER_WHEEL_PSCAL << TIMER_POS_PSCL)
+                                           | TIMER_MASK_OCIE
+                                           | FREE_RUNNING_MOD);
+        timer_enable(TIMER_WHEEL_TIMER, MASK_ENABLE);
+        timer_wheel_env.cnt_ref = timer_timer_GetCNT(TIMER_WHEEL_TIMER);
+        timer_wheel_env.running = true;
+    }
+
+    timer_timer_SetCCR(TIMER_WHEEL_TIMER, timer_wheel_env.cnt_ref + (head->expire - timer_wheel_env.base));
+
+    // the counter may have passed the compare value already
+    if ((int32_t)(head->expire - timer_wheel_time()) < TIMER_WHEEL_MIN_US) {
+        NVIC_SetPendingIRQ(TIMER_WHEEL_IRQn);
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief Timer wheel interrupt callback, call the expired timers
+ ****************************************************************************************
+ */
+static void timer_wheel_handler(void)
+{
+    struct timer_wheel_tag *tmr;
+    uint32_t now = timer_wheel_time();
+
+    while (((tmr = timer_wheel_env.head) != NULL) && ((int32_t)(tmr->expire - now) <= 0)) {
+        timer_wheel_remove(tmr);
+        if (tmr->period) {
+            // reload from the deadline to keep the period without drift
+            tmr->expire += tmr->period;
+            timer_wheel_insert(tmr);
+        }
+        tmr->callback(tmr);
+        now = timer_wheel_time();
+    }
+
+    timer_wheel_program();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Initialize the timer wheel
+ * @description
+ *  Timer wheel multiplexes any number of software timers on one hardware timer. The
+ *  timers are kept in deadline order and only the nearest deadline is programmed to
+ *  the compare register, so the interrupt occurs once per expiry. The hardware timer
+ *  is stopped when there is no timer, and then it does not prevent sleep.
+ * @note
+ *  While any timer is active, Timer1 runs and holds PM_MASK_TIMER1_ACTIVE_BIT: the chip
+ *  does not enter sleep, even for a long deadline. Use the kernel timer for the delays
+ *  during which the chip shall sleep.
+ ****************************************************************************************
+ */
+void timer_wheel_init(void)
+{
+    timer_wheel_env.head = NULL;
+    timer_wheel_env.base = 0;
+    timer_wheel_env.running = false;
+
+    timer_init(TIMER_WHEEL_TIMER, timer_wheel_handler);
+}
+
+/**
+ ****************************************************************************************
+ * @brief Start a software timer
+ * @param[in]    tmr            software timer, restarted if it is active
+ * @param[in]    delay          delay of the first expiry in micro seconds, less than 0x80000000
+ * @param[in]    period         reload period in micro seconds, 0 for one-shot timer
+ * @param[in]    callback       callback of timer expiry, called in interrupt
+ * @description
+ *  The timer is inserted in deadline order, the cost is linear in the active timers of an
+ *  earlier deadline. Stop and expiry cost constant time.
+ ****************************************************************************************
+ */
+void timer_wheel_start(struct timer_wheel_tag *tmr, uint32_t delay, uint32_t period,
+                       void (*callback)(struct timer_wheel_tag *tmr))
+{
+    GLOBAL_INT_DISABLE();
+
+    if (tmr->active) {
+        timer_wheel_remove(tmr);
+    }
+    tmr->expire = timer_wheel_time() + delay;
+    tmr->period = period;
+    tmr->callback = callback;
+    timer_wheel_insert(tmr);
+
+    if (timer_wheel_env.head == tmr) {
+        timer_wheel_program();
+    }
+
+    GLOBAL_INT_RESTORE();
+}
+
+/**
+ ****************************************************************************************
+ * @brief Stop a software timer
+ * @param[in]    tmr            software timer
+ ****************************************************************************************
+ */
+void timer_wheel_stop(struct timer_wheel_tag *tmr)
+{
+    GLOBAL_INT_DISABLE();
+
+    if (tmr->active) {
+        timer_wheel_remove(tmr);
+        if (timer_wheel_env.head == NULL) {
+            timer_wheel_program();
+        }
+    }
+
+    GLOBAL_INT_RESTORE();
+}
+#endif /* TIMER_WHEEL_EN==TRUE */
+
 #endif /* CONFIG_ENABLE_DRIVER_TIMER==TRUE */
 /// @} TIMER
@@ -111,6 +111,28 @@
 /// Timer input capture pin configuration
 #define TIMER_INCAP_PIN_CFG             INCAP_PIN0
 
+#if TIMER_WHEEL_EN==TRUE
+/// Hardware timer of the timer wheel, shall be a 32-bit timer
+#define TIMER_WHEEL_TIMER               QN_TIMER1
+/// Interrupt of the timer wheel hardware timer
+#define TIMER_WHEEL_IRQn                TIMER1_IRQn
+/// Timer wheel prescaler value, the timer wheel counts in micro seconds
+#define TIMER_WHEEL_PSCAL               (TIMER_CLK(TIMER_DIV) / 1000000 - 1)
+/// Deadline closer than this is handled at once, as the compare match may be missed
+#define TIMER_WHEEL_MIN_US              2
+
+#if (CONFIG_ENABLE_DRIVER_TIMER1!=TRUE || CONFIG_TIMER1_DEFAULT_IRQHANDLER!=TRUE \
+    || CONFIG_TIMER1_ENABLE_INTERRUPT!=TRUE || TIMER1_CALLBACK_EN!=TRUE)
+#error "Timer wheel needs the Timer1 driver with interrupt and callback"
+#endif
+#if (__TIMER_CLK < 1000000) || (__TIMER_CLK % 1000000)
+#error "Timer wheel needs a timer clock of integer MHz"
+#endif
+#if (QN_32K_RCO)
+#error "Timer wheel can not share Timer1 with the 32k RCO calibration (clock_32k_correction_enable)"
+#endif
+#endif
+
 
 /*
  * ENUMERATION DEFINITIONS
@@ -168,6 +190,17 @@ struct timer_env_tag
     void        (*callback)(void);              /*!< The callback of timer interrupt */
 };
 
+///Software timer of the timer wheel, allocated by the user
+struct timer_wheel_tag
+{
+    struct timer_wheel_tag  *next;              /*!< Next timer in deadline order */
+    struct timer_wheel_tag  *prev;              /*!< Previous timer in deadline order */
+    uint32_t    expire;                         /*!< Deadline in micro seconds of the timer wheel time */
+    uint32_t    period;                         /*!< Reload period in micro seconds, 0 for one-shot timer */
+    void        (*callback)(struct timer_wheel_tag *tmr); /*!< The callback of timer expiry, called in interrupt */
+    bool        active;                         /*!< Timer is in the timer wheel */
+};
+
 
 /*
  * FUNCTION DEFINITIONS
@@ -350,6 +383,13 @@ extern void timer_init(QN_TIMER_TypeDef *TIMER, void (*callback)(void));
 extern void timer_config(QN_TIMER_TypeDef *TIMER, uint32_t pscal, uint32_t count);
 extern void timer_pwm_config(QN_TIMER_TypeDef *TIMER, uint32_t pscal, uint32_t periodcount, uint32_t pulsecount);
 extern void timer_capture_config(QN_TIMER_TypeDef *TIMER, uint32_t cap_mode, uint32_t pscal, uint32_t count, uint32_t event_num);
+#if TIMER_WHEEL_EN==TRUE
+extern void timer_wheel_init(void);
+extern void timer_wheel_start(struct timer_wheel_tag *tmr, uint32_t delay, uint32_t period,
+                              void (*callback)(struct timer_wheel_tag *tmr));
+extern void timer_wheel_stop(struct timer_wheel_tag *tmr);
+extern uint32_t timer_wheel_time(void);
+#endif
 
 
 /// @} TIMER
@@ -59,7 +59,13 @@
  ****************************************************************************************
  */
 typedef void *(*p_ke_malloc)(uint32_t size);
+#if (defined(CFG_HEAP_MON))
+// The heap monitor counts the allocations
+extern void *app_heap_malloc(uint32_t size);
+#define ke_malloc app_heap_malloc
+#else
 #define ke_malloc ((p_ke_malloc)(_ke_malloc))
+#endif
 
 /**
  ****************************************************************************************
@@ -73,7 +79,12 @@ typedef void *(*p_ke_malloc)(uint32_t size);
  ****************************************************************************************
  */
 typedef void (*p_ke_free)(void *mem_ptr);
+#if (defined(CFG_HEAP_MON))
+extern void app_heap_free(void *mem_ptr);
+#define ke_free app_heap_free
+#else
 #define ke_free ((p_ke_free)(_ke_free))
+#endif
 
 #endif // _KE_MEM_H_
 
@@ -223,7 +223,14 @@ __INLINE void * ke_msg2param(struct ke_msg const *msg)
  */
 typedef void* (*p_ke_msg_alloc)(ke_msg_id_t const id, ke_task_id_t const dest_id,
                    ke_task_id_t const src_id, uint16_t const param_len);
+#if (defined(CFG_HEAP_MON))
+// The heap monitor counts the allocations
+extern void *app_heap_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                   ke_task_id_t const src_id, uint16_t const param_len);
+#define  ke_msg_alloc app_heap_msg_alloc
+#else
 #define  ke_msg_alloc ((p_ke_msg_alloc)(_ke_msg_alloc))
+#endif
 
 /**
  ****************************************************************************************
@@ -242,7 +249,13 @@ typedef void* (*p_ke_msg_alloc)(ke_msg_id_t const id, ke_task_id_t const dest_id
  ****************************************************************************************
  */
 typedef void (*p_ke_msg_send)(void const *_para_ptr);
+#if (defined(CFG_MSG_PROF))
+// The message profiler records the send time
+extern void app_prof_msg_send(void const *param_ptr);
+#define ke_msg_send app_prof_msg_send
+#else
 #define ke_msg_send ((p_ke_msg_send)(_ke_msg_send))
+#endif
 
 /**
  ****************************************************************************************
@@ -302,7 +315,13 @@ typedef void (*p_ke_msg_forward)(void const *param_ptr, ke_task_id_t const dest_
  ****************************************************************************************
  */
 typedef void (*p_ke_msg_free)(struct ke_msg const *param);
+#if (defined(CFG_MSG_PROF))
+// The message profiler drops the send time of the message
+extern void app_prof_msg_free(struct ke_msg const *msg);
+#define ke_msg_free app_prof_msg_free
+#else
 #define ke_msg_free ((p_ke_msg_free)(_ke_msg_free))
+#endif
 
 /// @} MSG
 
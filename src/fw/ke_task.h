@@ -210,7 +210,13 @@ typedef int (*p_ke_msg_save)(ke_msg_id_t const msgid, void const *param,
  ****************************************************************************************
  */
 typedef void (*p_task_desc_register)(uint8_t task_id, struct ke_task_desc task_desc);
+#if (defined(CFG_MSG_PROF))
+// The message profiler hooks the message handlers of the task
+extern void app_prof_task_register(uint8_t task_id, struct ke_task_desc task_desc);
+#define task_desc_register app_prof_task_register
+#else
 #define task_desc_register ((p_task_desc_register)(_task_desc_register))
+#endif
 
 /// @} TASK
 
@@ -42,6 +42,12 @@
 #include "sleep.h"
 #include "led.h"
 #include "rng.h"
+#if QN_HEAP_MON
+    #include "app_heap.h"
+#endif
+#if QN_MEM_MAP
+    #include "app_mem.h"
+#endif
 
 /*
  * LOCAL VARIABLES
@@ -50,8 +56,13 @@
 
 static uint8_t ble_heap[BLE_HEAP_SIZE];
 #if QN_NVDS_WRITE
+#if QN_MEM_MAP
+// Only used while writing NVDS, it does not need retention
+APP_MEM_NORETENTION static uint8_t nvds_tmp_buf[NVDS_TMP_BUF_SIZE];
+#else
 static uint8_t nvds_tmp_buf[NVDS_TMP_BUF_SIZE];
 #endif
+#endif
 
 #ifdef CFG_DBG_PRINT
 /**
@@ -168,6 +179,11 @@ int main(void)
     // Check to go normal work mode or test mode.
     // If the input of test control pin is low level, the program will enter into test mode, otherwise the program will
     // enter into work mode which is defined in the user configuration file.
+#if QN_HEAP_MON
+    // Paint the heap before use to find the peak usage
+    app_heap_paint(ble_heap, BLE_HEAP_SIZE);
+#endif
+
 #if (defined(QN_TEST_CTRL_PIN))
     if(gpio_read_pin(QN_TEST_CTRL_PIN) == GPIO_HIGH)
     {
@@ -203,6 +219,9 @@ int main(void)
     usr_init();
 
     sleep_init();
+#if QN_MEM_MAP
+    app_mem_retention_config();
+#endif
     wakeup_by_sleep_timer(__32K_TYPE);
 
     GLOBAL_INT_START();
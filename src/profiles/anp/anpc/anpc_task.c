@@ -992,6 +992,47 @@ static int gatt_handle_value_ntf_handler(ke_msg_id_t const msgid,
     return (KE_MSG_CONSUMED);
 }
 
+/**
+ ****************************************************************************************
+ * @brief Handles reception of the @ref ANPC_DISABLE_REQ message.
+ * The profile is disabled on the connection, the peer database can be discovered again.
+ * A procedure in progress is completed first.
+ * @param[in] msgid     Id of the message received.
+ * @param[in] param     Pointer to the parameters of the message.
+ * @param[in] dest_id   ID of the receiving task instance
+ * @param[in] src_id    ID of the sending task instance.
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+static int anpc_disable_req_handler(ke_msg_id_t const msgid,
+                                    struct anpc_disable_req const *param,
+                                    ke_task_id_t const dest_id,
+                                    ke_task_id_t const src_id)
+{
+    // Message status
+    uint8_t msg_status = KE_MSG_CONSUMED;
+    // Get the address of the environment
+    struct anpc_env_tag *anpc_env;
+
+    if (ke_state_get(dest_id) == ANPC_BUSY)
+    {
+        // Wait for the end of the procedure
+        msg_status = KE_MSG_SAVED;
+    }
+    else if (ke_state_get(dest_id) == ANPC_CONNECTED)
+    {
+        anpc_env = PRF_CLIENT_GET_ENV(dest_id, anpc);
+
+        // Unregister from GATT
+        prf_unregister_atthdl2gatt(&anpc_env->con_info, &anpc_env->ans.svc);
+
+        PRF_CLIENT_DISABLE_IND_SEND(anpc_envs, dest_id, ANPC);
+    }
+    // else ignore the message
+
+    return (int)msg_status;
+}
+
 /**
  ****************************************************************************************
  * @brief Disconnection indication to ANPC.
@@ -1033,6 +1074,7 @@ static int gap_discon_cmp_evt_handler(ke_msg_id_t const msgid,
 const struct ke_msg_handler anpc_default_state[] =
 {
     {ANPC_ENABLE_CMD,               (ke_msg_func_t)anpc_enable_cmd_handler},
+    {ANPC_DISABLE_REQ,              (ke_msg_func_t)anpc_disable_req_handler},
     {ANPC_READ_CMD,                 (ke_msg_func_t)anpc_read_cmd_handler},
     {ANPC_WRITE_CMD,                (ke_msg_func_t)anpc_write_cmd_handler},
 
@@ -90,6 +90,9 @@ enum anpc_msg_ids
 
     /// Complete Event Information
     ANPC_CMP_EVT,
+
+    /// Disable the profile role without disconnection
+    ANPC_DISABLE_REQ,
 };
 
 /// Operation Codes
@@ -151,6 +154,13 @@ struct anpc_enable_cmd
     struct anpc_ans_content ans;
 };
 
+/// Parameters of the @ref ANPC_DISABLE_REQ message
+struct anpc_disable_req
+{
+    /// Connection handle
+    uint16_t conhdl;
+};
+
 /// Parameters of the @ref ANPC_READ_CMD message
 struct anpc_read_cmd
 {
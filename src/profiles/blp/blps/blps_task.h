@@ -92,6 +92,8 @@ enum
     BLPS_MEAS_SEND_REQ,
     ///Send blood pressure measurement value confirm to APP so stable values can be erased
     ///if correctly sent.
+    ///With PRF_NTF_GET_DATA_CFM and QN_MULTI_NOTIFICATION_IN_ONE_EVENT, a notification is confirmed
+    ///twice: GATT_NOTIFY_GET_DATA when GATT takes the value, then the completion status.
     BLPS_MEAS_SEND_CFM,
     ///Inform APP of new configuration value
     BLPS_CFG_INDNTF_IND,
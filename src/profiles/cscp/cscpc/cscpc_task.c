@@ -1134,6 +1134,47 @@ static int gatt_handle_value_ind_handler(ke_msg_id_t const msgid,
     return (KE_MSG_CONSUMED);
 }
 
+/**
+ ****************************************************************************************
+ * @brief Handles reception of the @ref CSCPC_DISABLE_REQ message.
+ * The profile is disabled on the connection, the peer database can be discovered again.
+ * A procedure in progress is completed first.
+ * @param[in] msgid     Id of the message received.
+ * @param[in] param     Pointer to the parameters of the message.
+ * @param[in] dest_id   ID of the receiving task instance
+ * @param[in] src_id    ID of the sending task instance.
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+static int cscpc_disable_req_handler(ke_msg_id_t const msgid,
+                                     struct cscpc_disable_req const *param,
+                                     ke_task_id_t const dest_id,
+                                     ke_task_id_t const src_id)
+{
+    // Message status
+    uint8_t msg_status = KE_MSG_CONSUMED;
+    // Get the address of the environment
+    struct cscpc_env_tag *cscpc_env;
+
+    if (ke_state_get(dest_id) == CSCPC_BUSY)
+    {
+        // Wait for the end of the procedure
+        msg_status = KE_MSG_SAVED;
+    }
+    else if (ke_state_get(dest_id) == CSCPC_CONNECTED)
+    {
+        cscpc_env = PRF_CLIENT_GET_ENV(dest_id, cscpc);
+
+        // Unregister from GATT
+        prf_unregister_atthdl2gatt(&cscpc_env->con_info, &cscpc_env->cscs.svc);
+
+        PRF_CLIENT_DISABLE_IND_SEND(cscpc_envs, dest_id, CSCPC);
+    }
+    // else ignore the message
+
+    return (int)msg_status;
+}
+
 /**
  ****************************************************************************************
  * @brief Disconnection indication to ANPC.
@@ -1182,6 +1223,7 @@ static int gap_discon_cmp_evt_handler(ke_msg_id_t const msgid,
 const struct ke_msg_handler cscpc_default_state[] =
 {
     {CSCPC_ENABLE_CMD,              (ke_msg_func_t)cscpc_enable_cmd_handler},
+    {CSCPC_DISABLE_REQ,             (ke_msg_func_t)cscpc_disable_req_handler},
     {CSCPC_READ_CMD,                (ke_msg_func_t)cscpc_read_cmd_handler},
     {CSCPC_CFG_NTFIND_CMD,          (ke_msg_func_t)cscpc_cfg_ntfind_cmd_handler},
     {CSCPC_CTNL_PT_CFG_CMD,         (ke_msg_func_t)cscpc_ctnl_pt_cfg_cmd_handler},
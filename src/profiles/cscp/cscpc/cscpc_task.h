@@ -96,6 +96,9 @@ enum cscpc_msg_ids
 
     /// Procedure Timeout Timer
     CSCPC_TIMEOUT_TIMER_IND,
+
+    /// Disable the profile role without disconnection
+    CSCPC_DISABLE_REQ,
 };
 
 /// Operation Codes
@@ -136,6 +139,13 @@ struct cscpc_enable_cmd
     struct cscpc_cscs_content cscs;
 };
 
+/// Parameters of the @ref CSCPC_DISABLE_REQ message
+struct cscpc_disable_req
+{
+    /// Connection handle
+    uint16_t conhdl;
+};
+
 /// Parameters of the @ref CSCPC_READ_CMD message
 struct cscpc_read_cmd
 {
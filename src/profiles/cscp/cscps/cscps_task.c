@@ -34,7 +34,6 @@
 #include "cscps.h"
 #include "cscps_task.h"
 #include "prf_utils.h"
-#include <math.h>
 
 /*
  *  RUNNING SPEED AND CADENCE SERVICE ATTRIBUTES
@@ -393,17 +392,10 @@ static int cscps_ntf_csc_meas_cmd_handler(ke_msg_id_t const msgid,
             if (CSCPS_IS_PRESENT(param->flags, CSCP_MEAS_WHEEL_REV_DATA_PRESENT))
             {
                 // Update the cumulative wheel revolutions value stored in the environment
-                if (param->wheel_rev < 0)
+                // The value shall not decrement below zero
+                if ((param->wheel_rev < 0) && ((uint32_t)(-param->wheel_rev) > cscps_env.wheel_revol))
                 {
-                    // The value shall not decrement below zero
-                    if (fabs(param->wheel_rev) > cscps_env.wheel_revol)
-                    {
-                        cscps_env.wheel_revol = 0;
-                    }
-                    else
-                    {
-                        cscps_env.wheel_revol += param->wheel_rev;
-                    }
+                    cscps_env.wheel_revol = 0;
                 }
                 else
                 {
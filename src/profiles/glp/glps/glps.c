@@ -394,6 +394,108 @@ uint8_t glps_send_racp_rsp(struct glp_racp_rsp * racp_rsp,
     return status;
 }
 
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+struct glps_ntf *glps_ntf_alloc(uint8_t idx, uint8_t last)
+{
+    struct glps_ntf *ntf = &glps_env.ntf[(glps_env.ntf_head + glps_env.ntf_nb) % GLPS_NTF_QUEUE_SIZE];
+
+    glps_env.ntf_nb++;
+    ntf->idx = idx;
+    ntf->last = last;
+
+    return ntf;
+}
+
+void glps_ntf_send(void)
+{
+    struct glps_ntf *ntf;
+
+    // GATT copies the value from the database when it gets the data
+    if(GLPS_IS(NTF_GET_DATA) || (glps_env.ntf_sent == glps_env.ntf_nb))
+    {
+        return;
+    }
+
+    ntf = &glps_env.ntf[(glps_env.ntf_head + glps_env.ntf_sent) % GLPS_NTF_QUEUE_SIZE];
+    attsdb_att_set_value(GLPS_HANDLE(ntf->idx), ntf->length, ntf->value);
+
+    //Send notification through GATT
+    struct gatt_notify_req * req = KE_MSG_ALLOC(GATT_NOTIFY_REQ, TASK_GATT,
+            TASK_GLPS, gatt_notify_req);
+
+    req->conhdl  = glps_env.con_info.conhdl;
+    req->charhdl = GLPS_HANDLE(ntf->idx);
+
+    ke_msg_send(req);
+
+    glps_env.ntf_sent++;
+    GLPS_SET(NTF_GET_DATA);
+}
+
+void glps_ntf_cmp(uint8_t status)
+{
+    uint8_t last;
+    uint8_t cmp_nb = 0;
+    uint8_t i;
+
+    if(glps_env.ntf_sent == 0)
+    {
+        return;
+    }
+
+    last = glps_env.ntf[glps_env.ntf_head].last;
+    glps_env.ntf_head = (glps_env.ntf_head + 1) % GLPS_NTF_QUEUE_SIZE;
+    glps_env.ntf_sent--;
+    glps_env.ntf_nb--;
+
+    if(last || (status != PRF_ERR_OK))
+    {
+        cmp_nb++;
+    }
+
+    if(status != PRF_ERR_OK)
+    {
+        // the context of the failed measurement completes with it
+        if(!last && (glps_env.ntf_nb != 0))
+        {
+            glps_env.ntf[glps_env.ntf_head].last = 0;
+        }
+
+        // drop the notifications not requested yet, their measurements complete with the error
+        for(i = glps_env.ntf_sent; i < glps_env.ntf_nb; i++)
+        {
+            if(glps_env.ntf[(glps_env.ntf_head + i) % GLPS_NTF_QUEUE_SIZE].last)
+            {
+                cmp_nb++;
+            }
+        }
+        glps_env.ntf_nb = glps_env.ntf_sent;
+        GLPS_CLEAR(NTF_GET_DATA);
+    }
+
+    if(glps_env.ntf_nb == 0)
+    {
+        // allow to send other measurements
+        GLPS_CLEAR(SENDING_MEAS);
+    }
+
+    // send completed information to APP task, one per measurement
+    for(i = 0; i < cmp_nb; i++)
+    {
+        struct glps_req_cmp_evt * cmp_evt = KE_MSG_ALLOC(GLPS_REQ_CMP_EVT, glps_env.con_info.appid,
+                TASK_GLPS, glps_req_cmp_evt);
+
+        cmp_evt->conhdl     = glps_env.con_info.conhdl;
+        cmp_evt->request    = GLPS_SEND_MEAS_REQ_NTF_CMP;
+        cmp_evt->status     = status;
+
+        ke_msg_send(cmp_evt);
+    }
+
+    glps_ntf_send();
+}
+#endif
+
 void glps_disable(uint8_t status)
 {
     //Disable GLS in database
@@ -66,6 +66,15 @@
 #define GLPS_MANDATORY_MASK                (0x1F8F)
 #define GLPS_MEAS_CTX_PRES_MASK            (0x0070)
 
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+/// Measurement and context notifications queued in the profile, at most one per tx buffer
+#ifndef GLPS_NTF_QUEUE_SIZE
+#define GLPS_NTF_QUEUE_SIZE                (8)
+#endif
+/// Measurements the application can send before the completion of the first one
+#define GLPS_MEAS_QUEUE_NB                 (GLPS_NTF_QUEUE_SIZE / 2)
+#endif
+
 /*
  * MACROS
  ****************************************************************************************
@@ -175,6 +184,8 @@ enum
     GLPS_SENDING_MEAS,
     /// Measurement context sent
     GLPS_MEAS_CTX_SENT,
+    /// Notification value not taken by GATT yet
+    GLPS_NTF_GET_DATA,
 };
 
 /*
@@ -183,6 +194,21 @@ enum
  */
 
 
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+/// Packed measurement or context notification
+struct glps_ntf
+{
+    /// Value attribute index
+    uint8_t idx;
+    /// Last notification of the measurement
+    uint8_t last;
+    /// Packed value length
+    uint8_t length;
+    /// Packed value
+    uint8_t value[GLP_MEAS_MAX_LEN];
+};
+#endif
+
 /// Glucose Profile Sensor environment variable
 struct glps_env_tag
 {
@@ -200,6 +226,17 @@ struct glps_env_tag
 
     ///Event (notification/indication) configuration
     uint8_t evt_cfg;
+
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+    ///Notification queue
+    struct glps_ntf ntf[GLPS_NTF_QUEUE_SIZE];
+    ///Oldest notification not completed
+    uint8_t ntf_head;
+    ///Notifications queued
+    uint8_t ntf_nb;
+    ///Notifications requested to GATT, from the oldest one
+    uint8_t ntf_sent;
+#endif
 };
 
 
@@ -296,6 +333,35 @@ uint8_t glps_pack_racp_rsp(uint8_t *packed_val,
 uint8_t glps_send_racp_rsp(struct glp_racp_rsp * racp_rsp,
                            ke_task_id_t racp_ind_src);
 
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+/**
+ ****************************************************************************************
+ * @brief Allocate a notification at the end of the queue
+ * @param[in] idx Value attribute index
+ * @param[in] last Last notification of the measurement
+ * @return Notification to pack
+ ****************************************************************************************
+ */
+struct glps_ntf *glps_ntf_alloc(uint8_t idx, uint8_t last);
+
+/**
+ ****************************************************************************************
+ * @brief Request the next queued notification to GATT, once GATT took the previous value
+ ****************************************************************************************
+ */
+void glps_ntf_send(void);
+
+/**
+ ****************************************************************************************
+ * @brief Complete the oldest notification, inform the application at the end of a
+ * measurement. On error the notifications not requested to GATT are dropped, each dropped
+ * measurement completes with the error.
+ * @param[in] status Notification status
+ ****************************************************************************************
+ */
+void glps_ntf_cmp(uint8_t status);
+#endif
+
 /**
  ****************************************************************************************
  * @brief Disable actions grouped in getting back to IDLE and sending configuration to
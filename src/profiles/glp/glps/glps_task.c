@@ -216,6 +216,11 @@ static int glps_enable_req_handler(ke_msg_id_t const msgid,
             // No RACP at service start.
             GLPS_CLEAR(RACP_ON_GOING);
             GLPS_CLEAR(SENDING_MEAS);
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+            GLPS_CLEAR(NTF_GET_DATA);
+            glps_env.ntf_nb = 0;
+            glps_env.ntf_sent = 0;
+#endif
 
             // Configure Glucose Measuremment IND Cfg in DB
             if(param->con_type == PRF_CON_NORMAL)
@@ -308,8 +313,13 @@ static int glps_meas_send_req_handler(ke_msg_id_t const msgid,
 
     if(param->conhdl == glps_env.con_info.conhdl)
     {
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+        // notification queue full
+        if((glps_env.ntf_nb + ((msgid == GLPS_SEND_MEAS_WITH_CTX_REQ) ? 2 : 1)) > GLPS_NTF_QUEUE_SIZE)
+#else
         // device already sending a measurement
         if(GLPS_IS(SENDING_MEAS))
+#endif
         {
             //Cannot send another measurement in parallel
             status = (PRF_ERR_REQ_DISALLOWED);
@@ -335,6 +345,25 @@ static int glps_meas_send_req_handler(ke_msg_id_t const msgid,
                 status = (PRF_ERR_NTF_DISABLED);
 
             }
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+            else
+            {
+                struct glps_ntf *ntf;
+
+                // pack the values in the queue, they are notified back to back
+                ntf = glps_ntf_alloc(GLS_IDX_MEAS_VAL, (msgid == GLPS_SEND_MEAS_WITHOUT_CTX_REQ));
+                ntf->length = glps_pack_meas_value(ntf->value, &(param->meas), param->seq_num);
+
+                if(msgid == GLPS_SEND_MEAS_WITH_CTX_REQ)
+                {
+                    ntf = glps_ntf_alloc(GLS_IDX_MEAS_CTX_VAL, true);
+                    ntf->length = glps_pack_meas_ctx_value(ntf->value, &(param->ctx),
+                                                           param->seq_num);
+                }
+
+                glps_ntf_send();
+            }
+#else
             else
             {
                 struct atts_elmt * att_elmt;
@@ -381,6 +410,7 @@ static int glps_meas_send_req_handler(ke_msg_id_t const msgid,
                     GLPS_CLEAR(MEAS_CTX_SENT);
                 }
             }
+#endif
         }
     }
     else
@@ -393,6 +423,9 @@ static int glps_meas_send_req_handler(ke_msg_id_t const msgid,
     if(status != PRF_ERR_OK)
     {
         // allow to send other measurements
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+        if(glps_env.ntf_nb == 0)
+#endif
         GLPS_CLEAR(SENDING_MEAS);
 
         // send completed information to APP task that contains error status
@@ -748,9 +781,16 @@ static int gatt_notify_cmp_evt_handler(ke_msg_id_t const msgid,
 {
 #if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)  
     if(param->status == GATT_NOTIFY_GET_DATA)
-        return (KE_MSG_CONSUMED);        
-#endif
-
+    {
+        // the value is taken, the next one can be written in the database
+        GLPS_CLEAR(NTF_GET_DATA);
+        glps_ntf_send();
+    }
+    else
+    {
+        glps_ntf_cmp(param->status);
+    }
+#else
 
     /* send message indication if an error occurs,
      * or if all notification complete event has been received
@@ -772,6 +812,7 @@ static int gatt_notify_cmp_evt_handler(ke_msg_id_t const msgid,
 
         ke_msg_send(cmp_evt);
     }
+#endif
 
     return (KE_MSG_CONSUMED);
 }
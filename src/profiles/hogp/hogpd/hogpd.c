@@ -32,6 +32,8 @@
 #include "atts_util.h"
 #include "hogpd.h"
 #include "hogpd_task.h"
+#include "lib.h"
+#include "bletime.h"
 
 /*
  * HIDS ATTRIBUTES DEFINITION
@@ -258,32 +260,96 @@ void hogpd_init_ntf_cfg(uint16_t ntf_cfg, uint16_t handle, uint8_t con_type,
     attsdb_att_set_value(handle, sizeof(uint16_t), (uint8_t *)&value);
 }
 
+/**
+ ****************************************************************************************
+ * @brief Get the attribute value handle of a report
+ ****************************************************************************************
+ */
+static uint16_t hogpd_ntf_handle(uint8_t hids_nb, uint8_t char_code, uint8_t report_nb)
+{
+    return hogpd_env.shdl[hids_nb] + hogpd_env.att_tbl[hids_nb][char_code + report_nb] + 1;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Merge a mouse report into the last queued report of its characteristic
+ * @return true if the report has been merged
+ ****************************************************************************************
+ */
+static bool hogpd_ntf_merge(uint8_t hids_nb, uint8_t char_code, uint8_t report_nb,
+                            uint16_t report_len, uint8_t *p_report)
+{
+    struct hogpd_ntf *ntf = NULL;
+    uint8_t i, cursor;
+    // Relative bytes, the Boot Mouse report has at least X and Y
+    uint8_t delta_nb = (report_len > HOGPD_MOUSE_DELTA_NB) ? HOGPD_MOUSE_DELTA_NB : (report_len - 1);
+    int16_t delta[HOGPD_MOUSE_DELTA_NB];
+
+    // Find the last queued report of the characteristic
+    for (i = hogpd_env.ntf_nb; i > 0; i--)
+    {
+        ntf = &hogpd_env.ntf[(hogpd_env.ntf_head + i - 1) % HOGPD_NTF_QUEUE_SIZE];
+        if ((ntf->hids_nb == hids_nb) && (ntf->char_code == char_code)
+                && (ntf->report_nb == report_nb))
+        {
+            break;
+        }
+    }
+
+    // Not found, or already requested to GATT
+    if ((i <= hogpd_env.ntf_sent) || (ntf->length != report_len) || (report_len < 3))
+    {
+        return false;
+    }
+
+    // The buttons and the other bytes shall not change
+    if ((ntf->value[0] != p_report[0])
+            || memcmp(&ntf->value[1 + delta_nb], &p_report[1 + delta_nb], report_len - 1 - delta_nb))
+    {
+        return false;
+    }
+
+    for (cursor = 0; cursor < delta_nb; cursor++)
+    {
+        delta[cursor] = (int8_t)ntf->value[1 + cursor] + (int8_t)p_report[1 + cursor];
+        if ((delta[cursor] < -127) || (delta[cursor] > 127))
+        {
+            return false;
+        }
+    }
+
+    for (cursor = 0; cursor < delta_nb; cursor++)
+    {
+        ntf->value[1 + cursor] = (uint8_t)delta[cursor];
+    }
+
+    return true;
+}
+
 uint8_t hogpd_ntf_send(uint8_t hids_nb, uint8_t char_code, uint8_t report_nb,
                        uint16_t report_len, uint8_t *p_report)
 {
     // Status
     uint8_t status = PRF_ERR_OK;
-    // Handle
-    uint16_t handle;
     // Mask
     uint8_t mask;
     // Flag
     uint8_t flag;
+    // Mouse report
+    bool mouse = false;
+    // Queued notification
+    struct hogpd_ntf *ntf;
 
     // Check if the required Report Char. is supported
     if (hogpd_env.att_tbl[hids_nb][char_code + report_nb] != 0x00)
     {
-        handle = hogpd_env.shdl[hids_nb] + hogpd_env.att_tbl[hids_nb][char_code + report_nb] + 1;
-
-        // Set value in the database
-        attsdb_att_set_value(handle, report_len, p_report);
-
         // Check if notifications have been enabled for the required characteristic
         switch(char_code)
         {
             case HOGPD_REPORT_CHAR:
                 flag = hogpd_env.features[hids_nb].report_char_cfg[report_nb];
                 mask = HOGPD_REPORT_NTF_CFG_MASK;
+                mouse = ((flag & HOGPD_CFG_REPORT_MOUSE) == HOGPD_CFG_REPORT_MOUSE);
                 break;
             case HOGPD_BOOT_KB_IN_REPORT_CHAR:
                 flag = hogpd_env.features[hids_nb].svc_features;
@@ -292,6 +358,7 @@ uint8_t hogpd_ntf_send(uint8_t hids_nb, uint8_t char_code, uint8_t report_nb,
             case HOGPD_BOOT_MOUSE_IN_REPORT_CHAR:
                 flag = hogpd_env.features[hids_nb].svc_features;
                 mask = HOGPD_BOOT_MOUSE_IN_NTF_CFG_MASK;
+                mouse = true;
                 break;
             default:
                 return PRF_ERR_INVALID_PARAM;
@@ -299,20 +366,38 @@ uint8_t hogpd_ntf_send(uint8_t hids_nb, uint8_t char_code, uint8_t report_nb,
 
         if ((flag & mask) != mask)
         {
+            // Set value in the database
+            attsdb_att_set_value(hogpd_ntf_handle(hids_nb, char_code, report_nb), report_len, p_report);
+
             status = PRF_ERR_NTF_DISABLED;
         }
-
-        // Check if notifications are enabled
-        if (status == PRF_ERR_OK)
+        else if (mouse && hogpd_ntf_merge(hids_nb, char_code, report_nb, report_len, p_report))
         {
-            // Send notification through GATT
-            struct gatt_notify_req * ntf = KE_MSG_ALLOC(GATT_NOTIFY_REQ, TASK_GATT,
-                                                        TASK_HOGPD, gatt_notify_req);
+            hogpd_env.stat.merged_nb++;
 
-            ntf->conhdl  = hogpd_env.con_info.conhdl;
-            ntf->charhdl = handle;
+            // The merged report is notified with the queued one
+            hogpd_ntf_cfm_send(PRF_ERR_OK, char_code, hids_nb, report_nb);
+        }
+        else if (hogpd_env.ntf_nb == HOGPD_NTF_QUEUE_SIZE)
+        {
+            hogpd_env.stat.full_nb++;
 
-            ke_msg_send(ntf);
+            status = PRF_ERR_REQ_DISALLOWED;
+        }
+        else
+        {
+            // Queue the report, the database value is set when it is notified
+            ntf = &hogpd_env.ntf[(hogpd_env.ntf_head + hogpd_env.ntf_nb) % HOGPD_NTF_QUEUE_SIZE];
+            hogpd_env.ntf_nb++;
+
+            ntf->time      = (uint32_t)qn_clock_us();
+            ntf->char_code = char_code;
+            ntf->hids_nb   = hids_nb;
+            ntf->report_nb = report_nb;
+            ntf->length    = report_len;
+            memcpy(ntf->value, p_report, report_len);
+
+            hogpd_ntf_next();
         }
     }
     else
@@ -323,6 +408,90 @@ uint8_t hogpd_ntf_send(uint8_t hids_nb, uint8_t char_code, uint8_t report_nb,
     return status;
 }
 
+void hogpd_ntf_next(void)
+{
+    struct hogpd_ntf *ntf;
+    uint16_t handle;
+
+    // GATT takes the value from the database when it builds the notification
+    if (hogpd_env.ntf_get_data || (hogpd_env.ntf_sent == hogpd_env.ntf_nb))
+    {
+        return;
+    }
+
+    ntf = &hogpd_env.ntf[(hogpd_env.ntf_head + hogpd_env.ntf_sent) % HOGPD_NTF_QUEUE_SIZE];
+    handle = hogpd_ntf_handle(ntf->hids_nb, ntf->char_code, ntf->report_nb);
+
+    // Set value in the database
+    attsdb_att_set_value(handle, ntf->length, ntf->value);
+
+    // Send notification through GATT
+    struct gatt_notify_req * req = KE_MSG_ALLOC(GATT_NOTIFY_REQ, TASK_GATT,
+                                                TASK_HOGPD, gatt_notify_req);
+
+    req->conhdl  = hogpd_env.con_info.conhdl;
+    req->charhdl = handle;
+
+    ke_msg_send(req);
+
+    hogpd_env.ntf_sent++;
+    hogpd_env.ntf_get_data = true;
+}
+
+void hogpd_ntf_cmp(uint8_t status)
+{
+    struct hogpd_ntf *ntf = &hogpd_env.ntf[hogpd_env.ntf_head];
+    uint32_t lat;
+
+    if (hogpd_env.ntf_sent == 0)
+    {
+        return;
+    }
+
+    hogpd_env.ntf_head = (hogpd_env.ntf_head + 1) % HOGPD_NTF_QUEUE_SIZE;
+    hogpd_env.ntf_sent--;
+    hogpd_env.ntf_nb--;
+
+#if (!QN_MULTI_NOTIFICATION_IN_ONE_EVENT)
+    // The value is free once the notification is sent
+    hogpd_env.ntf_get_data = false;
+#endif
+
+    if (status == PRF_ERR_OK)
+    {
+        lat = (uint32_t)qn_clock_us() - ntf->time;
+
+        hogpd_env.stat.ntf_nb++;
+        hogpd_env.stat.lat_total += lat;
+        if (lat > hogpd_env.stat.lat_max)
+        {
+            hogpd_env.stat.lat_max = lat;
+        }
+    }
+
+    // Send a HOGPD_NTF_SEND_CFM message to the application
+    hogpd_ntf_cfm_send(status, ntf->char_code, ntf->hids_nb, ntf->report_nb);
+
+    hogpd_ntf_next();
+}
+
+struct hogpd_ntf_stat const *hogpd_ntf_stat_get(void)
+{
+    return &hogpd_env.stat;
+}
+
+void hogpd_ntf_stat_reset(void)
+{
+    memset(&hogpd_env.stat, 0, sizeof(hogpd_env.stat));
+}
+
+void hogpd_ntf_flush(void)
+{
+    hogpd_env.ntf_nb = 0;
+    hogpd_env.ntf_sent = 0;
+    hogpd_env.ntf_get_data = false;
+}
+
 void hogpd_ntf_cfm_send(uint8_t status, uint8_t char_code, uint8_t hids_nb, uint8_t report_nb)
 {
     struct hogpd_ntf_sent_cfm *cfm = KE_MSG_ALLOC(HOGPD_NTF_SENT_CFM, hogpd_env.con_info.appid,
@@ -472,6 +641,8 @@ void hogpd_disable(void)
 
     ind->conhdl = hogpd_env.con_info.conhdl;
 
+    hogpd_ntf_flush();
+
     for (hids_nb = 0; hids_nb < hogpd_env.hids_nb; hids_nb++)
     {
         // Disable HIDS in database
@@ -58,6 +58,13 @@
 /// Boot Report Notification Configuration Bit Mask
 #define HOGPD_REPORT_NTF_CFG_MASK           (0x20)
 
+/// Report notifications queued, shared by all the Report Char. instances
+#ifndef HOGPD_NTF_QUEUE_SIZE
+#define HOGPD_NTF_QUEUE_SIZE                (4)
+#endif
+/// Relative bytes of a mouse report (X, Y, wheel) after the buttons byte
+#define HOGPD_MOUSE_DELTA_NB                (3)
+
 /*
  * ENUMERATIONS
  ****************************************************************************************
@@ -155,6 +162,8 @@ enum
     //HOGPD_CFG_REPORT_FEAT can be used as a mask to check Report type
     HOGPD_CFG_REPORT_FEAT   = 0x03,
     HOGPD_CFG_REPORT_WR     = 0x10,
+    /// Input Report in the Boot Mouse layout, the queued movements are merged
+    HOGPD_CFG_REPORT_MOUSE  = 0x40,
 };
 
 /*
@@ -173,6 +182,38 @@ struct hogpd_features
     uint8_t report_char_cfg[HOGPD_NB_REPORT_INST_MAX];
 };
 
+/// Queued Report notification
+struct hogpd_ntf
+{
+    /// qn_clock_us() of the oldest report in the value, 32 bits
+    uint32_t time;
+    /// Characteristic Code
+    uint8_t char_code;
+    /// HIDS Instance
+    uint8_t hids_nb;
+    /// Report Char. Instance
+    uint8_t report_nb;
+    /// Value length
+    uint8_t length;
+    /// Value
+    uint8_t value[HOGPD_REPORT_MAX_LEN];
+};
+
+/// Report notification statistics, latencies in us
+struct hogpd_ntf_stat
+{
+    /// Notifications sent
+    uint16_t ntf_nb;
+    /// Mouse reports merged in a queued one
+    uint16_t merged_nb;
+    /// Reports refused with a full queue
+    uint16_t full_nb;
+    /// Maximum latency from the report request to the notification completion
+    uint32_t lat_max;
+    /// Total latency of the notifications sent
+    uint64_t lat_total;
+};
+
 /// HID Over GATT Profile HID Device Role Environment variable
 struct hogpd_env_tag
 {
@@ -192,6 +233,19 @@ struct hogpd_env_tag
 
     /// Number of HIDS added in the database
     uint8_t hids_nb;
+
+    /// Notification queue
+    struct hogpd_ntf ntf[HOGPD_NTF_QUEUE_SIZE];
+    /// Oldest notification not completed
+    uint8_t ntf_head;
+    /// Notifications queued
+    uint8_t ntf_nb;
+    /// Notifications requested to GATT, from the oldest one
+    uint8_t ntf_sent;
+    /// The last value is not taken by GATT yet
+    bool ntf_get_data;
+    /// Notification statistics
+    struct hogpd_ntf_stat stat;
 };
 
 /// Database Creation Service Instance Configuration structure
@@ -267,12 +321,51 @@ void hogpd_init_ntf_cfg(uint16_t ntf_cfg, uint16_t handle, uint8_t con_type,
 
 /**
  ****************************************************************************************
- * @brief Check if a report value can be notified to the peer central.
+ * @brief Check if a report value can be notified to the peer central and queue it.
+ * The key reports are notified in order. A mouse report with the same buttons as the
+ * last queued one of its characteristic is merged into it and confirmed at once.
  ****************************************************************************************
  */
 uint8_t hogpd_ntf_send(uint8_t hids_nb, uint8_t char_code, uint8_t report_nb,
                        uint16_t report_len, uint8_t *p_report);
 
+/**
+ ****************************************************************************************
+ * @brief Request the next queued notification to GATT, once GATT took the previous value
+ ****************************************************************************************
+ */
+void hogpd_ntf_next(void);
+
+/**
+ ****************************************************************************************
+ * @brief Complete the oldest notification and inform APP
+ * @param status Notification status
+ ****************************************************************************************
+ */
+void hogpd_ntf_cmp(uint8_t status);
+
+/**
+ ****************************************************************************************
+ * @brief Get the report notification statistics since the last reset.
+ * The latencies are read from the RTC clock of bletime, started by qn_time_init().
+ ****************************************************************************************
+ */
+struct hogpd_ntf_stat const *hogpd_ntf_stat_get(void);
+
+/**
+ ****************************************************************************************
+ * @brief Reset the report notification statistics
+ ****************************************************************************************
+ */
+void hogpd_ntf_stat_reset(void);
+
+/**
+ ****************************************************************************************
+ * @brief Drop the queued notifications
+ ****************************************************************************************
+ */
+void hogpd_ntf_flush(void);
+
 /**
  ****************************************************************************************
  * @brief Inform APP if a notification has been sent or not.
@@ -500,6 +500,8 @@ static int hogpd_enable_req_handler(ke_msg_id_t const msgid,
     }
     else
     {
+        hogpd_ntf_flush();
+
         for (hids_nb = 0; hids_nb < hogpd_env.hids_nb; hids_nb++)
         {
             // Set default value for Protocol Mode Char. - Report Protocol Mode
@@ -848,17 +850,17 @@ static int gatt_notify_cmp_evt_handler(ke_msg_id_t const msgid,
 {
 #if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)  
     if(param->status == GATT_NOTIFY_GET_DATA)
-        return (KE_MSG_CONSUMED);        
-#endif
-
-    // Attribute information
-    uint8_t char_code, hids_nb, report_nb;
+    {
+        // The value is taken, the next one can be written in the database
+        hogpd_env.ntf_get_data = false;
+        hogpd_ntf_next();
 
-    // Retrieve attribute information using the handle
-    hogpd_get_att(param->handle, &char_code, &hids_nb, &report_nb);
+        return (KE_MSG_CONSUMED);
+    }
+#endif
 
     // Send a HOGPD_NTF_SEND_CFM message to the application
-    hogpd_ntf_cfm_send(param->status, char_code, hids_nb, report_nb);
+    hogpd_ntf_cmp(param->status);
 
     return (KE_MSG_CONSUMED);
 }
@@ -569,6 +569,28 @@ static int gatt_handle_value_ntf_handler(ke_msg_id_t const msgid,
     return (KE_MSG_CONSUMED);
 }
 
+/**
+ ****************************************************************************************
+ * @brief Handles reception of the @ref HRPC_DISABLE_REQ message.
+ * The profile is disabled on the connection, the peer database can be discovered again.
+ * @param[in] msgid     Id of the message received.
+ * @param[in] param     Pointer to the parameters of the message.
+ * @param[in] dest_id   ID of the receiving task instance
+ * @param[in] src_id    ID of the sending task instance.
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+static int hrpc_disable_req_handler(ke_msg_id_t const msgid,
+                                    struct hrpc_disable_req const *param,
+                                    ke_task_id_t const dest_id,
+                                    ke_task_id_t const src_id)
+{
+    PRF_CLIENT_DISABLE_IND_SEND(hrpc_envs, dest_id, HRPC);
+
+    // Message is consumed
+    return (KE_MSG_CONSUMED);
+}
+
 /**
  ****************************************************************************************
  * @brief Disconnection indication to HRPC.
@@ -599,6 +621,7 @@ static int gap_discon_cmp_evt_handler(ke_msg_id_t const msgid,
 // Specifies the message handlers for the connected state
 const struct ke_msg_handler hrpc_connected[] =
 {
+    {HRPC_DISABLE_REQ,       (ke_msg_func_t)hrpc_disable_req_handler},
     {HRPC_RD_CHAR_REQ,       (ke_msg_func_t)hrpc_rd_char_req_handler},
     {GATT_READ_CHAR_RESP,    (ke_msg_func_t)gatt_rd_char_rsp_handler},
     {HRPC_CFG_INDNTF_REQ,    (ke_msg_func_t)hrpc_cfg_indntf_req_handler},
@@ -95,6 +95,9 @@ enum
 
     /// Heart Rate value send to APP
     HRPC_HR_MEAS_IND,
+
+    ///Disable profile role without disconnection
+    HRPC_DISABLE_REQ,
 };
 
 
@@ -109,6 +112,13 @@ struct hrpc_enable_req
     struct hrs_content hrs;
 };
 
+/// Parameters of the @ref HRPC_DISABLE_REQ message
+struct hrpc_disable_req
+{
+    /// Connection handle
+    uint16_t conhdl;
+};
+
 ///Parameters of the @ref HRPC_RD_CHAR_REQ message
 struct hrpc_rd_char_req
 {
@@ -352,9 +352,9 @@ static int gatt_notify_cmp_evt_handler(ke_msg_id_t const msgid,
                                        ke_task_id_t const dest_id,
                                        ke_task_id_t const src_id)
 {
-#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT)  
+#if (QN_MULTI_NOTIFICATION_IN_ONE_EVENT) && !(PRF_NTF_GET_DATA_CFM)
     if(param->status == GATT_NOTIFY_GET_DATA)
-        return (KE_MSG_CONSUMED);        
+        return (KE_MSG_CONSUMED);
 #endif
 
     hrps_meas_send_cfm_send(param->status);
@@ -81,6 +81,9 @@ enum
     ///Send temperature value from APP
     HTPT_TEMP_SEND_REQ,
     ///Send temperature value confirm to APP so stable values can be erased if correctly sent.
+    ///With PRF_NTF_GET_DATA_CFM and QN_MULTI_NOTIFICATION_IN_ONE_EVENT, a notification is confirmed
+    ///twice: GATT_NOTIFY_GET_DATA when GATT takes the value, then the completion status.
+    ///The Measurement Interval indication is confirmed with cfm_type HTPT_CENTRAL_IND_CFM too.
     HTPT_TEMP_SEND_CFM,
 
     ///Indicate Measurement Interval
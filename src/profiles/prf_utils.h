@@ -44,6 +44,12 @@
  ****************************************************************************************
  */
 
+/// Give the GATT_NOTIFY_GET_DATA status of the measurement notifications of HRPS, HTPT and
+/// BLPS to APP in their send confirmations, before the completion status
+#ifndef PRF_NTF_GET_DATA_CFM
+#define PRF_NTF_GET_DATA_CFM                (0)
+#endif
+
 #if (BLE_ATTC || BLE_TIP_SERVER || BLE_AN_SERVER || BLE_PAS_SERVER)
 /**
  ****************************************************************************************
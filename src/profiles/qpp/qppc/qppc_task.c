@@ -603,6 +603,28 @@ static int gatt_handle_value_ntf_handler(ke_msg_id_t const msgid,
     return (KE_MSG_CONSUMED);
 }
 
+/**
+ ****************************************************************************************
+ * @brief Handles reception of the @ref QPPC_DISABLE_REQ message.
+ * The profile is disabled on the connection, the peer database can be discovered again.
+ * @param[in] msgid     Id of the message received.
+ * @param[in] param     Pointer to the parameters of the message.
+ * @param[in] dest_id   ID of the receiving task instance
+ * @param[in] src_id    ID of the sending task instance.
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+static int qppc_disable_req_handler(ke_msg_id_t const msgid,
+                                    struct qppc_disable_req const *param,
+                                    ke_task_id_t const dest_id,
+                                    ke_task_id_t const src_id)
+{
+    PRF_CLIENT_DISABLE_IND_SEND(qppc_envs, dest_id, QPPC);
+
+    // Message is consumed
+    return (KE_MSG_CONSUMED);
+}
+
 /**
  ****************************************************************************************
  * @brief Disconnection indication to QPPC.
@@ -644,6 +666,7 @@ const struct ke_msg_handler qppc_idle[] =
 // Specifies the message handlers for the connected state
 const struct ke_msg_handler qppc_connected[] =
 {
+    {QPPC_DISABLE_REQ,       (ke_msg_func_t)qppc_disable_req_handler},
     {QPPC_RD_CHAR_REQ,       (ke_msg_func_t)qppc_rd_char_req_handler},
     {GATT_READ_CHAR_RESP,    (ke_msg_func_t)gatt_rd_char_rsp_handler},
     {QPPC_CFG_INDNTF_REQ,    (ke_msg_func_t)qppc_cfg_indntf_req_handler},
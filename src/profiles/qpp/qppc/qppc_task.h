@@ -125,6 +125,9 @@ enum
 
     /// value send to APP
     QPPC_DATA_IND,
+
+    ///Disable profile role without disconnection
+    QPPC_DISABLE_REQ,
 };
 
 ///Structure containing the characteristics handles, value handles and descriptors
@@ -152,6 +155,13 @@ struct qppc_enable_req
     struct qpps_content qpps;
 };
 
+/// Parameters of the @ref QPPC_DISABLE_REQ message
+struct qppc_disable_req
+{
+    /// Connection handle
+    uint16_t conhdl;
+};
+
 ///Parameters of the @ref QPPC_RD_CHAR_REQ message
 struct qppc_rd_char_req
 {
@@ -1132,6 +1132,47 @@ static int gatt_handle_value_ind_handler(ke_msg_id_t const msgid,
     return (KE_MSG_CONSUMED);
 }
 
+/**
+ ****************************************************************************************
+ * @brief Handles reception of the @ref RSCPC_DISABLE_REQ message.
+ * The profile is disabled on the connection, the peer database can be discovered again.
+ * A procedure in progress is completed first.
+ * @param[in] msgid     Id of the message received.
+ * @param[in] param     Pointer to the parameters of the message.
+ * @param[in] dest_id   ID of the receiving task instance
+ * @param[in] src_id    ID of the sending task instance.
+ * @return If the message was consumed or not.
+ ****************************************************************************************
+ */
+static int rscpc_disable_req_handler(ke_msg_id_t const msgid,
+                                     struct rscpc_disable_req const *param,
+                                     ke_task_id_t const dest_id,
+                                     ke_task_id_t const src_id)
+{
+    // Message status
+    uint8_t msg_status = KE_MSG_CONSUMED;
+    // Get the address of the environment
+    struct rscpc_env_tag *rscpc_env;
+
+    if (ke_state_get(dest_id) == RSCPC_BUSY)
+    {
+        // Wait for the end of the procedure
+        msg_status = KE_MSG_SAVED;
+    }
+    else if (ke_state_get(dest_id) == RSCPC_CONNECTED)
+    {
+        rscpc_env = PRF_CLIENT_GET_ENV(dest_id, rscpc);
+
+        // Unregister from GATT
+        prf_unregister_atthdl2gatt(&rscpc_env->con_info, &rscpc_env->rscs.svc);
+
+        PRF_CLIENT_DISABLE_IND_SEND(rscpc_envs, dest_id, RSCPC);
+    }
+    // else ignore the message
+
+    return (int)msg_status;
+}
+
 /**
  ****************************************************************************************
  * @brief Disconnection indication to ANPC.
@@ -1180,6 +1221,7 @@ static int gap_discon_cmp_evt_handler(ke_msg_id_t const msgid,
 const struct ke_msg_handler rscpc_default_state[] =
 {
     {RSCPC_ENABLE_CMD,              (ke_msg_func_t)rscpc_enable_cmd_handler},
+    {RSCPC_DISABLE_REQ,             (ke_msg_func_t)rscpc_disable_req_handler},
     {RSCPC_READ_CMD,                (ke_msg_func_t)rscpc_read_cmd_handler},
     {RSCPC_CFG_NTFIND_CMD,          (ke_msg_func_t)rscpc_cfg_ntfind_cmd_handler},
     {RSCPC_CTNL_PT_CFG_CMD,         (ke_msg_func_t)rscpc_ctnl_pt_cfg_cmd_handler},
@@ -96,6 +96,9 @@ enum rscpc_msg_ids
 
     /// Procedure Timeout Timer
     RSCPC_TIMEOUT_TIMER_IND,
+
+    /// Disable the profile role without disconnection
+    RSCPC_DISABLE_REQ,
 };
 
 /// Operation Codes
@@ -136,6 +139,13 @@ struct rscpc_enable_cmd
     struct rscpc_rscs_content rscs;
 };
 
+/// Parameters of the @ref RSCPC_DISABLE_REQ message
+struct rscpc_disable_req
+{
+    /// Connection handle
+    uint16_t conhdl;
+};
+
 /// Parameters of the @ref RSCPC_READ_CMD message
 struct rscpc_read_cmd
 {
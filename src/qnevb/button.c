@@ -33,6 +33,25 @@
  ****************************************************************************************
  */
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/// Time elapsed from a to b
+#define BUTTON_ELAPSED(a, b)        (((b) - (a)) & BUTTON_TIME_MASK)
+
+/// Gesture recognition state
+enum
+{
+    BUTTON_IDLE,
+    /// First press
+    BUTTON_PRESSED,
+    /// Released after a short press, waiting for a second press
+    BUTTON_RELEASED,
+    /// Second press
+    BUTTON_PRESSED_AGAIN,
+    /// Long press reported, waiting for the release
+    BUTTON_HELD
+};
+#endif
+
 /*
  * GLOBAL VARIABLE DEFINITIONS
  ****************************************************************************************
@@ -54,8 +73,12 @@ void button_init(void)
     //gpio_pull_set(BUTTON1_PIN, GPIO_PULL_UP);
     //gpio_set_direction_field(BUTTON1_PIN, (uint32_t)GPIO_INPUT);
     //gpio_set_interrupt(BUTTON1_PIN, GPIO_INT_FALLING_EDGE);
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+    gpio_edge_capture_enable(BUTTON1_PIN);
+#else
     gpio_wakeup_config(BUTTON1_PIN, GPIO_WKUP_BY_LOW);
     gpio_enable_interrupt(BUTTON1_PIN);
+#endif
 
     // button 2
     //gpio_pull_set(BUTTON2_PIN, GPIO_PULL_UP);
@@ -80,5 +103,207 @@ int check_button_state(int btn)
     }
 }
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/**
+ ****************************************************************************************
+ * @brief   Add a recognized gesture
+ ****************************************************************************************
+ */
+static void button_gesture_put(struct button_gesture_tag *btn, enum button_gesture gesture)
+{
+    if (btn->gesture_nb < BUTTON_GESTURE_QUEUE)
+        btn->gesture[btn->gesture_nb++] = gesture;
+}
+
+/**
+ ****************************************************************************************
+ * @brief   Recognize the gestures ended by the time passing up to time
+ ****************************************************************************************
+ */
+static void button_gesture_timeout(struct button_gesture_tag *btn, uint32_t time)
+{
+    uint32_t elapsed = BUTTON_ELAPSED(btn->state_time, time);
+
+    switch (btn->state)
+    {
+        case BUTTON_PRESSED_AGAIN:
+            if ((btn->enable & BUTTON_GESTURE_BIT(BUTTON_GESTURE_LONG_PRESS))
+                && elapsed >= BUTTON_LONG_PRESS_TIME)
+            {
+                // the first press was a click
+                button_gesture_put(btn, BUTTON_GESTURE_CLICK);
+                button_gesture_put(btn, BUTTON_GESTURE_LONG_PRESS);
+                btn->state = BUTTON_HELD;
+            }
+            break;
+
+        case BUTTON_PRESSED:
+            if ((btn->enable & BUTTON_GESTURE_BIT(BUTTON_GESTURE_LONG_PRESS))
+                && elapsed >= BUTTON_LONG_PRESS_TIME)
+            {
+                button_gesture_put(btn, BUTTON_GESTURE_LONG_PRESS);
+                btn->state = BUTTON_HELD;
+            }
+            break;
+
+        case BUTTON_RELEASED:
+            if (elapsed >= BUTTON_DOUBLE_CLICK_GAP)
+            {
+                button_gesture_put(btn, BUTTON_GESTURE_CLICK);
+                btn->state = BUTTON_IDLE;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ ****************************************************************************************
+ * @brief   Apply the debounced edges, the level change happened at the first edge
+ ****************************************************************************************
+ */
+static void button_gesture_debounce(struct button_gesture_tag *btn)
+{
+    uint32_t time = btn->edge_time;
+
+    btn->pending = 0;
+    if (btn->edge_level == btn->level)
+        return;     // a glitch
+    btn->level = btn->edge_level;
+
+    button_gesture_timeout(btn, time);
+
+    if (btn->level == 0)
+    {
+        // press
+        if (btn->state == BUTTON_IDLE)
+            btn->state = BUTTON_PRESSED;
+        else if (btn->state == BUTTON_RELEASED)
+            btn->state = BUTTON_PRESSED_AGAIN;
+    }
+    else
+    {
+        // release, a click is reported at once when there is no double click to wait for
+        if (btn->state == BUTTON_PRESSED
+            && (btn->enable & BUTTON_GESTURE_BIT(BUTTON_GESTURE_DOUBLE_CLICK)))
+            btn->state = BUTTON_RELEASED;
+        else if (btn->state == BUTTON_PRESSED)
+        {
+            button_gesture_put(btn, BUTTON_GESTURE_CLICK);
+            btn->state = BUTTON_IDLE;
+        }
+        else if (btn->state == BUTTON_PRESSED_AGAIN)
+        {
+            button_gesture_put(btn, BUTTON_GESTURE_DOUBLE_CLICK);
+            btn->state = BUTTON_IDLE;
+        }
+        else if (btn->state == BUTTON_HELD)
+            btn->state = BUTTON_IDLE;
+    }
+    btn->state_time = time;
+}
+
+/**
+ ****************************************************************************************
+ * @brief   Initialize the gesture recognition of a released button
+ * @param[in]    btn      gesture recognition state
+ * @param[in]    enable   gestures recognized besides the click, BUTTON_GESTURE_BIT() of
+ *                        BUTTON_GESTURE_DOUBLE_CLICK and BUTTON_GESTURE_LONG_PRESS
+ * @description
+ *  Without the double click, a click is reported when the button is released instead of
+ *  BUTTON_DOUBLE_CLICK_GAP later. Without the long press, a held button needs no timeout.
+ ****************************************************************************************
+ */
+void button_gesture_init(struct button_gesture_tag *btn, uint8_t enable)
+{
+    btn->enable = enable;
+    btn->pending = 0;
+    btn->level = 1;
+    btn->state = BUTTON_IDLE;
+    btn->gesture_nb = 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief   Add a captured edge of the button
+ * @param[in]    btn      gesture recognition state
+ * @param[in]    level    pin level after the edge
+ * @param[in]    time     time of the edge, in us
+ * @return  true if the edge starts a debounce, button_gesture_get() shall be called to time it
+ * @description
+ *  Edges shall be added in capture order. Any number of edges may be added before
+ *  button_gesture_get() is called, the gestures are recognized on the edge times. The
+ *  bounces that follow the first edge return false.
+ ****************************************************************************************
+ */
+bool button_gesture_edge(struct button_gesture_tag *btn, uint8_t level, uint32_t time)
+{
+    bool start = false;
+
+    // keep the times in order
+    if ((btn->pending || btn->state != BUTTON_IDLE)
+        && BUTTON_ELAPSED(btn->last_time, time) > BUTTON_TIME_MASK / 2)
+        time = btn->last_time;
+
+    if (btn->pending && BUTTON_ELAPSED(btn->last_time, time) >= BUTTON_DEBOUNCE_TIME)
+        button_gesture_debounce(btn);
+
+    if (!btn->pending)
+    {
+        btn->pending = 1;
+        btn->edge_time = time;
+        start = true;
+    }
+    btn->last_time = time;
+    btn->edge_level = level;
+
+    return start;
+}
+
+/**
+ ****************************************************************************************
+ * @brief   Get a recognized gesture of the button
+ * @param[in]    btn      gesture recognition state
+ * @param[in]    now      current time, in us
+ * @param[out]   delay    time (us) to call again if no gesture is returned, 0 if not needed
+ * @return  the oldest gesture not read yet, BUTTON_GESTURE_NONE if none
+ ****************************************************************************************
+ */
+enum button_gesture button_gesture_get(struct button_gesture_tag *btn, uint32_t now, uint32_t *delay)
+{
+    enum button_gesture gesture;
+    uint8_t i;
+
+    if (btn->pending && BUTTON_ELAPSED(btn->last_time, now) >= BUTTON_DEBOUNCE_TIME)
+        button_gesture_debounce(btn);
+    if (!btn->pending)
+        button_gesture_timeout(btn, now);
+
+    if (btn->gesture_nb)
+    {
+        gesture = (enum button_gesture)btn->gesture[0];
+        for (i = 1; i < btn->gesture_nb; i++)
+            btn->gesture[i - 1] = btn->gesture[i];
+        btn->gesture_nb--;
+        *delay = 0;
+        return gesture;
+    }
+
+    if (btn->pending)
+        *delay = BUTTON_DEBOUNCE_TIME - BUTTON_ELAPSED(btn->last_time, now);
+    else if ((btn->state == BUTTON_PRESSED || btn->state == BUTTON_PRESSED_AGAIN)
+             && (btn->enable & BUTTON_GESTURE_BIT(BUTTON_GESTURE_LONG_PRESS)))
+        *delay = BUTTON_LONG_PRESS_TIME - BUTTON_ELAPSED(btn->state_time, now);
+    else if (btn->state == BUTTON_RELEASED)
+        *delay = BUTTON_DOUBLE_CLICK_GAP - BUTTON_ELAPSED(btn->state_time, now);
+    else
+        *delay = 0;
+
+    return BUTTON_GESTURE_NONE;
+}
+#endif
+
 /// @} BUTTON
 
@@ -48,6 +48,64 @@
 
 #endif
 
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+/// Debounce time (us), the level shall be stable for this time after the last edge
+#define BUTTON_DEBOUNCE_TIME        20000
+/// Long press time (us)
+#define BUTTON_LONG_PRESS_TIME      1000000
+/// Maximum time between the release and the second press of a double click (us)
+#define BUTTON_DOUBLE_CLICK_GAP     300000
+/// Range of the edge time, the low 32 bits of qn_clock_us()
+#define BUTTON_TIME_MASK            0xFFFFFFFF
+/// Gestures kept before they are read
+#define BUTTON_GESTURE_QUEUE        4
+/// Bit of a gesture recognized besides the click, see button_gesture_init()
+#define BUTTON_GESTURE_BIT(g)       (1 << (g))
+
+/*
+ * ENUMERATION DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Button gesture
+enum button_gesture
+{
+    BUTTON_GESTURE_NONE,
+    BUTTON_GESTURE_CLICK,
+    BUTTON_GESTURE_DOUBLE_CLICK,
+    BUTTON_GESTURE_LONG_PRESS
+};
+
+/*
+ * TYPE DEFINITIONS
+ ****************************************************************************************
+ */
+
+/// Gesture recognition state of an active low button
+struct button_gesture_tag
+{
+    /// Time of the first edge not debounced yet
+    uint32_t edge_time;
+    /// Time of the last edge
+    uint32_t last_time;
+    /// Time of the last debounced press or release
+    uint32_t state_time;
+    /// Level after the last edge
+    uint8_t edge_level;
+    /// Edges are waiting for debounce
+    uint8_t pending;
+    /// Debounced level
+    uint8_t level;
+    /// Recognition state
+    uint8_t state;
+    /// Recognized gestures besides the click, BUTTON_GESTURE_BIT()
+    uint8_t enable;
+    /// Recognized gestures
+    uint8_t gesture[BUTTON_GESTURE_QUEUE];
+    uint8_t gesture_nb;
+};
+#endif
+
 /*
  * FUNCTION DECLARATIONS
  ****************************************************************************************
@@ -55,6 +113,11 @@
 
 extern void button_init(void);
 extern int check_button_state(int btn);
+#if GPIO_EDGE_CAPTURE_EN==TRUE
+extern void button_gesture_init(struct button_gesture_tag *btn, uint8_t enable);
+extern bool button_gesture_edge(struct button_gesture_tag *btn, uint8_t level, uint32_t time);
+extern enum button_gesture button_gesture_get(struct button_gesture_tag *btn, uint32_t now, uint32_t *delay);
+#endif
 
 #endif
 
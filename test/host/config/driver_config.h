@@ -0,0 +1,31 @@
+/**
+ ****************************************************************************************
+ *
+ * @file driver_config.h
+ *
+ * @brief Host test configuration, the project driver configuration with the tested options
+ *
+ ****************************************************************************************
+ */
+
+#ifndef HOST_DRIVER_CONFIG_H_
+#define HOST_DRIVER_CONFIG_H_
+
+#include "../../../project/src/driver_config.h"
+
+#undef  CONFIG_ADC_ENABLE_INTERRUPT
+#define CONFIG_ADC_ENABLE_INTERRUPT     TRUE
+#undef  ADC_STREAM_EN
+#define ADC_STREAM_EN                   TRUE
+#undef  SERIAL_FLASH_DMA_EN
+#define SERIAL_FLASH_DMA_EN             TRUE
+#undef  SERIAL_FLASH_READ_AHEAD_EN
+#define SERIAL_FLASH_READ_AHEAD_EN      TRUE
+#undef  TIMER_WHEEL_EN
+#define TIMER_WHEEL_EN                  TRUE
+#undef  GPIO_EDGE_CAPTURE_EN
+#define GPIO_EDGE_CAPTURE_EN            TRUE
+#undef  SLEEP_STAT_EN
+#define SLEEP_STAT_EN                   TRUE
+
+#endif
@@ -0,0 +1,32 @@
+/**
+ ****************************************************************************************
+ *
+ * @file host_cmsis.h
+ *
+ * @brief Host replacements of the Cortex-M0 intrinsics, included before any source
+ *
+ ****************************************************************************************
+ */
+
+#ifndef HOST_CMSIS_H_
+#define HOST_CMSIS_H_
+
+// Skip the intrinsics of the CMSIS core, they are ARM assembly
+#define __CORE_CMINSTR_H
+#define __CORE_CMFUNC_H
+#include <stdint.h>
+static inline void __NOP(void) {}
+static inline void __WFI(void) {}
+static inline void __WFE(void) {}
+static inline void __SEV(void) {}
+static inline void __ISB(void) {}
+static inline void __DSB(void) {}
+static inline void __DMB(void) {}
+static inline uint32_t __REV(uint32_t v) { return __builtin_bswap32(v); }
+static inline uint32_t __REV16(uint32_t v) { return ((v & 0xFF00FF00) >> 8) | ((v & 0x00FF00FF) << 8); }
+static inline void __enable_irq(void) {}
+static inline void __disable_irq(void) {}
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t m) { (void)m; }
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ ****************************************************************************************
+ *
+ * @file usr_config.h
+ *
+ * @brief Host test configuration, the project configuration with the tested modules
+ *
+ * HOST_CFG_CON replaces the number of connections of the project, for the tests run at
+ * several sizes of the connection tables.
+ *
+ ****************************************************************************************
+ */
+
+#ifndef HOST_USR_CONFIG_H_
+#define HOST_USR_CONFIG_H_
+
+#include "../../../project/src/usr_config.h"
+
+#if defined(HOST_CFG_CON)
+#undef CFG_CON
+#define CFG_CON HOST_CFG_CON
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ ****************************************************************************************
+ *
+ * @file host.c
+ *
+ * @brief Host test helpers: checks, benchmark clock and kernel stubs
+ *
+ ****************************************************************************************
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "host.h"
+
+int host_fail_nb;
+uint32_t host_ke_time;
+
+uint64_t host_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+int host_result(const char *name)
+{
+    printf("%s: %s (%d failed checks)\n", name, host_fail_nb ? "FAIL" : "PASS", host_fail_nb);
+    return host_fail_nb ? 1 : 0;
+}
+
+uint32_t ke_time(void)
+{
+    return host_ke_time;
+}
+
+void assert_err(const char *condition, const char *file, int line)
+{
+    printf("%s:%d: assert: %s\n", file, line, condition);
+    abort();
+}
+
+void assert_param(int param0, int param1, const char *file, int line)
+{
+    printf("%s:%d: assert: %d %d\n", file, line, param0, param1);
+    abort();
+}
+
+void assert_warn(const char *condition, const char *file, int line)
+{
+    printf("%s:%d: warning: %s\n", file, line, condition);
+}
@@ -0,0 +1,39 @@
+/**
+ ****************************************************************************************
+ *
+ * @file host.h
+ *
+ * @brief Host test helpers: checks, benchmark clock and kernel stubs
+ *
+ ****************************************************************************************
+ */
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// Count a failed check and print it, the test returns host_result()
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            host_fail_nb++;                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+        }                                                                       \
+    } while (0)
+
+/// Failed checks
+extern int host_fail_nb;
+
+/// Kernel time returned by the ke_time() stub, in 10ms
+extern uint32_t host_ke_time;
+
+/// Monotonic host clock in ns, for the benchmarks
+uint64_t host_ns(void);
+
+/// Print the result of the test and return the exit code
+int host_result(const char *name);
+
+#endif // HOST_H_
@@ -0,0 +1,249 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_ad.c
+ *
+ * @brief Advertising data iterator of the application: a corpus of advertising and scan
+ * response data checked field by field, a random fuzz against a reference walk of the AD
+ * structures, and the cost of app_ad_iter_init/app_ad_next per AD structure
+ *
+ * The fuzz data is allocated at its exact length, so a build with
+ * -DCMAKE_C_FLAGS=-fsanitize=address,undefined also reports any read past its end.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+#include "host.h"
+
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b);
+
+#undef co_bt_bdaddr_compare
+#define co_bt_bdaddr_compare host_bdaddr_compare
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_util.c"
+
+/// Fuzzed data, the iBeacon prefix is put in one of them every FUZZ_IBEACON_PERIOD
+#define FUZZ_NB                 1000000
+#define FUZZ_IBEACON_PERIOD     7
+/// Benchmark data and loops
+#define BENCH_NB                200000
+
+struct app_env_tag app_env;
+
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b)
+{
+    return memcmp(a->addr, b->addr, BD_ADDR_LEN) == 0;
+}
+
+/// Flags, complete name "abcd", 16-bit UUIDs 0x180D and 0x180F, incomplete UUID 0x180A
+static const uint8_t ad_name_uuid[] = {2, GAP_AD_TYPE_FLAGS, 0x06,
+                                       5, GAP_AD_TYPE_COMPLETE_NAME, 'a', 'b', 'c', 'd',
+                                       5, GAP_AD_TYPE_COMPLETE_LIST_16_BIT_UUID, 0x0D, 0x18, 0x0F, 0x18,
+                                       3, GAP_AD_TYPE_MORE_16_BIT_UUID, 0x0A, 0x18,
+                                       0, 0};
+/// iBeacon, major 0x0102, minor 0x0304, TX power -59
+static const uint8_t ad_ibeacon[] = {2, GAP_AD_TYPE_FLAGS, 0x06,
+                                     26, GAP_AD_TYPE_MANU_SPECIFIC_DATA, 0x4C, 0x00, 0x02, 0x15,
+                                     0xE2, 0xC5, 0x6D, 0xB5, 0xDF, 0xFB, 0x48, 0xD2,
+                                     0xB0, 0x60, 0xD0, 0xF5, 0xA7, 0x10, 0x96, 0xE0,
+                                     0x01, 0x02, 0x03, 0x04, 0xC5};
+/// Eddystone UID, TX power -20, the reserved bytes omitted
+static const uint8_t ad_eddystone_uid[] = {3, GAP_AD_TYPE_COMPLETE_LIST_16_BIT_UUID, 0xAA, 0xFE,
+                                           21, GAP_AD_TYPE_SERVICE_DATA, 0xAA, 0xFE, 0x00, 0xEC,
+                                           0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                           10, 11, 12, 13, 14, 15};
+/// Eddystone URL "https://www.nxp.com"
+static const uint8_t ad_eddystone_url[] = {3, GAP_AD_TYPE_COMPLETE_LIST_16_BIT_UUID, 0xAA, 0xFE,
+                                           10, GAP_AD_TYPE_SERVICE_DATA, 0xAA, 0xFE, 0x10, 0xEE,
+                                           0x01, 'n', 'x', 'p', 0x00};
+/// Eddystone TLM, 3000mV, 23.5 degrees, 5 advertisings, 256 x 0.1s
+static const uint8_t ad_eddystone_tlm[] = {3, GAP_AD_TYPE_COMPLETE_LIST_16_BIT_UUID, 0xAA, 0xFE,
+                                           17, GAP_AD_TYPE_SERVICE_DATA, 0xAA, 0xFE, 0x20, 0x00,
+                                           0x0B, 0xB8, 0x17, 0x80, 0, 0, 0, 5, 0, 0, 1, 0};
+/// The second AD structure runs past the end
+static const uint8_t ad_truncated[] = {2, GAP_AD_TYPE_FLAGS, 0x06, 9, GAP_AD_TYPE_COMPLETE_NAME, 'x'};
+/// Empty AD structures: the length only, and the type without payload
+static const uint8_t ad_short[] = {1, GAP_AD_TYPE_FLAGS, 1, GAP_AD_TYPE_MANU_SPECIFIC_DATA,
+                                   2, GAP_AD_TYPE_SERVICE_DATA, 0xAA};
+
+/// Views of all the AD structures of data, -1 if it is truncated
+static int sim_walk(uint8_t const *data, uint8_t len, struct app_ad_struct *ad, int max)
+{
+    struct app_ad_iter it;
+    int nb = 0;
+
+    app_ad_iter_init(&it, data, len);
+    while ((nb < max) && app_ad_next(&it, &ad[nb]))
+        nb++;
+    return app_ad_iter_error(&it) ? -1 : nb;
+}
+
+static void test_corpus(void)
+{
+    struct app_ad_struct ad[8];
+    struct app_adv_data adv;
+    struct app_ibeacon ib;
+    struct app_eddystone ed;
+
+    CHECK(sim_walk(ad_name_uuid, sizeof(ad_name_uuid), ad, 8) == 4);
+    CHECK(ad[0].kind == APP_AD_FLAGS && ad[0].id == 0x06);
+    CHECK(ad[1].kind == APP_AD_NAME && ad[1].len == 4 && memcmp(ad[1].data, "abcd", 4) == 0);
+    CHECK(ad[2].kind == APP_AD_UUID16 && ad[2].nb == 2 && co_read16p(ad[2].data) == 0x180D);
+    CHECK(ad[3].kind == APP_AD_UUID16 && ad[3].type == GAP_AD_TYPE_MORE_16_BIT_UUID && ad[3].nb == 1);
+    CHECK(app_parser_adv_data((uint8_t *)ad_name_uuid, sizeof(ad_name_uuid), &adv));
+    CHECK(adv.flag == (AD_TYPE_NAME_BIT | AD_TYPE_16bitUUID_BIT) && strcmp((char *)adv.name, "abcd") == 0);
+    CHECK(adv.uuid_num == 3 && adv.uuid[0] == 0x180D && adv.uuid[1] == 0x180F && adv.uuid[2] == 0x180A);
+
+    CHECK(sim_walk(ad_ibeacon, sizeof(ad_ibeacon), ad, 8) == 2);
+    CHECK(ad[1].kind == APP_AD_MANU_DATA && ad[1].id == APP_AD_COMPANY_APPLE && ad[1].len == 23);
+    CHECK(app_ad_ibeacon(&ad[1], &ib));
+    CHECK(ib.uuid == &ad_ibeacon[9] && ib.major == 0x0102 && ib.minor == 0x0304 && ib.tx_power == -59);
+    CHECK(!app_ad_ibeacon(&ad[0], &ib));
+    CHECK(!app_ad_eddystone(&ad[1], &ed));
+
+    CHECK(sim_walk(ad_eddystone_uid, sizeof(ad_eddystone_uid), ad, 8) == 2);
+    CHECK(ad[1].kind == APP_AD_SERVICE_DATA && ad[1].id == APP_AD_EDDYSTONE_UUID && ad[1].len == 18);
+    CHECK(app_ad_eddystone(&ad[1], &ed));
+    CHECK(ed.frame == APP_AD_EDDYSTONE_UID && ed.tx_power == -20 && ed.id == &ad_eddystone_uid[10]);
+
+    CHECK(sim_walk(ad_eddystone_url, sizeof(ad_eddystone_url), ad, 8) == 2);
+    CHECK(app_ad_eddystone(&ad[1], &ed));
+    CHECK(ed.frame == APP_AD_EDDYSTONE_URL && ed.tx_power == -18 && ed.url_len == 5);
+    CHECK(ed.id[0] == 0x01 && memcmp(&ed.id[1], "nxp", 3) == 0);
+
+    CHECK(sim_walk(ad_eddystone_tlm, sizeof(ad_eddystone_tlm), ad, 8) == 2);
+    CHECK(app_ad_eddystone(&ad[1], &ed));
+    CHECK(ed.frame == APP_AD_EDDYSTONE_TLM && ed.vbatt == 3000 && ed.temp == 0x1780);
+    CHECK(ed.adv_cnt == 5 && ed.sec_cnt == 256);
+
+    // the AD structures before a truncated one are given
+    CHECK(sim_walk(ad_truncated, sizeof(ad_truncated), ad, 8) == -1);
+    CHECK(ad[0].kind == APP_AD_FLAGS);
+    CHECK(!app_parser_adv_data((uint8_t *)ad_truncated, sizeof(ad_truncated), &adv));
+    CHECK(adv.flag == 0);
+
+    // too short for their type, they are not classified
+    CHECK(sim_walk(ad_short, sizeof(ad_short), ad, 8) == 3);
+    CHECK(ad[0].kind == APP_AD_OTHER && ad[0].len == 0);
+    CHECK(ad[1].kind == APP_AD_OTHER && ad[1].len == 0);
+    CHECK(ad[2].kind == APP_AD_OTHER && ad[2].len == 1);
+
+    // empty data and the padding only
+    CHECK(sim_walk(ad_short, 0, ad, 8) == 0);
+    CHECK(sim_walk(&ad_name_uuid[19], 2, ad, 8) == 0);
+}
+
+/// Random byte, biased to the lengths and types of the decoded frames
+static uint8_t sim_rand_byte(void)
+{
+    static const uint8_t bias[] = {0x00, 0x01, 0x02, 0x03, 0x09, 0x15, 0x16, 0x1A, 0xFF,
+                                   0x4C, 0xAA, 0xFE, 0x10, 0x20};
+    int r = rand();
+
+    return (r & 3) ? (uint8_t)(r >> 8) : bias[(r >> 8) % sizeof(bias)];
+}
+
+/// Check the views of the iterator against a walk of the length bytes
+static void sim_fuzz_check(uint8_t const *data, uint8_t len)
+{
+    struct app_ad_iter it;
+    struct app_ad_struct ad;
+    struct app_adv_data adv;
+    struct app_ibeacon ib;
+    struct app_eddystone ed;
+    uint8_t pos = 0;
+    bool error = false;
+
+    app_ad_iter_init(&it, data, len);
+    while (app_ad_next(&it, &ad))
+    {
+        // the reference: the AD structure at pos fits in the data
+        CHECK((pos < len) && (data[pos] != 0) && (data[pos] < len - pos));
+        if ((pos >= len) || (data[pos] == 0) || (data[pos] >= len - pos))
+            return;
+        CHECK(ad.type == data[pos + 1]);
+        CHECK((ad.data >= &data[pos + 2]) && (ad.data + ad.len == &data[pos + 1 + data[pos]]));
+        if (app_ad_ibeacon(&ad, &ib))
+            CHECK(ib.uuid + 16 <= data + len);
+        if (app_ad_eddystone(&ad, &ed) && (ed.frame != APP_AD_EDDYSTONE_TLM))
+            CHECK(ed.id + (ed.frame == APP_AD_EDDYSTONE_URL ? ed.url_len : 16) <= data + len);
+        pos += 1 + data[pos];
+    }
+    error = (pos < len) && (data[pos] != 0) && (data[pos] >= len - pos);
+    CHECK(app_ad_iter_error(&it) == error);
+    // the iterator stays at the end
+    CHECK(!app_ad_next(&it, &ad));
+
+    CHECK(app_parser_adv_data((uint8_t *)data, len, &adv) == !error);
+    CHECK(strlen((char *)adv.name) < sizeof(adv.name));
+    CHECK(adv.uuid_num <= sizeof(adv.uuid) / sizeof(adv.uuid[0]));
+}
+
+static void test_fuzz(void)
+{
+    static const uint8_t ibeacon_prefix[] = {26, GAP_AD_TYPE_MANU_SPECIFIC_DATA, 0x4C, 0x00, 0x02, 0x15};
+    int fail_nb = host_fail_nb;
+    uint8_t *data;
+    uint8_t len;
+    int i, j;
+
+    srand(48);
+    for (i = 0; (i < FUZZ_NB) && (host_fail_nb == fail_nb); i++)
+    {
+        len = rand() % (ADV_DATA_LEN + 1);
+        data = malloc(len ? len : 1);
+        for (j = 0; j < len; j++)
+            data[j] = sim_rand_byte();
+        if ((i % FUZZ_IBEACON_PERIOD == 0) && (len >= sizeof(ibeacon_prefix)))
+            memcpy(data, ibeacon_prefix, sizeof(ibeacon_prefix));
+        sim_fuzz_check(data, len);
+        free(data);
+    }
+    if (host_fail_nb != fail_nb)
+        printf("fuzz: failed at %d\n", i - 1);
+}
+
+/// ns per AD structure of app_ad_iter_init/app_ad_next over the corpus
+static void bench_iter(void)
+{
+    static const struct
+    {
+        uint8_t const *data;
+        uint8_t len;
+    } corpus[] = {{ad_name_uuid, sizeof(ad_name_uuid)}, {ad_ibeacon, sizeof(ad_ibeacon)},
+                  {ad_eddystone_uid, sizeof(ad_eddystone_uid)}, {ad_eddystone_tlm, sizeof(ad_eddystone_tlm)}};
+    struct app_ad_iter it;
+    struct app_ad_struct ad;
+    volatile uint32_t sink = 0;
+    uint32_t nb = 0;
+    uint64_t t;
+    int i, k;
+
+    t = host_ns();
+    for (i = 0; i < BENCH_NB; i++)
+    {
+        for (k = 0; k < sizeof(corpus) / sizeof(corpus[0]); k++)
+        {
+            app_ad_iter_init(&it, corpus[k].data, corpus[k].len);
+            while (app_ad_next(&it, &ad))
+            {
+                sink += ad.kind + ad.id;
+                nb++;
+            }
+        }
+    }
+    t = host_ns() - t;
+    printf("app_ad_next: %u AD structures, %.1f ns each\n", nb, (double)t / nb);
+}
+
+int main(void)
+{
+    test_corpus();
+    test_fuzz();
+    bench_iter();
+    return host_result("test_ad");
+}
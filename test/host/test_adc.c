@@ -0,0 +1,148 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_adc.c
+ *
+ * @brief ADC stream reductions: adc_stat_calc() and adc_decimate() against a reference,
+ * and their cost per sample, and the stream configurations refused by adc_stream_start()
+ *
+ ****************************************************************************************
+ */
+
+#include "adc.c"
+#include <math.h>
+#include "host.h"
+
+static int16_t buf[ADC_STREAM_MAX_SAMPLES];
+
+/// The ADC registers, not reached by the tests
+struct sleep_env_tag sleep_env;
+
+void __wr_reg_with_msk(uint32_t addr, uint32_t msk, uint32_t val)
+{
+    CHECK(0);
+}
+
+static void check_stat(uint16_t samples)
+{
+    adc_stream_stat stat;
+    int64_t sum = 0;
+    uint64_t sum_sq = 0;
+    int16_t min = 0x7FFF, max = -0x8000;
+    uint16_t i;
+
+    for (i = 0; i < samples; i++) {
+        sum += buf[i];
+        sum_sq += (int32_t)buf[i] * buf[i];
+        if (buf[i] < min) min = buf[i];
+        if (buf[i] > max) max = buf[i];
+    }
+
+    adc_stat_calc(buf, samples, ADC_REDUCE_MEAN | ADC_REDUCE_MIN_MAX | ADC_REDUCE_RMS, &stat);
+    CHECK(stat.mean == (int16_t)(sum / samples));
+    CHECK(stat.min == min);
+    CHECK(stat.max == max);
+    CHECK(stat.rms == (uint16_t)floor(sqrt((double)(sum_sq / samples))));
+
+    // Only the selected fields are set
+    adc_stat_calc(buf, samples, ADC_REDUCE_RMS, &stat);
+    CHECK(stat.mean == 0 && stat.min == 0 && stat.max == 0);
+}
+
+static void check_decimate(uint16_t samples, uint8_t ratio)
+{
+    static int16_t ref[ADC_STREAM_MAX_SAMPLES];
+    uint16_t i, n = 0;
+    int32_t acc;
+    uint8_t j;
+
+    for (i = 0; i + ratio <= samples; i += ratio) {
+        for (acc = 0, j = 0; j < ratio; j++) {
+            acc += buf[i + j];
+        }
+        ref[n++] = acc / ratio;
+    }
+
+    CHECK(adc_decimate(buf, samples, ratio) == n);
+    for (i = 0; i < n; i++) {
+        CHECK(buf[i] == ref[i]);
+    }
+}
+
+static void fill(uint16_t samples, int16_t lo, int16_t hi)
+{
+    uint16_t i;
+
+    for (i = 0; i < samples; i++) {
+        buf[i] = lo + rand() % (hi - lo + 1);
+    }
+}
+
+/// The refused configurations return before the ADC is touched
+static void check_stream_param(void)
+{
+    adc_stream_configuration stream = {{buf, buf}, ADC_STREAM_MAX_SAMPLES + 1, ADC_REDUCE_MEAN, 0, NULL};
+
+    CHECK(!adc_stream_start(NULL, &stream));
+    stream.samples = 0;
+    CHECK(!adc_stream_start(NULL, &stream));
+    stream.samples = 100;
+    stream.reduce = ADC_REDUCE_DECI;
+    CHECK(!adc_stream_start(NULL, &stream));
+    stream.deci_ratio = 3;
+    CHECK(!adc_stream_start(NULL, &stream));
+    CHECK(!adc_stream_env.active);
+}
+
+static void bench(void)
+{
+    adc_stream_stat stat;
+    uint64_t t;
+    int i;
+    const int loops = 2000;
+    const uint16_t n = ADC_STREAM_MAX_SAMPLES;
+
+    fill(n, -2048, 2047);
+    t = host_ns();
+    for (i = 0; i < loops; i++) {
+        adc_stat_calc(buf, n, ADC_REDUCE_MEAN | ADC_REDUCE_MIN_MAX, &stat);
+    }
+    printf("bench: mean+min/max %.2f ns/sample\n", (double)(host_ns() - t) / loops / n);
+
+    t = host_ns();
+    for (i = 0; i < loops; i++) {
+        adc_stat_calc(buf, n, ADC_REDUCE_RMS, &stat);
+    }
+    printf("bench: rms %.2f ns/sample\n", (double)(host_ns() - t) / loops / n);
+
+    t = host_ns();
+    for (i = 0; i < loops; i++) {
+        adc_decimate(buf, n, 1 + (i & 1));
+    }
+    printf("bench: decimate 2:1 %.2f ns/sample\n", (double)(host_ns() - t) * 2 / loops / n);
+}
+
+int main(void)
+{
+    int k;
+
+    srand(1);
+    for (k = 0; k < 200; k++) {
+        uint16_t samples = 1 + rand() % ADC_STREAM_MAX_SAMPLES;
+
+        // 12-bit signed (differential) and unsigned ranges
+        fill(samples, (k & 1) ? -2048 : 0, (k & 1) ? 2047 : 4095);
+        check_stat(samples);
+        check_decimate(samples, 1 + rand() % 16);
+    }
+
+    // Full scale worst case of the square sum
+    for (k = 0; k < ADC_STREAM_MAX_SAMPLES; k++) {
+        buf[k] = (k & 1) ? -2048 : 2047;
+    }
+    check_stat(ADC_STREAM_MAX_SAMPLES);
+
+    check_stream_param();
+    bench();
+    return host_result("test_adc");
+}
@@ -0,0 +1,299 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_ancsc.c
+ *
+ * @brief ANCS notification consumer of the application: the attribute cache kept for a
+ * bonded NP across its connections, also with a new private address, and cleared for a peer
+ * which is not bonded, another peer or a bonded slot given to another peer, and the fetch
+ * timeout restarted by the Data Source fragments
+ *
+ * The test plays the ANCSC profile task: it sends the enable, disable, Notification Source
+ * and Data Source messages to the handlers, and records the Get Notification Attributes
+ * commands and the fetch timer.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+
+static void host_ke_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task, uint16_t const delay);
+static void host_ke_timer_clear(ke_msg_id_t const timer_id, ke_task_id_t const task);
+
+#undef _ke_timer_set
+#undef _ke_timer_clear
+#define _ke_timer_set           host_ke_timer_set
+#define _ke_timer_clear         host_ke_timer_clear
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_ancsc_task.c"
+#include "host.h"
+
+#define IDX             0
+#define SRC             KE_BUILD_ID(TASK_ANCSC, IDX)
+#define CONHDL          5
+
+struct app_env_tag app_env;
+
+/// Peers, the first one is bonded, the third one is the first one with a new private address
+static const struct bd_addr sim_addr[3] = {{{1, 2, 3, 4, 5, 6}}, {{6, 5, 4, 3, 2, 1}}, {{7, 8, 9, 10, 11, 0x5C}}};
+/// Connected peer
+static struct bd_addr const *sim_peer;
+
+/// Get Notification Attributes commands, and the UID of the last one
+static int sim_fetch_nb;
+static uint32_t sim_fetch_uid;
+/// Fetch timer delay, 0 when not armed
+static uint16_t sim_timer;
+
+static void host_ke_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task, uint16_t const delay)
+{
+    CHECK(timer_id == ANCS_FETCH_TIMER0 + IDX && task == TASK_APP);
+    sim_timer = delay;
+}
+
+static void host_ke_timer_clear(ke_msg_id_t const timer_id, ke_task_id_t const task)
+{
+    CHECK(timer_id == ANCS_FETCH_TIMER0 + IDX && task == TASK_APP);
+    sim_timer = 0;
+}
+
+bool app_get_bd_addr_by_idx(uint8_t idx, struct bd_addr *addr)
+{
+    CHECK(idx == IDX);
+    if (sim_peer == NULL)
+        return false;
+    *addr = *sim_peer;
+    return true;
+}
+
+uint8_t app_find_bonded_dev(struct bd_addr const *addr)
+{
+    if (!memcmp(addr, &sim_addr[0], sizeof(*addr)) || !memcmp(addr, &sim_addr[2], sizeof(*addr)))
+        return 0;
+    return GAP_INVALID_CONIDX;
+}
+
+void app_ancsc_get_ntf_attribute_req(uint32_t notificationUID, uint8_t attribute_size, uint8_t *attribute_list,
+                                     uint16_t conhdl)
+{
+    CHECK(conhdl == CONHDL);
+    sim_fetch_nb++;
+    sim_fetch_uid = notificationUID;
+}
+
+void app_ancsc_cfg_indntf_req(uint8_t char_code, uint16_t cfg_val, uint16_t conhdl)
+{
+}
+
+void app_gap_bond_req(struct bd_addr *addr, uint8_t oob, uint8_t auth, uint8_t iocap)
+{
+}
+
+/// Initialize the application like app_init()
+static void sim_init(void)
+{
+    uint8_t idx;
+
+    memset(&app_env, 0, sizeof(app_env));
+    for (idx = 0; idx < BLE_CONNECTION_MAX; idx++)
+        app_ancsc_env[idx].cache_slot = GAP_INVALID_CONIDX;
+}
+
+/// Connect a peer and enable the role
+static void sim_enable(struct bd_addr const *peer)
+{
+    struct ancsc_cmp_evt evt = {CONHDL, ANCSC_ENABLE_OP_CODE, PRF_ERR_OK};
+
+    sim_peer = peer;
+    app_ancsc_cmp_evt_handler(ANCSC_CMP_EVT, &evt, TASK_APP, SRC);
+    CHECK(app_ancsc_env[IDX].enabled);
+}
+
+/// Disable the role and disconnect
+static void sim_disable(void)
+{
+    struct prf_client_disable_ind ind;
+
+    memset(&ind, 0, sizeof(ind));
+    app_ancsc_disable_ind_handler(ANCSC_DISABLE_IND, &ind, TASK_APP, SRC);
+    sim_peer = NULL;
+    CHECK(sim_timer == 0);
+}
+
+static void sim_ntf_source(uint8_t event_id, uint32_t uid)
+{
+    struct ancsc_ntf_source_ind ind;
+
+    memset(&ind, 0, sizeof(ind));
+    ind.conhdl = CONHDL;
+    ind.ntf_source.event_id = event_id;
+    ind.ntf_source.category_id = CATEGORYID_SOCIAL;
+    ind.ntf_source.ntf_uid = uid;
+    app_ancsc_ntf_source_ind_handler(ANCSC_NTF_SOURCE_IND, &ind, TASK_APP, SRC);
+}
+
+/// Send a Data Source value in fragments of a size, the attributes are "a", "t" and "m"
+static void sim_data_source(uint32_t uid, uint16_t frag, uint16_t max)
+{
+    struct
+    {
+        struct ancsc_data_source_ind ind;
+        uint8_t data[32];
+    } msg;
+    uint8_t rsp[] = {0, (uint8_t)uid, (uint8_t)(uid >> 8), (uint8_t)(uid >> 16), (uint8_t)(uid >> 24),
+                     APP_ANCSC_ATTR_APP_ID, 1, 0, 'a',
+                     APP_ANCSC_ATTR_TITLE, 1, 0, 't',
+                     APP_ANCSC_ATTR_MESSAGE, 1, 0, 'm'};
+    uint16_t pos;
+
+    for (pos = 0; pos < sizeof(rsp) && pos < max; pos += frag) {
+        msg.ind.conhdl = CONHDL;
+        msg.ind.data_size = (sizeof(rsp) - pos < frag) ? sizeof(rsp) - pos : frag;
+        memcpy(msg.ind.data_source, &rsp[pos], msg.ind.data_size);
+        app_ancsc_data_source_ind_handler(ANCSC_DATA_SOURCE_IND, &msg.ind, TASK_APP, SRC);
+    }
+}
+
+/// Fetch a notification added by the NP
+static void sim_fetch(uint32_t uid)
+{
+    int nb = sim_fetch_nb;
+
+    sim_ntf_source(NOTIFICATION_ADDED, uid);
+    CHECK(sim_fetch_nb == nb + 1 && sim_fetch_uid == uid);
+    CHECK(sim_timer == APP_ANCSC_FETCH_TIMEOUT);
+    sim_data_source(uid, 20, 0xFFFF);
+    CHECK(!app_ancsc_env[IDX].fetching && sim_timer == 0);
+}
+
+/// The cache of a bonded NP is kept across its connections
+static void test_bonded(void)
+{
+    int nb;
+
+    sim_init();
+    sim_enable(&sim_addr[0]);
+    sim_fetch(100);
+    sim_fetch(101);
+    sim_disable();
+
+    sim_enable(&sim_addr[0]);
+    nb = sim_fetch_nb;
+    sim_ntf_source(NOTIFICATION_ADDED, 100);
+    sim_ntf_source(NOTIFICATION_ADDED, 101);
+    CHECK(sim_fetch_nb == nb);
+    CHECK(app_ancsc_env[IDX].stat.hit_nb == 2);
+
+    // a modified notification is fetched again
+    sim_ntf_source(NOTIFICATION_MODIFIED, 101);
+    CHECK(sim_fetch_nb == nb + 1 && sim_fetch_uid == 101);
+    sim_data_source(101, 7, 0xFFFF);
+    CHECK(!app_ancsc_env[IDX].fetching);
+    sim_disable();
+
+    // another peer on the connection does not get the cache
+    sim_enable(&sim_addr[1]);
+    sim_fetch(100);
+    sim_disable();
+}
+
+/// The cache of a peer which is not bonded is cleared at the disconnection
+static void test_not_bonded(void)
+{
+    sim_init();
+    sim_enable(&sim_addr[1]);
+    sim_fetch(200);
+    sim_ntf_source(NOTIFICATION_ADDED, 200);
+    CHECK(app_ancsc_env[IDX].stat.hit_nb == 1);
+    sim_disable();
+
+    sim_enable(&sim_addr[1]);
+    sim_fetch(200);
+    sim_disable();
+
+    // the bonded peer after it does not find the cache of the other one
+    sim_enable(&sim_addr[0]);
+    sim_fetch(200);
+    sim_disable();
+}
+
+/// The cache follows the bonded slot, not the address of the peer
+static void test_rpa(void)
+{
+    int nb;
+
+    sim_init();
+    sim_enable(&sim_addr[0]);
+    sim_fetch(400);
+    sim_disable();
+
+    // the NP reconnects with a new resolvable private address
+    sim_enable(&sim_addr[2]);
+    nb = sim_fetch_nb;
+    sim_ntf_source(NOTIFICATION_ADDED, 400);
+    CHECK(sim_fetch_nb == nb && app_ancsc_env[IDX].stat.hit_nb == 1);
+    sim_disable();
+
+    // the slot is given to another peer, its cache is dropped
+    app_ancsc_cache_drop(0);
+    sim_enable(&sim_addr[0]);
+    sim_fetch(400);
+    CHECK(app_ancsc_env[IDX].stat.hit_nb == 0);
+
+    // during a connection the cache is dropped at the disconnection
+    app_ancsc_cache_drop(0);
+    sim_ntf_source(NOTIFICATION_ADDED, 400);
+    CHECK(app_ancsc_env[IDX].stat.hit_nb == 1);
+    sim_disable();
+    sim_enable(&sim_addr[0]);
+    sim_fetch(400);
+    sim_disable();
+}
+
+/// A fetch without Data Source is dropped, the fragments restart the timer
+static void test_timeout(void)
+{
+    struct app_ancsc_env_tag *env = &app_ancsc_env[IDX];
+    int nb;
+
+    sim_init();
+    sim_enable(&sim_addr[0]);
+    nb = sim_fetch_nb;
+    sim_ntf_source(NOTIFICATION_ADDED, 300);
+    sim_ntf_source(NOTIFICATION_ADDED, 301);
+    CHECK(sim_fetch_nb == nb + 1 && sim_fetch_uid == 300);
+
+    // the first fragments arrive, the timer restarts
+    sim_timer = 1;
+    sim_data_source(300, 5, 10);
+    CHECK(sim_timer == APP_ANCSC_FETCH_TIMEOUT);
+
+    // then nothing: the fetch is dropped and the next one starts
+    app_ancsc_fetch_timer_handler(ANCS_FETCH_TIMER0 + IDX, NULL, TASK_APP, TASK_APP);
+    CHECK(env->stat.timeout_nb == 1);
+    CHECK(sim_fetch_nb == nb + 2 && sim_fetch_uid == 301);
+    CHECK(env->fetching && sim_timer == APP_ANCSC_FETCH_TIMEOUT);
+
+    // the response of the next fetch is kept, the dropped notification is not cached
+    sim_data_source(301, 20, 0xFFFF);
+    CHECK(!env->fetching && sim_timer == 0);
+    CHECK(app_ancsc_cache_find(env, 301) != APP_ANCSC_CACHE_SIZE);
+    CHECK(app_ancsc_cache_find(env, 300) == APP_ANCSC_CACHE_SIZE);
+
+    // a late timer of a completed fetch does nothing
+    app_ancsc_fetch_timer_handler(ANCS_FETCH_TIMER0 + IDX, NULL, TASK_APP, TASK_APP);
+    CHECK(env->stat.timeout_nb == 1 && sim_fetch_nb == nb + 2);
+    sim_disable();
+}
+
+int main(void)
+{
+    test_bonded();
+    test_not_bonded();
+    test_rpa();
+    test_timeout();
+    return host_result("test_ancsc");
+}
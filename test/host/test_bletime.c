@@ -0,0 +1,215 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_bletime.c
+ *
+ * @brief Monotonic clock on an RTC model: extension of the RTC count past 32 bits of
+ * ticks, the carry between the second and the sub-second reads, the wrap of the second
+ * counter, a backward RTC set, the wall time, and the deep sleep hold
+ *
+ * The registers are a RAM model behind the register access functions of the chip ROM.
+ * The RTC counts 32K ticks, the second counter is read from the tick count.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "intc.h"
+
+// The interrupt disabling writes the NVIC, there is no interrupt on the host
+#undef GLOBAL_INT_DISABLE
+#undef GLOBAL_INT_RESTORE
+#define GLOBAL_INT_DISABLE()    do {
+#define GLOBAL_INT_RESTORE()    } while (0)
+
+#include "bletime.c"
+#include "host.h"
+
+/// Peripheral registers
+static uint32_t apb_reg[0x10000 / 4];
+/// RTC count in 32K ticks
+static uint64_t sim_tick;
+/// Ticks added after the next read of the second counter
+static uint32_t sim_carry;
+
+struct sleep_env_tag sleep_env;
+
+uint32_t __rd_reg(uint32_t addr)
+{
+    uint32_t sec;
+
+    if (addr == (uint32_t)(uintptr_t)&QN_RTC->SEC) {
+        sec = (uint32_t)(sim_tick / QN_CLOCK_HZ);
+        sim_tick = (sim_tick + sim_carry) % RTC_TICK_RANGE;
+        sim_carry = 0;
+        return sec;
+    }
+    if (addr == (uint32_t)(uintptr_t)&QN_RTC->CNT) {
+        return sim_tick % QN_CLOCK_HZ;
+    }
+    if (addr < QN_APB_BASE || addr >= QN_APB_BASE + sizeof(apb_reg)) {
+        printf("register 0x%08x not modelled\n", addr);
+        abort();
+    }
+    return apb_reg[(addr - QN_APB_BASE) / 4];
+}
+
+void __wr_reg(uint32_t addr, uint32_t val)
+{
+    if (addr == (uint32_t)(uintptr_t)&QN_RTC->SEC) {
+        sim_tick = (uint64_t)val * QN_CLOCK_HZ;
+        return;
+    }
+    __rd_reg(addr);
+    apb_reg[(addr - QN_APB_BASE) / 4] = val;
+}
+
+void __wr_reg_with_msk(uint32_t addr, uint32_t msk, uint32_t val)
+{
+    __wr_reg(addr, (__rd_reg(addr) & ~msk) | (msk & val));
+}
+
+/// Start the RTC at a second count and the clock from 0
+static void sim_init(uint32_t sec)
+{
+    memset(apb_reg, 0, sizeof(apb_reg));
+    memset(&sleep_env, 0, sizeof(sleep_env));
+    sim_tick = 0;
+    qn_time_init();
+    sim_tick = (uint64_t)sec * QN_CLOCK_HZ;
+    s_clock_rtc = rtc_tick_read();
+}
+
+static void test_init(void)
+{
+    sim_init(0);
+    CHECK(rtc_rtc_GetCR(QN_RTC) & RTC_MASK_CFG);
+    CHECK(__rd_reg((uint32_t)(uintptr_t)&QN_SYSCON->CRSC) & SYSCON_MASK_GATING_32K_CLK);
+    CHECK(qn_clock_tick() == 0);
+
+    // a running RTC is not restarted
+    sim_tick = 1000 * QN_CLOCK_HZ;
+    qn_time_init();
+    CHECK(sim_tick == 1000 * QN_CLOCK_HZ);
+    CHECK(qn_clock_tick() == 0);
+
+    // deep sleep is refused until the clock is released
+    CHECK(sleep_env.clk32k_user_bf == CLK32K_MASK_BLE_TIME_BIT);
+    qn_clock_keep(false);
+    CHECK(sleep_env.clk32k_user_bf == 0);
+    qn_clock_keep(true);
+    CHECK(sleep_env.clk32k_user_bf == CLK32K_MASK_BLE_TIME_BIT);
+}
+
+/// The count goes past 32 bits of ticks, read at random intervals
+static void test_extension(void)
+{
+    uint64_t expect = 0;
+    uint32_t step;
+    int i;
+
+    sim_init(12345);
+    srand(37);
+    while (expect < 3 * 0x100000000ULL) {
+        step = (uint32_t)rand() * 7u % (3600u * QN_CLOCK_HZ);
+        sim_tick += step;
+        expect += step;
+        CHECK(qn_clock_tick() == expect);
+    }
+    CHECK(qn_clock_us() == QN_CLOCK_TICK_TO_US(expect));
+
+    // the conversion does not overflow for centuries
+    CHECK(QN_CLOCK_TICK_TO_US(QN_CLOCK_HZ) == 1000000);
+    CHECK(QN_CLOCK_TICK_TO_US(4) == 125);
+    CHECK(QN_CLOCK_TICK_TO_US((uint64_t)QN_CLOCK_HZ * 3600 * 24 * 365 * 500)
+          == 1000000ULL * 3600 * 24 * 365 * 500);
+
+    for (i = 0; i < 1000; i++) {
+        sim_tick++;
+        expect++;
+    }
+    CHECK(qn_clock_tick() == expect);
+}
+
+/// The second counter moves between the two reads
+static void test_carry(void)
+{
+    uint64_t t0;
+    int i;
+
+    sim_init(500);
+    for (i = 1; i < 200; i++) {
+        t0 = qn_clock_tick();
+        sim_tick = (sim_tick / QN_CLOCK_HZ + 1) * QN_CLOCK_HZ - i % 3 - 1;
+        t0 += (sim_tick - s_clock_rtc);
+        sim_carry = i % 5 + 1;
+        t0 += sim_carry;
+        // read after the carry
+        CHECK(qn_clock_tick() == t0);
+    }
+}
+
+/// The second counter wraps, and the step at the wrap is counted
+static void test_wrap(void)
+{
+    uint64_t t0;
+
+    sim_init(0xFFFFFFFF - 2);
+    t0 = qn_clock_tick();
+    sim_tick = (sim_tick + 5 * QN_CLOCK_HZ + 17) % RTC_TICK_RANGE;
+    CHECK(sim_tick < QN_CLOCK_HZ * 3);
+    CHECK(qn_clock_tick() == t0 + 5 * QN_CLOCK_HZ + 17);
+
+    CHECK(rtc_tick_elapsed(0, RTC_TICK_RANGE - 1) == 1);
+    CHECK(rtc_tick_elapsed(RTC_TICK_RANGE / 2, 0) == RTC_TICK_RANGE / 2);
+    CHECK(rtc_tick_elapsed(RTC_TICK_RANGE / 2 + 1, 0) == 0);
+    CHECK(rtc_tick_elapsed(0, 1) == 0);
+}
+
+/// A backward RTC set holds the clock
+static void test_backward(void)
+{
+    uint64_t t0;
+
+    sim_init(100000);
+    sim_tick += 3 * QN_CLOCK_HZ;
+    t0 = qn_clock_tick();
+    CHECK(t0 == 3 * QN_CLOCK_HZ);
+    sim_tick -= 10 * QN_CLOCK_HZ;
+    CHECK(qn_clock_tick() == t0);
+    sim_tick += QN_CLOCK_HZ;
+    CHECK(qn_clock_tick() == t0 + QN_CLOCK_HZ);
+}
+
+/// Wall time from the clock, rounded to the second
+static void test_wall(void)
+{
+    qn_tm_t tm = {2024, 2, 29, 23, 59, 30};
+
+    setenv("TZ", "UTC", 1);
+    tzset();
+    sim_init(77);
+    CHECK(qn_time_set(&tm));
+    sim_tick += 29 * QN_CLOCK_HZ + QN_CLOCK_HZ / 2 - 1;
+    qn_time_get(&tm);
+    CHECK(tm.year == 2024 && tm.month == 2 && tm.day == 29);
+    CHECK(tm.hour == 23 && tm.minutes == 59 && tm.seconds == 59);
+    sim_tick += 1;
+    qn_time_get(&tm);
+    CHECK(tm.year == 2024 && tm.month == 3 && tm.day == 1);
+    CHECK(tm.hour == 0 && tm.minutes == 0 && tm.seconds == 0);
+
+    tm.month = 13;
+    CHECK(!qn_time_set(&tm));
+}
+
+int main(void)
+{
+    test_init();
+    test_extension();
+    test_carry();
+    test_wrap();
+    test_backward();
+    test_wall();
+    return host_result("test_bletime");
+}
@@ -0,0 +1,238 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_bond.c
+ *
+ * @brief Bonded device database on an NVDS model: least recently used replacement across
+ * resets against a model, NVDS writes per bond and per use, NVDS capacity of the largest
+ * table, and the cost of the address lookup
+ *
+ ****************************************************************************************
+ */
+
+#include "app_env.h"
+#include "host.h"
+
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b);
+
+#undef co_bt_bdaddr_compare
+#define co_bt_bdaddr_compare host_bdaddr_compare
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_util.c"
+
+/// NVDS sector size
+#define NVDS_SIZE               0x1000
+/// NVDS header (magic word) and tag header (tag, status, length) of the ROM format, the
+/// data of a tag is padded to 4 bytes
+#define NVDS_MAGIC_LEN          4
+#define NVDS_TAG_HDR_LEN        4
+#define NVDS_TAG_SIZE(len)      (NVDS_TAG_HDR_LEN + (((len) + 3) & ~3))
+
+struct app_env_tag app_env;
+
+/// NVDS model, one entry per tag
+static uint8_t nvds_data[256][sizeof(struct app_bonded_rec)];
+static nvds_tag_len_t nvds_len[256];
+static int nvds_put_nb;
+
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b)
+{
+    return memcmp(a->addr, b->addr, BD_ADDR_LEN) == 0;
+}
+
+uint8_t __nvds_get(uint8_t tag, nvds_tag_len_t *lengthPtr, uint8_t *buf)
+{
+    if (nvds_len[tag] == 0) {
+        return NVDS_TAG_NOT_DEFINED;
+    }
+    if (*lengthPtr < nvds_len[tag]) {
+        return NVDS_LENGTH_OUT_OF_RANGE;
+    }
+    memcpy(buf, nvds_data[tag], nvds_len[tag]);
+    *lengthPtr = nvds_len[tag];
+    return NVDS_OK;
+}
+
+uint8_t __nvds_put(uint8_t tag, nvds_tag_len_t length, uint8_t *buf)
+{
+    CHECK(length <= sizeof(nvds_data[0]));
+    memcpy(nvds_data[tag], buf, length);
+    nvds_len[tag] = length;
+    nvds_put_nb++;
+    return NVDS_OK;
+}
+
+static void reset(void)
+{
+    memset(&app_env, 0, sizeof(app_env));
+    app_env.bonded_info = (struct app_bonded_info *)app_env.bonded_db;
+    app_load_bonded_dev();
+}
+
+static struct app_bonded_info make_dev(uint32_t n)
+{
+    struct app_bonded_info dev;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.sec_prop = 1;
+    memcpy(dev.peer_addr.addr, &n, sizeof(n));
+    dev.peer_addr.addr[5] = 0xC0;
+    dev.pair_info.ediv = n;
+    return dev;
+}
+
+static uint8_t find_dev(uint32_t n)
+{
+    struct app_bonded_info dev = make_dev(n);
+
+    return app_find_bonded_dev(&dev.peer_addr);
+}
+
+/// Every NVDS tag of the chip plus a full bonded table shall fit in the NVDS sector
+static void test_capacity(void)
+{
+    static const uint8_t sys_len[] = {
+        NVDS_LEN_BD_ADDRESS, NVDS_LEN_DEVICE_NAME, NVDS_LEN_LPCLK_DRIFT, NVDS_LEN_FACTORY_SETTING_0,
+        NVDS_LEN_OSC_WAKEUP_TIME, NVDS_LEN_RM_WAKEUP_TIME, NVDS_LEN_SLEEP_ENABLE,
+        NVDS_LEN_FACTORY_SETTING_1, NVDS_LEN_FACTORY_SETTING_2, NVDS_LEN_FACTORY_SETTING_3,
+        NVDS_LEN_TK_TYPE, NVDS_LEN_TK_KEY, NVDS_LEN_IRK_KEY, NVDS_LEN_CSRK_KEY, NVDS_LEN_LTK_KEY,
+        NVDS_LEN_XCSEL, NVDS_LEN_TEMPERATURE_OFFSET, NVDS_LEN_ADC_INT_REF_SCALE,
+        NVDS_LEN_ADC_INT_REF_VCM
+    };
+    uint32_t used = NVDS_MAGIC_LEN;
+    uint32_t slot = NVDS_TAG_SIZE(sizeof(struct app_bonded_rec));
+    uint32_t i;
+
+    for (i = 0; i < sizeof(sys_len); i++) {
+        used += NVDS_TAG_SIZE(sys_len[i]);
+    }
+#if (QN_CSRK_SUPPORT)
+    printf("NVDS: %u bytes of system tags, %u bytes per bonded device with CSRK\n", used, slot);
+#else
+    printf("NVDS: %u bytes of system tags, %u bytes per bonded device\n", used, slot);
+#endif
+    printf("NVDS: %d bonded devices take %u of %u bytes, room for %u\n", APP_MAX_BONDED_DEVICE_NUMBER,
+           used + APP_MAX_BONDED_DEVICE_NUMBER * slot, NVDS_SIZE, (NVDS_SIZE - used) / slot);
+    CHECK(used + APP_MAX_BONDED_DEVICE_NUMBER * slot <= NVDS_SIZE);
+    CHECK(APP_NVDS_DB_END_TAG < 100);
+}
+
+/// Random bonds and uses with resets, the replaced device is always the least recently
+/// used one of a model
+static void test_lru(void)
+{
+    static uint32_t model_dev[APP_MAX_BONDED_DEVICE_NUMBER];
+    static uint32_t model_use[APP_MAX_BONDED_DEVICE_NUMBER];
+    struct app_bonded_info dev;
+    uint32_t clock = 0, next_dev = 1;
+    int model_nb = 0;
+    int it, i, lru, puts;
+    uint8_t idx;
+
+    memset(nvds_len, 0, sizeof(nvds_len));
+    reset();
+    srand(5);
+    for (it = 0; it < 20000; it++) {
+        switch (rand() % 4) {
+        case 0:
+            // Bond a new device, it replaces the least recently used one when full
+            if (model_nb < APP_MAX_BONDED_DEVICE_NUMBER) {
+                i = model_nb++;
+            } else {
+                for (i = 0, lru = 1; lru < model_nb; lru++) {
+                    if (model_use[lru] < model_use[i]) {
+                        i = lru;
+                    }
+                }
+            }
+            dev = make_dev(next_dev);
+            puts = nvds_put_nb;
+            CHECK(app_add_bonded_dev(&dev));
+            CHECK(nvds_put_nb == puts + 1);
+            CHECK(find_dev(model_dev[i]) == GAP_INVALID_CONIDX);
+            model_dev[i] = next_dev++;
+            model_use[i] = ++clock;
+            break;
+        case 1:
+            // Reset
+            reset();
+            break;
+        default:
+            // Reconnect a bonded device
+            if (model_nb == 0) {
+                break;
+            }
+            i = rand() % model_nb;
+            idx = find_dev(model_dev[i]);
+            CHECK(idx != GAP_INVALID_CONIDX);
+            if (idx == GAP_INVALID_CONIDX) {
+                break;
+            }
+            CHECK(app_env.bonded_info[idx].pair_info.ediv == (uint16_t)model_dev[i]);
+            puts = nvds_put_nb;
+            app_update_bonded_dev_lru(idx);
+            // The most recently used device is not written again
+            CHECK(nvds_put_nb == puts + (model_use[i] != clock));
+            model_use[i] = ++clock;
+            break;
+        }
+    }
+
+    // All the devices of the model are bonded
+    CHECK(app_get_bond_nb() == model_nb);
+    for (i = 0; i < model_nb; i++) {
+        CHECK(find_dev(model_dev[i]) != GAP_INVALID_CONIDX);
+    }
+}
+
+/// Lookup cost of a present and of an unknown address against the former linear scan
+static void bench(void)
+{
+    struct app_bonded_info dev;
+    struct bd_addr addr[64];
+    uint64_t t0, t1, t2;
+    uint32_t n, loops = 200000;
+    uint32_t found = 0;
+    uint8_t nb, i, k;
+
+    memset(nvds_len, 0, sizeof(nvds_len));
+    reset();
+    printf("devices  hash ns  linear ns\n");
+    for (nb = 1; nb <= APP_MAX_BONDED_DEVICE_NUMBER; nb++) {
+        dev = make_dev(nb * 7919);
+        app_add_bonded_dev(&dev);
+        if (nb != 1 && nb != 4 && nb != 8 && nb != 16 && nb != APP_MAX_BONDED_DEVICE_NUMBER) {
+            continue;
+        }
+        // Half of the lookups for bonded devices, half for unknown ones
+        for (i = 0; i < 64; i++) {
+            addr[i] = make_dev((i & 1) ? (1 + i % nb) * 7919 : 1000000 + i).peer_addr;
+        }
+        t0 = host_ns();
+        for (n = 0; n < loops; n++) {
+            found += app_find_bonded_dev(&addr[n & 63]) != GAP_INVALID_CONIDX;
+        }
+        t1 = host_ns();
+        for (n = 0; n < loops; n++) {
+            for (k = 0; k < app_env.bonded_count; k++) {
+                if (host_bdaddr_compare(&addr[n & 63], &app_env.bonded_info[k].peer_addr)) {
+                    found++;
+                    break;
+                }
+            }
+        }
+        t2 = host_ns();
+        printf("%7d  %7.1f  %9.1f\n", nb, (double)(t1 - t0) / loops, (double)(t2 - t1) / loops);
+    }
+    CHECK(found != 0);
+}
+
+int main(void)
+{
+    test_capacity();
+    test_lru();
+    bench();
+    return host_result("test_bond");
+}
@@ -0,0 +1,556 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_cache.c
+ *
+ * @brief GATT discovery cache on a GATT model: the Service Changed setup through the GATT
+ * service range, the characteristic and its configuration descriptor, the GATT events of
+ * other links and procedures left to the application, a peer without GATT service, an
+ * aborted setup retried, the enable of the cached clients on encryption, the records of a
+ * peer reconnecting with a new resolvable private address and of a replaced bonded device,
+ * and the discovery of the enabled clients again after a Service Changed indication
+ *
+ * The record store runs on a RAM flash model. The GATT requests sent by the cache are kept
+ * by the kernel model, the test answers them with the GATT events.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+
+static void sim_read(uint32_t addr, uint32_t *buf, uint32_t len);
+static void sim_write(uint32_t addr, const uint32_t *buf, uint32_t len);
+static void sim_erase(uint32_t addr);
+
+#define APP_STORE_FLASH_READ(addr, buf, len)    sim_read(addr, buf, len)
+#define APP_STORE_FLASH_WRITE(addr, buf, len)   sim_write(addr, buf, len)
+#define APP_STORE_FLASH_ERASE(addr)             sim_erase(addr)
+
+#include "app_env.h"
+
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len);
+static void host_ke_msg_send(void const *param_ptr);
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b);
+
+#undef _ke_msg_alloc
+#undef _ke_msg_send
+#undef _co_bt_bdaddr_compare
+#define _ke_msg_alloc           host_ke_msg_alloc
+#define _ke_msg_send            host_ke_msg_send
+#define _co_bt_bdaddr_compare   host_bdaddr_compare
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_store.c"
+#include "app_cache.c"
+#include "host.h"
+
+#define SIM_SIZE        (QN_REC_STORE_BASE_ADDR + QN_REC_STORE_SECTOR_NUM * APP_STORE_SECTOR_SIZE)
+#define CONHDL          5
+#define CONHDL_OTHER    6
+#define IDX             0
+#define IDX_OTHER       1
+#define SRC             KE_BUILD_ID(TASK_GATT, IDX)
+#define SRC_OTHER       KE_BUILD_ID(TASK_GATT, IDX_OTHER)
+/// GATT service and Service Changed characteristic of the peer
+#define GATT_SHDL       0x0010
+#define GATT_EHDL       0x0020
+#define SC_HDL          0x0012
+#define SC_CFG_HDL      0x0014
+
+static uint8_t sim_flash[SIM_SIZE];
+
+/// Last message sent by the cache
+static struct
+{
+    struct ke_msg msg;
+    uint8_t param[64];
+} sim_msg;
+static int sim_msg_nb;
+
+/// Last characteristic write
+static uint16_t sim_write_hdl;
+static uint16_t sim_write_val;
+static int sim_write_nb;
+
+struct app_env_tag app_env;
+
+/// Connections, the peer of CONHDL is bonded in slot 0, the other one is not
+static struct bd_addr sim_addr[2] = {{{1, 2, 3, 4, 5, 6}}, {{6, 5, 4, 3, 2, 1}}};
+static bool sim_linked;
+/// Bonded device of slot 0
+static struct app_bonded_info sim_bonded;
+/// Flash writes
+static int sim_flash_write_nb;
+
+/// Client enable calls and the enabled clients
+static int sim_hrpc_nb;
+static struct hrs_content sim_hrpc_content;
+static bool sim_hrpc_enabled;
+static int sim_hrpc_disc_nb;
+static int sim_hrpc_disable_nb;
+static int sim_qppc_nb;
+
+static void sim_read(uint32_t addr, uint32_t *buf, uint32_t len)
+{
+    memcpy(buf, sim_flash + addr, len);
+}
+
+static void sim_write(uint32_t addr, const uint32_t *buf, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)buf;
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        sim_flash[addr + i] &= src[i];
+    }
+    sim_flash_write_nb++;
+}
+
+static void sim_erase(uint32_t addr)
+{
+    memset(sim_flash + addr, 0xFF, APP_STORE_SECTOR_SIZE);
+}
+
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len)
+{
+    CHECK(param_len <= sizeof(sim_msg.param));
+    memset(&sim_msg, 0, sizeof(sim_msg));
+    sim_msg.msg.id = id;
+    sim_msg.msg.dest_id = dest_id;
+    sim_msg.msg.src_id = src_id;
+    sim_msg.msg.param_len = param_len;
+    return ke_msg2param(&sim_msg.msg);
+}
+
+static void host_ke_msg_send(void const *param_ptr)
+{
+    CHECK(param_ptr == ke_msg2param(&sim_msg.msg));
+    sim_msg_nb++;
+}
+
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b)
+{
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+uint8_t app_get_bd_addr_by_conhdl(uint16_t conhdl, struct bd_addr *addr)
+{
+    uint8_t idx;
+
+    if (!sim_linked)
+        return GAP_INVALID_CONIDX;
+    if (conhdl == CONHDL)
+        idx = IDX;
+    else if (conhdl == CONHDL_OTHER)
+        idx = IDX_OTHER;
+    else
+        return GAP_INVALID_CONIDX;
+    if (addr != NULL)
+        *addr = sim_addr[idx];
+    return idx;
+}
+
+uint8_t app_get_rec_idx_by_conhdl(uint16_t conhdl)
+{
+    return app_get_bd_addr_by_conhdl(conhdl, NULL);
+}
+
+uint16_t app_get_conhdl_by_idx(uint8_t idx)
+{
+    return idx == IDX ? CONHDL : CONHDL_OTHER;
+}
+
+/// The address of CONHDL is the one of slot 0 once resolved
+uint8_t app_find_bonded_dev(struct bd_addr const *addr)
+{
+    return memcmp(addr, &sim_bonded.peer_addr, sizeof(*addr)) == 0 ? 0 : GAP_INVALID_CONIDX;
+}
+
+bool app_get_bond_status(uint8_t idx, uint8_t key_flag)
+{
+    CHECK(idx == 0);
+    return (sim_bonded.peer_distribute_keys & key_flag) != 0;
+}
+
+void app_gatt_write_char_req(uint8_t req_type, uint16_t conhdl, uint16_t valhdl, uint16_t val_len, uint8_t *pdata)
+{
+    CHECK(req_type == GATT_WRITE_CHAR && conhdl == CONHDL && val_len == 2);
+    sim_write_hdl = valhdl;
+    sim_write_val = co_read16p(pdata);
+    sim_write_nb++;
+}
+
+bool app_get_client_service_status(uint8_t idx, uint16_t clt_bit)
+{
+    return clt_bit == BLE_HR_COLLECTOR_BIT && idx == IDX && sim_hrpc_enabled;
+}
+
+void app_set_client_service_status(uint8_t idx, uint16_t clt_bit, bool enabled)
+{
+    CHECK(idx == IDX && clt_bit == BLE_HR_COLLECTOR_BIT);
+    sim_hrpc_enabled = enabled;
+}
+
+uint8_t app_get_qpp_client_service_status(uint8_t idx)
+{
+    return false;
+}
+
+void app_hrpc_enable_req(struct hrs_content *hrs, uint16_t conhdl)
+{
+    CHECK(conhdl == CONHDL);
+    if (hrs == NULL)
+    {
+        sim_hrpc_disc_nb++;
+        return;
+    }
+    sim_hrpc_content = *hrs;
+    sim_hrpc_nb++;
+}
+
+void app_hrpc_disable_req(uint16_t conhdl)
+{
+    CHECK(conhdl == CONHDL);
+    sim_hrpc_disable_nb++;
+}
+
+void app_qppc_enable_req(struct qpps_content *qpps, uint16_t conhdl)
+{
+    sim_qppc_nb++;
+}
+
+void app_qppc_disable_req(uint16_t conhdl)
+{
+    CHECK(0);
+}
+
+/// Check the last request of the cache and return its parameters
+static void *sim_req(ke_msg_id_t id)
+{
+    CHECK(sim_msg.msg.id == id && sim_msg.msg.dest_id == TASK_GATT);
+    return ke_msg2param(&sim_msg.msg);
+}
+
+static bool sim_cmp(ke_msg_id_t id, uint8_t status, ke_task_id_t src)
+{
+    struct gatt_cmp_evt evt = {.status = status};
+
+    return app_cache_gatt_evt(id, &evt, src);
+}
+
+static bool sim_svc(uint16_t shdl, uint16_t ehdl)
+{
+    struct gatt_disc_svc_by_uuid_cmp_evt evt = {.status = ATT_ERR_NO_ERROR, .nb_resp = 1};
+
+    evt.list[0].start_hdl = shdl;
+    evt.list[0].end_hdl = ehdl;
+    return app_cache_gatt_evt(GATT_DISC_SVC_BY_UUID_CMP_EVT, &evt, SRC);
+}
+
+static bool sim_char(uint16_t hdl)
+{
+    struct gatt_disc_char_by_uuid_cmp_evt evt = {.status = ATT_ERR_NO_ERROR, .nb_entry = 1};
+
+    evt.list[0].attr_hdl = hdl - 1;
+    evt.list[0].prop = ATT_CHAR_PROP_IND;
+    evt.list[0].pointer_hdl = hdl;
+    evt.list[0].uuid = ATT_CHAR_SERVICE_CHANGED;
+    return app_cache_gatt_evt(GATT_DISC_CHAR_BY_UUID_CMP_EVT, &evt, SRC);
+}
+
+static void sim_init(void)
+{
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    memset(&app_cache_env, 0, sizeof(app_cache_env));
+    app_cache_env.sc_conhdl = 0xFFFF;
+    app_store_init();
+    sim_linked = true;
+    sim_msg_nb = 0;
+    sim_write_nb = 0;
+    sim_hrpc_nb = 0;
+    sim_hrpc_disc_nb = 0;
+    sim_hrpc_disable_nb = 0;
+    sim_qppc_nb = 0;
+    sim_hrpc_enabled = false;
+
+    // the peer of CONHDL is bonded with its public address
+    memset(&sim_bonded, 0, sizeof(sim_bonded));
+    sim_bonded.peer_distribute_keys = SMP_KDIST_ENCKEY;
+    sim_bonded.peer_addr = sim_addr[0] = (struct bd_addr){{1, 2, 3, 4, 5, 6}};
+    app_env.bonded_info = &sim_bonded;
+}
+
+/// Connect the peer of CONHDL with a resolvable private address, resolved in slot 0
+static void sim_rpa(uint8_t last)
+{
+    sim_addr[0].addr[0] = last;
+    sim_addr[0].addr[5] = 0x40;
+    sim_bonded.peer_addr = sim_addr[0];
+    app_cache_conn(CONHDL);
+}
+
+/// Store the content of a heart rate service, the first store starts the setup
+static void sim_store_hrpc(uint16_t shdl, uint16_t ehdl)
+{
+    struct hrs_content hrs;
+
+    memset(&hrs, 0, sizeof(hrs));
+    hrs.svc.shdl = shdl;
+    hrs.svc.ehdl = ehdl;
+    hrs.chars[0].val_hdl = shdl + 2;
+    app_cache_env.link[IDX].hit = 0;
+    app_cache_store(CONHDL, APP_CACHE_HRPC, &hrs, sizeof(hrs), 1);
+}
+
+/// The setup goes through the service, characteristic and descriptor discoveries
+static void test_setup(void)
+{
+    struct gatt_disc_svc_req *svc_req;
+    struct gatt_disc_char_req *char_req;
+    struct gatt_disc_char_desc_req *desc_req;
+    struct gatt_disc_char_desc_cmp_evt desc1 = {1, {{0x13, ATT_DESC_CHAR_USER_DESCRIPTION}}};
+    struct gatt_disc_char_desc_cmp_evt desc2 = {3, {{SC_CFG_HDL, ATT_DESC_CLIENT_CHAR_CFG},
+                                                    {0x15, ATT_DECL_CHARACTERISTIC},
+                                                    {0x17, ATT_DESC_CLIENT_CHAR_CFG}}};
+    uint8_t value[4];
+
+    sim_init();
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_msg_nb == 1);
+    svc_req = sim_req(GATT_DISC_SVC_REQ);
+    CHECK(svc_req->conhdl == CONHDL && svc_req->req_type == GATT_DISC_BY_UUID_SVC);
+    CHECK(co_read16p(svc_req->desired_svc.value) == ATT_SVC_GENERIC_ATTRIBUTE);
+    // no cached content before the indication is enabled
+    CHECK(APP_CACHE_GET(CONHDL, APP_CACHE_HRPC, struct hrs_content) == NULL);
+
+    // a procedure of another link and another procedure of the link are not taken
+    CHECK(!sim_cmp(GATT_CMP_EVT, ATT_ERR_NO_ERROR, SRC_OTHER));
+    CHECK(!sim_cmp(GATT_WRITE_CHAR_RESP, ATT_ERR_NO_ERROR, SRC));
+    CHECK(!app_cache_gatt_evt(GATT_DISC_CHAR_DESC_CMP_EVT, &desc1, SRC));
+
+    CHECK(sim_svc(GATT_SHDL, GATT_EHDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_ATTRIBUTE_NOT_FOUND, SRC));
+    CHECK(sim_msg_nb == 2);
+    char_req = sim_req(GATT_DISC_CHAR_REQ);
+    CHECK(char_req->start_hdl == GATT_SHDL && char_req->end_hdl == GATT_EHDL);
+    CHECK(co_read16p(char_req->desired_char.value) == ATT_CHAR_SERVICE_CHANGED);
+
+    CHECK(!sim_svc(0x50, 0x60));
+    CHECK(sim_char(SC_HDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_msg_nb == 3);
+    desc_req = sim_req(GATT_DISC_CHAR_DESC_REQ);
+    CHECK(desc_req->start_hdl == SC_HDL + 1 && desc_req->end_hdl == GATT_EHDL);
+
+    // the descriptors come in several responses, up to the next characteristic
+    CHECK(app_cache_gatt_evt(GATT_DISC_CHAR_DESC_CMP_EVT, &desc1, SRC));
+    CHECK(app_cache_gatt_evt(GATT_DISC_CHAR_DESC_CMP_EVT, &desc2, SRC));
+    CHECK(app_cache_env.sc_cfg_hdl == SC_CFG_HDL);
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_write_nb == 1);
+    CHECK(sim_write_hdl == SC_CFG_HDL && sim_write_val == PRF_CLI_START_IND);
+
+    // a discovery of the application ends while the write runs
+    CHECK(!sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_cmp(GATT_WRITE_CHAR_RESP, ATT_ERR_NO_ERROR, SRC));
+    CHECK(app_cache_env.sc_step == APP_CACHE_SC_IDLE);
+    CHECK(!sim_cmp(GATT_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(APP_CACHE_GET(CONHDL, APP_CACHE_HRPC, struct hrs_content) != NULL);
+
+    // the indication of the changed range drops the record
+    co_write16p(value, 0x35);
+    co_write16p(value + 2, 0x50);
+    app_cache_svc_changed(CONHDL, SC_HDL + 1, value, sizeof(value));
+    CHECK(APP_CACHE_GET(CONHDL, APP_CACHE_HRPC, struct hrs_content) != NULL);
+    app_cache_svc_changed(CONHDL, SC_HDL, value, sizeof(value));
+    CHECK(APP_CACHE_GET(CONHDL, APP_CACHE_HRPC, struct hrs_content) == NULL);
+}
+
+/// A peer without GATT service shall not change its database
+static void test_no_gatt_svc(void)
+{
+    sim_init();
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_ATTRIBUTE_NOT_FOUND, SRC));
+    CHECK(sim_msg_nb == 1 && sim_write_nb == 0);
+    CHECK(APP_CACHE_GET(CONHDL, APP_CACHE_HRPC, struct hrs_content) != NULL);
+
+    // nor a GATT service without Service Changed characteristic
+    sim_init();
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_svc(GATT_SHDL, GATT_EHDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_cmp(GATT_CMP_EVT, ATT_ERR_ATTRIBUTE_NOT_FOUND, SRC));
+    CHECK(sim_write_nb == 0);
+    CHECK(APP_CACHE_GET(CONHDL, APP_CACHE_HRPC, struct hrs_content) != NULL);
+}
+
+/// A failed setup is not cached and runs again on the next discovery
+static void test_retry(void)
+{
+    struct gatt_disc_char_desc_cmp_evt desc_next = {2, {{0x13, ATT_DECL_CHARACTERISTIC},
+                                                        {SC_CFG_HDL, ATT_DESC_CLIENT_CHAR_CFG}}};
+    struct gatt_disc_char_desc_cmp_evt desc = {1, {{SC_CFG_HDL, ATT_DESC_CLIENT_CHAR_CFG}}};
+
+    // the descriptor after the next characteristic declaration is not the one
+    sim_init();
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_svc(GATT_SHDL, GATT_EHDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_char(SC_HDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(app_cache_gatt_evt(GATT_DISC_CHAR_DESC_CMP_EVT, &desc_next, SRC));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_ATTRIBUTE_NOT_FOUND, SRC));
+    CHECK(sim_write_nb == 0);
+    CHECK(app_cache_env.sc_step == APP_CACHE_SC_IDLE);
+    CHECK(APP_CACHE_GET(CONHDL, APP_CACHE_HRPC, struct hrs_content) == NULL);
+
+    // the write is rejected
+    sim_msg_nb = 0;
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_msg_nb == 1);
+    CHECK(sim_svc(GATT_SHDL, GATT_EHDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_char(SC_HDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(app_cache_gatt_evt(GATT_DISC_CHAR_DESC_CMP_EVT, &desc, SRC));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_write_nb == 1);
+    CHECK(sim_cmp(GATT_WRITE_CHAR_RESP, ATT_ERR_WRITE_NOT_PERMITTED, SRC));
+    CHECK(app_cache_env.sc_step == APP_CACHE_SC_IDLE);
+    CHECK(APP_CACHE_GET(CONHDL, APP_CACHE_HRPC, struct hrs_content) == NULL);
+
+    // the link is lost during the setup
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(app_cache_env.sc_step == APP_CACHE_SC_SVC);
+    sim_linked = false;
+    app_cache_conn(CONHDL_OTHER);
+    CHECK(app_cache_env.sc_step == APP_CACHE_SC_IDLE);
+    sim_linked = true;
+    CHECK(!sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+}
+
+/// The cached clients not yet enabled are enabled with their content
+static void test_enable(void)
+{
+    sim_init();
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_ATTRIBUTE_NOT_FOUND, SRC));
+
+    app_cache_enable(CONHDL);
+    CHECK(sim_hrpc_nb == 1 && sim_qppc_nb == 0);
+    CHECK(sim_hrpc_content.svc.shdl == 0x30 && sim_hrpc_content.chars[0].val_hdl == 0x32);
+    CHECK(app_cache_env.link[IDX].hit == 1 << APP_CACHE_HRPC);
+
+    sim_hrpc_enabled = true;
+    app_cache_enable(CONHDL);
+    CHECK(sim_hrpc_nb == 1);
+
+    // not bonded, or no link
+    sim_hrpc_enabled = false;
+    app_cache_enable(CONHDL_OTHER);
+    CHECK(sim_hrpc_nb == 1);
+    sim_linked = false;
+    app_cache_enable(CONHDL);
+    CHECK(sim_hrpc_nb == 1);
+}
+
+/// A peer with an identity resolving key finds its records with a new private address
+static void test_rpa(void)
+{
+    int write_nb;
+
+    sim_init();
+    sim_bonded.peer_distribute_keys = SMP_KDIST_ENCKEY | SMP_KDIST_IDKEY;
+    memcpy(sim_bonded.pair_info.irk.key, "IRK of the peer!", KEY_LEN);
+    sim_rpa(0x11);
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_ATTRIBUTE_NOT_FOUND, SRC));
+
+    // reconnected with another address, the content is used and nothing is written
+    sim_rpa(0x22);
+    write_nb = sim_flash_write_nb;
+    app_cache_enable(CONHDL);
+    CHECK(sim_hrpc_nb == 1 && sim_hrpc_content.svc.shdl == 0x30);
+    app_cache_store(CONHDL, APP_CACHE_HRPC, &sim_hrpc_content, sizeof(sim_hrpc_content), 1);
+    CHECK(sim_flash_write_nb == write_nb);
+
+    // another device bonded in the slot does not use the records
+    sim_init();
+    sim_bonded.peer_distribute_keys = SMP_KDIST_ENCKEY | SMP_KDIST_IDKEY;
+    memcpy(sim_bonded.pair_info.irk.key, "IRK of the peer!", KEY_LEN);
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_ATTRIBUTE_NOT_FOUND, SRC));
+    sim_bonded.pair_info.irk.key[0] ^= 1;
+    sim_rpa(0x33);
+    app_cache_enable(CONHDL);
+    CHECK(sim_hrpc_nb == 0);
+
+    // nor without identity resolving key with another address
+    sim_init();
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_ATTRIBUTE_NOT_FOUND, SRC));
+    sim_rpa(0x44);
+    app_cache_enable(CONHDL);
+    CHECK(sim_hrpc_nb == 0);
+}
+
+/// The client enabled with the cached content is disabled and discovers the service again
+static void test_svc_changed_enabled(void)
+{
+    uint8_t value[4];
+
+    sim_init();
+    sim_store_hrpc(0x30, 0x40);
+    CHECK(sim_svc(GATT_SHDL, GATT_EHDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_char(SC_HDL));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(app_cache_gatt_evt(GATT_DISC_CHAR_DESC_CMP_EVT,
+                             &(struct gatt_disc_char_desc_cmp_evt){1, {{SC_CFG_HDL, ATT_DESC_CLIENT_CHAR_CFG}}}, SRC));
+    CHECK(sim_cmp(GATT_DISC_CMP_EVT, ATT_ERR_NO_ERROR, SRC));
+    CHECK(sim_cmp(GATT_WRITE_CHAR_RESP, ATT_ERR_NO_ERROR, SRC));
+
+    app_cache_conn(CONHDL);
+    app_cache_enable(CONHDL);
+    CHECK(sim_hrpc_nb == 1);
+    sim_hrpc_enabled = true;
+
+    // a change out of the service does not touch the client
+    co_write16p(value, 0x50);
+    co_write16p(value + 2, 0x60);
+    app_cache_svc_changed(CONHDL, SC_HDL, value, sizeof(value));
+    CHECK(sim_hrpc_disable_nb == 0);
+
+    co_write16p(value, 0x35);
+    app_cache_svc_changed(CONHDL, SC_HDL, value, sizeof(value));
+    CHECK(sim_hrpc_disable_nb == 1 && sim_hrpc_disc_nb == 0);
+
+    // a disable of another profile, then the one of the client starts the discovery
+    app_cache_disabled(CONHDL, APP_CACHE_QPPC);
+    CHECK(sim_hrpc_disc_nb == 0);
+    app_cache_disabled(CONHDL, APP_CACHE_HRPC);
+    CHECK(sim_hrpc_disc_nb == 1 && !sim_hrpc_enabled);
+    app_cache_disabled(CONHDL, APP_CACHE_HRPC);
+    CHECK(sim_hrpc_disc_nb == 1);
+
+    // the discovered content is stored again
+    sim_store_hrpc(0x35, 0x45);
+    sim_hrpc_enabled = false;
+    app_cache_enable(CONHDL);
+    CHECK(sim_hrpc_nb == 2 && sim_hrpc_content.svc.shdl == 0x35);
+}
+
+int main(void)
+{
+    test_setup();
+    test_no_gatt_svc();
+    test_retry();
+    test_enable();
+    test_rpa();
+    test_svc_changed_enabled();
+    return host_result("test_cache");
+}
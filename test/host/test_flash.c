@@ -0,0 +1,213 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_flash.c
+ *
+ * @brief Serial flash bulk read and read-ahead cache on a memory mapped flash model:
+ * content against the flash, cache invalidation by write and erase, write and erase from
+ * the completion callback of a bulk read, and the read rate of the CPU read, the DMA bulk
+ * read and the read-ahead cache
+ *
+ * The flash window and the controller registers are mapped at their chip addresses, and
+ * the test is linked at a low address so the driver can pass buffer addresses on 32 bits.
+ * The DMA model copies at once, so the host rates compare the copies done by each path:
+ * on the chip the prefetch overlaps with the processing of the current page.
+ *
+ ****************************************************************************************
+ */
+
+#include <sys/mman.h>
+#include "serialflash.c"
+#include "host.h"
+
+#define SIM_FLASH_SIZE  0x20000
+#define SIM_MAP_SIZE    0x10000000
+
+/// Bytes copied by the DMA model, pages prefetched
+static uint32_t dma_bytes;
+
+/// Register access of the chip ROM, on the mapped controller registers
+uint32_t __rd_reg(uint32_t addr)
+{
+    return *(volatile uint32_t *)(uintptr_t)addr;
+}
+
+void __wr_reg(uint32_t addr, uint32_t val)
+{
+    *(volatile uint32_t *)(uintptr_t)addr = val;
+}
+
+void __wr_reg_with_msk(uint32_t addr, uint32_t msk, uint32_t val)
+{
+    __wr_reg(addr, (__rd_reg(addr) & ~msk) | (msk & val));
+}
+
+void dma_init(void)
+{
+}
+
+int dma_check_status(void)
+{
+    return DMA_FREE;
+}
+
+void dma_memory_copy(uint32_t src, uint32_t dst, uint32_t size, void (*callback)(void))
+{
+    memcpy((void *)(uintptr_t)dst, (void *)(uintptr_t)src, size);
+    dma_bytes += size;
+    if (callback != NULL) {
+        callback();
+    }
+}
+
+static uint8_t *flash_map(void)
+{
+    void *p = mmap((void *)QN_FLASH_BASE, SIM_MAP_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE | MAP_NORESERVE, -1, 0);
+
+    if (p != (void *)QN_FLASH_BASE) {
+        printf("can not map the flash window at 0x%08lx\n", (unsigned long)QN_FLASH_BASE);
+        exit(1);
+    }
+    return p;
+}
+
+static uint8_t *flash;
+static uint8_t out[SIM_FLASH_SIZE];
+static uint32_t page_buf[FLASH_PAGE_SIZE / 4];
+
+/// Reads of random position and length follow the flash content
+static void test_seq(void)
+{
+    uint32_t addr, len, n;
+
+    flash_read_ahead_reset();
+    for (n = 0; n < 20000; n++) {
+        addr = 0x1000 + rand() % (SIM_FLASH_SIZE - 0x2000);
+        len = 1 + rand() % (2 * FLASH_PAGE_SIZE);
+        memset(out, 0, len);
+        read_flash_seq(addr, out, len);
+        CHECK(memcmp(out, flash + addr, len) == 0);
+    }
+
+    // A sequential reader gets every page after the first one from the prefetch, the
+    // page after the region is prefetched too
+    flash_read_ahead_reset();
+    dma_bytes = 0;
+    for (addr = 0x4000; addr + 20 <= 0x8000; addr += 20) {
+        read_flash_seq(addr, out, 20);
+        CHECK(memcmp(out, flash + addr, 20) == 0);
+    }
+    CHECK(dma_bytes == 0x4000);
+}
+
+/// Write and erase invalidate the cached pages
+static void test_invalidate(void)
+{
+    uint32_t i;
+
+    read_flash_seq(0x5000, out, 16);
+    for (i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        page_buf[i] = 0xA5A5A5A5;
+    }
+    write_flash(0x5000, page_buf, FLASH_PAGE_SIZE);
+    CHECK(flash[0x5000] == 0xA5);
+    read_flash_seq(0x5000, out, 16);
+    CHECK(out[0] == 0xA5 && out[15] == 0xA5);
+
+    read_flash_seq(0x5100, out, 16);
+    memset(flash + 0x5100, 0xFF, FLASH_PAGE_SIZE);   // the erase command has no effect on the model
+    sector_erase_flash(0x5000, 1);
+    read_flash_seq(0x5100, out, 16);
+    CHECK(out[0] == 0xFF);
+}
+
+static void done(void)
+{
+}
+
+static int cb_write_nb;
+
+/// Bulk read callback writing the flash, the bulk read is not busy any more
+static void done_write(void)
+{
+    CHECK(!is_flash_dma_busy());
+    write_flash(0x6000, page_buf, FLASH_PAGE_SIZE);
+    sector_erase_flash(0x7000, 1);
+    cb_write_nb++;
+}
+
+/// Write and erase wait for the bulk read, and do not wait in its completion callback
+static void test_write_in_cb(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < FLASH_PAGE_SIZE / 4; i++) {
+        page_buf[i] = 0x5A5A5A5A;
+    }
+    read_flash_dma(0x1000, (uint32_t *)out, 0x2000, done_write);
+    while (is_flash_dma_busy());
+    CHECK(cb_write_nb == 1);
+    CHECK(flash[0x6000] == 0x5A && flash[0x60FF] == 0x5A);
+    CHECK(memcmp(out, flash + 0x1000, 0x2000) == 0);
+}
+
+static void bench(void)
+{
+    uint32_t size = SIM_FLASH_SIZE - 0x1000;
+    uint32_t addr, chunk, n, rounds = 20;
+    uint64_t t0, t1;
+
+    printf("path                  MB/s (host)  by DMA\n");
+
+    t0 = host_ns();
+    for (n = 0; n < rounds; n++) {
+        for (addr = 0x1000; addr < SIM_FLASH_SIZE; addr += FLASH_PAGE_SIZE) {
+            read_flash(addr, (uint32_t *)(out + addr - 0x1000), FLASH_PAGE_SIZE);
+        }
+    }
+    t1 = host_ns();
+    printf("read_flash page loop  %11.1f  %5.1f%%\n", (double)size * rounds * 1000 / (t1 - t0), 0.0);
+
+    dma_bytes = 0;
+    t0 = host_ns();
+    for (n = 0; n < rounds; n++) {
+        read_flash_dma(0x1000, (uint32_t *)out, size, done);
+        while (is_flash_dma_busy());
+    }
+    t1 = host_ns();
+    printf("read_flash_dma        %11.1f  %5.1f%%\n", (double)size * rounds * 1000 / (t1 - t0),
+           (double)dma_bytes * 100 / size / rounds);
+    CHECK(memcmp(out, flash + 0x1000, size) == 0);
+
+    for (chunk = 16; chunk <= 256; chunk *= 4) {
+        flash_read_ahead_reset();
+        dma_bytes = 0;
+        t0 = host_ns();
+        for (n = 0; n < rounds; n++) {
+            for (addr = 0x1000; addr + chunk <= SIM_FLASH_SIZE; addr += chunk) {
+                read_flash_seq(addr, out + addr - 0x1000, chunk);
+            }
+        }
+        t1 = host_ns();
+        printf("read_flash_seq %3d B  %11.1f  %5.1f%%\n", chunk, (double)size * rounds * 1000 / (t1 - t0),
+               (double)dma_bytes * 100 / size / rounds);
+    }
+}
+
+int main(void)
+{
+    uint32_t i;
+
+    flash = flash_map();
+    for (i = 0; i < SIM_FLASH_SIZE; i++) {
+        flash[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+    srand(3);
+
+    test_seq();
+    test_invalidate();
+    test_write_in_cb();
+    bench();
+    return host_result("test_flash");
+}
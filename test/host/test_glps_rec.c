@@ -0,0 +1,449 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_glps_rec.c
+ *
+ * @brief Glucose record store on a RAM flash model: the mount from whole page reads, the
+ * measurements kept across a remount and the wrap of the log, and the report of the
+ * stored records through the GLPS notification queue, also when a notification fails, and
+ * the mount, the counts and the report of a full log with their flash page reads
+ *
+ * The flash functions of the chip ROM are replaced by a RAM model which checks the page
+ * reads and the programming. The measurements of a report go to the notification queue of
+ * GLPS, the test plays GATT: it takes the notified values and completes them, and delivers
+ * the GLPS completions to the store.
+ *
+ * The test is built with the default 4 sectors, and with 31 sectors (test_glps_rec_big),
+ * the whole 128KB flash above the NVDS sector. On the chip the mount and the reports are
+ * bound by the page reads, the benchmark prints them with the host times.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+#include "host.h"
+
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len);
+static void host_ke_msg_send(void const *param_ptr);
+static uint8_t host_attsdb_att_set_value(uint16_t handle, atts_size_t length, uint8_t *value);
+
+#undef _ke_msg_alloc
+#undef _ke_msg_send
+#undef _attsdb_att_set_value
+#define _ke_msg_alloc           host_ke_msg_alloc
+#define _ke_msg_send            host_ke_msg_send
+#define _attsdb_att_set_value   host_attsdb_att_set_value
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_glps_rec.c"
+#include "glps.c"
+
+#define SIM_SIZE        0x20000
+#define CONHDL          5
+/// Repetitions of the count benchmark
+#define BENCH_NB        2000
+
+static uint8_t sim_flash[SIM_SIZE];
+/// Flash reads, and the reads which are not a whole page
+static int sim_read_nb;
+static int sim_read_bad_nb;
+
+/// GLPS requests of the store
+static struct app_glps_env_tag sim_glps_env;
+struct app_glps_env_tag *app_glps_env = &sim_glps_env;
+static int sim_meas_nb;
+static uint16_t sim_meas_seq;
+static int sim_rsp_nb;
+static uint8_t sim_rsp_op;
+static uint8_t sim_rsp_status;
+static uint16_t sim_rsp_num;
+
+/// Messages of GLPS, the completions are kept for the store
+static struct
+{
+    struct ke_msg msg;
+    uint32_t param[4];
+} sim_msg[4];
+static int sim_msg_idx;
+static uint8_t sim_cmp_status[GLPS_NTF_QUEUE_SIZE * 2];
+static int sim_cmp_nb;
+/// Notifications requested to GATT
+static int sim_ntf_nb;
+
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len)
+{
+    struct ke_msg *msg = &sim_msg[sim_msg_idx++ % 4].msg;
+
+    CHECK(param_len <= sizeof(sim_msg[0].param));
+    msg->id = id;
+    msg->dest_id = dest_id;
+    msg->src_id = src_id;
+    return ke_msg2param(msg);
+}
+
+static void host_ke_msg_send(void const *param_ptr)
+{
+    struct ke_msg *msg = ke_param2msg(param_ptr);
+    struct glps_req_cmp_evt const *evt = param_ptr;
+
+    if (msg->id == GATT_NOTIFY_REQ) {
+        sim_ntf_nb++;
+    } else if (msg->id == GLPS_REQ_CMP_EVT) {
+        CHECK(evt->request == GLPS_SEND_MEAS_REQ_NTF_CMP);
+        CHECK(sim_cmp_nb < (int)sizeof(sim_cmp_status));
+        sim_cmp_status[sim_cmp_nb++] = evt->status;
+    }
+}
+
+static uint8_t host_attsdb_att_set_value(uint16_t handle, atts_size_t length, uint8_t *value)
+{
+    return ATT_ERR_NO_ERROR;
+}
+
+void read_flash(uint32_t addr, uint32_t *pBuf, uint32_t nbyte)
+{
+    CHECK(addr + nbyte <= SIM_SIZE);
+    sim_read_nb++;
+    if (addr % APP_GLPS_REC_PAGE_SIZE || nbyte != APP_GLPS_REC_PAGE_SIZE)
+        sim_read_bad_nb++;
+    memcpy(pBuf, sim_flash + addr, nbyte);
+}
+
+void write_flash(uint32_t addr, const uint32_t *pBuf, uint32_t nbyte)
+{
+    const uint8_t *src = (const uint8_t *)pBuf;
+    uint32_t i;
+
+    // whole pages only, programming can only clear bits
+    CHECK(addr % APP_GLPS_REC_PAGE_SIZE == 0 && nbyte == APP_GLPS_REC_PAGE_SIZE);
+    for (i = 0; i < nbyte; i++) {
+        sim_flash[addr + i] &= src[i];
+    }
+}
+
+void sector_erase_flash(uint32_t addr, uint32_t n)
+{
+    CHECK(addr % APP_GLPS_REC_SECTOR_SIZE == 0 && n == 1);
+    memset(sim_flash + addr, 0xFF, APP_GLPS_REC_SECTOR_SIZE);
+}
+
+void app_glps_racp_rsp_req_send(uint16_t conhdl, uint16_t num_of_record, uint8_t op_code, uint8_t status)
+{
+    CHECK(conhdl == CONHDL);
+    sim_rsp_nb++;
+    sim_rsp_num = num_of_record;
+    sim_rsp_op = op_code;
+    sim_rsp_status = status;
+}
+
+/// Queue the notifications of a measurement in GLPS
+void app_glps_meas_without_ctx_req_send(uint16_t conhdl, uint16_t seq_num, struct glp_meas *meas)
+{
+    CHECK(conhdl == CONHDL);
+    CHECK(sim_meas_nb == 0 || seq_num == sim_meas_seq + 1);
+    CHECK(glps_env.ntf_nb < GLPS_NTF_QUEUE_SIZE);
+    sim_meas_seq = seq_num;
+    sim_meas_nb++;
+    glps_ntf_alloc(GLS_IDX_MEAS_VAL, 1);
+    glps_ntf_send();
+}
+
+void app_glps_meas_with_ctx_req_send(uint16_t conhdl, uint16_t seq_num, struct glp_meas *meas, struct glp_meas_ctx *ctx)
+{
+    CHECK(conhdl == CONHDL);
+    CHECK(sim_meas_nb == 0 || seq_num == sim_meas_seq + 1);
+    CHECK(glps_env.ntf_nb + 2 <= GLPS_NTF_QUEUE_SIZE);
+    sim_meas_seq = seq_num;
+    sim_meas_nb++;
+    glps_ntf_alloc(GLS_IDX_MEAS_VAL, 0);
+    glps_ntf_alloc(GLS_IDX_MEAS_CTX_VAL, 1);
+    glps_ntf_send();
+}
+
+/// GATT takes the value of the requested notification
+static void sim_gatt_get_data(void)
+{
+    GLPS_CLEAR(NTF_GET_DATA);
+    glps_ntf_send();
+}
+
+/// Deliver the GLPS completions to the store
+static void sim_deliver(void)
+{
+    int i, nb = sim_cmp_nb;
+
+    sim_cmp_nb = 0;
+    for (i = 0; i < nb; i++) {
+        app_glps_rec_send_cmp(sim_cmp_status[i]);
+    }
+}
+
+/// GATT completes the oldest notification
+static void sim_gatt_cmp(uint8_t status)
+{
+    glps_ntf_cmp(status);
+    sim_deliver();
+}
+
+/// Run the report until it ends, GATT takes every requested value and completes it
+static void sim_gatt_run(void)
+{
+    while (glps_env.ntf_sent) {
+        if (GLPS_IS(NTF_GET_DATA))
+            sim_gatt_get_data();
+        sim_gatt_cmp(PRF_ERR_OK);
+    }
+}
+
+static void sim_init(void)
+{
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    memset(&glps_env, 0, sizeof(glps_env));
+    GLPS_SET(MEAS_CTX_SUPPORTED);
+    sim_glps_env.evt_cfg = GLPS_MEAS_NTF_CFG;
+    sim_cmp_nb = 0;
+    app_glps_rec_init();
+}
+
+static void sim_add(uint16_t nb, bool ctx)
+{
+    struct glp_meas meas;
+    struct glp_meas_ctx meas_ctx;
+    uint16_t i;
+
+    memset(&meas, 0, sizeof(meas));
+    memset(&meas_ctx, 0, sizeof(meas_ctx));
+    meas.base_time.year = 2015;
+    meas.base_time.month = 6;
+    meas.base_time.day = 1;
+    for (i = 0; i < nb; i++) {
+        meas.base_time.min = i % 60;
+        meas.base_time.hour = (i / 60) % 24;
+        CHECK(app_glps_rec_add(&meas, ctx ? &meas_ctx : NULL) == APP_GLPS_REC_OK);
+    }
+}
+
+static void sim_racp(uint8_t op_code, uint8_t operator)
+{
+    struct glp_racp_req req;
+
+    memset(&req, 0, sizeof(req));
+    req.op_code = op_code;
+    req.filter.operator = operator;
+    sim_rsp_nb = 0;
+    app_glps_rec_racp(CONHDL, &req);
+}
+
+/// The mount reads whole pages and finds the measurements again
+static void test_mount(void)
+{
+    sim_init();
+    sim_add(100, false);
+    app_glps_rec_flush();
+    CHECK(app_glps_rec_get_nb() == 100);
+
+    sim_read_nb = 0;
+    sim_read_bad_nb = 0;
+    app_glps_rec_init();
+    CHECK(app_glps_rec_get_nb() == 100);
+    CHECK(sim_read_nb > 0 && sim_read_bad_nb == 0);
+
+    // the records of the page buffer not programmed are lost
+    sim_add(5, false);
+    app_glps_rec_init();
+    CHECK(app_glps_rec_get_nb() == 100);
+    CHECK(sim_read_bad_nb == 0);
+}
+
+/// The oldest sector is dropped when the log is full
+static void test_wrap(void)
+{
+    sim_init();
+    sim_add(APP_GLPS_REC_CAPACITY + APP_GLPS_REC_SECTOR_PAGES * APP_GLPS_REC_PAGE_RECS, false);
+    app_glps_rec_flush();
+    CHECK(app_glps_rec_get_nb() >= APP_GLPS_REC_CAPACITY);
+    CHECK(app_glps_rec_get_nb() < APP_GLPS_REC_CAPACITY + APP_GLPS_REC_SECTOR_PAGES * APP_GLPS_REC_PAGE_RECS);
+    sim_read_bad_nb = 0;
+    sim_racp(GLP_REQ_REP_NUM_OF_STRD_RECS, GLP_OP_ALL_RECS);
+    CHECK(sim_rsp_nb == 1 && sim_rsp_num == app_glps_rec_get_nb());
+    app_glps_rec_init();
+    CHECK(sim_rsp_num == app_glps_rec_get_nb());
+    CHECK(sim_read_bad_nb == 0);
+}
+
+/// All the stored records are notified in order, then the RACP response is sent
+static void test_report(void)
+{
+    sim_init();
+    sim_add(50, false);
+    sim_meas_nb = 0;
+    sim_racp(GLP_REQ_REP_STRD_RECS, GLP_OP_ALL_RECS);
+    // several records are queued in GLPS
+    CHECK(app_glps_rec_env.pend_nb == APP_GLPS_REC_WINDOW && glps_env.ntf_nb == APP_GLPS_REC_WINDOW);
+    sim_gatt_run();
+    CHECK(sim_meas_nb == 50);
+    CHECK(sim_rsp_nb == 1 && sim_rsp_op == GLP_REQ_REP_STRD_RECS && sim_rsp_status == GLP_RSP_SUCCESS);
+    CHECK(app_glps_rec_env.pend_nb == 0 && glps_env.ntf_nb == 0);
+}
+
+/// A failed notification ends the report, the dropped records complete and the next report
+/// has its whole window
+static void test_report_error(void)
+{
+    int ctx, fail;
+
+    for (ctx = 0; ctx < 2; ctx++) {
+        sim_init();
+        if (ctx)
+            sim_glps_env.evt_cfg |= GLPS_MEAS_CTX_NTF_CFG;
+        sim_add(50, ctx);
+        // the failed notification is the first one, or a context after a measurement value
+        for (fail = 0; fail < 3; fail++) {
+            sim_meas_nb = 0;
+            sim_racp(GLP_REQ_REP_STRD_RECS, GLP_OP_ALL_RECS);
+            CHECK(app_glps_rec_env.pend_nb == APP_GLPS_REC_WINDOW);
+            if (fail > 0) {
+                sim_gatt_get_data();
+                if (fail > 1)
+                    sim_gatt_cmp(PRF_ERR_OK);
+            }
+            sim_gatt_cmp(ATT_INSUFF_RESOURCE);
+            CHECK(sim_rsp_nb == 1 && sim_rsp_status == GLP_RSP_PROCEDURE_NOT_COMPLETED);
+            // the values already taken by GATT still complete
+            sim_gatt_run();
+            CHECK(app_glps_rec_env.pend_nb == 0 && glps_env.ntf_nb == 0);
+            CHECK(!GLPS_IS(SENDING_MEAS));
+            CHECK(sim_rsp_nb == 1);
+        }
+
+        sim_meas_nb = 0;
+        sim_racp(GLP_REQ_REP_STRD_RECS, GLP_OP_ALL_RECS);
+        CHECK(app_glps_rec_env.pend_nb == APP_GLPS_REC_WINDOW);
+        sim_gatt_run();
+        CHECK(sim_meas_nb == 50 && sim_rsp_status == GLP_RSP_SUCCESS);
+    }
+}
+
+/// Time of a measurement taken every 5 minutes, in minutes from 2015
+static void sim_time(uint32_t m, struct prf_date_time *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->year = 2015 + m / 483840;
+    t->month = 1 + (m / 40320) % 12;
+    t->day = 1 + (m / 1440) % 28;
+    t->hour = (m / 60) % 24;
+    t->min = m % 60;
+}
+
+/// Fill the log past its capacity with measurements 5 minutes apart
+static uint64_t sim_fill(void)
+{
+    struct glp_meas meas;
+    uint64_t t = host_ns();
+    uint32_t i;
+
+    memset(&meas, 0, sizeof(meas));
+    for (i = 0; i < APP_GLPS_REC_CAPACITY + APP_GLPS_REC_SECTOR_PAGES * APP_GLPS_REC_PAGE_RECS; i++) {
+        sim_time(app_glps_rec_env.next_seq * 5, &meas.base_time);
+        CHECK(app_glps_rec_add(&meas, NULL) == APP_GLPS_REC_OK);
+    }
+    app_glps_rec_flush();
+    return host_ns() - t;
+}
+
+/// Mount, counts and report of a full log, with their page reads
+static void bench_full(void)
+{
+    static const char * const name[4] = {"all", "last", "seq half", "time half"};
+    struct glp_filter f;
+    struct app_glps_rec_query q;
+    uint64_t t_fill, t_mount, t;
+    uint16_t first, last, min, max, count = 0, expect;
+    int op, i, rec_nb, mount_reads, reads;
+
+    sim_init();
+    t_fill = sim_fill();
+    rec_nb = app_glps_rec_get_nb();
+
+    sim_read_nb = 0;
+    t_mount = host_ns();
+    app_glps_rec_init();
+    t_mount = host_ns() - t_mount;
+    mount_reads = sim_read_nb;
+    // the sector headers, then each page once at most
+    CHECK(app_glps_rec_get_nb() == rec_nb);
+    CHECK(mount_reads <= QN_GLPS_REC_SECTOR_NUM + APP_GLPS_REC_PAGE_NUM);
+
+    printf("%d sectors, %d records: fill %.2f us/record, mount %.0f us with %d page reads\n",
+           QN_GLPS_REC_SECTOR_NUM, rec_nb, t_fill / 1e3 / rec_nb, t_mount / 1e3, mount_reads);
+
+    CHECK(app_glps_rec_edge(false, &first) && app_glps_rec_edge(true, &last));
+    CHECK(last - first + 1 == rec_nb);
+    for (op = 0; op < 4; op++) {
+        memset(&f, 0, sizeof(f));
+        if (op == 0) {
+            f.operator = GLP_OP_ALL_RECS;
+            expect = rec_nb;
+        } else if (op == 1) {
+            f.operator = GLP_OP_LAST_REC;
+            expect = 1;
+        } else {
+            // middle half, the time range starts inside a page
+            min = first + (last - first) / 4;
+            max = last - (last - first) / 4;
+            expect = max - min + 1;
+            f.operator = GLP_OP_WITHIN_RANGE_OF;
+            if (op == 2) {
+                f.filter_type = GLP_FILTER_SEQ_NUMBER;
+                f.val.seq_num.min = min;
+                f.val.seq_num.max = max;
+            } else {
+                f.filter_type = GLP_FILTER_USER_FACING_TIME;
+                sim_time(min * 5 + 2, &f.val.time.base_min);
+                sim_time(max * 5, &f.val.time.base_max);
+                expect--;
+            }
+        }
+
+        app_glps_rec_env.cache_page = APP_GLPS_REC_NO_PAGE;
+        sim_read_nb = 0;
+        t = host_ns();
+        for (i = 0; i < BENCH_NB; i++) {
+            CHECK(app_glps_rec_query_set(&f, &q) == GLP_RSP_SUCCESS);
+            count = app_glps_rec_count(&q);
+        }
+        t = host_ns() - t;
+        reads = sim_read_nb;
+        CHECK(count == expect);
+        // the counts are resolved from the page table, the time filter reads the first and
+        // last pages which are partially inside, they evict each other from the read cache
+        CHECK(reads <= (op == 3 ? 2 * BENCH_NB : 0));
+        printf("  count %-9s %5d records, %6.2f us, %.0f page reads\n", name[op], count,
+               t / 1e3 / BENCH_NB, (double)reads / BENCH_NB);
+    }
+
+    // the report reads each page once
+    sim_meas_nb = 0;
+    sim_read_nb = 0;
+    t = host_ns();
+    sim_racp(GLP_REQ_REP_STRD_RECS, GLP_OP_ALL_RECS);
+    sim_gatt_run();
+    t = host_ns() - t;
+    CHECK(sim_meas_nb == rec_nb && sim_rsp_status == GLP_RSP_SUCCESS);
+    CHECK(sim_read_nb <= APP_GLPS_REC_PAGE_NUM);
+    printf("  report all %d records, %.2f us/record, %d page reads\n", sim_meas_nb, t / 1e3 / rec_nb, sim_read_nb);
+}
+
+int main(void)
+{
+    test_mount();
+    test_wrap();
+    test_report();
+    test_report_error();
+    bench_full();
+    return host_result("test_glps_rec");
+}
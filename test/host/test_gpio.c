@@ -0,0 +1,269 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_gpio.c
+ *
+ * @brief GPIO edge capture and button gestures on a pin model: the arming for the opposite
+ * edge when the pin bounces during the arming, the edge times in us, the full buffer, and
+ * the gestures recognized on the edge times, with and without the double click and the long
+ * press
+ *
+ * The GPIO block is a RAM page at its AHB address, the system controller registers are a
+ * RAM model behind the register access functions of the chip ROM. An edge interrupt is
+ * latched when the pin leaves the level the wakeup register is armed from.
+ *
+ ****************************************************************************************
+ */
+
+#include <sys/mman.h>
+#include <string.h>
+#include "gpio.c"
+#include "button.c"
+#include "host.h"
+
+#define TEST_PIN        GPIO_P13
+
+/// Peripheral registers
+static uint32_t apb_reg[0x10000 / 4];
+/// Time returned by qn_clock_us()
+static uint64_t sim_us;
+/// Pin toggles injected in the next reads of the wakeup register
+static int sim_race_nb;
+/// Latched edge interrupts
+static uint32_t sim_pending;
+
+uint64_t qn_clock_us(void)
+{
+    return sim_us;
+}
+
+static uint32_t sim_armed(enum gpio_pin pin)
+{
+    return (apb_reg[((uint32_t)(uintptr_t)&QN_SYSCON->IOWCR - QN_APB_BASE) / 4] >> 16) & pin;
+}
+
+static void sim_pin_set(enum gpio_pin pin, uint32_t level)
+{
+    QN_GPIO->DATA = level ? QN_GPIO->DATA | pin : QN_GPIO->DATA & ~pin;
+    if ((QN_GPIO->DATA & pin) != sim_armed(pin))
+        sim_pending |= pin;
+}
+
+uint32_t __rd_reg(uint32_t addr)
+{
+    if (addr < QN_APB_BASE || addr >= QN_APB_BASE + sizeof(apb_reg)) {
+        printf("register 0x%08x not modelled\n", addr);
+        abort();
+    }
+    if (addr == (uint32_t)(uintptr_t)&QN_SYSCON->IOWCR && sim_race_nb) {
+        // the pin bounces while it is armed
+        sim_race_nb--;
+        sim_pin_set(TEST_PIN, !(QN_GPIO->DATA & TEST_PIN));
+    }
+    return apb_reg[(addr - QN_APB_BASE) / 4];
+}
+
+void __wr_reg(uint32_t addr, uint32_t val)
+{
+    if (addr < QN_APB_BASE || addr >= QN_APB_BASE + sizeof(apb_reg)) {
+        printf("register 0x%08x not modelled\n", addr);
+        abort();
+    }
+    apb_reg[(addr - QN_APB_BASE) / 4] = val;
+}
+
+void __wr_reg_with_msk(uint32_t addr, uint32_t msk, uint32_t val)
+{
+    __wr_reg(addr, (__rd_reg(addr) & ~msk) | (msk & val));
+}
+
+/// Call the capture like the GPIO interrupt while an edge is latched
+static void sim_irq(void)
+{
+    while (sim_pending & TEST_PIN) {
+        sim_pending &= ~TEST_PIN;
+        gpio_edge_capture(TEST_PIN);
+    }
+}
+
+static void sim_init(uint32_t level)
+{
+    struct gpio_edge edge;
+
+    memset(apb_reg, 0, sizeof(apb_reg));
+    sim_pin_set(TEST_PIN, level);
+    gpio_edge_capture_enable(TEST_PIN);
+    while (gpio_edge_get(&edge));
+    sim_pending = 0;
+    sim_race_nb = 0;
+}
+
+/// A bounce while the pin is armed is captured, the pin stays armed from its level
+static void test_arm_race(void)
+{
+    struct gpio_edge edge;
+    int race, n;
+
+    sim_init(1);
+    CHECK(sim_armed(TEST_PIN) == TEST_PIN);
+
+    // press, the pin bounces back while the capture arms it for the rising edge
+    sim_us = 1000;
+    sim_pin_set(TEST_PIN, 0);
+    sim_race_nb = 1;
+    sim_irq();
+    CHECK(gpio_edge_get(&edge));
+    CHECK(edge.level == 1 && edge.time == 1000 && edge.pin == TEST_PIN);
+    CHECK(!gpio_edge_get(&edge));
+    CHECK(sim_armed(TEST_PIN) == TEST_PIN);
+
+    // the next press is not lost
+    sim_pin_set(TEST_PIN, 0);
+    sim_irq();
+    CHECK(gpio_edge_get(&edge));
+    CHECK(edge.level == 0);
+    CHECK(sim_armed(TEST_PIN) == 0);
+
+    // bounces at any read of the arming, the last edge has the pin level
+    srand(38);
+    for (n = 0; n < 2000; n++) {
+        sim_pin_set(TEST_PIN, !(QN_GPIO->DATA & TEST_PIN));
+        race = rand() % 4;
+        sim_race_nb = race;
+        sim_irq();
+        // a bounce and its return may both fall before the arming
+        sim_race_nb = 0;
+        edge.level = 2;
+        while (gpio_edge_get(&edge));
+        CHECK(edge.level == !!(QN_GPIO->DATA & TEST_PIN));
+        CHECK(sim_armed(TEST_PIN) == (QN_GPIO->DATA & TEST_PIN));
+    }
+    CHECK(gpio_edge_lost() == 0);
+}
+
+/// Edges past the buffer size are counted as lost, the pin is still armed
+static void test_full(void)
+{
+    struct gpio_edge edge;
+    int i;
+
+    sim_init(1);
+    for (i = 0; i < GPIO_EDGE_BUF_SIZE + 3; i++) {
+        sim_us = 0xFFFFFFF0ULL + i * 7;
+        sim_pin_set(TEST_PIN, i & 1);
+        sim_irq();
+    }
+    CHECK(gpio_edge_lost() == 3);
+    CHECK(sim_armed(TEST_PIN) == (QN_GPIO->DATA & TEST_PIN));
+    for (i = 0; i < GPIO_EDGE_BUF_SIZE; i++) {
+        CHECK(gpio_edge_get(&edge));
+        CHECK(edge.level == (i & 1));
+        CHECK(edge.time == (uint32_t)(0xFFFFFFF0ULL + i * 7));
+    }
+    CHECK(!gpio_edge_get(&edge));
+}
+
+static struct button_gesture_tag btn;
+
+/// Read the gestures at a time, return the first one and the delay to call again
+static enum button_gesture gesture_at(uint32_t now, uint32_t *delay)
+{
+    return button_gesture_get(&btn, now, delay);
+}
+
+static void test_gesture(void)
+{
+    uint32_t delay;
+    uint32_t t;
+
+    button_gesture_init(&btn, BUTTON_GESTURE_BIT(BUTTON_GESTURE_DOUBLE_CLICK)
+                              | BUTTON_GESTURE_BIT(BUTTON_GESTURE_LONG_PRESS));
+
+    // click with bounces of a few ms on both edges, only the first edge starts the debounce
+    CHECK(button_gesture_edge(&btn, 0, 100000));
+    CHECK(!button_gesture_edge(&btn, 1, 100400));
+    CHECK(!button_gesture_edge(&btn, 0, 101000));
+    CHECK(gesture_at(110000, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == BUTTON_DEBOUNCE_TIME - 9000);
+    button_gesture_edge(&btn, 1, 200000);
+    button_gesture_edge(&btn, 0, 200300);
+    button_gesture_edge(&btn, 1, 201000);
+    CHECK(gesture_at(230000, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == BUTTON_DOUBLE_CLICK_GAP - 30000);
+    CHECK(gesture_at(200000 + BUTTON_DOUBLE_CLICK_GAP, &delay) == BUTTON_GESTURE_CLICK);
+    CHECK(gesture_at(200000 + BUTTON_DOUBLE_CLICK_GAP, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == 0);
+
+    // a bounce shorter than the debounce time is a glitch
+    button_gesture_edge(&btn, 0, 1000000);
+    button_gesture_edge(&btn, 1, 1005000);
+    CHECK(gesture_at(1100000, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == 0);
+
+    // double click read late, on the edge times
+    button_gesture_edge(&btn, 0, 2000000);
+    button_gesture_edge(&btn, 1, 2100000);
+    button_gesture_edge(&btn, 0, 2250000);
+    button_gesture_edge(&btn, 1, 2350000);
+    CHECK(gesture_at(5000000, &delay) == BUTTON_GESTURE_DOUBLE_CLICK);
+    CHECK(gesture_at(5000000, &delay) == BUTTON_GESTURE_NONE);
+
+    // long press across the wrap of the 32-bit time
+    t = 0xFFFFFFFF - 400000;
+    button_gesture_edge(&btn, 0, t);
+    CHECK(gesture_at(t + 500000, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == BUTTON_LONG_PRESS_TIME - 500000);
+    CHECK(gesture_at(t + BUTTON_LONG_PRESS_TIME, &delay) == BUTTON_GESTURE_LONG_PRESS);
+    button_gesture_edge(&btn, 1, t + 2000000);
+    CHECK(gesture_at(t + 3000000, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == 0);
+}
+
+/// Click only: reported at the release, no timeout while the button is held
+static void test_click_only(void)
+{
+    uint32_t delay;
+
+    button_gesture_init(&btn, 0);
+
+    CHECK(button_gesture_edge(&btn, 0, 100000));
+    CHECK(!button_gesture_edge(&btn, 1, 100400));
+    CHECK(!button_gesture_edge(&btn, 0, 101000));
+    CHECK(gesture_at(121000, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == 0);
+
+    // held for 3s, then released with a bounce
+    CHECK(button_gesture_edge(&btn, 1, 3000000));
+    CHECK(!button_gesture_edge(&btn, 0, 3000200));
+    CHECK(!button_gesture_edge(&btn, 1, 3000500));
+    CHECK(gesture_at(3010000, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == BUTTON_DEBOUNCE_TIME - 9500);
+    CHECK(gesture_at(3020500, &delay) == BUTTON_GESTURE_CLICK);
+    CHECK(gesture_at(3020500, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == 0);
+
+    // two quick clicks are two clicks, the second one starts after the first debounce
+    CHECK(button_gesture_edge(&btn, 0, 4000000));
+    CHECK(button_gesture_edge(&btn, 1, 4100000));
+    CHECK(button_gesture_edge(&btn, 0, 4200000));
+    CHECK(button_gesture_edge(&btn, 1, 4300000));
+    CHECK(gesture_at(4400000, &delay) == BUTTON_GESTURE_CLICK);
+    CHECK(gesture_at(4400000, &delay) == BUTTON_GESTURE_CLICK);
+    CHECK(gesture_at(4400000, &delay) == BUTTON_GESTURE_NONE);
+    CHECK(delay == 0);
+}
+
+int main(void)
+{
+    if (mmap((void *)QN_GPIO_BASE, 0x2000, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != (void *)QN_GPIO_BASE) {
+        printf("can not map the GPIO registers\n");
+        return 1;
+    }
+
+    test_arm_race();
+    test_full();
+    test_gesture();
+    test_click_only();
+    return host_result("test_gpio");
+}
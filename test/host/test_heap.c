@@ -0,0 +1,489 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_heap.c
+ *
+ * @brief BLE heap monitor on a model of the kernel heap: the free list walk against the
+ * model, the peak left untouched by the probe, the broken lists, and a stress replay of
+ * QPPS notification bursts and GLPS record transfers over the heap sizes
+ *
+ * The model allocates like the kernel heap of the ROM: first fit in an address ordered
+ * free list, a block is cut at the end of a free block which keeps its header, a freed
+ * block is merged with its neighbours. The free block header is 16 bytes on the host and
+ * 8 bytes on the target, the sizes found here are a few bytes per free block above the
+ * target. Where the ROM asserts on an exhausted heap, the model counts a failure.
+ *
+ * The replay sizes the messages with the 16-byte kernel message header of the target.
+ * The buffer of a PDU waiting for the link is an estimate: a kernel message, a PDU
+ * descriptor and the L2CAP header.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+#include "host.h"
+#include "qpps_task.h"
+#include "glps_task.h"
+
+static void *host_ke_malloc(uint32_t size);
+static void host_ke_free(void *mem_ptr);
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len);
+extern struct app_heap_ke_env host_ke_env;
+
+#undef _ke_malloc
+#undef _ke_free
+#undef _ke_msg_alloc
+#undef _ke_env
+#define _ke_malloc              host_ke_malloc
+#define _ke_free                host_ke_free
+#define _ke_msg_alloc           host_ke_msg_alloc
+#define _ke_env                 (&host_ke_env)
+#undef QPRINTF
+#define QPRINTF(...)
+#undef GLOBAL_INT_DISABLE
+#undef GLOBAL_INT_RESTORE
+#define GLOBAL_INT_DISABLE()    do {
+#define GLOBAL_INT_RESTORE()    } while (0)
+
+#include "app_heap.c"
+
+/// Kernel message header of the target, before the parameters
+#define TARGET_MSG_HDR          16
+/// Estimated buffer of a PDU waiting for the link, before the ATT PDU
+#define SIM_PDU_HDR             32
+/// ATT notification and indication header: opcode and handle
+#define SIM_ATT_HDR             3
+/// Largest heap of the replay
+#define SIM_HEAP_MAX            8192
+/// PDU queue of the link
+#define SIM_PDU_MAX             64
+/// Headers of a block allocated in a free block
+#define APP_HEAP_MBLOCK_HDR     (sizeof(struct app_heap_mblock_free) + sizeof(uint32_t))
+#ifndef QPPS_TX_BUFFER_SIZE
+/// Credits of the QPPS test application, project/src/usr_config.h
+#define QPPS_TX_BUFFER_SIZE     8
+#endif
+
+struct app_heap_ke_env host_ke_env;
+
+/// Heap of the model, word aligned like the BLE heap
+static uint32_t heap[SIM_HEAP_MAX / 4];
+/// Sum of the used blocks, headers included
+static uint32_t used_sum;
+/// Allocations the ROM would assert on
+static int fail_nb;
+/// Probe the heap along the replay
+static bool sim_check;
+/// Largest usage found by the probes
+static uint16_t used_max;
+
+static void heap_init(uint16_t size)
+{
+    struct app_heap_mblock_free *first = (struct app_heap_mblock_free *)heap;
+
+    app_heap_paint((uint8_t *)heap, size);
+    first->next = NULL;
+    first->size = size;
+    host_ke_env.mblock_first = first;
+    used_sum = 0;
+    fail_nb = 0;
+    memset(&app_heap_env.stat, 0, sizeof(app_heap_env.stat));
+}
+
+static void *host_ke_malloc(uint32_t size)
+{
+    struct app_heap_mblock_free *node;
+    uint32_t *used;
+
+    size = ((size + 3) & ~3u) + sizeof(uint32_t);
+    // a freed block holds a free block header
+    if (size < sizeof(struct app_heap_mblock_free)) {
+        size = sizeof(struct app_heap_mblock_free);
+    }
+    for (node = host_ke_env.mblock_first; node != NULL; node = node->next) {
+        if (node->size >= size + sizeof(struct app_heap_mblock_free)) {
+            break;
+        }
+    }
+    if (node == NULL) {
+        fail_nb++;
+        return NULL;
+    }
+    node->size -= size;
+    used = (uint32_t *)((uint8_t *)node + node->size);
+    *used = size;
+    used_sum += size;
+    // the user writes the block
+    memset(used + 1, 0, size - sizeof(uint32_t));
+    return used + 1;
+}
+
+static void host_ke_free(void *mem_ptr)
+{
+    struct app_heap_mblock_free *block, *prev = NULL, *next;
+    uint32_t *used = (uint32_t *)mem_ptr - 1;
+    uint32_t size = *used;
+
+    used_sum -= size;
+    block = (struct app_heap_mblock_free *)used;
+    for (next = host_ke_env.mblock_first; next != NULL && next < block; next = next->next) {
+        prev = next;
+    }
+    block->size = size;
+    block->next = next;
+    if (next != NULL && (uint8_t *)block + block->size == (uint8_t *)next) {
+        block->size += next->size;
+        block->next = next->next;
+    }
+    if (prev == NULL) {
+        host_ke_env.mblock_first = block;
+    } else if ((uint8_t *)prev + prev->size == (uint8_t *)block) {
+        prev->size += block->size;
+        prev->next = block->next;
+    } else {
+        prev->next = block;
+    }
+}
+
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len)
+{
+    uint8_t *msg = host_ke_malloc(TARGET_MSG_HDR + param_len);
+
+    return msg == NULL ? NULL : msg + TARGET_MSG_HDR;
+}
+
+static void msg_free(void *param)
+{
+    host_ke_free((uint8_t *)param - TARGET_MSG_HDR);
+}
+
+/// Send and handle a message at once, as the kernel does for a short one
+static bool msg_pass(uint16_t param_len)
+{
+    void *msg = ke_msg_alloc(0, 0, 0, param_len);
+
+    if (msg == NULL) {
+        return false;
+    }
+    msg_free(msg);
+    return true;
+}
+
+/// Probe against the model, the peak and the counters are not changed by the probe
+static void check_probe(void)
+{
+    struct app_heap_probe probe, again;
+    struct app_heap_mblock_free *node;
+    uint32_t largest = 0;
+    uint16_t blocks = 0;
+    uint32_t malloc_nb = app_heap_env.stat.malloc_cnt[0];
+
+    CHECK(app_heap_probe(&probe));
+    CHECK(probe.free == probe.size - used_sum);
+    if (used_max < probe.size - probe.free) {
+        used_max = probe.size - probe.free;
+    }
+    for (node = host_ke_env.mblock_first; node != NULL; node = node->next) {
+        blocks++;
+        if (largest < node->size) {
+            largest = node->size;
+        }
+    }
+    CHECK(probe.blocks == blocks);
+    largest = largest < APP_HEAP_MBLOCK_HDR ? 0 : largest - APP_HEAP_MBLOCK_HDR;
+    CHECK(probe.largest == largest);
+    CHECK(app_heap_probe(&again));
+    CHECK(memcmp(&probe, &again, sizeof(probe)) == 0);
+    CHECK(app_heap_env.stat.malloc_cnt[0] == malloc_nb);
+}
+
+/// Random allocations and frees, the largest probed block can be allocated
+static void test_walk(void)
+{
+    static void *blocks[64];
+    struct app_heap_probe probe;
+    uint16_t peak;
+    void *p;
+    int it, i;
+
+    srand(31);
+    heap_init(4096);
+    for (it = 0; it < 20000; it++) {
+        i = rand() % 64;
+        if (blocks[i] != NULL) {
+            ke_free(blocks[i]);
+            blocks[i] = NULL;
+        } else {
+            blocks[i] = ke_malloc(1 + rand() % 120);
+        }
+        if (it % 7 == 0) {
+            check_probe();
+        }
+    }
+
+    // the largest block fits, one more byte does not
+    app_heap_probe(&probe);
+    peak = probe.peak;
+    p = ke_malloc(probe.largest);
+    CHECK(p != NULL);
+    ke_free(p);
+    CHECK(ke_malloc(probe.largest + 1) == NULL);
+    fail_nb = 0;
+    CHECK(probe.peak == peak);
+
+    for (i = 0; i < 64; i++) {
+        if (blocks[i] != NULL) {
+            ke_free(blocks[i]);
+            blocks[i] = NULL;
+        }
+    }
+    app_heap_probe(&probe);
+    CHECK(probe.free == 4096 && probe.blocks == 1);
+    CHECK(probe.peak == peak);
+}
+
+/// A block out of the heap, out of order or looping stops the walk
+static void test_broken(void)
+{
+    struct app_heap_mblock_free *node;
+    struct app_heap_probe probe;
+    void *p[4];
+    int i;
+
+    heap_init(1024);
+    for (i = 0; i < 4; i++) {
+        p[i] = ke_malloc(40);
+    }
+    ke_free(p[0]);
+    ke_free(p[2]);
+    app_heap_probe(&probe);
+    CHECK(probe.blocks == 3);
+
+    node = host_ke_env.mblock_first->next;
+    node->next = host_ke_env.mblock_first;
+    CHECK(!app_heap_probe(&probe));
+    CHECK(probe.blocks == 2);
+
+    node->next = (struct app_heap_mblock_free *)&heap[SIM_HEAP_MAX / 4 - 2];
+    CHECK(!app_heap_probe(&probe));
+
+    node->next = (struct app_heap_mblock_free *)((uint8_t *)node + 2);
+    CHECK(!app_heap_probe(&probe));
+
+    node->next = NULL;
+    node->size = 2048;
+    CHECK(!app_heap_probe(&probe));
+    CHECK(probe.blocks == 1);
+}
+
+/// Service databases and the profile environments allocated at start
+static void sim_db(uint16_t const *db, int nb)
+{
+    int i;
+
+    for (i = 0; i < nb; i++) {
+        ke_malloc(db[i]);
+    }
+}
+
+/// Link of the replay: PDU buffers queued until a connection event sends them
+struct sim_link
+{
+    void *pdu[SIM_PDU_MAX];
+    uint8_t last[SIM_PDU_MAX];
+    int nb;
+    /// PDUs sent per connection event
+    int rate;
+    /// Events without any PDU sent, every 16 events
+    int stall;
+    int event;
+};
+
+static bool link_push(struct sim_link *link, uint16_t att_len, uint8_t last)
+{
+    void *pdu;
+
+    // GATT gets the value and builds the PDU
+    if (link->nb == SIM_PDU_MAX || (pdu = ke_malloc(SIM_PDU_HDR + SIM_ATT_HDR + att_len)) == NULL) {
+        return false;
+    }
+    link->pdu[link->nb] = pdu;
+    link->last[link->nb++] = last;
+    return true;
+}
+
+/// Number of PDUs the next connection event sends
+static int link_event(struct sim_link *link)
+{
+    int n = (link->event++ % 16) < link->stall ? 0 : link->rate;
+
+    return n < link->nb ? n : link->nb;
+}
+
+static uint8_t link_pop(struct sim_link *link)
+{
+    uint8_t last = link->last[0];
+
+    ke_free(link->pdu[0]);
+    link->nb--;
+    memmove(link->pdu, link->pdu + 1, link->nb * sizeof(link->pdu[0]));
+    memmove(link->last, link->last + 1, link->nb);
+    return last;
+}
+
+/// QPPS bursts of the test application: one QPPS_DATA_SEND_REQ per credit, a credit back on
+/// each QPPS_DATA_SEND_CFM
+static void sim_qpps(uint16_t size, struct sim_link *link, int total)
+{
+    static const uint16_t db[] = {232, 60, 1400};
+    int credit = QPPS_TX_BUFFER_SIZE;
+    void *req;
+    int n;
+
+    heap_init(size);
+    sim_db(db, sizeof(db) / sizeof(db[0]));
+    link->nb = 0;
+    link->event = 0;
+    while (total > 0 || link->nb) {
+        while (credit && total > 0) {
+            req = ke_msg_alloc(QPPS_DATA_SEND_REQ, TASK_QPPS, TASK_APP,
+                               sizeof(struct qpps_data_send_req) - 1 + QPP_DATA_MAX_LEN);
+            total--;
+            if (req == NULL) {
+                continue;
+            }
+            credit--;
+            // QPPS forwards it to GATT, GATT builds the PDU at once
+            if (!msg_pass(sizeof(struct gatt_notify_req)) || !link_push(link, QPP_DATA_MAX_LEN, 1)) {
+                credit++;
+            }
+            msg_free(req);
+            if (sim_check) {
+                check_probe();
+            }
+        }
+        for (n = link_event(link); n > 0; n--) {
+            link_pop(link);
+            msg_pass(sizeof(struct gatt_notify_cmp_evt));
+            msg_pass(sizeof(struct qpps_data_send_cfm));
+            credit++;
+        }
+    }
+}
+
+/// GLPS record transfer of app_glps_rec: a window of GLPS_SEND_MEAS_WITH_CTX_REQ, GLPS
+/// notifies the measurement and the context, the report ends with a RACP indication
+static void sim_glps(uint16_t size, struct sim_link *link, int total)
+{
+    static const uint16_t db[] = {232, 60, 256};
+    int pend = 0;
+    void *req;
+    int n;
+
+    heap_init(size);
+    sim_db(db, sizeof(db) / sizeof(db[0]));
+    link->nb = 0;
+    link->event = 0;
+    while (total > 0 || link->nb) {
+        while (pend < GLPS_MEAS_QUEUE_NB && total > 0) {
+            req = ke_msg_alloc(GLPS_SEND_MEAS_WITH_CTX_REQ, TASK_GLPS, TASK_APP,
+                               sizeof(struct glps_send_meas_with_ctx_req));
+            total--;
+            if (req == NULL) {
+                continue;
+            }
+            pend++;
+            // GLPS packs both values in its queue and notifies them one after the other
+            if (!msg_pass(sizeof(struct gatt_notify_req)) || !link_push(link, 17, 0)
+                || !msg_pass(sizeof(struct gatt_notify_req)) || !link_push(link, 17, 1)) {
+                pend--;
+            }
+            msg_free(req);
+            if (total == 0) {
+                msg_pass(sizeof(struct gatt_indicate_req));
+                link_push(link, 4, 0);
+            }
+            if (sim_check) {
+                check_probe();
+            }
+        }
+        for (n = link_event(link); n > 0; n--) {
+            msg_pass(sizeof(struct gatt_notify_cmp_evt));
+            if (link_pop(link)) {
+                msg_pass(sizeof(struct glps_req_cmp_evt));
+                pend--;
+            }
+        }
+    }
+}
+
+/// Replays: traffic, PDUs sent per connection event, stalled events and the heap size of
+/// app_config.h, the databases with 512 bytes and 256 bytes per connection
+static const struct
+{
+    const char *name;
+    bool glps;
+    int rate;
+    int stall;
+    uint16_t size;
+} sims[] =
+{
+    {"QPPS burst",   false, 4, 0,  232 + 60 + 1400 + 512 + 256},
+    {"QPPS burst",   false, 1, 0,  232 + 60 + 1400 + 512 + 256},
+    {"QPPS burst",   false, 4, 12, 232 + 60 + 1400 + 512 + 256},
+    {"GLPS records", true,  4, 0,  232 + 60 + 256 + 512 + 256},
+    {"GLPS records", true,  1, 0,  232 + 60 + 256 + 512 + 256},
+    {"GLPS records", true,  4, 12, 232 + 60 + 256 + 512 + 256},
+};
+
+static int sim_run(int i, uint16_t size)
+{
+    struct sim_link link = {0};
+
+    link.rate = sims[i].rate;
+    link.stall = sims[i].stall;
+    if (sims[i].glps) {
+        sim_glps(size, &link, 500);
+    } else {
+        sim_qpps(size, &link, 2000);
+    }
+    return fail_nb;
+}
+
+/// Usage on a large heap, smallest heap without a failure and failures at the heap size of
+/// app_config.h. The largest usage is found by the probes along the replay. The paint peak
+/// covers most of the heap: first fit takes the lowest free block, while the oldest PDUs
+/// are freed above it, so the allocations sweep down the heap. The PDU buffers are
+/// estimated, the sizes are reported, not checked.
+static void test_replay(void)
+{
+    struct app_heap_probe probe;
+    uint16_t size;
+    int i, fail;
+
+    printf("replay         PDUs/event  stall  used max  paint peak  smallest heap  config heap  failures\n");
+    for (i = 0; i < (int)(sizeof(sims) / sizeof(sims[0])); i++) {
+        used_max = 0;
+        sim_check = true;
+        CHECK(sim_run(i, SIM_HEAP_MAX) == 0);
+        sim_check = false;
+        app_heap_probe(&probe);
+
+        for (size = 256; size < SIM_HEAP_MAX && sim_run(i, size); size += 16);
+        CHECK(size > used_max && used_max <= probe.peak);
+        fail = sim_run(i, sims[i].size);
+        printf("%-14s %10d  %5d  %8d  %10d  %13d  %11d  %8d\n", sims[i].name, sims[i].rate,
+               sims[i].stall, used_max, probe.peak, size, sims[i].size, fail);
+    }
+}
+
+int main(void)
+{
+    test_walk();
+    test_broken();
+    test_replay();
+    return host_result("test_heap");
+}
@@ -0,0 +1,185 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_hogpd.c
+ *
+ * @brief HID report notification queue of HOGPD: the latencies in us from the report
+ * request to the notification completion, across the wrap of the 32-bit time, the merge
+ * and full queue counts, and the statistics get and reset
+ *
+ * The test plays GATT: it takes the notified values and completes them. The time is the
+ * qn_clock_us() of the test.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+#include "host.h"
+
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len);
+static void host_ke_msg_send(void const *param_ptr);
+static uint8_t host_attsdb_att_set_value(uint16_t handle, atts_size_t length, uint8_t *value);
+
+#undef _ke_msg_alloc
+#undef _ke_msg_send
+#undef _attsdb_att_set_value
+#define _ke_msg_alloc           host_ke_msg_alloc
+#define _ke_msg_send            host_ke_msg_send
+#define _attsdb_att_set_value   host_attsdb_att_set_value
+
+#include "hogpd.c"
+
+#define REPORT_NB       0
+
+/// Time returned by qn_clock_us()
+static uint64_t sim_us;
+/// Messages of HOGPD
+static struct
+{
+    struct ke_msg msg;
+    uint32_t param[4];
+} sim_msg[4];
+static int sim_msg_idx;
+/// Notifications requested to GATT, and the confirmations to APP
+static int sim_ntf_nb;
+static int sim_cfm_nb;
+
+uint64_t qn_clock_us(void)
+{
+    return sim_us;
+}
+
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len)
+{
+    struct ke_msg *msg = &sim_msg[sim_msg_idx++ % 4].msg;
+
+    CHECK(param_len <= sizeof(sim_msg[0].param));
+    msg->id = id;
+    msg->dest_id = dest_id;
+    msg->src_id = src_id;
+    return ke_msg2param(msg);
+}
+
+static void host_ke_msg_send(void const *param_ptr)
+{
+    struct ke_msg *msg = ke_param2msg(param_ptr);
+
+    if (msg->id == GATT_NOTIFY_REQ)
+        sim_ntf_nb++;
+    else if (msg->id == HOGPD_NTF_SENT_CFM)
+        sim_cfm_nb++;
+}
+
+static uint8_t host_attsdb_att_set_value(uint16_t handle, atts_size_t length, uint8_t *value)
+{
+    return ATT_ERR_NO_ERROR;
+}
+
+/// One HID service with a mouse input report, notifications enabled
+static void sim_init(void)
+{
+    memset(&hogpd_env, 0, sizeof(hogpd_env));
+    hogpd_env.hids_nb = 1;
+    hogpd_env.shdl[0] = 0x20;
+    hogpd_env.att_tbl[0][HOGPD_REPORT_CHAR + REPORT_NB] = 5;
+    hogpd_env.features[0].report_char_cfg[REPORT_NB] = HOGPD_CFG_REPORT_MOUSE | HOGPD_REPORT_NTF_CFG_MASK;
+    sim_ntf_nb = 0;
+    sim_cfm_nb = 0;
+}
+
+/// Queue a mouse report with the buttons and a move
+static uint8_t sim_report(uint8_t buttons, int8_t x)
+{
+    uint8_t report[4] = {buttons, (uint8_t)x, 0, 0};
+
+    return hogpd_ntf_send(0, HOGPD_REPORT_CHAR, REPORT_NB, sizeof(report), report);
+}
+
+/// GATT takes the value of the requested notification and completes it
+static void sim_gatt_cmp(uint8_t status)
+{
+    hogpd_env.ntf_get_data = false;
+    hogpd_ntf_next();
+    hogpd_ntf_cmp(status);
+}
+
+static void test_latency(void)
+{
+    struct hogpd_ntf_stat const *stat = hogpd_ntf_stat_get();
+
+    sim_init();
+    hogpd_ntf_stat_reset();
+    CHECK(stat->ntf_nb == 0 && stat->lat_max == 0 && stat->lat_total == 0);
+
+    // a latency shorter than the 10ms of ke_time() is counted
+    sim_us = 1000;
+    CHECK(sim_report(0, 1) == PRF_ERR_OK);
+    CHECK(sim_ntf_nb == 1);
+    sim_us = 1000 + 7500;
+    sim_gatt_cmp(PRF_ERR_OK);
+    CHECK(stat->ntf_nb == 1);
+    CHECK(stat->lat_max == 7500 && stat->lat_total == 7500);
+
+    // across the wrap of the 32-bit time
+    sim_us = 0xFFFFFF00ULL;
+    CHECK(sim_report(1, 1) == PRF_ERR_OK);
+    sim_us = 0x100000000ULL + 0x300;
+    sim_gatt_cmp(PRF_ERR_OK);
+    CHECK(stat->ntf_nb == 2);
+    CHECK(stat->lat_max == 7500);
+    CHECK(stat->lat_total == 7500 + 0x400);
+
+    // a failed notification is not counted
+    sim_us = 0x200000000ULL;
+    CHECK(sim_report(0, 1) == PRF_ERR_OK);
+    sim_us += 20000;
+    sim_gatt_cmp(PRF_ERR_NTF_DISABLED);
+    CHECK(stat->ntf_nb == 2 && stat->lat_max == 7500);
+    CHECK(sim_cfm_nb == 3);
+
+    hogpd_ntf_stat_reset();
+    CHECK(stat->ntf_nb == 0 && stat->lat_max == 0 && stat->lat_total == 0);
+}
+
+/// The merged mouse reports and the refused ones are counted, the latency is from the
+/// oldest report of a merged value
+static void test_queue(void)
+{
+    struct hogpd_ntf_stat const *stat = hogpd_ntf_stat_get();
+    int i;
+
+    sim_init();
+    hogpd_ntf_stat_reset();
+
+    // the first report is given to GATT, the second is queued and the moves merge into it
+    sim_us = 5000;
+    CHECK(sim_report(0, 1) == PRF_ERR_OK);
+    sim_us = 6000;
+    CHECK(sim_report(0, 2) == PRF_ERR_OK);
+    sim_us = 7000;
+    CHECK(sim_report(0, 3) == PRF_ERR_OK);
+    CHECK(stat->merged_nb == 1);
+    CHECK(hogpd_env.ntf_nb == 2);
+
+    // a button change is not merged, the queue fills
+    for (i = 0; i < HOGPD_NTF_QUEUE_SIZE - 2; i++)
+        CHECK(sim_report(i & 1 ? 0 : 1, 1) == PRF_ERR_OK);
+    CHECK(sim_report(i & 1 ? 0 : 1, 1) == PRF_ERR_REQ_DISALLOWED);
+    CHECK(stat->full_nb == 1);
+
+    sim_us = 9000;
+    sim_gatt_cmp(PRF_ERR_OK);
+    sim_gatt_cmp(PRF_ERR_OK);
+    CHECK(stat->ntf_nb == 2);
+    CHECK(stat->lat_max == 4000 && stat->lat_total == 4000 + 3000);
+}
+
+int main(void)
+{
+    test_latency();
+    test_queue();
+    return host_result("test_hogpd");
+}
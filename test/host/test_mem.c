@@ -0,0 +1,146 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_mem.c
+ *
+ * @brief SRAM memory map on linker symbol values: an image ending in the middle of a bank
+ * or on a bank boundary, an empty .noretention section, a .noretention section across two
+ * banks, and the BLE stack data from 0x1000CDB0
+ *
+ * The linker symbols are variables set by the test.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+
+static uint32_t sim_image_end;
+static uint32_t sim_noret_begin;
+static uint32_t sim_noret_end;
+
+#define APP_MEM_IMAGE_END           sim_image_end
+#define APP_MEM_NORET_BEGIN         sim_noret_begin
+#define APP_MEM_NORET_END           sim_noret_end
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_mem.c"
+#include "host.h"
+
+#define BANK(n)                     (APP_MEM_RAM_BASE + (n) * APP_MEM_BANK_SIZE)
+
+struct sleep_env_tag sleep_env;
+
+/// Banks given to sleep_set_mem_retention()
+static uint32_t sim_retention;
+static uint32_t sim_active;
+
+void sleep_set_mem_retention(uint32_t retention, uint32_t active)
+{
+    sim_retention = retention;
+    sim_active = active;
+}
+
+static void sim_map(struct app_mem_map *map, uint32_t image_end, uint32_t noret_begin, uint32_t noret_end)
+{
+    sim_image_end = image_end;
+    sim_noret_begin = noret_begin;
+    sim_noret_end = noret_end;
+    memset(map, 0xA5, sizeof(*map));
+    app_mem_get_map(map);
+}
+
+/// The BLE stack data takes the end of bank 6 and bank 7 in every map
+static void check_ble(struct app_mem_map const *map)
+{
+    CHECK(map->retained[6] == BANK(7) - APP_MEM_BLE_BASE);
+    CHECK(map->retained[7] == APP_MEM_BANK_SIZE);
+    CHECK((map->retention & 0xC0) == 0xC0);
+}
+
+/// Image ending in bank 1, no .noretention data
+static void test_mid_bank(void)
+{
+    struct app_mem_map map;
+    uint8_t i;
+
+    sim_map(&map, BANK(1) + 0x100, BANK(2), BANK(2));
+    CHECK(map.retained[0] == APP_MEM_BANK_SIZE);
+    CHECK(map.retained[1] == 0x100);
+    for (i = 2; i < 6; i++)
+        CHECK(map.retained[i] == 0);
+    for (i = 0; i < APP_MEM_BANK_NB; i++)
+        CHECK(map.active[i] == 0);
+    check_ble(&map);
+    CHECK(map.retention == 0xC2);
+    CHECK(map.active_only == 0);
+
+    app_mem_retention_config();
+    CHECK(sim_retention == 0xC2 && sim_active == 0);
+}
+
+/// Image ending on a bank boundary, the next bank is not touched
+static void test_boundary(void)
+{
+    struct app_mem_map map;
+
+    sim_map(&map, BANK(2), BANK(2), BANK(2));
+    CHECK(map.retained[1] == APP_MEM_BANK_SIZE);
+    CHECK(map.retained[2] == 0);
+    check_ble(&map);
+    CHECK(map.retention == 0xC2);
+
+    // a single byte in the next bank retains it
+    sim_map(&map, BANK(2) + 1, BANK(3), BANK(3));
+    CHECK(map.retained[2] == 1);
+    CHECK(map.retention == 0xC6);
+}
+
+/// .noretention across banks 2 and 3, after an image in bank 0 only
+static void test_noret(void)
+{
+    struct app_mem_map map;
+
+    sim_map(&map, BANK(0) + 0x1800, BANK(2), BANK(3) + 0x800);
+    CHECK(map.retained[0] == 0x1800);
+    CHECK(map.retained[1] == 0 && map.retained[2] == 0 && map.retained[3] == 0);
+    CHECK(map.active[2] == APP_MEM_BANK_SIZE);
+    CHECK(map.active[3] == 0x800);
+    CHECK(map.active[1] == 0 && map.active[4] == 0);
+    check_ble(&map);
+    CHECK(map.retention == 0xC0);
+    CHECK(map.active_only == 0x0C);
+
+    app_mem_retention_config();
+    CHECK(sim_retention == 0xC0 && sim_active == 0x0C);
+
+    // up to the BLE stack data, the shared bank 6 is retained, not active only
+    sim_map(&map, BANK(1), BANK(1), APP_MEM_BLE_BASE);
+    CHECK(map.active[6] == APP_MEM_BLE_BASE - BANK(6));
+    CHECK(map.retention == 0xC0);
+    CHECK(map.active_only == 0x3E);
+}
+
+/// Image up to the BLE stack data, every bank retained
+static void test_full(void)
+{
+    struct app_mem_map map;
+    uint8_t i;
+
+    sim_map(&map, APP_MEM_BLE_BASE, APP_MEM_BLE_BASE, APP_MEM_BLE_BASE);
+    for (i = 0; i < 6; i++)
+        CHECK(map.retained[i] == APP_MEM_BANK_SIZE);
+    CHECK(map.retained[6] == APP_MEM_BANK_SIZE);
+    CHECK(map.retention == 0xFE);
+    CHECK(map.active_only == 0);
+}
+
+int main(void)
+{
+    test_mid_bank();
+    test_boundary();
+    test_noret();
+    test_full();
+    return host_result("test_mem");
+}
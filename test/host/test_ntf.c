@@ -0,0 +1,153 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_ntf.c
+ *
+ * @brief Measurement notification scheduler with the HTPT confirmations: the intermediate
+ * temperatures taken by GATT and completed, the stable temperature completed by the peer
+ * confirmation, and the confirmations of the Measurement Interval indication which are not
+ * measurements
+ *
+ * The test plays HTPT: it records the temperatures submitted by the scheduler and sends
+ * the HTPT_TEMP_SEND_CFM messages to the application handler. The latencies are read from
+ * the qn_clock_us() of the test.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_ntf.c"
+#include "app_htpt_task.c"
+#include "host.h"
+
+#define CONHDL          0
+
+struct app_env_tag app_env;
+
+/// Time returned by qn_clock_us()
+static uint64_t sim_us;
+/// Temperatures submitted to HTPT, and the last one
+static int sim_send_nb;
+static uint8_t sim_send_stable;
+/// Confirmations given to the user handler
+static int sim_user_cfm_nb;
+
+uint64_t qn_clock_us(void)
+{
+    return sim_us;
+}
+
+void app_htpt_temp_send(uint16_t conhdl, struct htp_temp_meas *temp_meas, uint8_t flag_stable_meas)
+{
+    CHECK(conhdl == CONHDL);
+    sim_send_nb++;
+    sim_send_stable = flag_stable_meas;
+}
+
+void app_task_msg_hdl(ke_msg_id_t const msgid, void const *param)
+{
+    CHECK(msgid == HTPT_TEMP_SEND_CFM);
+    sim_user_cfm_nb++;
+}
+
+/// HTPT confirms to the application
+static void sim_cfm(uint8_t status, uint8_t cfm_type)
+{
+    struct htpt_temp_send_cfm cfm = {CONHDL, status, cfm_type};
+
+    app_htpt_temp_send_cfm_handler(HTPT_TEMP_SEND_CFM, &cfm, TASK_APP, TASK_HTPT);
+}
+
+static void sim_temp(uint8_t stable)
+{
+    struct htp_temp_meas meas;
+
+    memset(&meas, 0, sizeof(meas));
+    CHECK(app_ntf_htpt_send(CONHDL, &meas, stable));
+}
+
+static void sim_init(void)
+{
+    memset(&app_env, 0, sizeof(app_env));
+    app_ntf_flush(APP_NTF_HTPT);
+    memset(app_ntf_get_stat(APP_NTF_HTPT), 0, sizeof(struct app_ntf_stat));
+    sim_send_nb = 0;
+    sim_user_cfm_nb = 0;
+    host_ke_time = 100;
+    sim_us = 0xFFFFF000;
+}
+
+/// The interval indication confirmed while notifications are in flight does not complete them
+static void test_intv_notify(void)
+{
+    struct app_ntf_stat *stat = app_ntf_get_stat(APP_NTF_HTPT);
+
+    sim_init();
+    sim_temp(0);
+    sim_temp(0);
+    CHECK(sim_send_nb == 1 && !sim_send_stable);
+
+    // the first one is taken by GATT, the second one is submitted
+    sim_cfm(GATT_NOTIFY_GET_DATA, HTPT_THERM_TEMP_SEND);
+    CHECK(sim_send_nb == 2 && sim_user_cfm_nb == 0);
+    CHECK(!app_ntf_ind_pending(APP_NTF_HTPT));
+
+    // the peer confirms a Measurement Interval indication
+    sim_cfm(PRF_ERR_OK, HTPT_CENTRAL_IND_CFM);
+    CHECK(stat->sent_nb == 0 && stat->err_nb == 0);
+    CHECK(sim_user_cfm_nb == 1);
+
+    // the latency in us across the wrap of 32 bits
+    sim_us += 7500;
+    sim_cfm(PRF_ERR_OK, HTPT_THERM_TEMP_SEND);
+    sim_cfm(GATT_NOTIFY_GET_DATA, HTPT_THERM_TEMP_SEND);
+    sim_cfm(PRF_ERR_OK, HTPT_THERM_TEMP_SEND);
+    CHECK(stat->sent_nb == 2 && stat->err_nb == 0 && stat->lat_max == 7500);
+    CHECK(stat->lat_total == 2 * 7500);
+    CHECK(sim_user_cfm_nb == 3);
+
+    // nothing in flight, the interval confirmation is only given to the user handler
+    sim_cfm(PRF_ERR_OK, HTPT_CENTRAL_IND_CFM);
+    CHECK(stat->sent_nb == 2 && stat->err_nb == 0 && sim_user_cfm_nb == 4);
+}
+
+/// The stable temperature is completed by the indication confirmation
+static void test_stable(void)
+{
+    struct app_ntf_stat *stat = app_ntf_get_stat(APP_NTF_HTPT);
+
+    sim_init();
+    sim_temp(1);
+    sim_temp(0);
+    CHECK(sim_send_nb == 1 && sim_send_stable);
+    CHECK(app_ntf_ind_pending(APP_NTF_HTPT));
+
+    // the indication keeps the service busy until the confirmation
+    sim_us += 70123;
+    sim_cfm(PRF_ERR_OK, HTPT_CENTRAL_IND_CFM);
+    CHECK(stat->sent_nb == 1 && stat->lat_max == 70123);
+    CHECK(!app_ntf_ind_pending(APP_NTF_HTPT));
+    CHECK(sim_send_nb == 2 && !sim_send_stable);
+
+    // a stable temperature refused by the profile (indication disabled) is an error
+    sim_cfm(GATT_NOTIFY_GET_DATA, HTPT_THERM_TEMP_SEND);
+    sim_temp(1);
+    CHECK(sim_send_nb == 3 && sim_send_stable);
+    sim_cfm(PRF_ERR_IND_DISABLED, HTPT_CENTRAL_IND_CFM);
+    CHECK(stat->err_nb == 1 && stat->sent_nb == 1);
+    CHECK(app_ntf_ind_pending(APP_NTF_HTPT) == false);
+    sim_cfm(PRF_ERR_OK, HTPT_THERM_TEMP_SEND);
+    CHECK(stat->sent_nb == 2 && stat->err_nb == 1);
+}
+
+int main(void)
+{
+    test_intv_notify();
+    test_stable();
+    return host_result("test_ntf");
+}
@@ -0,0 +1,414 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_pack.c
+ *
+ * @brief Measurement packing of CSCPS or RSCPS: the notified values byte for byte against
+ * the packing with the floating point wheel revolution update of the previous CSCPS, for
+ * every flag value and the supported features, and the time per measurement of the notify
+ * handler and of the wheel revolution update with fabs() and with integers
+ *
+ * The host has a floating point unit, the fabs() update is not slower here. On the
+ * Cortex-M0 it converts the value with the soft-float library calls.
+ *
+ * Built once with CFG_PRF_CSCPS and once with CFG_PRF_RSCPS, the task handlers of both
+ * profiles have the same names. The database is a model behind the functions of the chip
+ * ROM, it keeps the last value set.
+ *
+ ****************************************************************************************
+ */
+
+#include <math.h>
+#include <string.h>
+#include "app_env.h"
+#include "host.h"
+
+static ke_state_t host_ke_state_get(ke_task_id_t const id);
+static void host_ke_state_set(ke_task_id_t const id, ke_state_t const state_id);
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len);
+static void host_ke_msg_send(void const *param_ptr);
+static uint8_t host_attsdb_att_set_value(uint16_t handle, atts_size_t length, uint8_t *value);
+static uint8_t host_attsdb_svc_set_permission(uint16_t handle, uint8_t perm);
+static uint8_t host_atts_svc_create_db(uint16_t *shdl, uint8_t *cfg_flag, uint8_t max_nb_att,
+                                       uint8_t *att_tbl, ke_task_id_t const dest_id,
+                                       const struct atts_desc *att_db);
+
+#undef _ke_state_get
+#undef _ke_state_set
+#undef _ke_msg_alloc
+#undef _ke_msg_send
+#undef _attsdb_att_set_value
+#undef _attsdb_svc_set_permission
+#undef _atts_svc_create_db
+#define _ke_state_get               host_ke_state_get
+#define _ke_state_set               host_ke_state_set
+#define _ke_msg_alloc               host_ke_msg_alloc
+#define _ke_msg_send                host_ke_msg_send
+#define _attsdb_att_set_value       host_attsdb_att_set_value
+#define _attsdb_svc_set_permission  host_attsdb_svc_set_permission
+#define _atts_svc_create_db         host_atts_svc_create_db
+
+#include "prf_utils.c"
+#if (BLE_CSC_SENSOR)
+#include "cscps.c"
+#include "cscps_task.c"
+#else
+#include "rscps.c"
+#include "rscps_task.c"
+#endif
+
+#define CONHDL          3
+#define SHDL            0x20
+#define SIM_NB          20000
+
+/// Task state of the profile
+static ke_state_t sim_state;
+/// Message of the profile
+static struct
+{
+    struct ke_msg msg;
+    uint32_t param[8];
+} sim_msg;
+/// Last value set in the database
+static uint8_t sim_val[32];
+static uint8_t sim_val_len;
+static uint16_t sim_val_hdl;
+
+static ke_state_t host_ke_state_get(ke_task_id_t const id)
+{
+    return sim_state;
+}
+
+static void host_ke_state_set(ke_task_id_t const id, ke_state_t const state_id)
+{
+    sim_state = state_id;
+}
+
+static void *host_ke_msg_alloc(ke_msg_id_t const id, ke_task_id_t const dest_id,
+                               ke_task_id_t const src_id, uint16_t const param_len)
+{
+    CHECK(param_len <= sizeof(sim_msg.param));
+    sim_msg.msg.id = id;
+    return ke_msg2param(&sim_msg.msg);
+}
+
+static void host_ke_msg_send(void const *param_ptr)
+{
+}
+
+static uint8_t host_attsdb_att_set_value(uint16_t handle, atts_size_t length, uint8_t *value)
+{
+    CHECK(length <= sizeof(sim_val));
+    sim_val_hdl = handle;
+    sim_val_len = length;
+    memcpy(sim_val, value, length);
+    return ATT_ERR_NO_ERROR;
+}
+
+static uint8_t host_attsdb_svc_set_permission(uint16_t handle, uint8_t perm)
+{
+    return ATT_ERR_NO_ERROR;
+}
+
+static uint8_t host_atts_svc_create_db(uint16_t *shdl, uint8_t *cfg_flag, uint8_t max_nb_att,
+                                       uint8_t *att_tbl, ke_task_id_t const dest_id,
+                                       const struct atts_desc *att_db)
+{
+    *shdl = SHDL;
+    return ATT_ERR_NO_ERROR;
+}
+
+#if (BLE_CSC_SENSOR)
+
+/// Packing of the CSC Measurement with the floating point update, after the flag checks
+static uint8_t old_csc_meas_pack(uint8_t *pckd_meas, struct cscps_ntf_csc_meas_cmd const *param,
+                                 uint32_t *wheel_revol)
+{
+    uint8_t pckd_meas_len = CSCP_CSC_MEAS_MIN_LEN;
+
+    // Flag value
+    pckd_meas[0] = param->flags;
+
+    // Cumulative Wheel Resolutions
+    // Last Wheel Event Time
+    if (CSCPS_IS_PRESENT(param->flags, CSCP_MEAS_WHEEL_REV_DATA_PRESENT))
+    {
+        // Update the cumulative wheel revolutions value stored in the environment
+        if (param->wheel_rev < 0)
+        {
+            // The value shall not decrement below zero
+            if (fabs(param->wheel_rev) > *wheel_revol)
+            {
+                *wheel_revol = 0;
+            }
+            else
+            {
+                *wheel_revol += param->wheel_rev;
+            }
+        }
+        else
+        {
+            *wheel_revol += param->wheel_rev;
+        }
+
+        // Cumulative Wheel Resolutions
+        co_write32p(&pckd_meas[pckd_meas_len], *wheel_revol);
+        pckd_meas_len += 4;
+
+        // Last Wheel Event Time
+        co_write16p(&pckd_meas[pckd_meas_len], param->last_wheel_evt_time);
+        pckd_meas_len += 2;
+    }
+
+    // Cumulative Crank Revolutions
+    // Last Crank Event Time
+    if (CSCPS_IS_PRESENT(param->flags, CSCP_MEAS_CRANK_REV_DATA_PRESENT))
+    {
+        // Cumulative Crank Revolutions
+        co_write16p(&pckd_meas[pckd_meas_len], param->cumul_crank_rev);
+        pckd_meas_len += 2;
+
+        // Last Crank Event Time
+        co_write16p(&pckd_meas[pckd_meas_len], param->last_crank_evt_time);
+        pckd_meas_len += 2;
+    }
+
+    return pckd_meas_len;
+}
+
+/// Create the database with the features and connect
+static void sim_init(uint16_t feature)
+{
+    struct cscps_create_db_req req = {feature, CSCPS_SENSOR_LOC_NOT_SUPP, 0};
+
+    memset(&cscps_env, 0, sizeof(cscps_env));
+    sim_state = CSCPS_DISABLED;
+    cscps_create_db_req_handler(CSCPS_CREATE_DB_REQ, &req, TASK_CSCPS, TASK_APP);
+    CHECK(sim_state == CSCPS_IDLE);
+    cscps_env.con_info.conhdl = CONHDL;
+    cscps_env.prf_cfg |= CSCP_PRF_CFG_FLAG_CSC_MEAS_NTF;
+    sim_state = CSCPS_CONNECTED;
+}
+
+static void sim_param(struct cscps_ntf_csc_meas_cmd *param, uint8_t flags)
+{
+    param->conhdl              = CONHDL;
+    param->flags               = flags;
+    param->cumul_crank_rev     = rand();
+    param->last_crank_evt_time = rand();
+    param->last_wheel_evt_time = rand();
+    param->wheel_rev           = rand();
+}
+
+/// Notify a measurement with the handler, return the old packing of the same parameters
+static uint8_t sim_notify(struct cscps_ntf_csc_meas_cmd *param, uint8_t *old, uint32_t *wheel_revol)
+{
+    struct cscps_ntf_csc_meas_cmd req = *param;
+
+    CHECK(cscps_ntf_csc_meas_cmd_handler(CSCPS_NTF_CSC_MEAS_CMD, &req, TASK_CSCPS, TASK_APP)
+          == KE_MSG_CONSUMED);
+    CHECK(sim_state == CSCPS_BUSY && sim_val_hdl == SHDL + CSCS_IDX_CSC_MEAS_VAL);
+    cscps_env.operation = CSCPS_RESERVED_OP_CODE;
+    sim_state = CSCPS_CONNECTED;
+
+    // the flag checks of the handler come before the packing
+    param->flags = req.flags;
+    return old_csc_meas_pack(old, param, wheel_revol);
+}
+
+static void test_golden(void)
+{
+    static const uint16_t features[] = {0, CSCP_FEAT_WHEEL_REV_DATA_SUPP, CSCP_FEAT_CRANK_REV_DATA_SUPP,
+                                        CSCP_FEAT_WHEEL_REV_DATA_SUPP | CSCP_FEAT_CRANK_REV_DATA_SUPP};
+    struct cscps_ntf_csc_meas_cmd param;
+    uint8_t old[CSCP_CSC_MEAS_MAX_LEN];
+    uint8_t old_len;
+    uint32_t wheel_revol;
+    int f, n;
+
+    srand(45);
+    for (f = 0; f < (int)(sizeof(features) / sizeof(features[0])); f++) {
+        sim_init(features[f]);
+        wheel_revol = 0;
+        for (n = 0; n < SIM_NB; n++) {
+            sim_param(&param, n & 0xFF);
+            // go back below zero from time to time
+            if (n % 7 == 0)
+                param.wheel_rev = -(int16_t)(rand() & 0x7FFF);
+            old_len = sim_notify(&param, old, &wheel_revol);
+            CHECK(sim_val_len == old_len && memcmp(sim_val, old, old_len) == 0);
+            CHECK(cscps_env.wheel_revol == wheel_revol);
+        }
+    }
+}
+
+/// Wheel revolution update of the previous CSCPS
+__attribute__((noinline)) static uint32_t wheel_update_fabs(uint32_t wheel_revol, int16_t wheel_rev)
+{
+    if ((wheel_rev < 0) && (fabs(wheel_rev) > wheel_revol))
+        return 0;
+    return wheel_revol + wheel_rev;
+}
+
+/// Wheel revolution update of CSCPS
+__attribute__((noinline)) static uint32_t wheel_update_int(uint32_t wheel_revol, int16_t wheel_rev)
+{
+    if ((wheel_rev < 0) && ((uint32_t)(-wheel_rev) > wheel_revol))
+        return 0;
+    return wheel_revol + wheel_rev;
+}
+
+static void bench(void)
+{
+    struct cscps_ntf_csc_meas_cmd param, req;
+    volatile uint32_t sink = 0;
+    uint32_t wheel_revol = 0;
+    uint64_t t0, t1, t2, t3;
+    int n;
+
+    sim_init(CSCP_FEAT_WHEEL_REV_DATA_SUPP | CSCP_FEAT_CRANK_REV_DATA_SUPP);
+    sim_param(&param, 0);
+    t0 = host_ns();
+    for (n = 0; n < SIM_NB * 50; n++) {
+        req = param;
+        req.flags = n & CSCP_MEAS_ALL_PRESENT;
+        cscps_ntf_csc_meas_cmd_handler(CSCPS_NTF_CSC_MEAS_CMD, &req, TASK_CSCPS, TASK_APP);
+        cscps_env.operation = CSCPS_RESERVED_OP_CODE;
+        sim_state = CSCPS_CONNECTED;
+        sink += sim_val[1];
+    }
+    t1 = host_ns();
+    for (n = 0; n < SIM_NB * 50; n++)
+        wheel_revol = wheel_update_fabs(wheel_revol, (n & 1) ? -(n & 0x7FF) : (n & 0x3FF));
+    t2 = host_ns();
+    sink += wheel_revol;
+    wheel_revol = 0;
+    for (n = 0; n < SIM_NB * 50; n++)
+        wheel_revol = wheel_update_int(wheel_revol, (n & 1) ? -(n & 0x7FF) : (n & 0x3FF));
+    t3 = host_ns();
+    sink += wheel_revol;
+    printf("CSC Measurement  notify %.1fns  wheel revolution update fabs %.1fns  integer %.1fns\n",
+           (double)(t1 - t0) / (SIM_NB * 50), (double)(t2 - t1) / (SIM_NB * 50),
+           (double)(t3 - t2) / (SIM_NB * 50));
+}
+
+#else // (BLE_RSC_SENSOR)
+
+/// Per-flag packing of the RSC Measurement, after the flag checks
+static uint8_t old_rsc_meas_pack(uint8_t *pckd_meas, struct rscps_ntf_rsc_meas_cmd const *param)
+{
+    uint8_t pckd_meas_len = RSCP_RSC_MEAS_MIN_LEN;
+
+    // Flag value
+    pckd_meas[0] = param->flags;
+    // Instantaneous Speed
+    co_write16p(&pckd_meas[1], param->inst_speed);
+    // Instantaneous Cadence
+    pckd_meas[3] = param->inst_cad;
+
+    // Instantaneous Stride Length
+    if (RSCPS_IS_PRESENT(param->flags, RSCP_MEAS_INST_STRIDE_LEN_PRESENT))
+    {
+        co_write16p(&pckd_meas[pckd_meas_len], param->inst_stride_len);
+        pckd_meas_len += 2;
+    }
+
+    // Total Distance
+    if (RSCPS_IS_PRESENT(param->flags, RSCP_MEAS_TOTAL_DST_MEAS_PRESENT))
+    {
+        co_write32p(&pckd_meas[pckd_meas_len], param->total_dist);
+        pckd_meas_len += 4;
+    }
+
+    return pckd_meas_len;
+}
+
+/// Create the database with the features and connect
+static void sim_init(uint16_t feature)
+{
+    struct rscps_create_db_req req = {feature, RSCPS_SENSOR_LOC_NOT_SUPP, 0};
+
+    memset(&rscps_env, 0, sizeof(rscps_env));
+    sim_state = RSCPS_DISABLED;
+    rscps_create_db_req_handler(RSCPS_CREATE_DB_REQ, &req, TASK_RSCPS, TASK_APP);
+    CHECK(sim_state == RSCPS_IDLE);
+    rscps_env.con_info.conhdl = CONHDL;
+    rscps_env.prf_cfg |= RSCP_PRF_CFG_FLAG_RSC_MEAS_NTF;
+    sim_state = RSCPS_CONNECTED;
+}
+
+static void sim_param(struct rscps_ntf_rsc_meas_cmd *param, uint8_t flags)
+{
+    param->conhdl          = CONHDL;
+    param->flags           = flags;
+    param->inst_cad        = rand();
+    param->inst_speed      = rand();
+    param->inst_stride_len = rand();
+    param->total_dist      = (uint32_t)rand() * 7;
+}
+
+static void test_golden(void)
+{
+    static const uint16_t features[] = {0, RSCP_FEAT_INST_STRIDE_LEN_SUPP, RSCP_FEAT_TOTAL_DST_MEAS_SUPP,
+                                        RSCP_FEAT_INST_STRIDE_LEN_SUPP | RSCP_FEAT_TOTAL_DST_MEAS_SUPP |
+                                        RSCP_FEAT_WALK_RUN_STATUS_SUPP};
+    struct rscps_ntf_rsc_meas_cmd param, req;
+    uint8_t old[RSCP_RSC_MEAS_MAX_LEN];
+    uint8_t old_len;
+    int f, n;
+
+    srand(45);
+    for (f = 0; f < (int)(sizeof(features) / sizeof(features[0])); f++) {
+        sim_init(features[f]);
+        for (n = 0; n < SIM_NB; n++) {
+            sim_param(&param, n & 0xFF);
+            req = param;
+            CHECK(rscps_ntf_rsc_meas_cmd_handler(RSCPS_NTF_RSC_MEAS_CMD, &req, TASK_RSCPS, TASK_APP)
+                  == KE_MSG_CONSUMED);
+            CHECK(sim_state == RSCPS_BUSY && sim_val_hdl == SHDL + RSCS_IDX_RSC_MEAS_VAL);
+            rscps_env.operation = RSCPS_RESERVED_OP_CODE;
+            sim_state = RSCPS_CONNECTED;
+
+            // the flag checks of the handler come before the packing
+            param.flags = req.flags;
+            old_len = old_rsc_meas_pack(old, &param);
+            CHECK(sim_val_len == old_len && memcmp(sim_val, old, old_len) == 0);
+        }
+    }
+}
+
+static void bench(void)
+{
+    struct rscps_ntf_rsc_meas_cmd param, req;
+    volatile uint32_t sink = 0;
+    uint64_t t0, t1;
+    int n;
+
+    sim_init(RSCP_FEAT_INST_STRIDE_LEN_SUPP | RSCP_FEAT_TOTAL_DST_MEAS_SUPP);
+    sim_param(&param, 0);
+    t0 = host_ns();
+    for (n = 0; n < SIM_NB * 50; n++) {
+        req = param;
+        req.flags = n & (RSCP_MEAS_INST_STRIDE_LEN_PRESENT | RSCP_MEAS_TOTAL_DST_MEAS_PRESENT);
+        rscps_ntf_rsc_meas_cmd_handler(RSCPS_NTF_RSC_MEAS_CMD, &req, TASK_RSCPS, TASK_APP);
+        rscps_env.operation = RSCPS_RESERVED_OP_CODE;
+        sim_state = RSCPS_CONNECTED;
+        sink += sim_val[1];
+    }
+    t1 = host_ns();
+    printf("RSC Measurement  notify %.1fns\n", (double)(t1 - t0) / (SIM_NB * 50));
+}
+
+#endif // (BLE_CSC_SENSOR)
+
+int main(void)
+{
+    test_golden();
+    bench();
+#if (BLE_CSC_SENSOR)
+    return host_result("test_pack_csc");
+#else
+    return host_result("test_pack_rsc");
+#endif
+}
@@ -0,0 +1,415 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_prof.c
+ *
+ * @brief Kernel message profiler on a kernel model: queue residency after messages the
+ * kernel discards, buffers reused by the ROM stack, saved messages, messages freed by the
+ * application, the eviction of the oldest send time, residencies longer than the SysTick
+ * period, and SysTick used by the application with another period
+ *
+ * The kernel model delivers the messages in order to the handler tables registered by the
+ * profiler. SysTick is a RAM word in the system control space, the test moves it.
+ *
+ ****************************************************************************************
+ */
+
+#include <sys/mman.h>
+#include "app_env.h"
+#include "host.h"
+
+static void host_ke_msg_send(void const *param_ptr);
+static void host_ke_msg_free(struct ke_msg const *msg);
+static void host_task_desc_register(uint8_t task_id, struct ke_task_desc task_desc);
+static ke_state_t host_ke_state_get(ke_task_id_t const id);
+
+#undef _ke_msg_send
+#undef _ke_msg_free
+#undef _task_desc_register
+#undef _ke_state_get
+#define _ke_msg_send            host_ke_msg_send
+#define _ke_msg_free            host_ke_msg_free
+#define _task_desc_register     host_task_desc_register
+#define _ke_state_get           host_ke_state_get
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_prof.c"
+
+#define TASK_PROF               TASK_APP
+#define TASK_OTHER              TASK_GAP
+#define MSG_A                   KE_FIRST_MSG(TASK_APP) + 1
+#define MSG_SAVE                KE_FIRST_MSG(TASK_APP) + 2
+#define MSG_NO_FREE             KE_FIRST_MSG(TASK_APP) + 3
+#define MSG_UNHANDLED           KE_FIRST_MSG(TASK_APP) + 4
+#define POOL_NB                 16
+#define QUEUE_NB                64
+
+/// Message buffers, the last freed one is allocated first like a heap reuses a block
+static struct
+{
+    struct ke_msg msg;
+    uint32_t param[3];
+} pool[POOL_NB];
+static struct ke_msg *free_list[POOL_NB];
+static int free_nb;
+
+/// Kernel queue and saved queue
+static struct ke_msg *queue[QUEUE_NB];
+static int queue_nb;
+static struct ke_msg *saved[QUEUE_NB];
+static int saved_nb;
+static struct ke_msg *kept;
+
+/// Registered task descriptors
+static struct ke_task_desc task_desc[TASK_MAX];
+static ke_state_t task_state[TASK_MAX];
+
+uint32_t g_AhbClock = 32000000;
+
+static void host_ke_msg_send(void const *param_ptr)
+{
+    CHECK(queue_nb < QUEUE_NB);
+    queue[queue_nb++] = ke_param2msg(param_ptr);
+}
+
+static void host_ke_msg_free(struct ke_msg const *msg)
+{
+    free_list[free_nb++] = (struct ke_msg *)msg;
+}
+
+static void host_task_desc_register(uint8_t task_id, struct ke_task_desc desc)
+{
+    task_desc[task_id] = desc;
+}
+
+static ke_state_t host_ke_state_get(ke_task_id_t const id)
+{
+    return task_state[KE_TYPE_GET(id)];
+}
+
+static void *msg_alloc(ke_msg_id_t id, ke_task_id_t dest)
+{
+    struct ke_msg *msg = free_list[--free_nb];
+
+    msg->id = id;
+    msg->dest_id = dest;
+    msg->src_id = TASK_APP;
+    msg->param_len = sizeof(pool[0].param);
+    return ke_msg2param(msg);
+}
+
+static void sim_ticks(uint32_t n)
+{
+    SysTick->VAL = (SysTick->VAL - n) & APP_PROF_TICK_MASK;
+}
+
+static int handler_a(ke_msg_id_t const msgid, void const *param, ke_task_id_t const dest_id,
+                     ke_task_id_t const src_id)
+{
+    sim_ticks(5);
+    return KE_MSG_CONSUMED;
+}
+
+static int handler_save(ke_msg_id_t const msgid, void const *param, ke_task_id_t const dest_id,
+                        ke_task_id_t const src_id)
+{
+    // saved the first time
+    uint32_t *count = (uint32_t *)param;
+
+    return (*count)++ == 0 ? KE_MSG_SAVED : KE_MSG_CONSUMED;
+}
+
+static int handler_no_free(ke_msg_id_t const msgid, void const *param, ke_task_id_t const dest_id,
+                           ke_task_id_t const src_id)
+{
+    kept = ke_param2msg(param);
+    return KE_MSG_NO_FREE;
+}
+
+static const struct ke_msg_handler test_default_state[] =
+{
+    {MSG_A,         (ke_msg_func_t)handler_a},
+    {MSG_SAVE,      (ke_msg_func_t)handler_save},
+    {MSG_NO_FREE,   (ke_msg_func_t)handler_no_free},
+};
+static const struct ke_state_handler test_default_handler = KE_STATE_HANDLER(test_default_state);
+
+/// Deliver the queued messages like the kernel scheduler
+static void dispatch(void)
+{
+    struct ke_task_desc const *desc;
+    struct ke_msg *msg;
+    ke_msg_func_t func;
+    int i, ret;
+
+    while (queue_nb) {
+        msg = queue[0];
+        queue_nb--;
+        memmove(queue, queue + 1, queue_nb * sizeof(queue[0]));
+
+        desc = &task_desc[KE_TYPE_GET(msg->dest_id)];
+        func = NULL;
+        for (i = 0; desc->default_handler != NULL && i < desc->default_handler->msg_cnt; i++) {
+            if (desc->default_handler->msg_table[i].id == msg->id) {
+                func = desc->default_handler->msg_table[i].func;
+            }
+        }
+        if (func == NULL) {
+            // discarded without a handler call
+            host_ke_msg_free(msg);
+            continue;
+        }
+        ret = func(msg->id, ke_msg2param(msg), msg->dest_id, msg->src_id);
+        if (ret == KE_MSG_CONSUMED) {
+            host_ke_msg_free(msg);
+        } else if (ret == KE_MSG_SAVED) {
+            saved[saved_nb++] = msg;
+        }
+    }
+}
+
+/// Put the saved messages back in the queue, as on a state change
+static void restore_saved(void)
+{
+    memcpy(&queue[queue_nb], saved, saved_nb * sizeof(saved[0]));
+    queue_nb += saved_nb;
+    saved_nb = 0;
+}
+
+static struct app_prof_msg *stat_of(ke_msg_id_t id)
+{
+    return app_prof_get_msg(id, TASK_PROF);
+}
+
+static int sent_nb(void)
+{
+    int i, nb = 0;
+
+    for (i = 0; i < APP_PROF_SENT_MAX; i++) {
+        nb += app_prof_env.sent[i].msg != NULL;
+    }
+    return nb;
+}
+
+static void reset(void)
+{
+    dispatch();
+    app_prof_reset();
+}
+
+/// Discarded messages leave their entry, the residency of the next ones is still measured
+static void test_discarded(void)
+{
+    void *p;
+    int i;
+
+    reset();
+    for (i = 0; i < 3 * APP_PROF_SENT_MAX; i++) {
+        ke_msg_send(msg_alloc(MSG_UNHANDLED, TASK_PROF));
+        dispatch();
+    }
+    p = msg_alloc(MSG_A, TASK_PROF);
+    ke_msg_send(p);
+    sim_ticks(100);
+    dispatch();
+    CHECK(stat_of(MSG_A)->count == 1);
+    CHECK(stat_of(MSG_A)->queue_max == 100);
+    CHECK(stat_of(MSG_A)->cycles == 5);
+}
+
+/// A buffer the ROM stack reuses for another message has no residency
+static void test_reuse(void)
+{
+    void *p;
+
+    reset();
+    // discarded, the entry stays
+    ke_msg_send(msg_alloc(MSG_UNHANDLED, TASK_PROF));
+    dispatch();
+    CHECK(sent_nb() == 1);
+    sim_ticks(1000);
+
+    // the ROM stack sends the same buffer without the profiler
+    p = msg_alloc(MSG_A, TASK_PROF);
+    host_ke_msg_send(p);
+    sim_ticks(300);
+    dispatch();
+    CHECK(stat_of(MSG_A)->count == 1);
+    CHECK(stat_of(MSG_A)->queue_max == 0);
+    CHECK(sent_nb() == 0);
+
+    // the same buffer sent again through the profiler takes over the entry
+    ke_msg_send(msg_alloc(MSG_UNHANDLED, TASK_PROF));
+    dispatch();
+    sim_ticks(1000);
+    ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+    CHECK(sent_nb() == 1);
+    sim_ticks(20);
+    dispatch();
+    CHECK(stat_of(MSG_A)->queue_max == 20);
+    CHECK(sent_nb() == 0);
+}
+
+/// A saved message keeps its send time until it is consumed
+static void test_saved(void)
+{
+    uint32_t *count;
+
+    reset();
+    count = msg_alloc(MSG_SAVE, TASK_PROF);
+    *count = 0;
+    ke_msg_send(count);
+    sim_ticks(50);
+    dispatch();
+    CHECK(saved_nb == 1);
+    CHECK(stat_of(MSG_SAVE)->queue_max == 50);
+    sim_ticks(70);
+    restore_saved();
+    dispatch();
+    CHECK(*count == 2);
+    CHECK(stat_of(MSG_SAVE)->count == 2);
+    CHECK(stat_of(MSG_SAVE)->queue_max == 120);
+    CHECK(sent_nb() == 0);
+}
+
+/// Messages freed by the application drop their entry, no newer message evicts them
+static void test_free(void)
+{
+    void *p[APP_PROF_SENT_MAX];
+    int i;
+
+    reset();
+    for (i = 0; i < APP_PROF_SENT_MAX; i++) {
+        p[i] = msg_alloc(MSG_NO_FREE, TASK_PROF);
+        ke_msg_send(p[i]);
+        dispatch();
+        // kept by the task, freed later
+        CHECK(kept == ke_param2msg(p[i]));
+        ke_msg_free(kept);
+    }
+    CHECK(sent_nb() == 0);
+
+    // messages to another task are not recorded
+    ke_msg_send(msg_alloc(MSG_A, TASK_OTHER));
+    CHECK(sent_nb() == 0);
+    host_ke_msg_free(queue[--queue_nb]);
+
+    for (i = 0; i < APP_PROF_SENT_MAX; i++) {
+        p[i] = msg_alloc(MSG_A, TASK_PROF);
+        ke_msg_send(p[i]);
+    }
+    CHECK(sent_nb() == APP_PROF_SENT_MAX);
+    // the application flushes its queue
+    queue_nb = 0;
+    for (i = 0; i < APP_PROF_SENT_MAX; i++) {
+        ke_msg_free(ke_param2msg(p[i]));
+    }
+    CHECK(sent_nb() == 0);
+    CHECK(app_prof_env.sent_evict_nb == 0);
+}
+
+/// A full table evicts the oldest send time
+static void test_evict(void)
+{
+    int i;
+
+    reset();
+    for (i = 0; i <= APP_PROF_SENT_MAX; i++) {
+        ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+        sim_ticks(10);
+    }
+    CHECK(app_prof_env.sent_evict_nb == 1);
+    dispatch();
+    CHECK(stat_of(MSG_A)->count == APP_PROF_SENT_MAX + 1);
+    // the first message has no send time, the second one waited the longest
+    CHECK(stat_of(MSG_A)->queue_max == APP_PROF_SENT_MAX * 10 + 5);
+    CHECK(sent_nb() == 0);
+}
+
+/// Beyond the SysTick period the residency is in kernel time, saturated on 32 bits
+static void test_long(void)
+{
+    reset();
+    // 7 wraps of SysTick in 3.5s, the cycles are 3.5s from the kernel time
+    ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+    host_ke_time += 350;
+    sim_ticks(123);
+    dispatch();
+    CHECK(stat_of(MSG_A)->queue_max == 350 * (g_AhbClock / 100));
+
+    // one 10ms step may have wrapped 0.5s
+    ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+    host_ke_time += 40;
+    sim_ticks(123);
+    dispatch();
+    CHECK(stat_of(MSG_A)->queue_max == 350 * (g_AhbClock / 100));
+    reset();
+    ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+    host_ke_time += 55;
+    dispatch();
+    CHECK(stat_of(MSG_A)->queue_max == 55 * (g_AhbClock / 100));
+
+    // in the SysTick period, the cycles
+    reset();
+    ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+    host_ke_time += 1;
+    sim_ticks(400000);
+    dispatch();
+    CHECK(stat_of(MSG_A)->queue_max == 400000);
+
+    // across the kernel time wrap, and saturated above 134s
+    reset();
+    host_ke_time = 0x7FFFFF;
+    ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+    host_ke_time = 0x800000 + 99;
+    dispatch();
+    CHECK(stat_of(MSG_A)->queue_max == 100 * (g_AhbClock / 100));
+    ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+    host_ke_time += 20000;
+    dispatch();
+    CHECK(stat_of(MSG_A)->queue_max == 0xFFFFFFFF);
+    host_ke_time = 0;
+}
+
+/// SysTick running with another period is not used
+static void test_tick_off(void)
+{
+    reset();
+    SysTick->LOAD = 32000 - 1;
+    task_desc_register(TASK_OTHER, (struct ke_task_desc){NULL, NULL, NULL, 1, 1});
+    CHECK(app_prof_env.tick_off);
+    CHECK(SysTick->LOAD == 32000 - 1);
+
+    ke_msg_send(msg_alloc(MSG_A, TASK_PROF));
+    sim_ticks(100);
+    dispatch();
+    CHECK(stat_of(MSG_A)->count == 1);
+    CHECK(stat_of(MSG_A)->queue_max == 0 && stat_of(MSG_A)->cycles == 0);
+}
+
+int main(void)
+{
+    int i;
+
+    if (mmap((void *)SCS_BASE, 0x1000, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != (void *)SCS_BASE) {
+        printf("can not map the system control space\n");
+        return 1;
+    }
+    for (i = 0; i < POOL_NB; i++) {
+        free_list[free_nb++] = &pool[i].msg;
+    }
+
+    task_desc_register(TASK_PROF, (struct ke_task_desc){NULL, &test_default_handler, task_state, 1, 1});
+    CHECK(task_desc[TASK_PROF].default_handler != &test_default_handler);
+
+    test_discarded();
+    test_reuse();
+    test_saved();
+    test_free();
+    test_evict();
+    test_long();
+    test_tick_off();
+    return host_result("test_prof");
+}
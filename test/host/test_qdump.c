@@ -0,0 +1,220 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_qdump.c
+ *
+ * @brief Trace and dump of data buffers: the text of qtrace() against the former print of
+ * one byte per call, the lines of qdump() against a reference, the number of UART writes,
+ * and the cost per byte of both against the former qtrace()
+ *
+ ****************************************************************************************
+ */
+
+#include <ctype.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HOST_CYCLES()   __rdtsc()
+#else
+#define HOST_CYCLES()   0
+#endif
+
+// The formatter has its own strnlen()
+#define strnlen qsprintf_strnlen
+#include "app_printf.c"
+#undef strnlen
+#include "host.h"
+
+/// UART text
+static char cap[1 << 20];
+static size_t cap_nb;
+static int uart_nb;
+
+void uart_printf(QN_UART_TypeDef *UART, uint8_t *bufptr)
+{
+    size_t n = strlen((char *)bufptr);
+
+    CHECK(cap_nb + n < sizeof(cap));
+    memcpy(&cap[cap_nb], bufptr, n + 1);
+    cap_nb += n;
+    uart_nb++;
+}
+
+/// QPRINTF() without the standard printf, the former qtrace() called it for each byte
+static void old_qprintf(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    qsprintf(print_buff, fmt, args);
+    va_end(args);
+    uart_printf(QN_DEBUG_UART, (uint8_t *)print_buff);
+}
+
+/// Former qtrace(), one print per byte through the formatter
+static void old_qtrace(uint8_t *data, uint16_t len, bool dir, uint8_t fmt, char *out)
+{
+    static const char *const fmts[] = {"%c", "%d", "%02x"};
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        out += sprintf(out, fmts[fmt], dir == 0 ? data[i] : data[len - i - 1]);
+    }
+}
+
+/// Reference lines of qdump()
+static void ref_qdump(const uint8_t *data, uint16_t len, uint8_t flags, char *out)
+{
+    uint16_t i, j;
+
+    for (i = 0; i < len; i += QDUMP_LINE_LEN) {
+        if (flags & QDUMP_OFFSET) {
+            out += sprintf(out, "%04x: ", i);
+        }
+        for (j = 0; j < QDUMP_LINE_LEN; j++) {
+            if (i + j < len) {
+                out += sprintf(out, "%02x ", data[i + j]);
+            } else if (flags & QDUMP_ASCII) {
+                out += sprintf(out, "   ");
+            }
+        }
+        if (flags & QDUMP_ASCII) {
+            *out++ = '|';
+            for (j = 0; j < QDUMP_LINE_LEN && i + j < len; j++) {
+                *out++ = isprint(data[i + j]) ? data[i + j] : '.';
+            }
+            *out++ = '|';
+        }
+        out += sprintf(out, "\r\n");
+    }
+    *out = 0;
+}
+
+static void random_data(uint8_t *data, uint16_t len, bool printable)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        data[i] = printable ? ' ' + rand() % 95 : rand();
+    }
+}
+
+static void test_qtrace(void)
+{
+    static uint8_t data[1024];
+    static char expect[4096];
+    uint16_t len;
+    uint8_t fmt;
+    int it;
+    bool dir;
+
+    srand(23);
+    for (it = 0; it < 3000; it++) {
+        len = 1 + rand() % sizeof(data);
+        fmt = rand() % 3;
+        dir = rand() % 2;
+        // A 0 byte ends the text of a %c trace
+        random_data(data, len, fmt == 0);
+        old_qtrace(data, len, dir, fmt, expect);
+        cap_nb = 0;
+        uart_nb = 0;
+        qtrace(data, len, dir, fmt);
+        CHECK(strcmp(cap, expect) == 0);
+        // The text goes out in writes of nearly a whole print_buff
+        CHECK(uart_nb <= 1 + strlen(expect) / (sizeof(print_buff) - 4));
+    }
+}
+
+static void test_qdump(void)
+{
+    static uint8_t data[1024];
+    static char expect[8192], line[128];
+    uint16_t len;
+    uint8_t flags;
+    int it, line_nb, per_write;
+
+    srand(29);
+    for (it = 0; it < 3000; it++) {
+        len = rand() % 4 ? 1 + rand() % 64 : 1 + rand() % sizeof(data);
+        flags = rand() % 4;
+        random_data(data, len, false);
+        ref_qdump(data, len, flags, expect);
+        cap_nb = 0;
+        uart_nb = 0;
+        qdump(data, len, flags);
+        CHECK(strcmp(cap, expect) == 0);
+        // A line is never split across writes, the writes are as full as print_buff allows
+        line_nb = (len + QDUMP_LINE_LEN - 1) / QDUMP_LINE_LEN;
+        per_write = (sizeof(print_buff) - 1) / (((flags & QDUMP_OFFSET) ? 6 : 0) + QDUMP_LINE_LEN * 3
+                                               + ((flags & QDUMP_ASCII) ? QDUMP_LINE_LEN + 2 : 0) + 2);
+        CHECK(uart_nb <= (line_nb + per_write - 1) / per_write);
+    }
+
+    data[0] = 'H';
+    data[1] = 'i';
+    data[2] = 0;
+    cap_nb = 0;
+    qdump(data, 3, QDUMP_OFFSET | QDUMP_ASCII);
+    sprintf(line, "0000: 48 69 00 %39s|Hi.|\r\n", "");
+    CHECK(strcmp(cap, line) == 0);
+}
+
+/// Host ns and TSC cycles per byte of qtrace() and qdump() against the former qtrace(),
+/// the former one sends each byte through qsprintf() and a UART write
+static void bench(void)
+{
+    static uint8_t data[256];
+    static const char *const fmts[] = {"%c", "%d", "%x"};
+    uint64_t t0, t1, c0, c1;
+    uint32_t n, loops = 2000;
+    uint16_t i;
+    int f;
+
+    random_data(data, sizeof(data), true);
+    printf("function         ns/byte  cycles/byte\n");
+    for (f = 0; f < 3; f++) {
+        t0 = host_ns();
+        c0 = HOST_CYCLES();
+        for (n = 0; n < loops; n++) {
+            cap_nb = 0;
+            for (i = 0; i < sizeof(data); i++) {
+                old_qprintf(fmts[f], data[i]);
+            }
+        }
+        c1 = HOST_CYCLES();
+        t1 = host_ns();
+        printf("old qtrace %s   %8.2f  %11.1f\n", fmts[f], (double)(t1 - t0) / loops / sizeof(data),
+               (double)(c1 - c0) / loops / sizeof(data));
+
+        t0 = host_ns();
+        c0 = HOST_CYCLES();
+        for (n = 0; n < loops; n++) {
+            cap_nb = 0;
+            qtrace(data, sizeof(data), 0, f);
+        }
+        c1 = HOST_CYCLES();
+        t1 = host_ns();
+        printf("qtrace %s       %8.2f  %11.1f\n", fmts[f], (double)(t1 - t0) / loops / sizeof(data),
+               (double)(c1 - c0) / loops / sizeof(data));
+    }
+
+    t0 = host_ns();
+    c0 = HOST_CYCLES();
+    for (n = 0; n < loops; n++) {
+        cap_nb = 0;
+        qdump(data, sizeof(data), QDUMP_OFFSET | QDUMP_ASCII);
+    }
+    c1 = HOST_CYCLES();
+    t1 = host_ns();
+    printf("qdump            %8.2f  %11.1f\n", (double)(t1 - t0) / loops / sizeof(data),
+           (double)(c1 - c0) / loops / sizeof(data));
+    cap_nb = 0;
+}
+
+int main(void)
+{
+    test_qtrace();
+    test_qdump();
+    bench();
+    return host_result("test_qdump");
+}
@@ -0,0 +1,388 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_qlog.c
+ *
+ * @brief Tokenized print through the host decoder: random formats decoded against the text
+ * of qsprintf(), string and record limits, lost records with a stalled UART, resync after
+ * line noise, format strings of an ELF image, and the UART bytes and host time of a record
+ * against the text
+ *
+ * The format strings are read at their address in the test image, the test links at a
+ * fixed address below 4GB.
+ *
+ ****************************************************************************************
+ */
+
+#include "intc.h"
+
+// The interrupt disabling writes the NVIC, there is no interrupt on the host
+#undef GLOBAL_INT_DISABLE
+#undef GLOBAL_INT_RESTORE
+#define GLOBAL_INT_DISABLE()    do {
+#define GLOBAL_INT_RESTORE()    } while (0)
+
+// The formatter has its own strnlen()
+#define strnlen qsprintf_strnlen
+#include "app_printf.c"
+#undef strnlen
+#define QLOG_DECODE_NO_MAIN
+#include "qlog_decode.c"
+#include "host.h"
+
+/// UART capture
+static uint8_t cap[1 << 20];
+static size_t cap_nb;
+/// Transmission left pending by the UART, NULL when done
+static void (*uart_done)(void);
+/// The UART completes the transmissions at once
+static int uart_run = 1;
+
+void uart_write(QN_UART_TypeDef *UART, uint8_t *bufptr, uint32_t size, void (*tx_callback)(void))
+{
+    CHECK(cap_nb + size <= sizeof(cap));
+    memcpy(&cap[cap_nb], bufptr, size);
+    cap_nb += size;
+    if (uart_run) {
+        tx_callback();
+    } else {
+        uart_done = tx_callback;
+    }
+}
+
+static const char *host_fmt_get(uint32_t addr, void *ctx)
+{
+    return (const char *)(uintptr_t)addr;
+}
+
+/// Format text of the records captured since the last call
+static char *capture_text(uint32_t *skipped)
+{
+    static char text[1 << 20];
+    FILE *f = fmemopen(text, sizeof(text), "w");
+    size_t used;
+
+    *skipped = 0;
+    used = qlog_decode_buf(cap, cap_nb, host_fmt_get, NULL, f, skipped);
+    fputc(0, f);
+    fclose(f);
+    CHECK(used == cap_nb);
+    cap_nb = 0;
+    return text;
+}
+
+static void random_str(char *s, int max)
+{
+    int n = rand() % (max + 1);
+    int i;
+
+    for (i = 0; i < n; i++) {
+        s[i] = ' ' + rand() % 95;
+    }
+    s[n] = 0;
+}
+
+/// Text of qsprintf()
+static int expect_text(char *buf, const char *fmt, ...)
+{
+    va_list args;
+    int n;
+
+    va_start(args, fmt);
+    n = qsprintf(buf, fmt, args);
+    va_end(args);
+    return n;
+}
+
+/// Random formats of up to three conversions, the decoded text shall be the text of
+/// qsprintf(). The host printf of the decoder does not pad with zeros when a precision is
+/// given and prints the alternate forms of 0 without a prefix, the formats keep off those.
+static void test_random(void)
+{
+    static const char conv[][3] = {"d", "i", "u", "x", "X", "o", "c", "s", "a", "A", "la", "lA"};
+    static char fmts[2000][64];
+    static char expect[1 << 20];
+    char s[3][16], *f, *e = expect, *text;
+    uint8_t addr[3][6];
+    intptr_t args[6];
+    uint32_t skipped;
+    int it, k, c, i, argn, zero;
+    char last;
+
+    srand(17);
+    for (it = 0; it < 2000; it++) {
+        f = fmts[it];
+        f += sprintf(f, "<%d>", it);
+        argn = 0;
+        for (k = 0; k < 3; k++) {
+            c = rand() % (sizeof(conv) / sizeof(conv[0]));
+            last = conv[c][strlen(conv[c]) - 1];
+            zero = 0;
+            *f++ = '%';
+            if (rand() % 3 == 0) {
+                *f++ = '-';
+            } else if (rand() % 3 == 0 && strchr("diuxXo", last)) {
+                *f++ = '0';
+                zero = 1;
+            }
+            if (rand() % 4 == 0 && (last == 'd' || last == 'i')) {
+                *f++ = rand() % 2 ? '+' : ' ';
+            }
+            switch (rand() % 3) {
+            case 0:
+                f += sprintf(f, "%d", 1 + rand() % 20);
+                break;
+            case 1:
+                *f++ = '*';
+                args[argn++] = rand() % 41 - 20;
+                break;
+            }
+            if (!zero && strchr("diuxXos", last) && rand() % 4 == 0) {
+                f += sprintf(f, ".%d", 1 + rand() % 9);
+            }
+            f += sprintf(f, "%s|", conv[c]);
+
+            switch (last) {
+            case 'd':
+            case 'i':
+                args[argn++] = (int32_t)(rand() * 2654435761u) >> (rand() % 32);
+                break;
+            case 'c':
+                args[argn++] = ' ' + rand() % 95;
+                break;
+            case 's':
+                random_str(s[k], 8);
+                args[argn++] = (intptr_t)s[k];
+                break;
+            case 'a':
+            case 'A':
+                for (i = 0; i < 6; i++) {
+                    addr[k][i] = rand();
+                }
+                args[argn++] = (intptr_t)addr[k];
+                break;
+            default:
+                // 0 has no precision digit nor prefix on the host
+                args[argn++] = 1 + (rand() * 2654435761u) % 0xFFFFFFFEu;
+                break;
+            }
+        }
+        strcpy(f, "\n");
+
+        qlog(fmts[it], args[0], args[1], args[2], args[3], args[4], args[5]);
+        e += expect_text(e, fmts[it], args[0], args[1], args[2], args[3], args[4], args[5]);
+    }
+    text = capture_text(&skipped);
+    CHECK(skipped == 0);
+    CHECK(strcmp(text, expect) == 0);
+    for (i = 0; text[i] == expect[i] && text[i]; i++) {
+    }
+    if (text[i] != expect[i]) {
+        printf("decoded:  %.80s\nexpected: %.80s\n", &text[i > 40 ? i - 40 : 0], &expect[i > 40 ? i - 40 : 0]);
+    }
+}
+
+/// A string is cut at QLOG_STR_MAX bytes, the arguments past QLOG_REC_MAX are cut
+static void test_limits(void)
+{
+    static const char long_str[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEF";
+    uint32_t skipped;
+    char *text;
+
+    qlog("[%s]\n", long_str);
+    text = capture_text(&skipped);
+    CHECK(strcmp(text, "[0123456789abcdefghijklmnopqrstuv]\n") == 0);
+
+    qlog("%s%s%s\n", long_str, long_str, long_str);
+    text = capture_text(&skipped);
+    CHECK(skipped == 0);
+    CHECK(strcmp(text, "0123456789abcdefghijklmnopqrstuv0123456789abcdefghijklmn<cut>\n") == 0);
+
+    qlog("%d %u %% %p %q\n", -1, 0xFFFFFFFFu, 0x1234);
+    text = capture_text(&skipped);
+    CHECK(strcmp(text, "-1 4294967295 % 00001234 %q\n") == 0);
+}
+
+/// Records queued while the UART is stalled are counted as lost when the ring is full,
+/// the count comes before the next record that fits
+static void test_lost(void)
+{
+    uint32_t skipped, lost = 0, got = 0;
+    char *text, *l;
+    int i;
+
+    uart_run = 0;
+    for (i = 0; i < 100; i++) {
+        qlog("record %d\n", i);
+    }
+    uart_run = 1;
+    uart_done();
+    qlog("record %d\n", 100);
+    text = capture_text(&skipped);
+    CHECK(skipped == 0);
+
+    for (l = text; *l; l = strchr(l, '\n') + 1) {
+        if (sscanf(l, "<%u records lost>", &i) == 1) {
+            lost += i;
+        } else {
+            CHECK(sscanf(l, "record %d", &i) == 1);
+            got++;
+        }
+    }
+    CHECK(lost != 0);
+    CHECK(got + lost == 101);
+    // The last record follows the lost count
+    CHECK(strstr(text, "records lost>\nrecord 100\n") != NULL);
+}
+
+/// Line noise between the records, the decoder finds the next record
+static void test_resync(void)
+{
+    static uint8_t clean[1 << 16], noisy[1 << 17];
+    static char expect[1 << 20];
+    uint32_t skipped;
+    size_t clean_nb, n = 0, i;
+    char *text;
+    uint8_t b;
+    int k;
+
+    for (k = 0; k < 1000; k++) {
+        qlog("%d:%s\n", k, "noise");
+    }
+    clean_nb = cap_nb;
+    memcpy(clean, cap, cap_nb);
+    strcpy(expect, capture_text(&skipped));
+
+    // Bytes other than the sync byte before some records
+    srand(19);
+    for (i = 0; i < clean_nb; i++) {
+        if (clean[i] == QLOG_SYNC && rand() % 4 == 0) {
+            for (k = rand() % 8; k > 0; k--) {
+                do {
+                    b = rand();
+                } while (b == QLOG_SYNC);
+                noisy[n++] = b;
+            }
+        }
+        noisy[n++] = clean[i];
+    }
+    memcpy(cap, noisy, n);
+    cap_nb = n;
+    text = capture_text(&skipped);
+    CHECK(strcmp(text, expect) == 0);
+    CHECK(skipped == n - clean_nb);
+
+    // A capture starting in the middle of a record
+    memcpy(cap, clean + 3, clean_nb - 3);
+    cap_nb = clean_nb - 3;
+    text = capture_text(&skipped);
+    CHECK(skipped != 0);
+    CHECK(strcmp(text, strchr(expect, '\n') + 1) == 0);
+}
+
+/// Put a little endian number to an ELF image
+static void elf_put(uint8_t *p, uint32_t v, int n)
+{
+    while (n--) {
+        *p++ = v;
+        v >>= 8;
+    }
+}
+
+/// The format strings are read from the allocated sections of a 32-bit ELF image
+static void test_elf(void)
+{
+    static const char strs[] = "boot\0rssi %d dBm\r\n";
+    const uint32_t base = 0x10001000;
+    uint8_t img[52 + 32 + 3 * 40];
+    uint8_t rec[] = {QLOG_SYNC, 5, 5, 0x10, 0x00, 0x10, 2 * 60 - 1};
+    uint8_t *sh = img + 52 + 32;
+    uint32_t skipped = 0;
+    char text[64];
+    FILE *f;
+
+    memset(img, 0, sizeof(img));
+    memcpy(img, "\177ELF\1\1\1", 7);
+    elf_put(img + 32, 52 + 32, 4);              // e_shoff
+    elf_put(img + 46, 40, 2);                   // e_shentsize
+    elf_put(img + 48, 3, 2);                    // e_shnum
+    memcpy(img + 52, strs, sizeof(strs));
+    // Section 1: allocated PROGBITS with the strings
+    elf_put(sh + 40 + 4, 1, 4);
+    elf_put(sh + 40 + 8, 2, 4);
+    elf_put(sh + 40 + 12, base, 4);
+    elf_put(sh + 40 + 16, 52, 4);
+    elf_put(sh + 40 + 20, sizeof(strs), 4);
+    // Section 2: NOBITS at the same address, no content in the file
+    elf_put(sh + 80 + 4, 8, 4);
+    elf_put(sh + 80 + 8, 3, 4);
+    elf_put(sh + 80 + 12, base + 0x100, 4);
+    elf_put(sh + 80 + 20, 0x100, 4);
+
+    f = fopen("test_qlog.elf", "wb");
+    CHECK(f != NULL && fwrite(img, 1, sizeof(img), f) == sizeof(img));
+    fclose(f);
+    CHECK(elf_load("test_qlog.elf"));
+    remove("test_qlog.elf");
+
+    CHECK(elf_fmt_get(base, NULL) != NULL && strcmp(elf_fmt_get(base, NULL), "boot") == 0);
+    CHECK(elf_fmt_get(base + 0x100, NULL) == NULL);
+    CHECK(elf_fmt_get(base - 1, NULL) == NULL);
+
+    f = fmemopen(text, sizeof(text), "w");
+    CHECK(qlog_decode_buf(rec, sizeof(rec), elf_fmt_get, NULL, f, &skipped) == sizeof(rec));
+    fputc(0, f);
+    fclose(f);
+    CHECK(skipped == 0);
+    CHECK(strcmp(text, "rssi -60 dBm\n") == 0);
+}
+
+/// UART bytes and host time of a record against the text of the same print
+static void bench(void)
+{
+    static const char *fmts[] = {
+        "Connection %d established\r\n",
+        "conhdl 0x%04x, interval %d, latency %d, timeout %d\r\n",
+        "Peer %la type %d rssi %d\r\n",
+        "%s: %d bytes left\r\n",
+    };
+    static const uint8_t addr[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+    uint64_t t0, t1, t2;
+    uint32_t n, loops = 100000;
+    size_t rec, txt;
+    int i;
+
+    printf("record bytes  text bytes  qlog ns  qsprintf ns  format\n");
+    for (i = 0; i < (int)(sizeof(fmts) / sizeof(fmts[0])); i++) {
+        cap_nb = 0;
+        qlog(fmts[i], i == 2 ? (intptr_t)addr : i == 3 ? (intptr_t)"heap" : 0x10, 40, 0, 500);
+        rec = cap_nb;
+        txt = expect_text(print_buff, fmts[i], i == 2 ? (intptr_t)addr : i == 3 ? (intptr_t)"heap" : 0x10,
+                          40, 0, 500);
+        t0 = host_ns();
+        for (n = 0; n < loops; n++) {
+            cap_nb = 0;
+            qlog(fmts[i], i == 2 ? (intptr_t)addr : i == 3 ? (intptr_t)"heap" : (intptr_t)n, 40, 0, 500);
+        }
+        t1 = host_ns();
+        for (n = 0; n < loops; n++) {
+            expect_text(print_buff, fmts[i], i == 2 ? (intptr_t)addr : i == 3 ? (intptr_t)"heap" : (intptr_t)n,
+                        40, 0, 500);
+        }
+        t2 = host_ns();
+        printf("%12zu  %10zu  %7.1f  %11.1f  %.*s\n", rec, txt, (double)(t1 - t0) / loops,
+               (double)(t2 - t1) / loops, (int)strcspn(fmts[i], "\r"), fmts[i]);
+    }
+    cap_nb = 0;
+}
+
+int main(void)
+{
+    test_random();
+    test_limits();
+    test_lost();
+    test_resync();
+    test_elf();
+    bench();
+    return host_result("test_qlog");
+}
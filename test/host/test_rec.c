@@ -0,0 +1,196 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_rec.c
+ *
+ * @brief Device records of the connections: the connection handle map and the address
+ * hash table checked against a linear search across random connections and
+ * disconnections, and the lookups per second of both against the linear search
+ *
+ * The test is built for 1, 4 and 8 connections (HOST_CFG_CON).
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+#include "host.h"
+
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b);
+
+#undef co_bt_bdaddr_compare
+#define co_bt_bdaddr_compare host_bdaddr_compare
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_util.c"
+
+/// Peer addresses, more than the connections
+#define PEER_NB                 64
+/// Connections and disconnections of the model check
+#define STEP_NB                 20000
+/// Lookups of the benchmark
+#define BENCH_NB                20000000
+
+struct app_env_tag app_env;
+
+static struct bd_addr sim_peer[PEER_NB];
+/// Peer of each connection handle, -1 when not connected
+static int sim_conn[BLE_CONNECTION_MAX];
+
+__attribute__((noinline)) static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b)
+{
+    return memcmp(a->addr, b->addr, BD_ADDR_LEN) == 0;
+}
+
+/// Linear search of the connection handle, the lookup before the map
+static uint8_t sim_linear_rec_idx(uint16_t conhdl)
+{
+    for (uint8_t i = 0; i < BLE_CONNECTION_MAX; i++)
+    {
+        if (app_env.dev_rec[i].conhdl == conhdl)
+            return i;
+    }
+    return GAP_INVALID_CONIDX;
+}
+
+/// Linear search of the address, the lookup before the hash table
+static uint16_t sim_linear_conhdl(struct bd_addr const *addr, uint8_t *idx)
+{
+    for (uint8_t i = 0; i < BLE_CONNECTION_MAX; i++)
+    {
+        if (!app_env.dev_rec[i].free && host_bdaddr_compare(addr, &app_env.dev_rec[i].bonded_info.peer_addr))
+        {
+            *idx = i;
+            return app_env.dev_rec[i].conhdl;
+        }
+    }
+    *idx = GAP_INVALID_CONIDX;
+    return 0xFFFF;
+}
+
+static void sim_init(void)
+{
+    int i, k;
+
+    memset(&app_env, 0, sizeof(app_env));
+    for (i = 0; i < BLE_CONNECTION_MAX; i++)
+    {
+        app_env.dev_rec[i].free = true;
+        app_env.dev_rec[i].conhdl = 0xFFFF;
+        sim_conn[i] = -1;
+    }
+    srand(49);
+    for (i = 0; i < PEER_NB; i++)
+    {
+        for (k = 0; k < BD_ADDR_LEN; k++)
+            sim_peer[i].addr[k] = (uint8_t)rand();
+    }
+}
+
+/// Connect a peer which is not connected on a handle
+static void sim_connect(uint16_t conhdl)
+{
+    struct gap_link_info info;
+    int p, i;
+
+    do {
+        p = rand() % PEER_NB;
+        for (i = 0; (i < BLE_CONNECTION_MAX) && (sim_conn[i] != p); i++)
+            ;
+    } while (i < BLE_CONNECTION_MAX);
+
+    memset(&info, 0, sizeof(info));
+    info.peer_addr = sim_peer[p];
+    app_set_link_status_by_conhdl(conhdl, &info, true);
+    sim_conn[conhdl] = p;
+}
+
+static void test_model(void)
+{
+    int fail_nb = host_fail_nb;
+    int step, nb = 0, p;
+    uint16_t conhdl;
+    uint8_t idx, ref_idx;
+
+    sim_init();
+    for (step = 0; (step < STEP_NB) && (host_fail_nb == fail_nb); step++)
+    {
+        conhdl = rand() % BLE_CONNECTION_MAX;
+        if (sim_conn[conhdl] < 0)
+        {
+            sim_connect(conhdl);
+            app_set_client_service_status(app_get_rec_idx_by_conhdl(conhdl), 1u << (rand() % 16), true);
+            nb++;
+        }
+        else
+        {
+            idx = app_get_rec_idx_by_conhdl(conhdl);
+            app_set_link_status_by_conhdl(conhdl, NULL, false);
+            CHECK(app_env.dev_rec[idx].free && app_env.dev_rec[idx].client_flag == 0);
+            sim_conn[conhdl] = -1;
+            nb--;
+        }
+        CHECK(app_env.cn_count == nb);
+
+        // the handles, one out of the map, and 0xFFFF which finds a free record
+        for (conhdl = 0; conhdl < BLE_CONNECTION_MAX + 2; conhdl++)
+            CHECK(app_get_rec_idx_by_conhdl(conhdl) == sim_linear_rec_idx(conhdl));
+        CHECK(app_get_rec_idx_by_conhdl(0xFFFF) == sim_linear_rec_idx(0xFFFF));
+        for (p = 0; p < PEER_NB; p++)
+        {
+            CHECK(app_get_conhdl_by_bdaddr(&sim_peer[p], &idx) == sim_linear_conhdl(&sim_peer[p], &ref_idx));
+            CHECK(idx == ref_idx);
+        }
+    }
+    if (host_fail_nb != fail_nb)
+        printf("model: failed at step %d\n", step - 1);
+}
+
+/// Lookups per second of all the connections, against the linear search
+static void bench_lookup(void)
+{
+    volatile uint32_t sink = 0;
+    uint64_t t_lin, t_map, t_lin_addr, t_hash;
+    uint16_t conhdl;
+    uint8_t idx;
+    int i;
+
+    for (conhdl = 0; conhdl < BLE_CONNECTION_MAX; conhdl++)
+    {
+        if (sim_conn[conhdl] < 0)
+            sim_connect(conhdl);
+    }
+
+    t_lin = host_ns();
+    for (i = 0; i < BENCH_NB; i++)
+        sink += sim_linear_rec_idx(i % BLE_CONNECTION_MAX);
+    t_lin = host_ns() - t_lin;
+
+    t_map = host_ns();
+    for (i = 0; i < BENCH_NB; i++)
+        sink += app_get_rec_idx_by_conhdl(i % BLE_CONNECTION_MAX);
+    t_map = host_ns() - t_map;
+
+    t_lin_addr = host_ns();
+    for (i = 0; i < BENCH_NB; i++)
+        sink += sim_linear_conhdl(&sim_peer[sim_conn[i % BLE_CONNECTION_MAX]], &idx);
+    t_lin_addr = host_ns() - t_lin_addr;
+
+    t_hash = host_ns();
+    for (i = 0; i < BENCH_NB; i++)
+        sink += app_get_conhdl_by_bdaddr(&sim_peer[sim_conn[i % BLE_CONNECTION_MAX]], &idx);
+    t_hash = host_ns() - t_hash;
+
+    printf("%d connections: handle lookups/s linear %.0fM, map %.0fM; "
+           "address lookups/s linear %.0fM, hash %.0fM\n", BLE_CONNECTION_MAX,
+           BENCH_NB * 1e3 / t_lin, BENCH_NB * 1e3 / t_map,
+           BENCH_NB * 1e3 / t_lin_addr, BENCH_NB * 1e3 / t_hash);
+}
+
+int main(void)
+{
+    test_model();
+    bench_lookup();
+    return host_result("test_rec");
+}
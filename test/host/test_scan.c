@@ -0,0 +1,294 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_scan.c
+ *
+ * @brief Beacon scanner table: random reports and age-outs checked against a reference
+ * list of the devices, the clusters wrapping at the end of the table, the 3/4 fill limit,
+ * and the removals per second of the backward shift deletion with the mean probe length
+ * of the lookups after them
+ *
+ * The reports are given to app_scan_report() and the age-out runs in the summary timer
+ * handler. The kernel time, the timers and the GAP scan requests are stubs.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "app_env.h"
+
+static void host_ke_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task, uint16_t const delay);
+static void host_ke_timer_clear(ke_msg_id_t const timer_id, ke_task_id_t const task);
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b);
+
+#undef _ke_timer_set
+#undef _ke_timer_clear
+#undef co_bt_bdaddr_compare
+#define _ke_timer_set           host_ke_timer_set
+#define _ke_timer_clear         host_ke_timer_clear
+#define co_bt_bdaddr_compare    host_bdaddr_compare
+#undef QPRINTF
+#define QPRINTF(...)
+
+#include "app_util.c"
+#include "app_scan.c"
+#include "host.h"
+
+/// Addresses of the model check, more than the table holds
+#define PEER_NB                 (APP_SCAN_TABLE_SIZE * 2)
+/// Reports of the model check
+#define STEP_NB                 200000
+/// Removals of the benchmark
+#define BENCH_NB                2000000
+
+struct app_env_tag app_env;
+
+static struct bd_addr sim_peer[PEER_NB];
+/// Reference list: kernel time of the last report of each address, 0 when not in the table
+static uint32_t sim_seen[PEER_NB];
+static int sim_nb;
+
+static void host_ke_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task, uint16_t const delay)
+{
+    CHECK(timer_id == APP_SCAN_REPORT_TIMER && delay == APP_SCAN_REPORT_TIME);
+}
+
+static void host_ke_timer_clear(ke_msg_id_t const timer_id, ke_task_id_t const task)
+{
+}
+
+static bool host_bdaddr_compare(struct bd_addr const *a, struct bd_addr const *b)
+{
+    return memcmp(a->addr, b->addr, BD_ADDR_LEN) == 0;
+}
+
+int8_t app_correct_rssi(int8_t rssi)
+{
+    return rssi;
+}
+
+void app_gap_set_scan_mode_req(uint8_t mode, uint16_t interval, uint16_t window)
+{
+}
+
+void app_gap_scan_req(uint8_t flag)
+{
+}
+
+/// Random address, or an address of a home slot when home is not -1
+static void sim_addr(struct bd_addr *addr, int home)
+{
+    int k;
+
+    do {
+        for (k = 0; k < BD_ADDR_LEN; k++)
+            addr->addr[k] = (uint8_t)rand();
+    } while ((home >= 0) && (app_scan_hash(addr) != home));
+}
+
+static void sim_report(struct bd_addr const *addr)
+{
+    struct adv_report rep;
+
+    memset(&rep, 0, sizeof(rep));
+    rep.adv_addr = *addr;
+    rep.adv_addr_type = ADDR_RAND;
+    rep.rssi = -60;
+    app_scan_report(&rep);
+}
+
+static void sim_start(void)
+{
+    host_ke_time = 1000;
+    app_scan_start();
+    memset(sim_seen, 0, sizeof(sim_seen));
+    sim_nb = 0;
+}
+
+/// The table holds the devices of the reference list, each one reached from its home slot
+static void sim_check(void)
+{
+    uint16_t i;
+    uint8_t home;
+    int p, nb = 0;
+
+    CHECK(app_scan_env.dev_nb == sim_nb);
+    for (p = 0; p < PEER_NB; p++) {
+        home = app_scan_find(&sim_peer[p]);
+        CHECK((app_scan_env.dev[home].addr_type != APP_SCAN_EMPTY) == (sim_seen[p] != 0));
+        if (sim_seen[p] != 0)
+            CHECK(app_scan_env.dev[home].last_seen == sim_seen[p]);
+    }
+    for (i = 0; i < APP_SCAN_TABLE_SIZE; i++) {
+        if (app_scan_env.dev[i].addr_type != APP_SCAN_EMPTY) {
+            nb++;
+            // no empty slot between the home slot and the device
+            for (home = app_scan_hash(&app_scan_env.dev[i].addr); home != i;
+                 home = (home + 1) & (APP_SCAN_TABLE_SIZE - 1))
+                CHECK(app_scan_env.dev[home].addr_type != APP_SCAN_EMPTY);
+        }
+    }
+    CHECK(nb == sim_nb);
+}
+
+/// Random reports and summaries against the reference list
+static void test_model(void)
+{
+    int fail_nb = host_fail_nb;
+    int step, p, full_nb = 0;
+
+    srand(47);
+    for (p = 0; p < PEER_NB; p++)
+        sim_addr(&sim_peer[p], -1);
+    sim_start();
+
+    for (step = 0; (step < STEP_NB) && (host_fail_nb == fail_nb); step++) {
+        // a few addresses are seen often, the others come and go
+        p = (rand() & 3) ? rand() % (PEER_NB / 8) : rand() % PEER_NB;
+        sim_report(&sim_peer[p]);
+        if (sim_seen[p] != 0) {
+            sim_seen[p] = host_ke_time;
+        } else if (sim_nb < APP_SCAN_DEV_MAX) {
+            sim_seen[p] = host_ke_time;
+            sim_nb++;
+        } else {
+            full_nb++;
+        }
+        CHECK(app_scan_env.stat.full_nb == full_nb);
+
+        host_ke_time += rand() % 8;
+        if (step % 500 == 499) {
+            app_scan_report_timer_handler(APP_SCAN_REPORT_TIMER, NULL, TASK_APP, TASK_APP);
+            full_nb = 0;
+            for (p = 0; p < PEER_NB; p++) {
+                if ((sim_seen[p] != 0)
+                    && (((host_ke_time - sim_seen[p]) & APP_SCAN_TIME_MASK) > APP_SCAN_AGE_TIME)) {
+                    sim_seen[p] = 0;
+                    sim_nb--;
+                }
+            }
+        }
+        if (step % 97 == 0)
+            sim_check();
+    }
+    if (host_fail_nb != fail_nb)
+        printf("model: failed at step %d\n", step - 1);
+    app_scan_stop();
+}
+
+/// A cluster wrapping at the end of the table is moved back across the wrap
+static void test_wrap(void)
+{
+    struct bd_addr addr[4];
+    uint8_t last = APP_SCAN_TABLE_SIZE - 1;
+    int k;
+
+    sim_start();
+    // two devices of the last slot, one of the slot before, one of slot 0
+    sim_addr(&addr[0], last);
+    sim_addr(&addr[1], last - 1);
+    sim_addr(&addr[2], last);
+    sim_addr(&addr[3], 0);
+    for (k = 0; k < 4; k++)
+        sim_report(&addr[k]);
+    CHECK(app_scan_find(&addr[0]) == last && app_scan_find(&addr[1]) == last - 1);
+    CHECK(app_scan_find(&addr[2]) == 0 && app_scan_find(&addr[3]) == 1);
+
+    // removing the first of the last slot moves its follower back across the wrap, the
+    // device of slot 0 goes home
+    app_scan_remove(last);
+    CHECK(app_scan_env.dev_nb == 3);
+    CHECK(app_scan_find(&addr[2]) == last && app_scan_find(&addr[3]) == 0);
+    CHECK(app_scan_env.dev[1].addr_type == APP_SCAN_EMPTY);
+    CHECK(app_scan_find(&addr[1]) == last - 1);
+    CHECK(app_scan_env.dev[app_scan_find(&addr[0])].addr_type == APP_SCAN_EMPTY);
+
+    // the device of slot 0 stays in its home slot
+    app_scan_remove(last);
+    CHECK(app_scan_env.dev_nb == 2 && app_scan_find(&addr[1]) == last - 1);
+    CHECK(app_scan_find(&addr[3]) == 0);
+    app_scan_stop();
+}
+
+/// A new device is not added when the table is 3/4 full, a known device is updated
+static void test_full(void)
+{
+    struct bd_addr addr;
+    int k;
+
+    sim_start();
+    for (k = 0; k < APP_SCAN_DEV_MAX; k++) {
+        sim_addr(&sim_peer[k], -1);
+        sim_report(&sim_peer[k]);
+    }
+    CHECK(app_scan_env.dev_nb == APP_SCAN_DEV_MAX && app_scan_env.stat.full_nb == 0);
+
+    sim_addr(&addr, -1);
+    sim_report(&addr);
+    CHECK(app_scan_env.dev_nb == APP_SCAN_DEV_MAX && app_scan_env.stat.full_nb == 1);
+    CHECK(app_scan_env.dev[app_scan_find(&addr)].addr_type == APP_SCAN_EMPTY);
+
+    sim_report(&sim_peer[0]);
+    CHECK(app_scan_env.dev[app_scan_find(&sim_peer[0])].rpt_nb == 2);
+    CHECK(app_scan_env.stat.full_nb == 1);
+    app_scan_stop();
+}
+
+/// Mean probe length of the lookups of the devices in the table
+static double sim_probe_len(void)
+{
+    uint32_t len = 0;
+    uint16_t i;
+
+    for (i = 0; i < APP_SCAN_TABLE_SIZE; i++) {
+        if (app_scan_env.dev[i].addr_type != APP_SCAN_EMPTY)
+            len += ((i - app_scan_hash(&app_scan_env.dev[i].addr)) & (APP_SCAN_TABLE_SIZE - 1)) + 1;
+    }
+    return (double)len / app_scan_env.dev_nb;
+}
+
+/// Removals per second in a table kept 3/4 full, a new device replaces each removed one
+static void bench_remove(void)
+{
+    struct bd_addr addr;
+    double probe_start;
+    uint64_t t = 0, t0;
+    uint8_t i;
+    int n;
+
+    srand(48);
+    sim_start();
+    while (app_scan_env.dev_nb < APP_SCAN_DEV_MAX) {
+        sim_addr(&addr, -1);
+        sim_report(&addr);
+    }
+    probe_start = sim_probe_len();
+
+    for (n = 0; n < BENCH_NB; n++) {
+        do {
+            i = rand() & (APP_SCAN_TABLE_SIZE - 1);
+        } while (app_scan_env.dev[i].addr_type == APP_SCAN_EMPTY);
+        t0 = host_ns();
+        app_scan_remove(i);
+        t += host_ns() - t0;
+
+        sim_addr(&addr, -1);
+        sim_report(&addr);
+    }
+    CHECK(app_scan_env.dev_nb == APP_SCAN_DEV_MAX);
+
+    // without tombstones the probe length is the one of the devices in the table, about 2.5
+    // for linear probing at 3/4 load
+    printf("%d slots 3/4 full: %.0fM removals/s, mean probe length %.2f before, %.2f after %dM removals\n",
+           APP_SCAN_TABLE_SIZE, BENCH_NB * 1e3 / t, probe_start, sim_probe_len(), BENCH_NB / 1000000);
+    app_scan_stop();
+}
+
+int main(void)
+{
+    test_model();
+    test_wrap();
+    test_full();
+    bench_remove();
+    return host_result("test_scan");
+}
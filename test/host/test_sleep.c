@@ -0,0 +1,228 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_sleep.c
+ *
+ * @brief Sleep mode check on a kernel timer model: the mode usr_sleep() returns with the
+ * kernel timers, the BLE events and the 32K clock users, and the refusal reasons counted
+ *
+ * The kernel timer functions of the chip ROM are a list of pending timers, the kernel
+ * time is moved by the test. The system controller registers are a RAM model behind the
+ * register access functions of the ROM, the 32K XTAL is ready.
+ *
+ ****************************************************************************************
+ */
+
+#include <string.h>
+#include "sleep.h"
+#include "lib.h"
+#include "ke_timer.h"
+#include "uart.h"
+
+static void host_ke_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task, uint16_t const delay);
+static void host_ke_timer_clear(ke_msg_id_t const timer_id, ke_task_id_t const task);
+static bool host_ke_timer_empty(void);
+
+#undef _ke_timer_set
+#undef _ke_timer_clear
+#undef ke_timer_empty
+#define _ke_timer_set           host_ke_timer_set
+#define _ke_timer_clear         host_ke_timer_clear
+#define ke_timer_empty          host_ke_timer_empty
+
+#include "sleep.c"
+#include "host.h"
+
+#define TEST_TASK               TASK_APP
+#define TEST_TIMER              KE_FIRST_MSG(TASK_APP)
+#define TEST_TIMER_2            KE_FIRST_MSG(TASK_APP) + 1
+#define TEST_TIMER_ROM          KE_FIRST_MSG(TASK_GAP)
+#define TEST_TIMER_NB           8
+
+/// Peripheral registers
+static uint32_t apb_reg[0x10000 / 4];
+/// Pending kernel timers
+static struct
+{
+    ke_msg_id_t id;
+    ke_task_id_t task;
+    uint32_t expiry;
+} sim_timer[TEST_TIMER_NB];
+/// BLE events pending
+static bool sim_ble_evt;
+
+uint32_t __rd_reg(uint32_t addr)
+{
+    if (addr < QN_APB_BASE || addr >= QN_APB_BASE + sizeof(apb_reg)) {
+        printf("register 0x%08x not modelled\n", addr);
+        abort();
+    }
+    return apb_reg[(addr - QN_APB_BASE) / 4];
+}
+
+void __wr_reg(uint32_t addr, uint32_t val)
+{
+    __rd_reg(addr);
+    apb_reg[(addr - QN_APB_BASE) / 4] = val;
+}
+
+void __wr_reg_with_msk(uint32_t addr, uint32_t msk, uint32_t val)
+{
+    __wr_reg(addr, (__rd_reg(addr) & ~msk) | (msk & val));
+}
+
+bool ble_evt_empty(void)
+{
+    return !sim_ble_evt;
+}
+
+bool gpio_sleep_allowed(void)
+{
+    return true;
+}
+
+int uart_check_tx_free(QN_UART_TypeDef *UART)
+{
+    return UART_TX_FREE;
+}
+
+static void sim_timer_add(ke_msg_id_t const timer_id, ke_task_id_t const task, uint32_t expiry)
+{
+    int i, free = -1;
+
+    for (i = 0; i < TEST_TIMER_NB; i++) {
+        if (sim_timer[i].id == timer_id && sim_timer[i].task == task) {
+            free = i;
+            break;
+        }
+        if (sim_timer[i].id == 0 && free < 0) {
+            free = i;
+        }
+    }
+    CHECK(free >= 0);
+    sim_timer[free].id = timer_id;
+    sim_timer[free].task = task;
+    sim_timer[free].expiry = expiry;
+}
+
+static void host_ke_timer_set(ke_msg_id_t const timer_id, ke_task_id_t const task, uint16_t const delay)
+{
+    sim_timer_add(timer_id, task, host_ke_time + delay);
+}
+
+static void host_ke_timer_clear(ke_msg_id_t const timer_id, ke_task_id_t const task)
+{
+    int i;
+
+    for (i = 0; i < TEST_TIMER_NB; i++) {
+        if (sim_timer[i].id == timer_id && sim_timer[i].task == task) {
+            sim_timer[i].id = 0;
+        }
+    }
+}
+
+static bool host_ke_timer_empty(void)
+{
+    int i;
+
+    for (i = 0; i < TEST_TIMER_NB; i++) {
+        if (sim_timer[i].id != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Move the kernel time, the expired timers leave the queue
+static void sim_time(uint32_t ticks)
+{
+    int i;
+
+    host_ke_time = (host_ke_time + ticks) & SLEEP_STAT_TIME_MASK;
+    for (i = 0; i < TEST_TIMER_NB; i++) {
+        if (sim_timer[i].id != 0
+            && ((host_ke_time - sim_timer[i].expiry) & SLEEP_STAT_TIME_MASK) <= KE_TIMER_DELAY_MAX) {
+            sim_timer[i].id = 0;
+        }
+    }
+}
+
+static void sim_init(void)
+{
+    memset(apb_reg, 0, sizeof(apb_reg));
+    apb_reg[((uint32_t)(uintptr_t)&QN_SYSCON->BLESR - QN_APB_BASE) / 4] = SYSCON_MASK_CLK_XTAL32_RDY;
+    memset(sim_timer, 0, sizeof(sim_timer));
+    memset(&sleep_env, 0, sizeof(sleep_env));
+    sim_ble_evt = false;
+    host_ke_time = 1000;
+    sleep_stat_reset();
+}
+
+/// The mode of usr_sleep() from the kernel timers and the reasons counted
+static void test_usr_sleep(void)
+{
+    sim_init();
+    sleep_set_pm(PM_DEEP_SLEEP);
+    CHECK(usr_sleep() == PM_DEEP_SLEEP);
+
+    // any timer refuses the deep sleep, however far
+    ke_timer_set(TEST_TIMER, TEST_TASK, 6000);
+    CHECK(usr_sleep() == PM_SLEEP);
+    CHECK(sleep_stat.refuse[SLEEP_REFUSE_KE_TIMER] == 1);
+    ke_timer_set(TEST_TIMER_2, TEST_TASK, 1);
+    CHECK(usr_sleep() == PM_SLEEP);
+    sim_time(1);
+    CHECK(usr_sleep() == PM_SLEEP);
+    ke_timer_clear(TEST_TIMER, TEST_TASK);
+    CHECK(usr_sleep() == PM_DEEP_SLEEP);
+    CHECK(sleep_stat.refuse[SLEEP_REFUSE_KE_TIMER] == 3);
+
+    // a timer of the ROM stack
+    host_ke_timer_set(TEST_TIMER_ROM, TASK_GAP, 1);
+    CHECK(usr_sleep() == PM_SLEEP);
+    sim_time(1);
+    CHECK(usr_sleep() == PM_DEEP_SLEEP);
+
+    // a BLE event
+    sim_ble_evt = true;
+    CHECK(usr_sleep() == PM_SLEEP);
+    sim_ble_evt = false;
+
+    // a sleep is not refused by a timer
+    sleep_set_pm(PM_SLEEP);
+    ke_timer_set(TEST_TIMER, TEST_TASK, 1);
+    CHECK(usr_sleep() == PM_SLEEP);
+    CHECK(sleep_stat.refuse[SLEEP_REFUSE_KE_TIMER] == 5);
+}
+
+/// A user of the 32K clock holds it, deep sleep only
+static void test_32k_clock(void)
+{
+    sim_init();
+    sleep_set_pm(PM_DEEP_SLEEP);
+    clk32k_prevent_deep_sleep(CLK32K_MASK_BLE_TIME_BIT);
+    CHECK(usr_sleep() == PM_SLEEP);
+    CHECK(sleep_stat.refuse[SLEEP_REFUSE_32K_CLK] == 1);
+
+    // a sleep is not refused by it
+    sleep_set_pm(PM_SLEEP);
+    CHECK(usr_sleep() == PM_SLEEP);
+    CHECK(sleep_stat.refuse[SLEEP_REFUSE_32K_CLK] == 1);
+
+    // the timer refuses the deep sleep first
+    sleep_set_pm(PM_DEEP_SLEEP);
+    ke_timer_set(TEST_TIMER, TEST_TASK, 1);
+    CHECK(usr_sleep() == PM_SLEEP);
+    CHECK(sleep_stat.refuse[SLEEP_REFUSE_32K_CLK] == 1);
+    ke_timer_clear(TEST_TIMER, TEST_TASK);
+
+    clk32k_allow_deep_sleep(CLK32K_MASK_BLE_TIME_BIT);
+    CHECK(usr_sleep() == PM_DEEP_SLEEP);
+}
+
+int main(void)
+{
+    test_usr_sleep();
+    test_32k_clock();
+    return host_result("test_sleep");
+}
@@ -0,0 +1,353 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_store.c
+ *
+ * @brief Record store on a RAM flash model: random writes and deletes against a model with
+ * remounts, power loss at every flash operation, garbage collection recovery, and the
+ * throughput and write amplification of the log
+ *
+ ****************************************************************************************
+ */
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <string.h>
+
+static void sim_read(uint32_t addr, uint32_t *buf, uint32_t len);
+static void sim_write(uint32_t addr, const uint32_t *buf, uint32_t len);
+static void sim_erase(uint32_t addr);
+
+#define APP_STORE_FLASH_READ(addr, buf, len)    sim_read(addr, buf, len)
+#define APP_STORE_FLASH_WRITE(addr, buf, len)   sim_write(addr, buf, len)
+#define APP_STORE_FLASH_ERASE(addr)             sim_erase(addr)
+
+#include "app_store.c"
+#include "host.h"
+
+#define SIM_SIZE        (QN_REC_STORE_BASE_ADDR + QN_REC_STORE_SECTOR_NUM * APP_STORE_SECTOR_SIZE)
+#define ID_NB           60
+#define LEN_MAX         60
+
+static uint8_t sim_flash[SIM_SIZE];
+/// Flash operations before the simulated power loss, 0 for none
+static int sim_fail_after;
+static jmp_buf sim_reset;
+
+/// Model of the store content, len 0 means not present
+static uint8_t model[ID_NB][LEN_MAX];
+static uint8_t model_len[ID_NB];
+
+static void sim_tick(void)
+{
+    if (sim_fail_after > 0 && --sim_fail_after == 0) {
+        longjmp(sim_reset, 1);
+    }
+}
+
+static void sim_read(uint32_t addr, uint32_t *buf, uint32_t len)
+{
+    memcpy(buf, sim_flash + addr, len);
+}
+
+static void sim_write(uint32_t addr, const uint32_t *buf, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)buf;
+    uint32_t i;
+
+    // Whole pages only, programming can only clear bits
+    CHECK(addr % APP_STORE_PAGE_SIZE == 0 && len == APP_STORE_PAGE_SIZE);
+    sim_tick();
+    for (i = 0; i < len; i++) {
+        sim_flash[addr + i] &= src[i];
+    }
+}
+
+static void sim_erase(uint32_t addr)
+{
+    CHECK(addr % APP_STORE_SECTOR_SIZE == 0);
+    sim_tick();
+    memset(sim_flash + addr, 0xFF, APP_STORE_SECTOR_SIZE);
+}
+
+static uint8_t random_data(uint8_t *data)
+{
+    uint8_t len = 1 + rand() % LEN_MAX;
+    uint8_t i;
+
+    for (i = 0; i < len; i++) {
+        data[i] = rand();
+    }
+    return len;
+}
+
+/// Count the records that differ from the model
+static int model_diff(void)
+{
+    uint8_t data[APP_STORE_MAX_DATA_LEN];
+    uint8_t len;
+    int id, bad = 0;
+
+    for (id = 0; id < ID_NB; id++) {
+        len = sizeof(data);
+        if (app_store_read(id, data, &len) != APP_STORE_OK) {
+            bad += model_len[id] != 0;
+        } else {
+            bad += len != model_len[id] || memcmp(data, model[id], len);
+        }
+    }
+    return bad;
+}
+
+/// Adopt the store content after a power loss, each record shall be its old or new value
+static int model_adopt(uint8_t (*old)[LEN_MAX], const uint8_t *old_len)
+{
+    uint8_t data[APP_STORE_MAX_DATA_LEN];
+    uint8_t len;
+    int id, bad = 0;
+
+    for (id = 0; id < ID_NB; id++) {
+        len = sizeof(data);
+        if (app_store_read(id, data, &len) != APP_STORE_OK) {
+            len = 0;
+        }
+        if ((len != old_len[id] || memcmp(data, old[id], len))
+            && (len != model_len[id] || memcmp(data, model[id], len))) {
+            bad++;
+        }
+        memcpy(model[id], data, len);
+        model_len[id] = len;
+    }
+    return bad;
+}
+
+static int free_sector_nb(void)
+{
+    int n, nb = 0;
+
+    for (n = 0; n < QN_REC_STORE_SECTOR_NUM; n++) {
+        nb += app_store_env.sector_seq[n] == 0;
+    }
+    return nb;
+}
+
+static void store_format(void)
+{
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    memset(model_len, 0, sizeof(model_len));
+    app_store_init();
+}
+
+static void test_random(void)
+{
+    uint8_t data[LEN_MAX];
+    uint8_t len, st;
+    int it, id;
+
+    store_format();
+    srand(7);
+    for (it = 0; it < 20000; it++) {
+        id = rand() % ID_NB;
+        if (rand() % 5 == 0) {
+            st = app_store_delete(id);
+            CHECK(st == (model_len[id] ? APP_STORE_OK : APP_STORE_NOT_FOUND));
+            model_len[id] = 0;
+        } else {
+            len = random_data(data);
+            st = app_store_write(id, data, len);
+            CHECK(st == APP_STORE_OK || st == APP_STORE_NO_SPACE || st == APP_STORE_INDEX_FULL);
+            if (st == APP_STORE_OK) {
+                memcpy(model[id], data, len);
+                model_len[id] = len;
+            }
+        }
+
+        if (it % 1000 == 999) {
+            app_store_flush();
+            app_store_init();
+        }
+        if (it % 97 == 0) {
+            CHECK(model_diff() == 0);
+            CHECK(free_sector_nb() >= 1);
+        }
+    }
+    CHECK(model_diff() == 0);
+}
+
+/// Cut the power at a random flash operation, the store shall mount with each record
+/// either before or after the interrupted write
+static void test_power_loss(void)
+{
+    static uint8_t old[ID_NB][LEN_MAX];
+    static uint8_t old_len[ID_NB];
+    uint8_t data[LEN_MAX];
+    uint8_t len;
+    int round, k, id, resets = 0;
+
+    store_format();
+    srand(11);
+    for (round = 0; round < 3000; round++) {
+        memcpy(old, model, sizeof(old));
+        memcpy(old_len, model_len, sizeof(old_len));
+        sim_fail_after = 1 + rand() % 20;
+        if (setjmp(sim_reset) == 0) {
+            for (k = 0; k < 40; k++) {
+                id = rand() % ID_NB;
+                len = random_data(data);
+                if (app_store_write(id, data, len) == APP_STORE_OK) {
+                    memcpy(model[id], data, len);
+                    model_len[id] = len;
+                }
+                app_store_flush();
+                memcpy(old, model, sizeof(old));
+                memcpy(old_len, model_len, sizeof(old_len));
+            }
+            sim_fail_after = 0;
+        } else {
+            resets++;
+            sim_fail_after = 0;
+            app_store_init();
+            CHECK(model_adopt(old, old_len) == 0);
+            CHECK(free_sector_nb() >= 1);
+        }
+    }
+    CHECK(resets > 1000);
+}
+
+/// Sector with the highest sequence number in flash, the head of the log
+static uint8_t flash_head(int *used_nb)
+{
+    uint32_t const *hdr;
+    uint32_t seq = 0;
+    uint8_t n, head = 0;
+
+    *used_nb = 0;
+    for (n = 0; n < QN_REC_STORE_SECTOR_NUM; n++) {
+        hdr = (uint32_t const *)(sim_flash + QN_REC_STORE_BASE_ADDR + n * APP_STORE_SECTOR_SIZE);
+        if (hdr[0] == APP_STORE_MAGIC) {
+            (*used_nb)++;
+            if (hdr[1] > seq) {
+                seq = hdr[1];
+                head = n;
+            }
+        }
+    }
+    return head;
+}
+
+/// A collection interrupted by a reset is rolled back when the rest of the copies does not
+/// fit in the head sector anymore: no record is lost and a sector is free again
+static void test_gc_rollback(void)
+{
+    static uint8_t old[ID_NB][LEN_MAX];
+    static uint8_t old_len[ID_NB];
+    uint8_t *page;
+    uint8_t data[LEN_MAX];
+    uint32_t addr;
+    uint8_t len, head = 0;
+    int k, id, used_nb, rollbacks = 0;
+
+    store_format();
+    srand(13);
+    while (rollbacks < 20) {
+        memcpy(old, model, sizeof(old));
+        memcpy(old_len, model_len, sizeof(old_len));
+        sim_fail_after = 1 + rand() % 20;
+        if (setjmp(sim_reset) == 0) {
+            for (k = 0; k < 40; k++) {
+                id = rand() % ID_NB;
+                len = random_data(data);
+                if (app_store_write(id, data, len) == APP_STORE_OK) {
+                    memcpy(model[id], data, len);
+                    model_len[id] = len;
+                }
+                app_store_flush();
+                memcpy(old, model, sizeof(old));
+                memcpy(old_len, model_len, sizeof(old_len));
+            }
+            continue;
+        }
+        sim_fail_after = 0;
+
+        // All sectors used: the collection was interrupted before its erase. Fill the rest
+        // of the head sector with deletions of an unknown record, they take the room of
+        // the copies still to do without changing the content.
+        head = flash_head(&used_nb);
+        if (used_nb == QN_REC_STORE_SECTOR_NUM) {
+            for (addr = APP_STORE_PAGE_ADDR(head * APP_STORE_SECTOR_PAGES);
+                 addr < APP_STORE_PAGE_ADDR((head + 1) * APP_STORE_SECTOR_PAGES);
+                 addr += APP_STORE_PAGE_SIZE) {
+                page = sim_flash + addr;
+                if (*(uint32_t *)page == APP_STORE_ERASED) {
+                    page[0] = 0xFE;
+                    page[1] = 0xFF;
+                    page[2] = 0;
+                    page[3] = app_store_chk(0xFFFE, 0, NULL);
+                }
+            }
+        }
+
+        app_store_init();
+        CHECK(model_adopt(old, old_len) == 0);
+        CHECK(free_sector_nb() >= 1);
+        if (used_nb == QN_REC_STORE_SECTOR_NUM && app_store_env.sector_seq[head] == 0) {
+            rollbacks++;
+
+            // The collection starts over at the next write
+            for (id = rand() % ID_NB; model_len[id] == 0; id = (id + 1) % ID_NB) {
+            }
+            len = random_data(data);
+            CHECK(app_store_write(id, data, len) == APP_STORE_OK);
+            memcpy(model[id], data, len);
+            model_len[id] = len;
+            app_store_flush();
+            app_store_init();
+            CHECK(model_diff() == 0);
+        }
+    }
+}
+
+/// Write throughput and write amplification of the log at different fill levels
+static void bench(void)
+{
+    const struct app_store_stat *stat;
+    uint8_t data[APP_STORE_MAX_DATA_LEN];
+    uint16_t ids[] = {8, 16, QN_REC_STORE_MAX_RECORDS};
+    uint8_t lens[] = {16, 64, 120};
+    uint64_t t0, t1;
+    uint32_t live;
+    int i, j, n, nb = 20000;
+
+    memset(data, 0x5A, sizeof(data));
+    printf("ids  len  live%%  us/write  WA    erases/kB  gc copies/write\n");
+    for (i = 0; i < (int)(sizeof(ids) / sizeof(ids[0])); i++) {
+        for (j = 0; j < (int)sizeof(lens); j++) {
+            live = ids[i] * APP_STORE_REC_SIZE(lens[j]);
+            if (live > APP_STORE_LIVE_MAX) {
+                continue;
+            }
+            store_format();
+            srand(3);
+            t0 = host_ns();
+            for (n = 0; n < nb; n++) {
+                CHECK(app_store_write(rand() % ids[i], data, lens[j]) == APP_STORE_OK);
+            }
+            app_store_flush();
+            t1 = host_ns();
+            stat = app_store_get_stat();
+            printf("%3d  %3d  %5d  %8.3f  %5.2f  %9.3f  %15.3f\n", ids[i], lens[j],
+                   (int)(live * 100 / APP_STORE_LIVE_MAX), (t1 - t0) / 1000.0 / nb,
+                   (double)stat->page_writes * APP_STORE_PAGE_SIZE / stat->user_bytes,
+                   stat->sector_erases * 1024.0 / stat->user_bytes, (double)stat->gc_copies / nb);
+        }
+    }
+}
+
+int main(void)
+{
+    test_random();
+    test_power_loss();
+    test_gc_rollback();
+    bench();
+    return host_result("test_store");
+}
@@ -0,0 +1,240 @@
+/**
+ ****************************************************************************************
+ *
+ * @file test_timer.c
+ *
+ * @brief Timer wheel on a Timer1 model: hundreds of one-shot and periodic timers started,
+ * restarted and stopped at random against their deadlines across the counter wrap, the
+ * release of Timer1 when the wheel is empty, and the cost of start, stop and expiry
+ *
+ * The registers are a RAM model behind the register access functions of the chip ROM.
+ * Timer1 counts in micro seconds and raises the compare interrupt when the counter
+ * reaches the compare register.
+ *
+ ****************************************************************************************
+ */
+
+#include <sys/mman.h>
+#include "timer.c"
+#include "host.h"
+
+#define TMR_NB          256
+
+/// Peripheral registers
+static uint32_t apb_reg[0x10000 / 4];
+/// Timer1 counter
+static uint32_t sim_cnt;
+
+struct sleep_env_tag sleep_env;
+
+uint32_t __rd_reg(uint32_t addr)
+{
+    if (addr == (uint32_t)(uintptr_t)&QN_TIMER1->CNT) {
+        return sim_cnt;
+    }
+    if (addr < QN_APB_BASE || addr >= QN_APB_BASE + sizeof(apb_reg)) {
+        printf("register 0x%08x not modelled\n", addr);
+        abort();
+    }
+    return apb_reg[(addr - QN_APB_BASE) / 4];
+}
+
+void __wr_reg(uint32_t addr, uint32_t val)
+{
+    __rd_reg(addr);
+    apb_reg[(addr - QN_APB_BASE) / 4] = val;
+}
+
+void __wr_reg_with_msk(uint32_t addr, uint32_t msk, uint32_t val)
+{
+    __wr_reg(addr, (__rd_reg(addr) & ~msk) | (msk & val));
+}
+
+static bool timer1_on(void)
+{
+    return (__rd_reg((uint32_t)(uintptr_t)&QN_TIMER1->CR) & TIMER_MASK_TEN) != 0;
+}
+
+/// Run the interrupts set pending by the driver, the entry takes 1 us
+static void sim_pending(void)
+{
+    while (NVIC->ISPR[0] & (1 << TIMER1_IRQn)) {
+        NVIC->ISPR[0] = 0;
+        sim_cnt++;
+        TIMER1_IRQHandler();
+    }
+}
+
+/// Advance the counter by us, with the compare interrupts on the way
+static void sim_run(uint32_t us)
+{
+    uint32_t end = sim_cnt + us;
+    uint32_t step;
+
+    sim_pending();
+    while ((int32_t)(end - sim_cnt) > 0) {
+        step = __rd_reg((uint32_t)(uintptr_t)&QN_TIMER1->CCR) - sim_cnt;
+        if (!timer1_on() || step == 0 || step > end - sim_cnt) {
+            sim_cnt = end;
+            return;
+        }
+        sim_cnt += step;
+        TIMER1_IRQHandler();
+        sim_pending();
+    }
+}
+
+/// Software timer with its expected deadlines
+struct test_tmr
+{
+    struct timer_wheel_tag tmr;
+    uint32_t deadline;
+    uint32_t expiries;
+};
+
+static struct test_tmr tmrs[TMR_NB];
+static uint32_t late_nb, early_nb, expiry_nb;
+
+static void tmr_cb(struct timer_wheel_tag *tmr)
+{
+    struct test_tmr *t = (struct test_tmr *)tmr;
+    int32_t diff = (int32_t)(timer_wheel_time() - t->deadline);
+
+    // The compare match is exact in the model, the late ones are started too close
+    late_nb += diff > TIMER_WHEEL_MIN_US;
+    early_nb += diff < 0;
+    expiry_nb++;
+    t->expiries++;
+    if (tmr->period) {
+        t->deadline += tmr->period;
+    }
+}
+
+static void tmr_start(struct test_tmr *t, uint32_t delay, uint32_t period)
+{
+    timer_wheel_start(&t->tmr, delay, period, tmr_cb);
+    t->deadline = timer_wheel_time() + delay;
+}
+
+static void test_random(void)
+{
+    struct test_tmr *t;
+    uint32_t n, us, active;
+
+    // Start close to the counter wrap
+    sim_cnt = 0xFFF00000;
+    timer_wheel_init();
+    srand(9);
+    for (n = 0; n < 200000; n++) {
+        t = &tmrs[rand() % TMR_NB];
+        switch (rand() % 8) {
+        case 0:
+            timer_wheel_stop(&t->tmr);
+            break;
+        case 1:
+        case 2:
+            tmr_start(t, 3 + rand() % 5000, 0);
+            break;
+        case 3:
+            tmr_start(t, 3 + rand() % 5000, 100 + rand() % 3000);
+            break;
+        default:
+            sim_run(rand() % 200);
+            break;
+        }
+    }
+    CHECK(expiry_nb > 100000);
+    CHECK(late_nb == 0);
+    CHECK(early_nb == 0);
+
+    // The deadline list is ordered and holds the active timers
+    for (active = 0, n = 0; n < TMR_NB; n++) {
+        active += tmrs[n].tmr.active;
+    }
+    for (us = 0, t = (struct test_tmr *)timer_wheel_env.head; t != NULL;
+         t = (struct test_tmr *)t->tmr.next, us++) {
+        CHECK(t->tmr.next == NULL || (int32_t)(t->tmr.next->expire - t->tmr.expire) >= 0);
+    }
+    CHECK(us == active);
+
+    // Timer1 is released when the last timer is stopped
+    for (n = 0; n < TMR_NB; n++) {
+        timer_wheel_stop(&tmrs[n].tmr);
+    }
+    CHECK(!timer1_on());
+    CHECK((sleep_env.dev_active_bf & PM_MASK_TIMER1_ACTIVE_BIT) == 0);
+}
+
+/// A periodic timer keeps its period without drift among the other timers
+static void test_period(void)
+{
+    struct test_tmr *t = &tmrs[0];
+    uint32_t start = timer_wheel_time(), n;
+
+    for (n = 1; n < 150; n++) {
+        tmr_start(&tmrs[n], 10 + n * 37, 50 + n);
+    }
+    tmr_start(t, 1000, 1000);
+    t->expiries = 0;
+    sim_run(1000000);
+    CHECK(t->expiries == 1000);
+    CHECK(t->deadline == start + 1001000);
+    CHECK(late_nb == 0);
+    for (n = 0; n < 150; n++) {
+        timer_wheel_stop(&tmrs[n].tmr);
+    }
+}
+
+static void bench(void)
+{
+    static uint32_t delay[TMR_NB * 4];
+    uint32_t nb_list[] = {16, 100, 256};
+    uint64_t t0, t1, t2, t3;
+    uint32_t i, k, nb, rounds = 200;
+    uint32_t expiries;
+
+    for (i = 0; i < TMR_NB * 4; i++) {
+        delay[i] = 10 + rand() % 100000;
+    }
+
+    printf("timers  start ns  stop ns  expiry ns\n");
+    for (k = 0; k < sizeof(nb_list) / sizeof(nb_list[0]); k++) {
+        nb = nb_list[k];
+        t0 = host_ns();
+        for (i = 0; i < rounds; i++) {
+            timer_wheel_start(&tmrs[i % nb].tmr, delay[i % (TMR_NB * 4)], 0, tmr_cb);
+        }
+        for (i = 0; i < nb; i++) {
+            timer_wheel_start(&tmrs[i].tmr, delay[i], 0, tmr_cb);
+        }
+        t1 = host_ns();
+        for (i = 0; i < nb; i++) {
+            timer_wheel_stop(&tmrs[(i * 7) % nb].tmr);
+        }
+        t2 = host_ns();
+        for (i = 0; i < nb; i++) {
+            timer_wheel_start(&tmrs[i].tmr, delay[i], 0, tmr_cb);
+        }
+        expiries = expiry_nb;
+        t3 = host_ns();
+        sim_run(200000);
+        t3 = host_ns() - t3;
+        CHECK(expiry_nb - expiries == nb);
+        printf("%6d  %8.1f  %7.1f  %9.1f\n", nb, (double)(t1 - t0) / (rounds + nb),
+               (double)(t2 - t1) / nb, (double)t3 / nb);
+    }
+}
+
+int main(void)
+{
+    if (mmap((void *)SCS_BASE, 0x1000, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != (void *)SCS_BASE) {
+        printf("can not map the system control space\n");
+        return 1;
+    }
+
+    test_random();
+    test_period();
+    bench();
+    return host_result("test_timer");
+}
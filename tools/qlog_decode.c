@@ -0,0 +1,428 @@
+/**
+ ****************************************************************************************
+ *
+ * @file qlog_decode.c
+ *
+ * @brief Host decoder of the tokenized print records of qlog()
+ *
+ *   qlog_decode <image.axf|image.elf> [capture.bin]
+ *
+ * The records are read from the capture file, or from the standard input as they arrive
+ * from the debug UART, and printed with the format strings of the ELF image of the
+ * firmware. The record format is in src/app/app_qlog.h, build with:
+ *
+ *   cc -I src/app -o qlog_decode tools/qlog_decode.c
+ *
+ * Copyright(C) 2015 NXP Semiconductors N.V.
+ * All rights reserved.
+ *
+ * $Rev: 1.0 $
+ *
+ ****************************************************************************************
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_qlog.h"
+
+/// Format string at a firmware address, NULL if unknown
+typedef const char *(*qlog_fmt_get)(uint32_t addr, void *ctx);
+
+/// Read a LEB128 number, return false if the record ends before it
+static int qlog_get_num(const uint8_t **p, const uint8_t *end, uint32_t *v)
+{
+    uint8_t shift = 0;
+
+    *v = 0;
+    while (*p < end && shift < 35)
+    {
+        *v |= (uint32_t)(**p & 0x7F) << shift;
+        if ((*(*p)++ & 0x80) == 0)
+            return 1;
+        shift += 7;
+    }
+    return 0;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Print a record to a text buffer
+ *
+ * @param[in] body      Record after the sync and length bytes
+ * @param[in] len       Length of the body
+ * @param[in] get       Format string lookup
+ * @param[out] out      Text, always terminated
+ * @param[in] size      Size of the text buffer
+ *
+ * @return Text length, -1 if the record does not match its format string. An argument
+ * cut by the QLOG_REC_MAX limit of the firmware is printed as "<cut>" and ends the line.
+ ****************************************************************************************
+ */
+int qlog_decode_rec(const uint8_t *body, uint8_t len, qlog_fmt_get get, void *ctx,
+                    char *out, int size)
+{
+    const uint8_t *p = body + QLOG_HDR_LEN - 2;
+    const uint8_t *end = body + len;
+    const char *fmt;
+    char spec[32], text[24];
+    char *o = out;
+    uint32_t addr, u;
+    int32_t v;
+    uint8_t arg, qualifier, n, i, has_width, in_prec;
+    int sl, tl;
+    char *dot;
+
+    if (len < QLOG_HDR_LEN - 2)
+        return -1;
+    addr = body[0] | (body[1] << 8) | (body[2] << 16) | ((uint32_t)body[3] << 24);
+
+#define QLOG_OUT(...)                                                   \
+    do {                                                                \
+        int r = snprintf(o, size - (o - out), __VA_ARGS__);             \
+        o += (r < size - (o - out)) ? r : size - (o - out) - 1;         \
+    } while (0)
+
+    if (addr == QLOG_LOST_ADDR)
+    {
+        if (!qlog_get_num(&p, end, &u) || p != end)
+            return -1;
+        QLOG_OUT("<%u records lost>\n", u);
+        return o - out;
+    }
+
+    fmt = get(addr, ctx);
+    if (fmt == NULL)
+        return -1;
+
+    *o = '\0';
+    for (; *fmt; fmt++)
+    {
+        if (*fmt != '%')
+        {
+            if (*fmt != '\r')
+                QLOG_OUT("%c", *fmt);
+            continue;
+        }
+
+        // rebuild the conversion with the '*' values written in
+        sl = 0;
+        spec[sl++] = '%';
+        has_width = 0;
+        in_prec = 0;
+        while (*++fmt && strchr(QLOG_FLAG_CHARS, *fmt) && sl < 20)
+        {
+            if (*fmt == '*')
+            {
+                if (!qlog_get_num(&p, end, &u))
+                {
+                    QLOG_OUT("<cut>\n");
+                    return o - out;
+                }
+                v = (int32_t)u;
+                // a negative precision is no precision
+                if (spec[sl - 1] == '.' && v < 0)
+                    v = 0;
+                sl += snprintf(&spec[sl], sizeof(spec) - sl, "%d", (int)v);
+            }
+            else
+            {
+                spec[sl++] = *fmt;
+            }
+            if (*fmt == '.')
+                in_prec = 1;
+            else if (*fmt != '0' && !in_prec && strchr("123456789*", *fmt))
+                has_width = 1;
+        }
+        spec[sl] = '\0';
+
+        qualifier = 0;
+        if (*fmt == 'h' || *fmt == 'l' || *fmt == 'L')
+            qualifier = *fmt++;
+
+        if (*fmt == '\0')
+            break;
+
+        switch (*fmt)
+        {
+            QLOG_CONV_TABLE(QLOG_CONV_CASE)
+            default:
+                arg = QLOG_ARG_NONE;
+                break;
+        }
+
+        if (arg == QLOG_ARG_ZIGZAG || arg == QLOG_ARG_NUM)
+        {
+            if (!qlog_get_num(&p, end, &u))
+            {
+                QLOG_OUT("<cut>\n");
+                return o - out;
+            }
+        }
+
+        switch (arg)
+        {
+            case QLOG_ARG_ZIGZAG:
+                v = (int32_t)((u >> 1) ^ (0 - (u & 1)));
+                spec[sl++] = *fmt;
+                spec[sl] = '\0';
+                QLOG_OUT(spec, (int)v);
+                break;
+            case QLOG_ARG_NUM:
+                if (*fmt == 'p')
+                {
+                    // the firmware prints a pointer in 8 digits by default
+                    if (!has_width)
+                    {
+                        spec[sl++] = '0';
+                        spec[sl++] = '8';
+                    }
+                    spec[sl++] = 'x';
+                }
+                else
+                {
+                    spec[sl++] = *fmt;
+                }
+                spec[sl] = '\0';
+                if (*fmt == 'c')
+                    QLOG_OUT(spec, (int)(uint8_t)u);
+                else
+                    QLOG_OUT(spec, (unsigned int)u);
+                break;
+            case QLOG_ARG_STR:
+                for (n = 0; p + n < end && p[n]; n++)
+                    ;
+                if (p + n == end)
+                {
+                    QLOG_OUT("%.*s<cut>\n", n, (const char *)p);
+                    return o - out;
+                }
+                spec[sl++] = 's';
+                spec[sl] = '\0';
+                QLOG_OUT(spec, (const char *)p);
+                p += n + 1;
+                break;
+            case QLOG_ARG_ADDR:
+                n = QLOG_ADDR_LEN(qualifier);
+                if (end - p < n)
+                {
+                    QLOG_OUT("<cut>\n");
+                    return o - out;
+                }
+                tl = 0;
+                for (i = 0; i < n; i++)
+                {
+                    if (n == 4)
+                        tl += sprintf(&text[tl], i ? ".%d" : "%d", p[i]);
+                    else
+                        tl += sprintf(&text[tl], *fmt == 'A' ? (i ? ":%02X" : "%02X")
+                                                             : (i ? ":%02x" : "%02x"), p[i]);
+                }
+                p += n;
+                // the address is padded to the width, there is no precision
+                dot = strchr(spec, '.');
+                if (dot != NULL)
+                    sl = dot - spec;
+                spec[sl++] = 's';
+                spec[sl] = '\0';
+                QLOG_OUT(spec, text);
+                break;
+            case QLOG_ARG_SKIP:
+                break;
+            default:
+                if (*fmt != '%')
+                    QLOG_OUT("%%");
+                QLOG_OUT("%c", *fmt);
+                break;
+        }
+    }
+
+#undef QLOG_OUT
+
+    return (p == end) ? (int)(o - out) : -1;
+}
+
+/**
+ ****************************************************************************************
+ * @brief Print the complete records of a byte stream
+ *
+ * The bytes before a sync byte, and a sync byte starting no valid record, are skipped.
+ *
+ * @param[in] data      Received bytes
+ * @param[in] n         Number of received bytes
+ * @param[in] get       Format string lookup
+ * @param[in] out       Text output
+ * @param[in,out] skipped   Count of the skipped bytes
+ *
+ * @return Bytes consumed, the rest is the start of a record still to receive
+ ****************************************************************************************
+ */
+size_t qlog_decode_buf(const uint8_t *data, size_t n, qlog_fmt_get get, void *ctx, FILE *out,
+                       uint32_t *skipped)
+{
+    char text[512];
+    size_t i = 0;
+    uint8_t len;
+
+    while (i < n)
+    {
+        if (data[i] != QLOG_SYNC)
+        {
+            i++;
+            (*skipped)++;
+            continue;
+        }
+        if (i + 1 >= n)
+            break;
+        len = data[i + 1];
+        if (len < QLOG_HDR_LEN - 2 || len > QLOG_REC_MAX - 2)
+        {
+            i++;
+            (*skipped)++;
+            continue;
+        }
+        if (i + 2 + len > n)
+            break;
+        if (qlog_decode_rec(&data[i + 2], len, get, ctx, text, sizeof(text)) < 0)
+        {
+            i++;
+            (*skipped)++;
+            continue;
+        }
+        fputs(text, out);
+        i += 2 + len;
+    }
+    return i;
+}
+
+/// Allocated sections of the ELF image
+static struct
+{
+    uint8_t *file;
+    long size;
+    struct
+    {
+        uint32_t addr;
+        uint32_t size;
+        uint32_t offset;
+    } sec[64];
+    int sec_nb;
+} elf;
+
+static uint32_t elf_u32(long off)
+{
+    return elf.file[off] | (elf.file[off + 1] << 8) | (elf.file[off + 2] << 16)
+         | ((uint32_t)elf.file[off + 3] << 24);
+}
+
+static uint16_t elf_u16(long off)
+{
+    return elf.file[off] | (elf.file[off + 1] << 8);
+}
+
+/// Load the allocated sections with content of a 32-bit little endian ELF file
+static int elf_load(const char *name)
+{
+    FILE *f = fopen(name, "rb");
+    uint32_t shoff, type, flags;
+    uint16_t shentsize, shnum, k;
+    long sh;
+
+    if (f == NULL)
+        return 0;
+    fseek(f, 0, SEEK_END);
+    elf.size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    elf.file = malloc(elf.size);
+    if (elf.file == NULL || fread(elf.file, 1, elf.size, f) != (size_t)elf.size)
+    {
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+
+    // ELFCLASS32, ELFDATA2LSB
+    if (elf.size < 52 || memcmp(elf.file, "\177ELF\1\1", 6) != 0)
+        return 0;
+    shoff = elf_u32(32);
+    shentsize = elf_u16(46);
+    shnum = elf_u16(48);
+    for (k = 0; k < shnum && elf.sec_nb < 64; k++)
+    {
+        sh = shoff + (long)k * shentsize;
+        if (sh + 40 > elf.size)
+            return 0;
+        type = elf_u32(sh + 4);
+        flags = elf_u32(sh + 8);
+        // SHF_ALLOC, not SHT_NOBITS
+        if ((flags & 0x2) && type != 8 && elf_u32(sh + 16) + elf_u32(sh + 20) <= (uint32_t)elf.size)
+        {
+            elf.sec[elf.sec_nb].addr = elf_u32(sh + 12);
+            elf.sec[elf.sec_nb].offset = elf_u32(sh + 16);
+            elf.sec[elf.sec_nb].size = elf_u32(sh + 20);
+            elf.sec_nb++;
+        }
+    }
+    return elf.sec_nb != 0;
+}
+
+static const char *elf_fmt_get(uint32_t addr, void *ctx)
+{
+    const char *s;
+    int k;
+
+    (void)ctx;
+    for (k = 0; k < elf.sec_nb; k++)
+    {
+        if (addr - elf.sec[k].addr < elf.sec[k].size)
+        {
+            // the string shall end in the section
+            s = (const char *)&elf.file[elf.sec[k].offset + addr - elf.sec[k].addr];
+            if (memchr(s, 0, elf.sec[k].size - (addr - elf.sec[k].addr)) == NULL)
+                return NULL;
+            return s;
+        }
+    }
+    return NULL;
+}
+
+#ifndef QLOG_DECODE_NO_MAIN
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[4096];
+    FILE *in = stdin;
+    size_t n = 0, r, used;
+    uint32_t skipped = 0;
+
+    if (argc < 2 || argc > 3)
+    {
+        fprintf(stderr, "usage: %s <image.axf|image.elf> [capture.bin]\n", argv[0]);
+        return 2;
+    }
+    if (!elf_load(argv[1]))
+    {
+        fprintf(stderr, "%s: not a 32-bit little endian ELF image\n", argv[1]);
+        return 1;
+    }
+    if (argc == 3 && (in = fopen(argv[2], "rb")) == NULL)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+
+    while ((r = fread(buf + n, 1, sizeof(buf) - n, in)) > 0)
+    {
+        n += r;
+        used = qlog_decode_buf(buf, n, elf_fmt_get, NULL, stdout, &skipped);
+        memmove(buf, buf + used, n - used);
+        n -= used;
+        fflush(stdout);
+    }
+    if (skipped + n)
+        fprintf(stderr, "%u bytes skipped\n", skipped + (uint32_t)n);
+    return 0;
+}
+
+#endif // QLOG_DECODE_NO_MAIN